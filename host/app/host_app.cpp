@@ -0,0 +1,485 @@
+/* Host stand-in for app_main.cpp, light_sync.cpp, the fan-out transport, the scene store / transport and the rule store (see host_app.h). */
+#include "host_app.h"
+
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <app-common/zap-generated/cluster-objects.h>
+#include <platform/PlatformManager.h>
+#include "mock_hw.h"
+#include "frame_pool.h"
+#include "light_internal.h"
+#include "rules.h"
+
+// Endpoints as app_main numbers them: channels 1..LIGHT_CHANNELS, then temperature and humidity.
+uint16_t g_onoff_endpoint_ids[LIGHT_CHANNELS];
+uint16_t g_temp_endpoint_id = LIGHT_CHANNELS + 1;
+uint16_t g_humidity_endpoint_id = LIGHT_CHANNELS + 2;
+static struct EndpointInit {
+    EndpointInit() { for (int i = 0; i < LIGHT_CHANNELS; i++) g_onoff_endpoint_ids[i] = (uint16_t)(i + 1); }
+} s_endpoint_init;
+
+static ShadowBindingList s_lists[LIGHT_CHANNELS];
+const ShadowBindingList * shadow_binding_get_list(int ch) { return (ch >= 0 && ch < LIGHT_CHANNELS) ? &s_lists[ch] : nullptr; }
+
+struct Target {
+    bool on = false;
+    bool reachable = true;
+    bool lost = false;
+    bool session = false; // a CASE session is up (set by the first answered exchange)
+    uint32_t toggles = 0;
+    int64_t rtt_us = 0;
+    // LevelControl: level at move_start_us, moving at move_rate units/s (sign = direction, 0 = still).
+    int level = 128;
+    int move_rate = 0;
+    int64_t move_start_us = 0;
+    uint32_t level_cmds = 0;
+    int mireds = 0; // ColorControl colour temperature (0 = never set)
+};
+static std::map<std::pair<uint64_t, uint16_t>, Target> s_targets;
+static std::multimap<uint16_t, std::pair<uint64_t, uint16_t>> s_group_members;
+static HostAppStats s_stats;
+static bool s_link_up = true; // light_link_up(); down: cluster_update fails and reads are not started
+
+// Responses / read results waiting for the Matter thread, delivered in send order.
+struct PendingResult {
+    void * txn; // request_data of the dispatch (press transaction handle)
+    LightToggleResult result;
+};
+struct PendingFanout {
+    intptr_t token;
+    bool ok;
+    uint32_t rtt_us;
+    void * frame;
+};
+struct PendingRead {
+    void * frame;
+    intptr_t req;
+    uint64_t node_id;
+    uint32_t rtt_us;
+    uint8_t n;
+    struct {
+        uint8_t ch;
+        uint16_t ep;
+        bool on;
+        bool ok; // false: the target is down (or lost), its path fails
+    } paths[SyncBatchPlan::kMaxPaths];
+};
+// Pending deliveries live in slot pools reserved in host_app_reset(): with per-target RTTs they
+// complete out of order, and steady-state delivery must not touch the heap (host_scale counts it).
+template <typename T>
+struct Pool {
+    std::vector<T> slots;
+    std::vector<uint32_t> free_list;
+    uint32_t put(const T & v)
+    {
+        if (free_list.empty()) {
+            slots.push_back(v);
+            return (uint32_t)slots.size() - 1;
+        }
+        uint32_t i = free_list.back();
+        free_list.pop_back();
+        slots[i] = v;
+        return i;
+    }
+    T take(uint32_t i)
+    {
+        free_list.push_back(i);
+        return slots[i];
+    }
+    void reset(size_t reserve)
+    {
+        slots.clear();
+        free_list.clear();
+        slots.reserve(reserve);
+        free_list.reserve(reserve);
+    }
+};
+static Pool<PendingResult> s_results;
+static Pool<PendingRead> s_reads;
+static Pool<PendingFanout> s_fanout;
+struct PendingSceneResult {
+    intptr_t handle;
+    bool ok;
+};
+static Pool<PendingSceneResult> s_scene_results;
+
+static Target & target(uint64_t node, uint16_t ep) { return s_targets[{ node, ep }]; }
+
+void host_target_set(uint64_t node, uint16_t ep, bool on, bool reachable)
+{
+    Target & t = target(node, ep);
+    t.on = on;
+    t.reachable = reachable;
+}
+void host_target_set_rtt(uint64_t node, uint16_t ep, int64_t rtt_us) { target(node, ep).rtt_us = rtt_us; }
+void host_target_set_lost(uint64_t node, uint16_t ep, bool lost) { target(node, ep).lost = lost; }
+// MoveWithOnOff semantics: the level clamps to 1..254 and a move down that reaches 1 switches off.
+static int level_at(Target & t, int64_t now)
+{
+    if (!t.move_rate) return t.level;
+    int64_t l = t.level + t.move_rate * (now - t.move_start_us) / 1000000;
+    return l < 1 ? 1 : l > 254 ? 254 : (int)l;
+}
+static void level_settle(Target & t, int64_t now)
+{
+    t.level = level_at(t, now);
+    if (t.move_rate < 0 && t.level == 1) t.on = false;
+    t.move_rate = 0;
+}
+bool host_target_on(uint64_t node, uint16_t ep)
+{
+    Target & t = target(node, ep);
+    if (t.move_rate < 0 && level_at(t, mock_clock_now_us()) == 1) level_settle(t, mock_clock_now_us());
+    return t.on;
+}
+int host_target_level(uint64_t node, uint16_t ep)
+{
+    Target & t = target(node, ep);
+    return level_at(t, mock_clock_now_us());
+}
+uint32_t host_target_level_cmds(uint64_t node, uint16_t ep) { return target(node, ep).level_cmds; }
+int host_target_mireds(uint64_t node, uint16_t ep) { return target(node, ep).mireds; }
+void host_group_add_member(uint16_t group_id, uint64_t node, uint16_t ep) { s_group_members.insert({ group_id, { node, ep } }); }
+uint32_t host_target_toggles(uint64_t node, uint16_t ep) { return target(node, ep).toggles; }
+const HostAppStats & host_app_stats() { return s_stats; }
+
+static void deliver_result(intptr_t slot)
+{
+    PendingResult p = s_results.take((uint32_t)slot);
+    light_toggle_target_result(p.txn, &p.result);
+}
+
+// Apply one OnOff / LevelControl command to a target (state changes when the command is sent).
+static bool apply_command(Target & t, const chip::app::CommandPathParams & path, const void * request_data)
+{
+    using namespace chip::app::Clusters;
+    int64_t now = mock_clock_now_us();
+    if (path.mClusterId == LevelControl::Id) {
+        level_settle(t, now);
+        t.level_cmds++;
+        if (path.mCommandId == LevelControl::Commands::MoveWithOnOff::Id) {
+            LightLevelReq r = light_level_unpack(request_data);
+            t.move_rate = r.mode == kLevelMoveUp ? r.rate : -(int)r.rate;
+            t.move_start_us = now;
+            if (r.mode == kLevelMoveUp) t.on = true;
+        }
+        return true;
+    }
+    if (path.mCommandId == OnOff::Commands::Off::Id) t.on = false;
+    else if (path.mCommandId == OnOff::Commands::On::Id) t.on = true;
+    else t.on = !t.on;
+    t.toggles++;
+    return true;
+}
+
+// Mirrors the binding-manager request callbacks in app_main: the command goes to every binding of the
+// channel that owns `local_ep` whose cluster matches (or that has none). Unicast OnOff commands answer
+// one target RTT later; groupcasts reach every member at once and are fire-and-forget.
+static esp_err_t on_cluster_update(uint16_t local_ep, const esp_matter::client::request_handle_t & req)
+{
+    s_stats.cluster_updates++;
+    if (!s_link_up) return ESP_ERR_INVALID_STATE;
+    int ch = -1;
+    for (int i = 0; i < LIGHT_CHANNELS; i++) if (g_onoff_endpoint_ids[i] == local_ep) ch = i;
+    if (ch < 0) return ESP_ERR_NOT_FOUND;
+    const bool level = req.command_path.mClusterId == chip::app::Clusters::LevelControl::Id;
+    const ShadowBindingList & list = s_lists[ch];
+    for (int i = 0; i < list.count; i++) {
+        const ShadowBindingEntry & e = list.entries[i];
+        if (e.cluster_id && e.cluster_id != req.command_path.mClusterId) continue;
+        if (e.is_group) {
+            s_stats.group_sends++;
+            auto range = s_group_members.equal_range(e.group_id);
+            for (auto it = range.first; it != range.second; ++it) {
+                Target & m = target(it->second.first, it->second.second);
+                if (m.reachable && !m.lost) apply_command(m, req.command_path, req.request_data);
+            }
+            continue;
+        }
+        if (level && light_level_unpack(req.request_data).group_only) continue;
+        if (light_target_blocked(e.node_id, e.endpoint, level ? 0 : (intptr_t)req.request_data)) continue; // breaker open: the dispatch already failed it
+        Target & t = target(e.node_id, e.endpoint);
+        s_stats.toggles_sent++;
+        if (t.lost) continue;
+        bool ok = t.reachable;
+        if (ok) apply_command(t, req.command_path, req.request_data);
+        else s_stats.toggles_failed++;
+        if (level) continue; // LevelControl responses carry no press transaction
+        uint32_t slot = s_results.put({ req.request_data, { e.node_id, e.endpoint, ok, (uint32_t)t.rtt_us } });
+        mock_matter_post_after(t.rtt_us, deliver_result, (intptr_t)slot);
+    }
+    return ESP_OK;
+}
+
+static void deliver_fanout(intptr_t slot)
+{
+    PendingFanout p = s_fanout.take((uint32_t)slot);
+    light_fanout_result(p.token, p.ok, p.rtt_us);
+    coro_frame_free(p.frame);
+}
+
+// fanout_transport.cpp replacement. A command to a target without a session pays for CASE setup
+// (two more RTTs); it applies when sent and answers one exchange later. A lost target fails after
+// kExchangeTimeoutUs (the CASE / exchange timeout on the device). Like the coroutine it stands in for,
+// each send holds a frame of the shared pool (coro_frames.cpp) until its result is delivered.
+static constexpr int64_t kExchangeTimeoutUs = 5000000;
+static constexpr size_t kFrameBytes = 512; // stand-in for a transport coroutine frame
+bool light_unicast_send(uint8_t, uint64_t node_id, uint16_t endpoint, uint32_t cmd, intptr_t token)
+{
+    if (!s_link_up) return false;
+    void * frame = coro_frame_alloc(kFrameBytes);
+    if (!frame) return false;
+    Target & t = target(node_id, endpoint);
+    s_stats.toggles_sent++;
+    int64_t took = t.lost ? kExchangeTimeoutUs : t.rtt_us * (t.session ? 1 : 3);
+    bool ok = t.reachable && !t.lost;
+    if (ok) {
+        chip::app::CommandPathParams path(endpoint, 0, chip::app::Clusters::OnOff::Id, cmd, (chip::app::CommandPathFlags)0);
+        apply_command(t, path, nullptr);
+        t.session = true;
+    } else if (!t.lost) {
+        s_stats.toggles_failed++;
+    }
+    uint32_t slot = s_fanout.put({ token, ok, ok ? (uint32_t)took : 0, frame });
+    mock_matter_post_after(took, deliver_fanout, (intptr_t)slot);
+    return true;
+}
+bool light_session_cached(uint8_t, uint64_t node_id)
+{
+    for (auto it = s_targets.lower_bound({ node_id, 0 }); it != s_targets.end() && it->first.first == node_id; ++it)
+        if (it->second.session) return true;
+    return false;
+}
+bool light_group_send(uint8_t, uint16_t group_id, uint32_t cmd)
+{
+    if (!s_link_up) return false;
+    s_stats.group_sends++;
+    chip::app::CommandPathParams path(0, group_id, chip::app::Clusters::OnOff::Id, cmd, (chip::app::CommandPathFlags)0);
+    auto range = s_group_members.equal_range(group_id);
+    for (auto it = range.first; it != range.second; ++it) {
+        Target & m = target(it->second.first, it->second.second);
+        if (m.reachable && !m.lost) apply_command(m, path, nullptr);
+    }
+    return true;
+}
+
+static void deliver_read(intptr_t slot)
+{
+    PendingRead r = s_reads.take((uint32_t)slot);
+    for (uint8_t i = 0; i < r.n; i++) {
+        bool dup = false;
+        for (uint8_t j = 0; j < i && !dup; j++) dup = r.paths[j].ep == r.paths[i].ep;
+        if (dup) continue;
+        light_target_report(r.node_id, r.paths[i].ep, r.paths[i].ok, r.paths[i].ok ? r.rtt_us : 0);
+        if (r.paths[i].ok) target(r.node_id, r.paths[i].ep).session = true;
+    }
+    for (uint8_t i = 0; i < r.n; i++)
+        if (r.paths[i].ok) light_sync_on_value(r.req, r.paths[i].ch, r.paths[i].on);
+    light_sync_on_done(r.req);
+    coro_frame_free(r.frame);
+}
+
+// light_sync.cpp replacement: one request per node, answered after the slowest of its targets' RTTs
+// (next drain in real-time mode). Paths of down or lost targets fail. A node whose targets are all
+// lost answers nothing: its read fails only when the CASE attempt gives up (kCaseTimeoutUs), well
+// after LIGHT_SYNC_READ_TIMEOUT_MS. Each read holds a frame of the shared pool until then.
+static constexpr int64_t kCaseTimeoutUs = 3 * kExchangeTimeoutUs; // CASE establishment with its retries
+bool light_sync_send_reads(uint8_t, uint64_t node_id, const LightSyncPath * paths, uint8_t n, intptr_t req)
+{
+    if (!s_link_up || !n || n > SyncBatchPlan::kMaxPaths) return false;
+    void * frame = coro_frame_alloc(kFrameBytes);
+    if (!frame) return false;
+    PendingRead r{ frame, req, node_id, 0, n, {} };
+    bool any = false;
+    for (uint8_t i = 0; i < n; i++) {
+        Target & t = target(node_id, paths[i].endpoint);
+        r.paths[i] = { paths[i].ch, paths[i].endpoint, t.on, t.reachable && !t.lost };
+        if (!t.lost) any = true;
+        if ((uint32_t)t.rtt_us > r.rtt_us) r.rtt_us = (uint32_t)t.rtt_us;
+    }
+    s_stats.reads_sent++;
+    s_stats.read_paths += n;
+    if (!any) r.rtt_us = (uint32_t)kCaseTimeoutUs;
+    uint32_t slot = s_reads.put(r);
+    mock_matter_post_after(r.rtt_us, deliver_read, (intptr_t)slot);
+    return true;
+}
+
+// switch_event_log.cpp replacement: the event log and CurrentPosition of every channel endpoint.
+static std::vector<HostSwitchEvent> s_switch_events[LIGHT_CHANNELS];
+static uint8_t s_switch_position[LIGHT_CHANNELS];
+
+bool light_switch_log_event(uint16_t endpoint, SwitchEvent ev, uint8_t count)
+{
+    for (int ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        if (g_onoff_endpoint_ids[ch] != endpoint) continue;
+        s_switch_events[ch].push_back({ ev, count });
+        if (ev == SwitchEvent::InitialPress) s_switch_position[ch] = 1;
+        else if (ev == SwitchEvent::ShortRelease || ev == SwitchEvent::LongRelease) s_switch_position[ch] = 0;
+        return true;
+    }
+    return false;
+}
+
+const std::vector<HostSwitchEvent> & host_switch_events(uint8_t ch) { return s_switch_events[ch % LIGHT_CHANNELS]; }
+void host_switch_events_clear(uint8_t ch) { s_switch_events[ch % LIGHT_CHANNELS].clear(); }
+uint8_t host_switch_position(uint8_t ch) { return s_switch_position[ch % LIGHT_CHANNELS]; }
+
+// scene_store.cpp replacement: scenes kept in RAM only.
+static Scene s_scenes[SCENE_COUNT];
+
+void scene_store_load() {}
+const Scene * scene_store_get(uint8_t id) { return id < SCENE_COUNT && s_scenes[id].count ? &s_scenes[id] : nullptr; }
+esp_err_t scene_store_put(uint8_t id, const Scene * s)
+{
+    if (id >= SCENE_COUNT || (s && s->count > SCENE_MAX_ACTIONS)) return ESP_ERR_INVALID_ARG;
+    s_scenes[id] = s ? *s : Scene{};
+    return ESP_OK;
+}
+
+// scene_transport.cpp replacement. Unicast commands apply when sent and answer one target RTT later
+// (lost targets never answer); groupcasts reach every member at once and count as done when sent.
+static void apply_scene_cmd(Target & t, const SceneCmd & c)
+{
+    switch (c.kind) {
+    case SceneCmd::Off: t.on = false; t.toggles++; break;
+    case SceneCmd::On: t.on = true; t.toggles++; break;
+    case SceneCmd::Level:
+        level_settle(t, mock_clock_now_us());
+        t.level = c.level;
+        t.on = true;
+        t.level_cmds++;
+        break;
+    case SceneCmd::ColorTemp: t.mireds = c.mireds; break;
+    }
+}
+
+static void deliver_scene_result(intptr_t slot)
+{
+    PendingSceneResult r = s_scene_results.take((uint32_t)slot);
+    light_scene_cmd_result(r.handle, r.ok);
+}
+
+void light_scene_send(const SceneCmd * cmds, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        const SceneCmd & c = cmds[i];
+        if (c.group) {
+            s_stats.group_sends++;
+            auto range = s_group_members.equal_range(c.dest);
+            for (auto it = range.first; it != range.second; ++it) {
+                Target & m = target(it->second.first, it->second.second);
+                if (m.reachable && !m.lost) apply_scene_cmd(m, c);
+            }
+            light_scene_cmd_result(c.handle, true);
+            continue;
+        }
+        Target & t = target(c.node_id, c.dest);
+        s_stats.scene_cmds_sent++;
+        if (t.lost) continue;
+        if (t.reachable) apply_scene_cmd(t, c);
+        uint32_t slot = s_scene_results.put({ c.handle, t.reachable });
+        mock_matter_post_after(t.rtt_us, deliver_scene_result, (intptr_t)slot);
+    }
+}
+
+void light_scene_prewarm(uint8_t, uint64_t) { s_stats.scene_prewarms++; }
+
+// rules_store.cpp replacement: the last saved rule set, in RAM.
+static RuleSet s_rule_store;
+static bool s_rule_store_saved = false;
+
+esp_err_t rules_store_load(RuleSet * out)
+{
+    if (!s_rule_store_saved) return ESP_ERR_NOT_FOUND;
+    *out = s_rule_store;
+    return ESP_OK;
+}
+esp_err_t rules_store_save(const RuleSet & set)
+{
+    s_rule_store = set;
+    s_rule_store_saved = true;
+    return ESP_OK;
+}
+
+// offline_journal.cpp replacement: the link is whatever the scenario set; the journal lives in RAM.
+static OfflineJournal s_journal;
+static bool s_journal_saved = false;
+
+void host_set_link(bool up) { s_link_up = up; }
+bool light_link_up() { return s_link_up; }
+bool light_offline_journal_save(const OfflineJournal & j)
+{
+    s_journal = j;
+    s_journal_saved = true;
+    s_stats.journal_writes++;
+    return true;
+}
+bool light_offline_journal_load(OfflineJournal * out)
+{
+    if (!s_journal_saved) return false;
+    *out = s_journal;
+    return true;
+}
+
+void host_app_reset()
+{
+    host_app_run_until_idle();
+    memset(s_lists, 0, sizeof(s_lists));
+    s_targets.clear();
+    s_group_members.clear();
+    for (int ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        s_switch_events[ch].clear();
+        s_switch_position[ch] = 0;
+    }
+    s_stats = {};
+    for (Scene & sc : s_scenes) sc = {};
+    s_rule_store_saved = false;
+    s_journal_saved = false;
+    s_link_up = true;
+    s_results.reset(LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH * 4);
+    s_reads.reset(LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH * 4);
+    s_fanout.reset(LIGHT_FANOUT_MAX_INFLIGHT * 4);
+    s_scene_results.reset(SCENE_MAX_CMDS * 4);
+    light_button_scan_reset();
+    mock_client_set_update_handler(on_cluster_update);
+}
+
+static shadow_import_result_t import(const ShadowBindingSource & src)
+{
+    int out_ch = -1;
+    return shadow_binding_import(s_lists, g_onoff_endpoint_ids, &src, &out_ch);
+}
+
+shadow_import_result_t host_bind_unicast(uint8_t ch, uint64_t node_id, uint16_t remote_ep, uint32_t cluster_id)
+{
+    if (ch >= LIGHT_CHANNELS) return SHADOW_IMPORT_NOT_OURS;
+    ShadowBindingSource src = { SHADOW_SRC_UNICAST, g_onoff_endpoint_ids[ch], node_id, remote_ep, 0, cluster_id, 1 };
+    return import(src);
+}
+
+shadow_import_result_t host_bind_group(uint8_t ch, uint16_t group_id, uint32_t cluster_id)
+{
+    if (ch >= LIGHT_CHANNELS) return SHADOW_IMPORT_NOT_OURS;
+    ShadowBindingSource src = { SHADOW_SRC_GROUP, g_onoff_endpoint_ids[ch], 0, 0, group_id, cluster_id, 1 };
+    return import(src);
+}
+
+size_t host_app_run_until_idle()
+{
+    if (mock_sim_enabled()) { // virtual time: everything due now (later RTTs stay pending)
+        const MockSimStats & st = mock_sim_stats();
+        uint64_t before = st.work_items + st.timers_fired;
+        mock_sim_run_until(mock_clock_now_us());
+        return (size_t)(st.work_items + st.timers_fired - before);
+    }
+    size_t n = 0;
+    for (;;) {
+        size_t step = mock_matter_run_pending() + mock_timers_run_due();
+        if (!step) return n;
+        n += step;
+    }
+}
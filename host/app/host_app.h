@@ -0,0 +1,69 @@
+/*
+ * Host stand-in for app_main.cpp: endpoint ids, shadow binding lists and a set of simulated
+ * Matter targets that answer OnOff / LevelControl commands and OnOff reads through the mock client
+ * (see mock_hw.h), plus the Generic Switch event log and in-memory scene and rule stores.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "light_manager.h"
+#include "light_internal.h"
+#include "shadow_binding.h"
+
+// Reset endpoints, bindings, targets and the button debounce state.
+void host_app_reset();
+
+// Add a unicast / group binding to `ch` (goes through shadow_binding_import like app_main).
+// `cluster_id` 0 = a binding without a cluster (receives every cluster's commands).
+shadow_import_result_t host_bind_unicast(uint8_t ch, uint64_t node_id, uint16_t remote_ep, uint32_t cluster_id = 0x0006);
+shadow_import_result_t host_bind_group(uint8_t ch, uint16_t group_id, uint32_t cluster_id = 0x0006);
+// Group membership of simulated targets (groupcasts from group bindings reach every member).
+void host_group_add_member(uint16_t group_id, uint64_t node_id, uint16_t ep);
+
+// Simulated target state. Unknown targets are created on first use (off, reachable).
+void host_target_set(uint64_t node_id, uint16_t ep, bool on, bool reachable = true);
+// Response / read-result delay for the target (virtual-time mode only; 0 = next Matter drain).
+void host_target_set_rtt(uint64_t node_id, uint16_t ep, int64_t rtt_us);
+// Lost target: Toggles vanish without a response (the press transaction times out; a fan-out send
+// fails after the exchange timeout); reads go unanswered (the sync read times out).
+void host_target_set_lost(uint64_t node_id, uint16_t ep, bool lost);
+bool host_target_on(uint64_t node_id, uint16_t ep);
+uint32_t host_target_toggles(uint64_t node_id, uint16_t ep);
+// LevelControl model: MoveWithOnOff ramps the level (1..254, starts at 128) until Stop.
+int host_target_level(uint64_t node_id, uint16_t ep);
+uint32_t host_target_level_cmds(uint64_t node_id, uint16_t ep);
+// ColorControl colour temperature set by scenes (0 = never set).
+int host_target_mireds(uint64_t node_id, uint16_t ep);
+
+// Network link (light_link_up). While it is down cluster_update fails and no reads start; a reset
+// brings it back up. The offline journal is kept in RAM (HostAppStats::journal_writes).
+void host_set_link(bool up);
+
+// Generic Switch events logged on channel `ch`'s endpoint (light_switch_log_event), oldest first,
+// and the endpoint's CurrentPosition.
+struct HostSwitchEvent {
+    SwitchEvent ev;
+    uint8_t count;
+};
+const std::vector<HostSwitchEvent> & host_switch_events(uint8_t ch);
+void host_switch_events_clear(uint8_t ch);
+uint8_t host_switch_position(uint8_t ch);
+
+// Counters kept by the simulated transport.
+struct HostAppStats {
+    uint32_t cluster_updates;   // esp_matter::client::cluster_update calls
+    uint32_t toggles_sent;      // unicast Toggle commands delivered to targets
+    uint32_t toggles_failed;    // sent to unreachable targets
+    uint32_t reads_sent;        // OnOff read requests started by the sync round (one per node)
+    uint32_t read_paths;        // attribute paths they carried (one per binding entry)
+    uint32_t group_sends;       // groupcasts (one per group binding and command)
+    uint32_t scene_cmds_sent;   // unicast scene commands
+    uint32_t scene_prewarms;    // scene session prewarms
+    uint32_t journal_writes;    // offline journal saves
+};
+const HostAppStats & host_app_stats();
+
+// Drain Matter work and due timers until both are idle. Returns jobs + timers run.
+// In virtual-time mode this runs the simulation up to the current time without advancing it.
+size_t host_app_run_until_idle();
@@ -0,0 +1,408 @@
+/*
+ * Host micro-benchmarks for the switch logic (button debounce, binding import, toggle fan-out,
+ * LED sync rounds, transport coroutines vs callbacks, DHT22 decode / report, sensor rules, metrics). Runs the firmware sources against the mocks
+ * in host/mocks, so numbers are for comparing changes, not for predicting on-device timing.
+ *
+ *   host_bench [name-substring]
+ *
+ * Every benchmark checks its own result first and exits non-zero if the logic misbehaves.
+ */
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+
+#include "mock_hw.h"
+#include "host_app.h"
+#include "light_internal.h"
+#include "channels.h"
+#include "temp_manager.h"
+#include "dht22_decode.h"
+#include "rules.h"
+#include "coro.h"
+#include "diag/metrics.h"
+#include <app-common/zap-generated/cluster-objects.h>
+
+#define BENCH_CHECK(cond)                                                                  \
+    do {                                                                                   \
+        if (!(cond)) {                                                                     \
+            fprintf(stderr, "check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__);      \
+            exit(1);                                                                       \
+        }                                                                                  \
+    } while (0)
+
+static volatile uint32_t s_sink; // keeps results observable to the optimiser
+
+static void run(const char * filter, const char * name, uint32_t iters, const std::function<void()> & setup,
+                const std::function<void()> & body)
+{
+    if (filter && !strstr(name, filter)) return;
+    setup();
+    body(); // warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iters; i++) body();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    printf("%-28s %10u iters %12.1f ns/op\n", name, iters, (double)ns / iters);
+}
+
+// ---- button debounce ----
+static void check_debounce()
+{
+    host_app_reset();
+    uint32_t seen = 0;
+    for (int i = 0; i < BUTTON_STABLE_CNT + 4; i++) {
+        uint32_t p = light_button_scan_step(1u << 1);
+        BENCH_CHECK(p == 0 || i == BUTTON_STABLE_CNT); // fires once, after BUTTON_STABLE_CNT + 1 samples
+        seen |= p;
+    }
+    BENCH_CHECK(seen == (1u << 1));
+    for (int i = 0; i < BUTTON_STABLE_CNT + 4; i++) BENCH_CHECK(light_button_scan_step(0) == 0);
+    // A bounce shorter than the stable count never fires.
+    for (int i = 0; i < BUTTON_STABLE_CNT; i++) BENCH_CHECK(light_button_scan_step(1u << 0) == 0);
+    BENCH_CHECK(light_button_scan_step(0) == 0);
+
+    // Batched I/O: one poll is one input-register read, one LED update one write per changed direction.
+    uint64_t reads0 = mock_gpio_reg_stats().reads;
+    mock_gpio_set_input(channels::kButtonPins[0], 0);
+    for (int i = 0; i <= BUTTON_STABLE_CNT; i++) seen = light_button_poll();
+    mock_gpio_set_input(channels::kButtonPins[0], 1);
+    BENCH_CHECK(seen == 1u);
+    BENCH_CHECK(mock_gpio_reg_stats().reads - reads0 == BUTTON_STABLE_CNT + 1);
+    uint64_t writes0 = mock_gpio_reg_stats().writes;
+    channels::write_leds(0x5 & channels::kChannelMask);
+    BENCH_CHECK(mock_gpio_reg_stats().writes - writes0 <= 2);
+    BENCH_CHECK(mock_gpio_get_output(channels::kLedPins[0]) == 1);
+    if (LIGHT_CHANNELS > 1) BENCH_CHECK(mock_gpio_get_output(channels::kLedPins[1]) == 0);
+    channels::write_leds(0);
+    light_button_scan_reset();
+}
+
+static void bench_debounce(uint32_t & step)
+{
+    // Each channel bounces for a few polls then holds; produces a press every 16 polls per channel.
+    uint32_t held = 0;
+    for (int c = 0; c < LIGHT_CHANNELS; c++) held |= (((step + (uint32_t)c * 4) & 15) < 8 ? 1u : 0u) << c;
+    s_sink = s_sink + light_button_scan_step(held);
+    step++;
+}
+
+// ---- toggle fan-out ----
+static void setup_bindings(int unicast_per_ch, bool with_group)
+{
+    host_app_reset();
+    for (int ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        for (int i = 0; i < unicast_per_ch; i++) {
+            uint64_t node = 0x1000 + (uint64_t)ch * 0x100 + (uint64_t)i;
+            BENCH_CHECK(host_bind_unicast((uint8_t)ch, node, 1) == SHADOW_IMPORT_ADDED);
+            host_target_set(node, 1, false);
+        }
+        if (with_group) BENCH_CHECK(host_bind_group((uint8_t)ch, (uint16_t)(0x100 + ch)) == SHADOW_IMPORT_ADDED);
+    }
+}
+
+struct FanoutCtx {
+    uint32_t ok = 0;
+    uint32_t fail = 0;
+};
+static void on_toggle_result(void * ctx, const LightToggleResult * r)
+{
+    auto * c = static_cast<FanoutCtx *>(ctx);
+    if (r->ok) c->ok++; else c->fail++;
+}
+
+static void check_fanout()
+{
+    setup_bindings(4, true);
+    host_target_set(0x1002, 1, false, false); // one unreachable target on ch0
+    FanoutCtx ctx;
+    LightToggleObserver obs = { on_toggle_result, &ctx };
+    light_manager_toggle_dispatch(0, &obs);
+    host_app_run_until_idle();
+    BENCH_CHECK(ctx.ok == 3 && ctx.fail == 1);
+    BENCH_CHECK(host_target_on(0x1000, 1) && !host_target_on(0x1002, 1));
+    BENCH_CHECK(host_app_stats().cluster_updates == (LIGHT_FANOUT_ENABLE ? 0 : 1)); // fan-out: OnOff skips the binding manager
+    BENCH_CHECK(host_app_stats().toggles_sent == 4 && host_app_stats().group_sends == 1);
+    BENCH_CHECK(light_manager_get(0));
+}
+
+// ---- LED sync ----
+static void check_sync()
+{
+    setup_bindings(3, false);
+    host_target_set(0x1101, 1, true); // ch1: one target on
+    light_manager_sync_initial_state();
+    host_app_run_until_idle();
+    BENCH_CHECK(light_manager_get(1));
+    BENCH_CHECK(!light_manager_get(0));
+    BENCH_CHECK(host_app_stats().reads_sent == 3 * LIGHT_CHANNELS);
+    host_target_set(0x1101, 1, false);
+    light_manager_sync_initial_state();
+    host_app_run_until_idle();
+    BENCH_CHECK(!light_manager_get(1));
+}
+
+// ---- transport coroutines vs callbacks ----
+// The shape of a sync read (light_sync.cpp): a hop onto the work queue, session setup, the read, then
+// the result. The "callback" version allocates what the transport did before coroutines: the queued
+// request, the session context, the read callback and the client. The coroutine version keeps all of
+// it in one pool frame. Both complete through the same queue (standing in for the Matter event loop),
+// so the numbers compare only the machinery. Heap use is counted by the operator new below.
+static uint64_t s_heap_allocs, s_heap_bytes;
+
+__attribute__((noinline)) void * operator new(size_t n)
+{
+    s_heap_allocs++;
+    s_heap_bytes += n;
+    if (void * p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void * p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void * p, size_t) noexcept { free(p); }
+
+static constexpr size_t kClientBytes = 256; // stand-in for a ReadClient
+
+struct Step {
+    void (*fn)(void *);
+    void * arg;
+};
+static Step s_steps[64];
+static int s_step_head, s_step_count;
+
+static void post_step(void (*fn)(void *), void * arg)
+{
+    BENCH_CHECK(s_step_count < 64);
+    s_steps[(s_step_head + s_step_count++) % 64] = Step{ fn, arg };
+}
+static void run_steps()
+{
+    while (s_step_count) {
+        Step st = s_steps[s_step_head];
+        s_step_head = (s_step_head + 1) % 64;
+        s_step_count--;
+        st.fn(st.arg);
+    }
+}
+
+struct CbRequest { uint64_t node; uint32_t * done; };
+struct CbSession { CbRequest r; };
+struct CbClient { uint8_t bytes[kClientBytes]; };
+struct CbRead { CbRequest r; CbClient * client; };
+
+static bool cb_read(uint64_t node, uint32_t * done)
+{
+    post_step([](void * a) {
+        auto * req = static_cast<CbRequest *>(a);
+        auto * ctx = new CbSession{ *req };
+        delete req;
+        post_step([](void * b) {
+            auto * ctx = static_cast<CbSession *>(b);
+            auto * cb = new CbRead{ ctx->r, new CbClient };
+            delete ctx;
+            cb->client->bytes[0] = (uint8_t)cb->r.node;
+            post_step([](void * c) {
+                auto * cb = static_cast<CbRead *>(c);
+                *cb->r.done += cb->client->bytes[0] == (uint8_t)cb->r.node;
+                delete cb->client;
+                delete cb;
+            }, cb);
+        }, ctx);
+    }, new CbRequest{ node, done });
+    return true;
+}
+
+struct StepAwait {
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        post_step([](void * a) { std::coroutine_handle<>::from_address(a).resume(); }, h.address());
+    }
+    void await_resume() const {}
+};
+
+static coro::Task co_read(uint64_t node, uint32_t * done)
+{
+    co_await StepAwait{}; // hop
+    co_await StepAwait{}; // session
+    uint8_t client[kClientBytes];
+    client[0] = (uint8_t)node;
+    co_await StepAwait{}; // read
+    *done += client[0] == (uint8_t)node;
+}
+
+// Keeps more than a block across its suspension: its frame can never come from the pool.
+static coro::Task co_big(uint32_t * done)
+{
+    uint8_t buf[LIGHT_CORO_FRAME_BYTES];
+    buf[0] = 1;
+    co_await StepAwait{};
+    *done += buf[0];
+}
+
+static void check_coro()
+{
+    uint32_t done = 0;
+    int started = 0;
+    while (co_read((uint64_t)started, &done)) started++; // suspended at their first step, holding a frame each
+    BENCH_CHECK(started == LIGHT_CORO_FRAMES && done == 0);
+    run_steps();
+    BENCH_CHECK(done == (uint32_t)started);
+    for (int i = 0; i < LIGHT_CORO_FRAMES; i++) BENCH_CHECK(co_read(7, &done)); // every frame came back
+    run_steps();
+    BENCH_CHECK(done == 2u * LIGHT_CORO_FRAMES);
+    uint64_t allocs0 = s_heap_allocs;
+    BENCH_CHECK(co_read(1, &done));
+    run_steps();
+    BENCH_CHECK(s_heap_allocs == allocs0);
+    BENCH_CHECK(cb_read(1, &done));
+    run_steps();
+    BENCH_CHECK(s_heap_allocs - allocs0 == 4 && done == 2u * LIGHT_CORO_FRAMES + 2);
+    const auto * oversize = static_cast<const metrics::Counter *>(metrics::find("coro.frames_oversize"));
+    uint32_t oversize0 = oversize ? oversize->value() : 0;
+    BENCH_CHECK(!co_big(&done)); // refused at allocation, counted as oversize rather than an empty pool
+    BENCH_CHECK(oversize && oversize->value() == oversize0 + 1);
+}
+
+// One round of `n` reads in flight at once.
+static void read_round(bool (*start)(uint64_t, uint32_t *), int n)
+{
+    uint32_t done = 0;
+    for (int i = 0; i < n; i++) BENCH_CHECK(start((uint64_t)i, &done));
+    run_steps();
+    s_sink = s_sink + done;
+}
+
+static void heap_per_op(const char * filter, const char * name, uint32_t iters, const std::function<void()> & body)
+{
+    if (filter && !strstr(name, filter)) return;
+    uint64_t a0 = s_heap_allocs, b0 = s_heap_bytes;
+    for (uint32_t i = 0; i < iters; i++) body();
+    printf("%-28s %10u iters %9.1f allocs/op %9.1f B/op\n", name, iters, (double)(s_heap_allocs - a0) / iters,
+           (double)(s_heap_bytes - b0) / iters);
+}
+
+// ---- binding import ----
+static void bench_import(uint32_t & n)
+{
+    if ((n % (LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH)) == 0) host_app_reset();
+    uint8_t ch = (uint8_t)(n % LIGHT_CHANNELS);
+    s_sink = s_sink + (uint32_t)host_bind_unicast(ch, 0x2000 + n, 1);
+    s_sink = s_sink + (uint32_t)host_bind_unicast(ch, 0x2000 + n, 1); // duplicate path
+    n++;
+}
+
+// ---- DHT22 ----
+static uint8_t s_lvl[96];
+static uint16_t s_dur[96];
+static size_t s_pulses;
+
+static void check_dht22()
+{
+    Dht22Frame f;
+    s_pulses = mock_dht22_build_pulses(-123, 456, s_lvl, s_dur, 96);
+    BENCH_CHECK(dht22_decode_pulses(s_lvl, s_dur, s_pulses, &f) == DHT22_DECODE_OK);
+    BENCH_CHECK(f.temp_x10 == -123 && f.hum_x10 == 456);
+    s_dur[21] = (uint16_t)(s_dur[21] == 70 ? 26 : 70); // flip data bit 9
+    BENCH_CHECK(dht22_decode_pulses(s_lvl, s_dur, s_pulses, &f) == DHT22_DECODE_CHECKSUM);
+    s_pulses = mock_dht22_build_pulses(215, 487, s_lvl, s_dur, 96);
+}
+
+static void check_temp_poll()
+{
+    host_app_reset();
+    mock_dht22_set_reading(215, 487);
+    for (int i = 0; i < DHT22_WARMUP_READS + 1; i++) {
+        temp_manager_poll_once();
+        host_app_run_until_idle();
+    }
+    esp_matter_attr_val_t v;
+    BENCH_CHECK(mock_attr_last(g_temp_endpoint_id, chip::app::Clusters::TemperatureMeasurement::Id,
+                               chip::app::Clusters::TemperatureMeasurement::Attributes::MeasuredValue::Id, &v));
+    BENCH_CHECK(v.val.i16 == 2150);
+}
+
+// ---- sensor rules ----
+static RuleEngine s_rule_engine;
+static Rule s_rule_set[RULES_MAX];
+
+static void check_rules()
+{
+    // Humidity above 70 % with 5 % hysteresis and a 30 s dwell; the engine sees one sample every 10 s.
+    Rule r = { Rule::kHumidity | Rule::kOn | Rule::kClearSends, 0, 7000, 500, 30 };
+    int fired = 0, cleared = 0;
+    auto fire = [&](uint8_t, const Rule &, bool on) { (on ? fired : cleared)++; };
+    const uint16_t h[] = { 6900, 7100, 7200, 6900, 7100, 7100, 7100, 7100, 6800, 6400, 6400, 6400, 6400 };
+    const int want_fired[] = { 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1 };
+    const int want_cleared[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+    s_rule_engine.reset();
+    for (size_t i = 0; i < sizeof(h) / sizeof(h[0]); i++) {
+        s_rule_engine.step(&r, 1, 2000, h[i], (int64_t)(i + 1) * 10000000, fire);
+        BENCH_CHECK(fired == want_fired[i] && cleared == want_cleared[i]); // a dip resets the dwell; 6800 is inside the band
+    }
+    // Temperature below 18 C, no dwell: fires on the first sample past it.
+    Rule t = { Rule::kBelow | Rule::kOn, 1, 1800, 50, 0 };
+    s_rule_engine.reset();
+    BENCH_CHECK(s_rule_engine.step(&t, 1, 1799, 5000, 1, fire) == 1 && s_rule_engine.active(0));
+    BENCH_CHECK(s_rule_engine.step(&t, 1, 1840, 5000, 2, fire) == 0 && s_rule_engine.active(0));
+    BENCH_CHECK(s_rule_engine.step(&t, 1, 1851, 5000, 3, fire) == 1 && !s_rule_engine.active(0));
+    for (int i = 0; i < RULES_MAX; i++)
+        s_rule_set[i] = { (uint8_t)((i & 1) ? Rule::kHumidity : 0), 0, (int16_t)(i & 1 ? 7000 : 2600), 100, 60 };
+    s_rule_engine.reset();
+}
+
+int main(int argc, char ** argv)
+{
+    const char * filter = argc > 1 ? argv[1] : nullptr;
+
+    check_debounce();
+    check_fanout();
+    check_sync();
+    check_dht22();
+    check_temp_poll();
+    check_rules();
+    check_coro();
+
+    uint32_t step = 0;
+    run(filter, "debounce.scan_step", 2000000, [] { host_app_reset(); }, [&] { bench_debounce(step); });
+    run(filter, "debounce.poll", 2000000, [] { host_app_reset(); }, [] { s_sink = s_sink + light_button_poll(); });
+
+    uint32_t n = 0;
+    run(filter, "binding.import", 200000, [] { host_app_reset(); }, [&] { bench_import(n); });
+
+    run(filter, "toggle.fanout_1x", 200000, [] { setup_bindings(1, false); },
+        [] { light_manager_button_press(0); host_app_run_until_idle(); });
+    run(filter, "toggle.fanout_10x", 100000, [] { setup_bindings(MAX_SHADOW_BINDINGS_PER_CH - 1, true); },
+        [] { light_manager_button_press(0); host_app_run_until_idle(); });
+
+    run(filter, "sync.round_4x4", 50000, [] { setup_bindings(4, false); },
+        [] { light_manager_sync_initial_state(); host_app_run_until_idle(); });
+
+    auto co_start = [](uint64_t node, uint32_t * done) { return static_cast<bool>(co_read(node, done)); };
+    run(filter, "transport.callbacks_x8", 200000, [] {}, [] { read_round(cb_read, 8); });
+    run(filter, "transport.coro_x8", 200000, [] {}, [&] { read_round(co_start, 8); });
+    heap_per_op(filter, "transport.callbacks_x8.heap", 1000, [] { read_round(cb_read, 8); });
+    heap_per_op(filter, "transport.coro_x8.heap", 1000, [&] { read_round(co_start, 8); });
+
+    Dht22Frame f;
+    run(filter, "dht22.decode", 1000000, [] {}, [&] { s_sink = s_sink + (uint32_t)dht22_decode_pulses(s_lvl, s_dur, s_pulses, &f); });
+
+    run(filter, "temp.poll_once", 100000, [] { mock_dht22_set_reading(215, 487); },
+        [] { temp_manager_poll_once(); host_app_run_until_idle(); });
+
+    // One sample against a full rule table; the values swing across every threshold so rules keep changing state.
+    int64_t now = 0;
+    run(filter, "rules.eval_full", 2000000, [] { s_rule_engine.reset(); }, [&] {
+        now += 10000000;
+        int16_t t = (int16_t)(2400 + (now / 10000000 % 64) * 8);
+        uint16_t h = (uint16_t)(6500 + (now / 10000000 % 32) * 40);
+        s_sink = s_sink + (uint32_t)s_rule_engine.step(s_rule_set, RULES_MAX, t, h, now, [](uint8_t, const Rule &, bool) { s_sink = s_sink + 1; });
+    });
+
+    static metrics::Histogram s_h("host.bench_us", metrics::kLatencyBucketsUs);
+    uint32_t v = 0;
+    run(filter, "metrics.hist_record", 5000000, [] {}, [&] { s_h.record(v); v = (v + 977) % 200000; });
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * Scale harness: one channel bound to N simulated lights (host build, see host_app.h).
+ *
+ *   host_scale [--targets 1,5,10,25,50] [--iters 200] [--group] [--json report.json]
+ *
+ * For each N it binds N unicast targets (plus one group with --group) to channel 0 and measures
+ *   toggle.*   press -> every LightToggleResult delivered (fan-out through the Matter queue)
+ *   sync.*     one LED sync round (N OnOff reads issued and completed)
+ *   import_ns  shadow_binding_import() of all N entries
+ *   heap.*     operator new calls / bytes / peak live bytes during the measured loops
+ * Latencies are host CPU time through the firmware code with zero network RTT; compare builds,
+ * not absolute numbers. The JSON report (schema "switch-scale/1") is what tools/scale_test.py reads.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "mock_hw.h"
+#include "host_app.h"
+
+// ---- allocation accounting ----
+static std::atomic<uint64_t> s_alloc_calls{0}, s_alloc_bytes{0};
+static std::atomic<int64_t> s_live_bytes{0}, s_peak_bytes{0};
+
+static void * counted_alloc(size_t n)
+{
+    void * p = malloc(n + sizeof(max_align_t));
+    if (!p) return nullptr;
+    *static_cast<size_t *>(p) = n;
+    s_alloc_calls++;
+    s_alloc_bytes += n;
+    int64_t live = s_live_bytes += (int64_t)n;
+    int64_t peak = s_peak_bytes.load();
+    while (live > peak && !s_peak_bytes.compare_exchange_weak(peak, live)) {}
+    return static_cast<char *>(p) + sizeof(max_align_t);
+}
+static void counted_free(void * p)
+{
+    if (!p) return;
+    void * base = static_cast<char *>(p) - sizeof(max_align_t);
+    s_live_bytes -= (int64_t)*static_cast<size_t *>(base);
+    free(base);
+}
+void * operator new(size_t n) { void * p = counted_alloc(n); if (!p) throw std::bad_alloc(); return p; }
+void * operator new[](size_t n) { void * p = counted_alloc(n); if (!p) throw std::bad_alloc(); return p; }
+void * operator new(size_t n, const std::nothrow_t &) noexcept { return counted_alloc(n); }
+void * operator new[](size_t n, const std::nothrow_t &) noexcept { return counted_alloc(n); }
+void operator delete(void * p) noexcept { counted_free(p); }
+void operator delete[](void * p) noexcept { counted_free(p); }
+void operator delete(void * p, size_t) noexcept { counted_free(p); }
+void operator delete[](void * p, size_t) noexcept { counted_free(p); }
+
+struct HeapWindow {
+    uint64_t calls0, bytes0;
+    int64_t live0;
+    HeapWindow() : calls0(s_alloc_calls), bytes0(s_alloc_bytes), live0(s_live_bytes) { s_peak_bytes = live0; }
+    uint64_t calls() const { return s_alloc_calls - calls0; }
+    uint64_t bytes() const { return s_alloc_bytes - bytes0; }
+    int64_t peak() const { return s_peak_bytes - live0; }
+};
+
+// ---- stats ----
+struct Summary {
+    double p50, p90, p99, max, mean;
+};
+static Summary summarize(std::vector<uint64_t> & v)
+{
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) { return (double)v[std::min(v.size() - 1, (size_t)(q * (double)(v.size() - 1) + 0.5))]; };
+    double sum = 0;
+    for (uint64_t x : v) sum += (double)x;
+    return { at(0.50), at(0.90), at(0.99), (double)v.back(), sum / (double)v.size() };
+}
+
+static uint64_t now_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+    int targets;
+    bool group;
+    double import_ns;
+    Summary toggle;
+    Summary sync;
+    uint32_t toggle_results;
+    uint32_t sync_reads;
+    uint64_t heap_calls, heap_bytes;
+    int64_t heap_peak;
+};
+
+struct FanoutCtx {
+    uint32_t results = 0;
+    uint32_t fail = 0;
+};
+static void on_result(void * ctx, const LightToggleResult * r)
+{
+    auto * c = static_cast<FanoutCtx *>(ctx);
+    c->results++;
+    if (!r->ok) c->fail++;
+}
+
+static Result measure(int n, bool group, int iters)
+{
+    Result res = {};
+    res.targets = n;
+    res.group = group;
+
+    host_app_reset();
+    for (int i = 0; i < n; i++) host_target_set(0x10000 + (uint64_t)i, 1, false);
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < n; i++) {
+        if (host_bind_unicast(0, 0x10000 + (uint64_t)i, 1) != SHADOW_IMPORT_ADDED) {
+            fprintf(stderr, "bind %d/%d failed (MAX_SHADOW_BINDINGS_PER_CH=%d)\n", i, n, MAX_SHADOW_BINDINGS_PER_CH);
+            exit(1);
+        }
+    }
+    if (group) host_bind_group(0, 0x0100);
+    res.import_ns = (double)(now_ns() - t0);
+
+    FanoutCtx ctx;
+    LightToggleObserver obs = { on_result, &ctx };
+    std::vector<uint64_t> toggle_ns, sync_ns;
+    toggle_ns.reserve(iters);
+    sync_ns.reserve(iters);
+
+    // Warm-up (first timer creation, map nodes, vector growth) outside the heap window.
+    light_manager_toggle_dispatch(0, &obs);
+    light_manager_sync_initial_state();
+    host_app_run_until_idle();
+    ctx = FanoutCtx();
+    uint32_t reads0 = host_app_stats().reads_sent;
+
+    HeapWindow heap;
+    for (int i = 0; i < iters; i++) {
+        uint64_t a = now_ns();
+        light_manager_toggle_dispatch(0, &obs);
+        host_app_run_until_idle();
+        toggle_ns.push_back(now_ns() - a);
+
+        a = now_ns();
+        light_manager_sync_initial_state();
+        host_app_run_until_idle();
+        sync_ns.push_back(now_ns() - a);
+    }
+    res.heap_calls = heap.calls();
+    res.heap_bytes = heap.bytes();
+    res.heap_peak = heap.peak();
+    res.toggle_results = ctx.results;
+    res.sync_reads = host_app_stats().reads_sent - reads0;
+    if (ctx.results != (uint32_t)(n * iters) || ctx.fail || res.sync_reads != (uint32_t)(n * iters)) {
+        fprintf(stderr, "N=%d: expected %d results/reads, got %u/%u (fail=%u)\n", n, n * iters, ctx.results, res.sync_reads, ctx.fail);
+        exit(1);
+    }
+    res.toggle = summarize(toggle_ns);
+    res.sync = summarize(sync_ns);
+    return res;
+}
+
+static void write_summary(FILE * f, const char * key, const Summary & s)
+{
+    fprintf(f, "\"%s\": {\"p50_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f, \"mean_ns\": %.1f}", key, s.p50, s.p90,
+            s.p99, s.max, s.mean);
+}
+
+static void write_json(FILE * f, const std::vector<Result> & results, int iters)
+{
+    fprintf(f, "{\n  \"schema\": \"switch-scale/1\",\n  \"iters\": %d,\n  \"max_bindings_per_ch\": %d,\n", iters, MAX_SHADOW_BINDINGS_PER_CH);
+    fprintf(f, "  \"static_bytes\": {\"shadow_lists\": %zu},\n  \"results\": [\n", sizeof(ShadowBindingList) * LIGHT_CHANNELS);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result & r = results[i];
+        fprintf(f, "    {\"targets\": %d, \"group\": %s, \"import_ns\": %.0f, ", r.targets, r.group ? "true" : "false", r.import_ns);
+        write_summary(f, "toggle", r.toggle);
+        fprintf(f, ", ");
+        write_summary(f, "sync", r.sync);
+        fprintf(f, ", \"heap\": {\"calls\": %llu, \"bytes\": %llu, \"peak_bytes\": %lld}}%s\n", (unsigned long long)r.heap_calls,
+                (unsigned long long)r.heap_bytes, (long long)r.heap_peak, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<int> targets = { 1, 5, 10, 25, 50 };
+    int iters = 200;
+    bool group = false;
+    const char * json = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--targets") && i + 1 < argc) {
+            targets.clear();
+            for (char * tok = strtok(argv[++i], ","); tok; tok = strtok(nullptr, ",")) targets.push_back(atoi(tok));
+        } else if (!strcmp(argv[i], "--iters") && i + 1 < argc) {
+            iters = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--group")) {
+            group = true;
+        } else if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+            json = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--targets 1,5,10] [--iters N] [--group] [--json out.json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    printf("%8s %12s %12s %12s %12s %10s %10s\n", "targets", "toggle_p50", "toggle_p99", "sync_p50", "sync_p99", "heap_calls", "heap_peak");
+    for (int n : targets) {
+        if (n < 1 || n + (group ? 1 : 0) > MAX_SHADOW_BINDINGS_PER_CH) {
+            fprintf(stderr, "targets=%d outside 1..%d\n", n, MAX_SHADOW_BINDINGS_PER_CH - (group ? 1 : 0));
+            return 2;
+        }
+        Result r = measure(n, group, iters);
+        printf("%8d %10.0fns %10.0fns %10.0fns %10.0fns %10llu %10lld\n", n, r.toggle.p50, r.toggle.p99, r.sync.p50, r.sync.p99,
+               (unsigned long long)r.heap_calls, (long long)r.heap_peak);
+        results.push_back(r);
+    }
+    if (json) {
+        FILE * f = strcmp(json, "-") ? fopen(json, "w") : stdout;
+        if (!f) { perror(json); return 1; }
+        write_json(f, results, iters);
+        if (f != stdout) fclose(f);
+    }
+    return 0;
+}
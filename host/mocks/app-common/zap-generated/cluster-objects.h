@@ -0,0 +1,40 @@
+/* Cluster / attribute / command ids used by the firmware (subset of the generated header). */
+#pragma once
+#include <app/CommandPathParams.h>
+namespace chip {
+namespace app {
+namespace Clusters {
+namespace OnOff {
+static constexpr ClusterId Id = 0x0006;
+namespace Attributes { namespace OnOff { static constexpr AttributeId Id = 0x0000; } }
+namespace Commands {
+namespace Off { static constexpr CommandId Id = 0x00; }
+namespace On { static constexpr CommandId Id = 0x01; }
+namespace Toggle { static constexpr CommandId Id = 0x02; }
+} // namespace Commands
+} // namespace OnOff
+namespace LevelControl {
+static constexpr ClusterId Id = 0x0008;
+namespace Commands {
+namespace Stop { static constexpr CommandId Id = 0x03; }
+namespace MoveToLevelWithOnOff { static constexpr CommandId Id = 0x04; }
+namespace MoveWithOnOff { static constexpr CommandId Id = 0x05; }
+} // namespace Commands
+} // namespace LevelControl
+namespace ColorControl {
+static constexpr ClusterId Id = 0x0300;
+namespace Commands {
+namespace MoveToColorTemperature { static constexpr CommandId Id = 0x0A; }
+} // namespace Commands
+} // namespace ColorControl
+namespace TemperatureMeasurement {
+static constexpr ClusterId Id = 0x0402;
+namespace Attributes { namespace MeasuredValue { static constexpr AttributeId Id = 0x0000; } }
+}
+namespace RelativeHumidityMeasurement {
+static constexpr ClusterId Id = 0x0405;
+namespace Attributes { namespace MeasuredValue { static constexpr AttributeId Id = 0x0000; } }
+}
+} // namespace Clusters
+} // namespace app
+} // namespace chip
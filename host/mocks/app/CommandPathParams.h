@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+namespace chip {
+typedef uint16_t EndpointId;
+typedef uint16_t GroupId;
+typedef uint32_t ClusterId;
+typedef uint32_t CommandId;
+typedef uint32_t AttributeId;
+namespace app {
+enum class CommandPathFlags : uint8_t { kEndpointIdValid = 0x01, kGroupIdValid = 0x02 };
+struct CommandPathParams {
+    CommandPathParams() = default;
+    CommandPathParams(EndpointId ep, GroupId group, ClusterId cluster, CommandId command, CommandPathFlags flags)
+        : mEndpointId(ep), mGroupId(group), mClusterId(cluster), mCommandId(command), mFlags(flags) {}
+    EndpointId mEndpointId = 0;
+    GroupId mGroupId = 0;
+    ClusterId mClusterId = 0;
+    CommandId mCommandId = 0;
+    CommandPathFlags mFlags = CommandPathFlags::kEndpointIdValid;
+};
+} // namespace app
+} // namespace chip
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdio.h>
+#include <inttypes.h>
+#include "esp_err.h"
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE } esp_log_level_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Global threshold only (per-tag levels are ignored on the host). Default ESP_LOG_WARN keeps benchmarks quiet.
+extern esp_log_level_t g_mock_log_level;
+void esp_log_level_set(const char * tag, esp_log_level_t level);
+#ifdef __cplusplus
+}
+#endif
+#define ESP_LOG_MOCK_(lvl, c, tag, fmt, ...) do { if (g_mock_log_level >= (lvl)) printf(c " (%s) " fmt "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGE(tag, fmt, ...) ESP_LOG_MOCK_(ESP_LOG_ERROR, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) ESP_LOG_MOCK_(ESP_LOG_WARN, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ESP_LOG_MOCK_(ESP_LOG_INFO, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOG_MOCK_(ESP_LOG_DEBUG, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOG_MOCK_(ESP_LOG_VERBOSE, "V", tag, fmt, ##__VA_ARGS__)
+#define ESP_EARLY_LOGI ESP_LOGI
@@ -0,0 +1,64 @@
+/* Host mock of the esp-matter data model API (only what the firmware modules use). */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include <lib/core/CHIPError.h>
+#include <lib/support/CHIPMem.h>
+#include <app-common/zap-generated/cluster-objects.h>
+
+typedef enum {
+    ESP_MATTER_VAL_TYPE_INVALID = 0,
+    ESP_MATTER_VAL_TYPE_BOOLEAN,
+    ESP_MATTER_VAL_TYPE_INTEGER,
+    ESP_MATTER_VAL_TYPE_UINT8,
+    ESP_MATTER_VAL_TYPE_UINT16,
+    ESP_MATTER_VAL_TYPE_UINT32,
+    ESP_MATTER_VAL_TYPE_INT16,
+    ESP_MATTER_VAL_TYPE_INT32,
+    ESP_MATTER_VAL_TYPE_NULLABLE_INT16,
+    ESP_MATTER_VAL_TYPE_NULLABLE_UINT16,
+} esp_matter_val_type_t;
+
+typedef struct {
+    esp_matter_val_type_t type;
+    union { bool b; int i; uint8_t u8; uint16_t u16; uint32_t u32; int16_t i16; int32_t i32; } val;
+} esp_matter_attr_val_t;
+
+static inline esp_matter_attr_val_t esp_matter_bool(bool v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_BOOLEAN; a.val.b = v; return a; }
+static inline esp_matter_attr_val_t esp_matter_uint8(uint8_t v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_UINT8; a.val.u8 = v; return a; }
+static inline esp_matter_attr_val_t esp_matter_uint16(uint16_t v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_UINT16; a.val.u16 = v; return a; }
+static inline esp_matter_attr_val_t esp_matter_uint32(uint32_t v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_UINT32; a.val.u32 = v; return a; }
+static inline esp_matter_attr_val_t esp_matter_int16(int16_t v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_INT16; a.val.i16 = v; return a; }
+static inline esp_matter_attr_val_t esp_matter_int32(int32_t v) { esp_matter_attr_val_t a{}; a.type = ESP_MATTER_VAL_TYPE_INT32; a.val.i32 = v; return a; }
+
+#define CLUSTER_FLAG_SERVER 0x02
+#define CLUSTER_FLAG_CLIENT 0x04
+#define ATTRIBUTE_FLAG_NONE 0
+
+namespace esp_matter {
+// Opaque handles, as in esp_matter_core.h.
+typedef size_t node_t;
+typedef size_t endpoint_t;
+typedef size_t cluster_t;
+typedef size_t attribute_t;
+
+namespace endpoint {
+endpoint_t * get(node_t * node, uint16_t endpoint_id);
+}
+namespace cluster {
+cluster_t * create(endpoint_t * endpoint, uint32_t cluster_id, uint8_t flags);
+namespace global {
+namespace attribute {
+attribute_t * create_cluster_revision(cluster_t * cluster, uint16_t value);
+attribute_t * create_feature_map(cluster_t * cluster, uint32_t value);
+} // namespace attribute
+} // namespace global
+} // namespace cluster
+namespace attribute {
+attribute_t * create(cluster_t * cluster, uint32_t attribute_id, uint16_t flags, esp_matter_attr_val_t val, uint16_t max_val_size = 0);
+esp_err_t report(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t * val);
+esp_err_t update(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t * val);
+} // namespace attribute
+} // namespace esp_matter
@@ -0,0 +1,15 @@
+/* Host mock of esp_matter::client: cluster_update() is routed to a handler installed by host/app. */
+#pragma once
+#include "esp_err.h"
+#include <app/CommandPathParams.h>
+
+namespace esp_matter {
+namespace client {
+typedef struct request_handle {
+    chip::app::CommandPathParams command_path;
+    void * request_data = nullptr;
+} request_handle_t;
+
+esp_err_t cluster_update(uint16_t local_endpoint_id, request_handle_t * req_handle);
+} // namespace client
+} // namespace esp_matter
@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+namespace esp_matter {
+namespace console {
+typedef esp_err_t (*command_handler_t)(int argc, char ** argv);
+typedef struct {
+    const char * name;
+    const char * description;
+    command_handler_t handler;
+} command_t;
+esp_err_t add_commands(const command_t * command_set, uint8_t count);
+} // namespace console
+} // namespace esp_matter
@@ -0,0 +1,39 @@
+/* Host mock of the FreeRTOS types/macros used by the firmware. Single "Matter thread" model:
+ * critical sections are no-ops and firmware tasks are registered but not run (see mock_hw.h). */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define configMAX_TASK_NAME_LEN 16
+#define tskIDLE_PRIORITY 0
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define taskENTER_CRITICAL(m) (void)(m)
+#define taskEXIT_CRITICAL(m) (void)(m)
+#define taskENTER_CRITICAL_ISR(m) (void)(m)
+#define taskEXIT_CRITICAL_ISR(m) (void)(m)
+#define portENTER_CRITICAL(m) (void)(m)
+#define portEXIT_CRITICAL(m) (void)(m)
+#define portYIELD_FROM_ISR(x) (void)(x)
+typedef struct { void * p[32]; } StaticTask_t;
+typedef struct { void * p[20]; } StaticQueue_t;
+typedef struct { void * p[12]; } StaticTimer_t;
+typedef struct { void * p[20]; } StaticSemaphore_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+BaseType_t xPortInIsrContext(void);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#include "FreeRTOS.h"
+typedef struct QueueDefinition * QueueHandle_t;
+#ifdef __cplusplus
+extern "C" {
+#endif
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t * storage, StaticQueue_t * buf);
+// Never blocks on the host: a full/empty queue returns pdFALSE immediately.
+BaseType_t xQueueSend(QueueHandle_t q, const void * item, TickType_t ticks);
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void * item, BaseType_t * woken);
+BaseType_t xQueueReceive(QueueHandle_t q, void * item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+void vQueueDelete(QueueHandle_t q);
+#ifdef __cplusplus
+}
+#endif
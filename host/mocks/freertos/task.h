@@ -0,0 +1,23 @@
+#pragma once
+#include "FreeRTOS.h"
+typedef struct tskTaskControlBlock * TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+#ifdef __cplusplus
+extern "C" {
+#endif
+BaseType_t xTaskCreate(TaskFunction_t fn, const char * name, uint32_t stack_bytes, void * arg, UBaseType_t prio, TaskHandle_t * out);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char * name, uint32_t stack_bytes, void * arg, UBaseType_t prio,
+                               StackType_t * stack, StaticTask_t * tcb);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+char * pcTaskGetName(TaskHandle_t task);
+TaskHandle_t xTaskGetHandle(const char * name);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken);
+#ifdef __cplusplus
+}
+#endif
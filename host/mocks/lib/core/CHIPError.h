@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+class ChipError {
+public:
+    constexpr explicit ChipError(uint32_t v = 0) : mValue(v) {}
+    bool operator==(const ChipError & o) const { return mValue == o.mValue; }
+    bool operator!=(const ChipError & o) const { return mValue != o.mValue; }
+    uint32_t AsInteger() const { return mValue; }
+    const char * Format() const { return mValue ? "CHIP_ERROR" : "CHIP_NO_ERROR"; }
+private:
+    uint32_t mValue;
+};
+typedef ChipError CHIP_ERROR;
+#define CHIP_NO_ERROR ChipError(0)
+#define CHIP_ERROR_INCORRECT_STATE ChipError(3)
+#define CHIP_ERROR_NO_MEMORY ChipError(11)
+#define CHIP_ERROR_TIMEOUT ChipError(50)
+#define CHIP_ERROR_FORMAT "s"
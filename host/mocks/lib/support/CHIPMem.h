@@ -0,0 +1,11 @@
+#pragma once
+#include <new>
+#include <utility>
+namespace chip {
+namespace Platform {
+template <typename T, typename... Args>
+T * New(Args &&... args) { return new (std::nothrow) T(std::forward<Args>(args)...); }
+template <typename T>
+void Delete(T * p) { delete p; }
+} // namespace Platform
+} // namespace chip
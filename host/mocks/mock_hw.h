@@ -0,0 +1,112 @@
+/*
+ * Host mock control API.
+ *
+ * The host build runs everything on one thread. Firmware code posts Matter work with
+ * ScheduleWork() and arms esp_timers; the harness decides when those run:
+ *   mock_matter_run_pending()  drains the Matter work FIFO (jobs posted while draining run too)
+ *   mock_timers_run_due()      fires esp_timers whose deadline has passed
+ * In real-time mode, firmware tasks created with xTaskCreate are recorded but never started; drive
+ * their step functions (light_button_scan_step, temp_manager_poll_once, ...) directly instead.
+ * In virtual-time mode (mock_sim_enable) the tasks run and mock_sim_run_* does all of the above.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+#include "esp_err.h"
+#include "esp_matter.h"
+#include "esp_matter_client.h"
+#include "platform/PlatformManager.h"
+
+// ---- Clock ----
+// esp_timer_get_time(): microseconds of real (steady) time since process start, or the virtual
+// clock once mock_sim_enable() has been called.
+int64_t mock_clock_now_us();
+
+// ---- Virtual-time simulation (mock_sim.cpp) ----
+// Switch to the virtual clock. From then on xTaskCreate'd tasks really run (cooperatively, one at a
+// time) inside mock_sim_run_*; tasks created earlier are started too. Cannot be switched back.
+void mock_sim_enable(int64_t start_us = 0);
+bool mock_sim_enabled();
+// Advance virtual time, running Matter work, esp_timers, timed posts and tasks in deterministic order.
+void mock_sim_run_until(int64_t t_us);
+void mock_sim_run_for(int64_t us);
+// Stop and join every task thread (call before exit in virtual-time mode).
+void mock_sim_shutdown();
+struct MockSimStats {
+    uint64_t task_switches;
+    uint64_t timers_fired;
+    uint64_t work_items;
+    uint64_t timed_posts;
+};
+const MockSimStats & mock_sim_stats();
+
+// ---- Matter thread / timers ----
+size_t mock_matter_run_pending();
+size_t mock_matter_pending();
+// Fault injection: ScheduleWork() fails (CHIP_ERROR_NO_MEMORY) while `max_pending` jobs wait (0 = no
+// limit); a stalled queue keeps its jobs until un-stalled (a busy Matter thread).
+void mock_matter_set_limit(size_t max_pending);
+void mock_matter_stall(bool stalled);
+// Post to the Matter queue after `delay_us` of virtual time (immediately in real-time mode).
+void mock_matter_post_after(int64_t delay_us, chip::DeviceLayer::AsyncWorkFunct fn, intptr_t arg);
+size_t mock_timers_run_due();
+// Earliest armed esp_timer deadline (INT64_MAX if none).
+int64_t mock_timers_next_deadline_us();
+
+// ---- GPIO ----
+void mock_gpio_set_input(int pin, int level);
+int mock_gpio_get_output(int pin);
+uint32_t mock_gpio_output_writes(int pin);
+// REG_READ(GPIO_IN_REG) / REG_WRITE(GPIO_OUT_W1T[SC]_REG) calls (batched channel I/O).
+struct MockGpioRegStats {
+    uint64_t reads;
+    uint64_t writes;
+};
+const MockGpioRegStats & mock_gpio_reg_stats();
+
+// ---- LEDC (indicator LEDs) ----
+// A channel's pin output (mock_gpio_get_output) is high while its duty is non-zero; fades complete
+// immediately. mock_ledc_pin_hz: frequency of the timer the pin's channel is bound to (0 = not LEDC),
+// i.e. the PWM carrier for a steady level or the blink rate of an effect.
+struct MockLedcStats {
+    uint64_t duty_updates;
+    uint64_t fades;
+    uint64_t binds;
+};
+const MockLedcStats & mock_ledc_stats();
+int mock_ledc_pin_hz(int pin);
+
+// ---- I/O expander (mock_iox.cpp, BUTTON_IO != BUTTON_IO_GPIO builds) ----
+// Drive expander input `input` (= channel) of the simulated MCP23017 / 74HC165 chain; 0 = pressed.
+// The MCP23017 model asserts IOX_INT_GPIO on a change of an interrupt-enabled input until GPIO is
+// read. No-op in direct-GPIO builds.
+void mock_iox_set_input(int input, int level);
+struct MockIoxStats {
+    uint64_t transactions; // I2C or SPI transactions issued by the driver
+    uint64_t scans;        // of those, input reads (GPIO burst read / chain read)
+};
+const MockIoxStats & mock_iox_stats();
+
+// ---- DHT22 over RMT ----
+// Next rmt_receive() synthesises a valid frame for these values (0.1 units).
+void mock_dht22_set_reading(int16_t temp_x10, uint16_t hum_x10);
+// Next rmt_receive() never completes (read times out).
+void mock_dht22_set_absent();
+// Build the pulse train a DHT22 sends for the given values (presence + 40 bits).
+size_t mock_dht22_build_pulses(int16_t temp_x10, uint16_t hum_x10, uint8_t * lvl, uint16_t * dur_us, size_t cap);
+
+// ---- esp_matter data model ----
+// Last value passed to attribute::report/update for the path (false if never reported).
+bool mock_attr_last(uint16_t endpoint, uint32_t cluster, uint32_t attribute, esp_matter_attr_val_t * out);
+uint32_t mock_attr_report_count();
+
+// ---- esp_matter::client ----
+using MockClusterUpdateHandler = std::function<esp_err_t(uint16_t local_ep, const esp_matter::client::request_handle_t & req)>;
+void mock_client_set_update_handler(MockClusterUpdateHandler handler);
+
+// ---- Console ----
+// Run a registered `matter <cmd> ...` command line, e.g. "metrics light.". Returns ESP_ERR_NOT_FOUND if unknown.
+esp_err_t mock_console_run(const char * line);
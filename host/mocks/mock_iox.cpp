@@ -0,0 +1,160 @@
+/*
+ * Simulated button I/O expanders behind the mock I2C / SPI drivers: an MCP23017 register model
+ * (IOCON.BANK = 0) and a 74HC165 chain. Wiring (address, INT and load pins) comes from app_config.h
+ * so the firmware driver and the model agree.
+ */
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/i2c_master.h"
+#include "driver/spi_master.h"
+
+#include "app_config.h"
+#include "mock_hw.h"
+
+static MockIoxStats s_stats;
+const MockIoxStats & mock_iox_stats() { return s_stats; }
+
+// Input levels, bit i = expander input i (1 = high = released, pull-ups).
+static uint32_t s_levels = 0xFFFFFFFFu;
+
+// ---------------------------------------------------------------- MCP23017
+namespace {
+enum : uint8_t { IODIRA = 0x00, GPINTENA = 0x04, DEFVALA = 0x06, INTCONA = 0x08, IOCON = 0x0A, GPIOA = 0x12, OLATA = 0x14, REG_COUNT = 0x16 };
+constexpr uint8_t kIoconSeqop = 0x20;
+
+struct Mcp23017 {
+    uint8_t regs[REG_COUNT];
+    uint8_t pointer = 0;
+    bool int_pending = false;
+    uint16_t last_levels = 0xFFFF; // value the change interrupt compares against (INTCON = 0)
+
+    Mcp23017()
+    {
+        memset(regs, 0, sizeof(regs));
+        regs[IODIRA] = regs[IODIRA + 1] = 0xFF;
+    }
+    uint16_t reg16(uint8_t a) const { return (uint16_t)(regs[a] | (regs[a + 1] << 8)); }
+    void drive_int()
+    {
+        if (IOX_INT_GPIO != GPIO_NUM_NC) mock_gpio_set_input(IOX_INT_GPIO, int_pending ? 0 : 1);
+    }
+    void inputs_changed(uint16_t levels)
+    {
+        uint16_t intcon = reg16(INTCONA);
+        uint16_t ref = (uint16_t)((reg16(DEFVALA) & intcon) | (last_levels & ~intcon));
+        if ((levels ^ ref) & reg16(GPINTENA)) int_pending = true;
+        drive_int();
+    }
+    uint8_t read_next()
+    {
+        uint8_t a = pointer;
+        uint8_t v = regs[a];
+        if (a == GPIOA || a == GPIOA + 1) {
+            v = (uint8_t)(s_levels >> (8 * (a - GPIOA)));
+            last_levels = (uint16_t)s_levels;
+            int_pending = false; // reading GPIO clears the interrupt
+        }
+        if (!(regs[IOCON] & kIoconSeqop)) pointer = (uint8_t)((a + 1) % REG_COUNT);
+        return v;
+    }
+    void write_next(uint8_t v)
+    {
+        uint8_t a = pointer;
+        if (a == IOCON || a == IOCON + 1) regs[IOCON] = regs[IOCON + 1] = v; // IOCON is mirrored
+        else if (a != GPIOA && a != GPIOA + 1) regs[a] = v;
+        else regs[OLATA + (a - GPIOA)] = v;
+        if (!(regs[IOCON] & kIoconSeqop)) pointer = (uint8_t)((a + 1) % REG_COUNT);
+    }
+};
+Mcp23017 s_mcp;
+} // namespace
+
+struct i2c_master_bus_t { int unused; };
+struct i2c_master_dev_t { uint16_t addr; };
+static i2c_master_bus_t s_i2c_bus;
+static i2c_master_dev_t s_i2c_dev;
+
+extern "C" esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t * cfg, i2c_master_bus_handle_t * ret)
+{
+    if (!cfg || !ret) return ESP_ERR_INVALID_ARG;
+    *ret = &s_i2c_bus;
+    return ESP_OK;
+}
+extern "C" esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t * cfg, i2c_master_dev_handle_t * ret)
+{
+    if (!bus || !cfg || !ret) return ESP_ERR_INVALID_ARG;
+    s_i2c_dev.addr = cfg->device_address;
+    *ret = &s_i2c_dev;
+    return ESP_OK;
+}
+static bool mcp_present(i2c_master_dev_handle_t dev)
+{
+    return BUTTON_IO == BUTTON_IO_MCP23017 && dev && dev->addr == IOX_I2C_ADDR;
+}
+extern "C" esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t * buf, size_t len, int)
+{
+    s_stats.transactions++;
+    if (!mcp_present(dev)) return ESP_FAIL; // NACK
+    if (len == 0) return ESP_OK;
+    s_mcp.pointer = buf[0];
+    for (size_t i = 1; i < len; i++) s_mcp.write_next(buf[i]);
+    return ESP_OK;
+}
+extern "C" esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t * wbuf, size_t wlen, uint8_t * rbuf, size_t rlen, int)
+{
+    s_stats.transactions++;
+    if (!mcp_present(dev)) return ESP_FAIL;
+    if (wlen) s_mcp.pointer = wbuf[0];
+    if (s_mcp.pointer == GPIOA) s_stats.scans++;
+    for (size_t i = 0; i < rlen; i++) rbuf[i] = s_mcp.read_next();
+    s_mcp.drive_int();
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------- 74HC165 chain
+struct spi_device_t { int unused; };
+static spi_device_t s_spi_dev;
+
+extern "C" esp_err_t spi_bus_initialize(spi_host_device_t, const spi_bus_config_t * cfg, spi_common_dma_t)
+{
+    return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+extern "C" esp_err_t spi_bus_add_device(spi_host_device_t, const spi_device_interface_config_t * cfg, spi_device_handle_t * ret)
+{
+    if (!cfg || !ret) return ESP_ERR_INVALID_ARG;
+    *ret = &s_spi_dev;
+    return ESP_OK;
+}
+// The registers latch their parallel inputs while SH/LD is low; the last latched value shifts out.
+static uint32_t s_sr_latched = 0xFFFFFFFFu;
+static uint32_t s_sr_load_writes = 0;
+extern "C" esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t * t)
+{
+    if (!dev || !t) return ESP_ERR_INVALID_ARG;
+    s_stats.transactions++;
+    if (BUTTON_IO != BUTTON_IO_74HC165) return ESP_FAIL;
+    uint32_t load_writes = mock_gpio_output_writes(IOX_SR_LOAD_GPIO);
+    if (load_writes != s_sr_load_writes) s_sr_latched = s_levels; // SH/LD pulsed since the last read
+    s_sr_load_writes = load_writes;
+    s_stats.scans++;
+    size_t bytes = (t->rxlength ? t->rxlength : t->length) / 8;
+    uint8_t * rx = (t->flags & SPI_TRANS_USE_RXDATA) ? t->rx_data : static_cast<uint8_t *>(t->rx_buffer);
+    for (size_t i = 0; i < bytes; i++) rx[i] = (uint8_t)(s_sr_latched >> (8 * i)); // register 0 shifts out first
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------- harness
+void mock_iox_set_input(int input, int level)
+{
+    if (BUTTON_IO == BUTTON_IO_GPIO || input < 0 || input >= 32) return;
+    uint32_t bit = 1u << input;
+    s_levels = level ? (s_levels | bit) : (s_levels & ~bit);
+    if (BUTTON_IO == BUTTON_IO_MCP23017) {
+        s_mcp.inputs_changed((uint16_t)s_levels);
+    } else if (IOX_INT_GPIO != GPIO_NUM_NC) {
+        // Optional diode-OR of the chain inputs: low while any button is held.
+        uint32_t wired = LIGHT_CHANNELS >= 32 ? 0xFFFFFFFFu : (1u << LIGHT_CHANNELS) - 1u;
+        mock_gpio_set_input(IOX_INT_GPIO, (s_levels & wired) == wired ? 1 : 0);
+    }
+}
@@ -0,0 +1,448 @@
+/* Host implementations of the ESP-IDF / esp-matter symbols used by the firmware modules (clock + FreeRTOS: mock_sim.cpp). */
+#include "mock_hw.h"
+
+#include <climits>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_matter_console.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/rmt_rx.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "platform/PlatformManager.h"
+
+// ---------------------------------------------------------------- log
+esp_log_level_t g_mock_log_level = ESP_LOG_WARN;
+extern "C" void esp_log_level_set(const char * tag, esp_log_level_t level)
+{
+    if (tag && strcmp(tag, "*") == 0) g_mock_log_level = level;
+}
+
+extern "C" const char * esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "ESP_ERR_?";
+    }
+}
+
+// ---------------------------------------------------------------- esp_timer
+struct esp_timer {
+    esp_timer_create_args_t args;
+    int64_t deadline_us = INT64_MAX;
+    uint64_t period_us = 0;
+    bool armed = false;
+};
+static std::vector<esp_timer *> s_timers;
+
+extern "C" esp_err_t esp_timer_create(const esp_timer_create_args_t * args, esp_timer_handle_t * out)
+{
+    if (!args || !out || !args->callback) return ESP_ERR_INVALID_ARG;
+    auto * t = new esp_timer();
+    t->args = *args;
+    s_timers.push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    if (!t) return ESP_ERR_INVALID_ARG;
+    if (t->armed) return ESP_ERR_INVALID_STATE;
+    t->deadline_us = esp_timer_get_time() + (int64_t)timeout_us;
+    t->period_us = 0;
+    t->armed = true;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us)
+{
+    if (!t || period_us == 0) return ESP_ERR_INVALID_ARG;
+    if (t->armed) return ESP_ERR_INVALID_STATE;
+    t->deadline_us = esp_timer_get_time() + (int64_t)period_us;
+    t->period_us = period_us;
+    t->armed = true;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t) return ESP_ERR_INVALID_ARG;
+    if (!t->armed) return ESP_ERR_INVALID_STATE;
+    t->armed = false;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_delete(esp_timer_handle_t t)
+{
+    if (!t) return ESP_ERR_INVALID_ARG;
+    for (auto it = s_timers.begin(); it != s_timers.end(); ++it) {
+        if (*it == t) { s_timers.erase(it); break; }
+    }
+    delete t;
+    return ESP_OK;
+}
+
+extern "C" bool esp_timer_is_active(esp_timer_handle_t t) { return t && t->armed; }
+
+int64_t mock_timers_next_deadline_us()
+{
+    int64_t next = INT64_MAX;
+    for (auto * t : s_timers) if (t->armed && t->deadline_us < next) next = t->deadline_us;
+    return next;
+}
+
+size_t mock_timers_run_due()
+{
+    size_t fired = 0;
+    for (;;) {
+        int64_t now = esp_timer_get_time();
+        esp_timer * due = nullptr;
+        for (auto * t : s_timers) {
+            if (t->armed && t->deadline_us <= now && (!due || t->deadline_us < due->deadline_us)) due = t;
+        }
+        if (!due) return fired;
+        if (due->period_us) due->deadline_us += (int64_t)due->period_us; else due->armed = false;
+        due->args.callback(due->args.arg); // may stop/delete/re-arm timers
+        fired++;
+    }
+}
+
+// ---------------------------------------------------------------- Matter work queue
+// Vector-backed FIFO (reserved up front) so draining does not allocate in steady state.
+static std::vector<std::pair<chip::DeviceLayer::AsyncWorkFunct, intptr_t>> s_work;
+static size_t s_work_head = 0;
+static size_t s_work_limit = 0; // mock_matter_set_limit()
+static bool s_work_stalled = false;
+
+namespace chip {
+namespace DeviceLayer {
+CHIP_ERROR PlatformManager::ScheduleWork(AsyncWorkFunct fn, intptr_t arg)
+{
+    if (s_work_limit && mock_matter_pending() >= s_work_limit) return CHIP_ERROR_NO_MEMORY;
+    if (s_work.capacity() == 0) s_work.reserve(4096);
+    s_work.emplace_back(fn, arg);
+    return CHIP_NO_ERROR;
+}
+PlatformManager & PlatformMgr()
+{
+    static PlatformManager s_mgr;
+    return s_mgr;
+}
+} // namespace DeviceLayer
+} // namespace chip
+
+size_t mock_matter_pending() { return s_work.size() - s_work_head; }
+void mock_matter_set_limit(size_t max_pending) { s_work_limit = max_pending; }
+void mock_matter_stall(bool stalled) { s_work_stalled = stalled; }
+
+size_t mock_matter_run_pending()
+{
+    size_t n = 0;
+    if (s_work_stalled) return 0;
+    while (s_work_head < s_work.size()) {
+        auto job = s_work[s_work_head++];
+        job.first(job.second);
+        n++;
+    }
+    s_work.clear();
+    s_work_head = 0;
+    return n;
+}
+
+// ---------------------------------------------------------------- heap (FreeRTOS + clock live in mock_sim.cpp)
+extern "C" size_t heap_caps_get_free_size(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 256 * 1024; }
+extern "C" size_t heap_caps_get_minimum_free_size(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 200 * 1024; }
+extern "C" size_t heap_caps_get_largest_free_block(uint32_t caps) { return (caps & MALLOC_CAP_SPIRAM) ? 0 : 128 * 1024; }
+
+// ---------------------------------------------------------------- GPIO
+static int s_gpio_in[GPIO_NUM_MAX];
+static int s_gpio_out[GPIO_NUM_MAX];
+static uint32_t s_gpio_writes[GPIO_NUM_MAX];
+static struct GpioInit { GpioInit() { for (int & l : s_gpio_in) l = 1; } } s_gpio_init; // pull-ups: idle high
+
+static bool valid_pin(int pin) { return pin >= 0 && pin < GPIO_NUM_MAX; }
+
+static gpio_int_type_t s_gpio_intr[GPIO_NUM_MAX];
+static gpio_isr_t s_gpio_isr[GPIO_NUM_MAX];
+static void * s_gpio_isr_arg[GPIO_NUM_MAX];
+
+extern "C" esp_err_t gpio_config(const gpio_config_t * cfg)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++)
+        if (cfg->pin_bit_mask & (1ULL << pin)) s_gpio_intr[pin] = cfg->intr_type;
+    return ESP_OK;
+}
+extern "C" esp_err_t gpio_install_isr_service(int) { return ESP_OK; }
+extern "C" esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void * arg)
+{
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    s_gpio_isr[pin] = handler;
+    s_gpio_isr_arg[pin] = arg;
+    return ESP_OK;
+}
+extern "C" esp_err_t gpio_isr_handler_remove(gpio_num_t pin) { return gpio_isr_handler_add(pin, nullptr, nullptr); }
+extern "C" esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    if (!valid_pin(pin)) return ESP_ERR_INVALID_ARG;
+    s_gpio_out[pin] = level ? 1 : 0;
+    s_gpio_writes[pin]++;
+    return ESP_OK;
+}
+extern "C" int gpio_get_level(gpio_num_t pin) { return valid_pin(pin) ? s_gpio_in[pin] : 0; }
+extern "C" esp_err_t gpio_set_pull_mode(gpio_num_t pin, gpio_pull_mode_t) { return valid_pin(pin) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+extern "C" void esp_rom_delay_us(uint32_t) {}
+
+void mock_gpio_set_input(int pin, int level)
+{
+    if (!valid_pin(pin)) return;
+    int prev = s_gpio_in[pin];
+    s_gpio_in[pin] = level ? 1 : 0;
+    if (prev == s_gpio_in[pin] || !s_gpio_isr[pin]) return;
+    gpio_int_type_t t = s_gpio_intr[pin];
+    bool rising = s_gpio_in[pin] == 1;
+    if (t == GPIO_INTR_ANYEDGE || (t == GPIO_INTR_POSEDGE && rising) || (t == GPIO_INTR_NEGEDGE && !rising))
+        s_gpio_isr[pin](s_gpio_isr_arg[pin]);
+}
+int mock_gpio_get_output(int pin) { return valid_pin(pin) ? s_gpio_out[pin] : 0; }
+uint32_t mock_gpio_output_writes(int pin) { return valid_pin(pin) ? s_gpio_writes[pin] : 0; }
+
+static MockGpioRegStats s_gpio_reg_stats;
+const MockGpioRegStats & mock_gpio_reg_stats() { return s_gpio_reg_stats; }
+
+extern "C" uint32_t mock_reg_read(uint32_t addr)
+{
+    uint32_t v = 0;
+    if (addr == GPIO_IN_REG) {
+        s_gpio_reg_stats.reads++;
+        for (int pin = 0; pin < GPIO_NUM_MAX; pin++) v |= (uint32_t)(s_gpio_in[pin] & 1) << pin;
+    } else if (addr == GPIO_OUT_REG) {
+        for (int pin = 0; pin < GPIO_NUM_MAX; pin++) v |= (uint32_t)(s_gpio_out[pin] & 1) << pin;
+    }
+    return v;
+}
+extern "C" void mock_reg_write(uint32_t addr, uint32_t value)
+{
+    if (addr != GPIO_OUT_W1TS_REG && addr != GPIO_OUT_W1TC_REG) return;
+    s_gpio_reg_stats.writes++;
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (!(value & (1u << pin))) continue;
+        s_gpio_out[pin] = addr == GPIO_OUT_W1TS_REG ? 1 : 0;
+        s_gpio_writes[pin]++;
+    }
+}
+
+// ---------------------------------------------------------------- LEDC
+// A channel drives its pin high while its duty is non-zero (fades jump straight to the target).
+struct LedcChannel {
+    int gpio = -1;
+    int timer = 0;
+    uint32_t duty = 0;
+    uint32_t pending_duty = 0;
+};
+static LedcChannel s_ledc[LEDC_CHANNEL_MAX];
+static uint32_t s_ledc_timer_hz[LEDC_TIMER_MAX];
+static MockLedcStats s_ledc_stats;
+const MockLedcStats & mock_ledc_stats() { return s_ledc_stats; }
+
+static void ledc_output(LedcChannel & c)
+{
+    if (!valid_pin(c.gpio)) return;
+    s_gpio_out[c.gpio] = c.duty ? 1 : 0;
+    s_gpio_writes[c.gpio]++;
+}
+static bool valid_ledc(ledc_channel_t ch) { return ch >= 0 && ch < LEDC_CHANNEL_MAX; }
+
+extern "C" esp_err_t ledc_timer_config(const ledc_timer_config_t * cfg)
+{
+    if (!cfg || cfg->timer_num < 0 || cfg->timer_num >= LEDC_TIMER_MAX || !cfg->freq_hz) return ESP_ERR_INVALID_ARG;
+    s_ledc_timer_hz[cfg->timer_num] = cfg->freq_hz;
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_channel_config(const ledc_channel_config_t * cfg)
+{
+    if (!cfg || !valid_ledc(cfg->channel) || !valid_pin(cfg->gpio_num)) return ESP_ERR_INVALID_ARG;
+    LedcChannel & c = s_ledc[cfg->channel];
+    c.gpio = cfg->gpio_num;
+    c.timer = cfg->timer_sel;
+    c.duty = c.pending_duty = cfg->duty;
+    ledc_output(c);
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_bind_channel_timer(ledc_mode_t, ledc_channel_t ch, ledc_timer_t timer)
+{
+    if (!valid_ledc(ch)) return ESP_ERR_INVALID_ARG;
+    s_ledc[ch].timer = timer;
+    s_ledc_stats.binds++;
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_set_duty(ledc_mode_t, ledc_channel_t ch, uint32_t duty)
+{
+    if (!valid_ledc(ch)) return ESP_ERR_INVALID_ARG;
+    s_ledc[ch].pending_duty = duty;
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t ch)
+{
+    if (!valid_ledc(ch)) return ESP_ERR_INVALID_ARG;
+    s_ledc[ch].duty = s_ledc[ch].pending_duty;
+    s_ledc_stats.duty_updates++;
+    ledc_output(s_ledc[ch]);
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_fade_func_install(int) { return ESP_OK; }
+extern "C" esp_err_t ledc_set_fade_time_and_start(ledc_mode_t, ledc_channel_t ch, uint32_t target, uint32_t, ledc_fade_mode_t)
+{
+    if (!valid_ledc(ch)) return ESP_ERR_INVALID_ARG;
+    s_ledc[ch].duty = s_ledc[ch].pending_duty = target;
+    s_ledc_stats.fades++;
+    ledc_output(s_ledc[ch]);
+    return ESP_OK;
+}
+extern "C" esp_err_t ledc_fade_stop(ledc_mode_t, ledc_channel_t ch) { return valid_ledc(ch) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+int mock_ledc_pin_hz(int pin)
+{
+    for (const LedcChannel & c : s_ledc)
+        if (c.gpio == pin) return (int)s_ledc_timer_hz[c.timer];
+    return 0;
+}
+
+// ---------------------------------------------------------------- RMT / DHT22
+struct rmt_channel_t {
+    rmt_rx_event_callbacks_t cbs;
+    void * user;
+};
+static bool s_dht_present = false;
+static int16_t s_dht_t = 0;
+static uint16_t s_dht_h = 0;
+
+void mock_dht22_set_reading(int16_t temp_x10, uint16_t hum_x10) { s_dht_present = true; s_dht_t = temp_x10; s_dht_h = hum_x10; }
+void mock_dht22_set_absent() { s_dht_present = false; }
+
+size_t mock_dht22_build_pulses(int16_t temp_x10, uint16_t hum_x10, uint8_t * lvl, uint16_t * dur, size_t cap)
+{
+    uint8_t d[5];
+    uint16_t t = temp_x10 < 0 ? (uint16_t)(0x8000 | (uint16_t)(-temp_x10)) : (uint16_t)temp_x10;
+    d[0] = (uint8_t)(hum_x10 >> 8); d[1] = (uint8_t)hum_x10; d[2] = (uint8_t)(t >> 8); d[3] = (uint8_t)t;
+    d[4] = (uint8_t)(d[0] + d[1] + d[2] + d[3]);
+    size_t n = 0;
+    auto put = [&](uint8_t l, uint16_t us) { if (n < cap) { lvl[n] = l; dur[n] = us; n++; } };
+    put(0, 80); put(1, 80); // presence
+    for (int i = 0; i < 40; i++) {
+        bool bit = (d[i / 8] >> (7 - (i % 8))) & 1;
+        put(0, 50);
+        put(1, bit ? 70 : 26);
+    }
+    put(0, 50); // release
+    return n;
+}
+
+extern "C" esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *, rmt_channel_handle_t * out)
+{
+    *out = new rmt_channel_t();
+    return ESP_OK;
+}
+extern "C" esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t ch, const rmt_rx_event_callbacks_t * cbs, void * user)
+{
+    ch->cbs = *cbs;
+    ch->user = user;
+    return ESP_OK;
+}
+extern "C" esp_err_t rmt_enable(rmt_channel_handle_t) { return ESP_OK; }
+extern "C" esp_err_t rmt_receive(rmt_channel_handle_t ch, void * buffer, size_t buffer_size, const rmt_receive_config_t *)
+{
+    if (!s_dht_present) return ESP_OK; // never completes: caller times out
+    uint8_t lvl[96];
+    uint16_t dur[96];
+    size_t n = mock_dht22_build_pulses(s_dht_t, s_dht_h, lvl, dur, 96);
+    auto * sym = static_cast<rmt_symbol_word_t *>(buffer);
+    size_t cap = buffer_size / sizeof(rmt_symbol_word_t), count = 0;
+    for (size_t i = 0; i + 1 < n && count < cap; i += 2, count++) {
+        sym[count].val = 0;
+        sym[count].level0 = lvl[i]; sym[count].duration0 = dur[i];
+        sym[count].level1 = lvl[i + 1]; sym[count].duration1 = dur[i + 1];
+    }
+    rmt_rx_done_event_data_t ev = { sym, count };
+    if (ch->cbs.on_recv_done) ch->cbs.on_recv_done(ch, &ev, ch->user);
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------- esp_matter
+static esp_matter::endpoint_t s_endpoint;
+static esp_matter::cluster_t s_cluster;
+static esp_matter::attribute_t s_attribute;
+static std::map<std::tuple<uint16_t, uint32_t, uint32_t>, esp_matter_attr_val_t> s_attr_values;
+static uint32_t s_attr_reports = 0;
+
+namespace esp_matter {
+endpoint_t * endpoint::get(node_t * node, uint16_t) { return node ? &s_endpoint : nullptr; }
+cluster_t * cluster::create(endpoint_t * ep, uint32_t, uint8_t) { return ep ? &s_cluster : nullptr; }
+attribute_t * cluster::global::attribute::create_cluster_revision(cluster_t *, uint16_t) { return &s_attribute; }
+attribute_t * cluster::global::attribute::create_feature_map(cluster_t *, uint32_t) { return &s_attribute; }
+attribute_t * attribute::create(cluster_t *, uint32_t, uint16_t, esp_matter_attr_val_t, uint16_t) { return &s_attribute; }
+esp_err_t attribute::report(uint16_t ep, uint32_t cluster, uint32_t attr, esp_matter_attr_val_t * val)
+{
+    if (!val) return ESP_ERR_INVALID_ARG;
+    s_attr_values[{ ep, cluster, attr }] = *val;
+    s_attr_reports++;
+    return ESP_OK;
+}
+esp_err_t attribute::update(uint16_t ep, uint32_t cluster, uint32_t attr, esp_matter_attr_val_t * val) { return report(ep, cluster, attr, val); }
+} // namespace esp_matter
+
+bool mock_attr_last(uint16_t ep, uint32_t cluster, uint32_t attr, esp_matter_attr_val_t * out)
+{
+    auto it = s_attr_values.find({ ep, cluster, attr });
+    if (it == s_attr_values.end()) return false;
+    if (out) *out = it->second;
+    return true;
+}
+uint32_t mock_attr_report_count() { return s_attr_reports; }
+
+static MockClusterUpdateHandler s_update_handler;
+void mock_client_set_update_handler(MockClusterUpdateHandler handler) { s_update_handler = std::move(handler); }
+esp_err_t esp_matter::client::cluster_update(uint16_t local_ep, request_handle_t * req)
+{
+    if (!req) return ESP_ERR_INVALID_ARG;
+    return s_update_handler ? s_update_handler(local_ep, *req) : ESP_FAIL;
+}
+
+static std::vector<esp_matter::console::command_t> s_commands;
+esp_err_t esp_matter::console::add_commands(const command_t * set, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) s_commands.push_back(set[i]);
+    return ESP_OK;
+}
+
+esp_err_t mock_console_run(const char * line)
+{
+    std::vector<std::string> words;
+    std::string cur;
+    for (const char * p = line; ; p++) {
+        if (*p == ' ' || *p == '\0') { if (!cur.empty()) words.push_back(cur); cur.clear(); if (!*p) break; }
+        else cur += *p;
+    }
+    if (words.empty()) return ESP_ERR_INVALID_ARG;
+    for (auto & c : s_commands) {
+        if (words[0] != c.name) continue;
+        std::vector<char *> argv;
+        for (size_t i = 1; i < words.size(); i++) argv.push_back(&words[i][0]);
+        return c.handler((int)argv.size(), argv.data());
+    }
+    return ESP_ERR_NOT_FOUND;
+}
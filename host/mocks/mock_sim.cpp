@@ -0,0 +1,382 @@
+/*
+ * Host clock + FreeRTOS mock, with an optional deterministic virtual-time scheduler.
+ *
+ * Real-time mode (default): esp_timer_get_time() is wall time, tasks are recorded but never run,
+ * queues never block. The harness drives step functions directly (host_bench, host_scale).
+ *
+ * Virtual-time mode (mock_sim_enable()): time only moves inside mock_sim_run_until(). Each
+ * FreeRTOS task runs on its own std::thread, but a single baton (s_mutex + s_current) lets exactly
+ * one context execute at a time, and control only changes hands when a task blocks (vTaskDelay,
+ * empty-queue receive, notify wait) or returns. The scheduler repeatedly:
+ *   1. drains the Matter work queue,
+ *   2. fires due esp_timers and timed posts,
+ *   3. resumes the earliest-woken runnable task (ties: the order they became runnable),
+ * and when nothing is runnable jumps the clock to the next deadline. There is no preemption and
+ * no priority: a task runs until it blocks. Same inputs -> same interleaving, every run.
+ */
+#include "mock_hw.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "platform/PlatformManager.h"
+
+// ---------------------------------------------------------------- clock
+static const auto s_epoch = std::chrono::steady_clock::now();
+static bool s_sim = false;
+static int64_t s_now_us = 0;
+static MockSimStats s_stats;
+
+int64_t mock_clock_now_us()
+{
+    if (s_sim) return s_now_us;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+extern "C" int64_t esp_timer_get_time(void) { return mock_clock_now_us(); }
+
+// ---------------------------------------------------------------- tasks
+struct SimTaskExit {}; // thrown inside a task thread to unwind it (self-delete / shutdown)
+
+struct tskTaskControlBlock {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void * arg;
+    uint32_t stack_bytes;
+    // virtual-time mode only
+    std::thread thread;
+    std::condition_variable cv;
+    bool go = false;       // holds the baton
+    bool exit = false;     // unwind at next resume
+    bool done = false;     // thread finished
+    int64_t wake_us = INT64_MAX;
+    uint64_t seq = 0;      // FIFO order among tasks waking at the same time
+    QueueDefinition * wait_queue = nullptr;
+    bool wait_notify = false;
+    uint32_t notify = 0;
+};
+
+static std::mutex s_mutex;
+static std::condition_variable s_sched_cv;
+static tskTaskControlBlock * s_current = nullptr; // task holding the baton (nullptr = harness)
+static std::vector<tskTaskControlBlock *> s_tasks;
+static tskTaskControlBlock s_host_task = { "host", nullptr, nullptr, 0 };
+static uint64_t s_seq = 0;
+static bool s_in_scheduler = false;
+
+static void make_runnable(tskTaskControlBlock * t, int64_t wake_us)
+{
+    t->wake_us = wake_us;
+    t->seq = ++s_seq;
+}
+
+// Task side: give the baton back and sleep until resumed. Called without s_mutex held.
+static void task_block(tskTaskControlBlock * t)
+{
+    std::unique_lock<std::mutex> lk(s_mutex);
+    t->go = false;
+    s_current = nullptr;
+    s_sched_cv.notify_one();
+    t->cv.wait(lk, [t] { return t->go; });
+    if (t->exit) throw SimTaskExit();
+}
+
+static void task_main(tskTaskControlBlock * t)
+{
+    {
+        std::unique_lock<std::mutex> lk(s_mutex);
+        t->cv.wait(lk, [t] { return t->go; });
+    }
+    if (!t->exit) {
+        try {
+            t->fn(t->arg);
+        } catch (const SimTaskExit &) {
+        }
+    }
+    std::lock_guard<std::mutex> lk(s_mutex);
+    t->done = true;
+    t->go = false;
+    s_current = nullptr;
+    s_sched_cv.notify_one();
+}
+
+// Harness side: hand the baton to `t` and wait until it blocks or finishes.
+static void resume(tskTaskControlBlock * t)
+{
+    std::unique_lock<std::mutex> lk(s_mutex);
+    s_current = t;
+    t->go = true;
+    t->cv.notify_one();
+    s_sched_cv.wait(lk, [] { return s_current == nullptr; });
+    s_stats.task_switches++;
+}
+
+static void reap(tskTaskControlBlock * t)
+{
+    if (t->thread.joinable()) t->thread.join();
+    for (auto it = s_tasks.begin(); it != s_tasks.end(); ++it) {
+        if (*it == t) { s_tasks.erase(it); break; }
+    }
+    delete t;
+}
+
+static bool in_task() { return s_sim && s_current != nullptr; }
+
+extern "C" BaseType_t xPortInIsrContext(void) { return pdFALSE; }
+
+extern "C" BaseType_t xTaskCreate(TaskFunction_t fn, const char * name, uint32_t stack_bytes, void * arg, UBaseType_t, TaskHandle_t * out)
+{
+    auto * t = new tskTaskControlBlock();
+    strncpy(t->name, name ? name : "", sizeof(t->name) - 1);
+    t->name[sizeof(t->name) - 1] = '\0';
+    t->fn = fn;
+    t->arg = arg;
+    t->stack_bytes = stack_bytes;
+    s_tasks.push_back(t);
+    if (s_sim) {
+        make_runnable(t, s_now_us);
+        t->thread = std::thread(task_main, t);
+    }
+    if (out) *out = t;
+    return pdPASS;
+}
+
+extern "C" TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char * name, uint32_t stack_bytes, void * arg, UBaseType_t prio,
+                                          StackType_t *, StaticTask_t *)
+{
+    TaskHandle_t h = nullptr;
+    xTaskCreate(fn, name, stack_bytes, arg, prio, &h);
+    return h;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t task)
+{
+    if (in_task() && (!task || task == s_current)) throw SimTaskExit(); // self-delete; reaped by the scheduler
+    if (!task) return;
+    if (in_task()) { // another task: unwind it the next time the scheduler resumes it
+        task->exit = true;
+        make_runnable(task, s_now_us);
+        return;
+    }
+    if (s_sim && task->thread.joinable() && !task->done) {
+        task->exit = true;
+        resume(task);
+    }
+    reap(task);
+}
+
+extern "C" void vTaskDelay(TickType_t ticks)
+{
+    int64_t us = (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    if (in_task()) {
+        tskTaskControlBlock * t = s_current;
+        make_runnable(t, s_now_us + us);
+        task_block(t);
+    } else if (s_sim && !s_in_scheduler) {
+        mock_sim_run_for(us); // harness sleeping: let the simulation run
+    }
+    // Real-time mode, or a timer / Matter callback: never blocks.
+}
+
+extern "C" TickType_t xTaskGetTickCount(void) { return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS); }
+extern "C" UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return task ? task->stack_bytes / 2 : 4096; // no real stack on the host; report half used
+}
+extern "C" char * pcTaskGetName(TaskHandle_t task)
+{
+    if (!task) task = in_task() ? s_current : &s_host_task;
+    return task->name;
+}
+extern "C" TaskHandle_t xTaskGetHandle(const char * name)
+{
+    for (auto * t : s_tasks) if (strncmp(t->name, name, sizeof(t->name)) == 0) return t;
+    return nullptr;
+}
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void) { return in_task() ? s_current : &s_host_task; }
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    tskTaskControlBlock * t = xTaskGetCurrentTaskHandle();
+    if (!t->notify && ticks && in_task()) {
+        t->wait_notify = true;
+        make_runnable(t, ticks == portMAX_DELAY ? INT64_MAX : s_now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000);
+        task_block(t);
+        t->wait_notify = false;
+    }
+    uint32_t v = t->notify;
+    if (v) t->notify = clear_on_exit ? 0 : v - 1;
+    return v;
+}
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    if (!task) return pdFAIL;
+    task->notify++;
+    if (task->wait_notify) make_runnable(task, s_now_us);
+    return pdPASS;
+}
+extern "C" void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken)
+{
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+
+// ---------------------------------------------------------------- queues
+struct QueueDefinition {
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t item_size;
+};
+
+extern "C" QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    auto * q = new QueueDefinition();
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+extern "C" QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *, StaticQueue_t *)
+{
+    return xQueueCreate(length, item_size);
+}
+// Senders never block (a full queue fails immediately); receivers block only in virtual-time tasks.
+extern "C" BaseType_t xQueueSend(QueueHandle_t q, const void * item, TickType_t)
+{
+    if (!q || q->items.size() >= q->length) return pdFALSE;
+    const uint8_t * p = static_cast<const uint8_t *>(item);
+    q->items.emplace_back(p, p + q->item_size);
+    for (auto * t : s_tasks) if (t->wait_queue == q) make_runnable(t, s_now_us);
+    return pdTRUE;
+}
+extern "C" BaseType_t xQueueSendFromISR(QueueHandle_t q, const void * item, BaseType_t * woken)
+{
+    if (woken) *woken = pdFALSE;
+    return xQueueSend(q, item, 0);
+}
+extern "C" BaseType_t xQueueReceive(QueueHandle_t q, void * item, TickType_t ticks)
+{
+    if (!q) return pdFALSE;
+    int64_t deadline = ticks == portMAX_DELAY ? INT64_MAX : s_now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    while (q->items.empty()) {
+        if (!ticks || !in_task() || s_now_us >= deadline) return pdFALSE;
+        tskTaskControlBlock * t = s_current;
+        t->wait_queue = q;
+        make_runnable(t, deadline);
+        task_block(t);
+        t->wait_queue = nullptr;
+    }
+    memcpy(item, q->items.front().data(), q->item_size);
+    q->items.pop_front();
+    return pdTRUE;
+}
+extern "C" UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) { return q ? (UBaseType_t)q->items.size() : 0; }
+extern "C" void vQueueDelete(QueueHandle_t q) { delete q; }
+
+// ---------------------------------------------------------------- timed Matter posts
+struct TimedPost {
+    int64_t due_us;
+    uint64_t seq;
+    chip::DeviceLayer::AsyncWorkFunct fn;
+    intptr_t arg;
+};
+static std::vector<TimedPost> s_posts;
+
+void mock_matter_post_after(int64_t delay_us, chip::DeviceLayer::AsyncWorkFunct fn, intptr_t arg)
+{
+    if (!s_sim || delay_us <= 0) {
+        chip::DeviceLayer::PlatformMgr().ScheduleWork(fn, arg);
+        return;
+    }
+    s_posts.push_back({ s_now_us + delay_us, ++s_seq, fn, arg });
+}
+
+static size_t run_due_posts()
+{
+    size_t n = 0;
+    for (;;) {
+        auto best = s_posts.end();
+        for (auto it = s_posts.begin(); it != s_posts.end(); ++it) {
+            if (it->due_us <= s_now_us && (best == s_posts.end() || it->due_us < best->due_us ||
+                                           (it->due_us == best->due_us && it->seq < best->seq)))
+                best = it;
+        }
+        if (best == s_posts.end()) return n;
+        TimedPost p = *best;
+        s_posts.erase(best);
+        chip::DeviceLayer::PlatformMgr().ScheduleWork(p.fn, p.arg);
+        n++;
+    }
+}
+
+// ---------------------------------------------------------------- scheduler
+void mock_sim_enable(int64_t start_us)
+{
+    if (s_sim) return;
+    s_sim = true;
+    s_now_us = start_us;
+    // Tasks created before the switch were never started; start them now.
+    for (auto * t : s_tasks) {
+        if (t->thread.joinable()) continue;
+        make_runnable(t, s_now_us);
+        t->thread = std::thread(task_main, t);
+    }
+}
+
+bool mock_sim_enabled() { return s_sim; }
+const MockSimStats & mock_sim_stats() { return s_stats; }
+
+void mock_sim_run_until(int64_t t_end_us)
+{
+    if (!s_sim || s_in_scheduler) return;
+    s_in_scheduler = true;
+    for (;;) {
+        size_t n = mock_matter_run_pending();
+        s_stats.work_items += n;
+        size_t fired = mock_timers_run_due();
+        s_stats.timers_fired += fired;
+        size_t posts = run_due_posts();
+        s_stats.timed_posts += posts;
+        if (n || fired || posts) continue;
+
+        tskTaskControlBlock * next = nullptr;
+        for (auto * t : s_tasks) {
+            if (t->done || !t->thread.joinable() || t->wake_us > s_now_us) continue;
+            if (!next || t->wake_us < next->wake_us || (t->wake_us == next->wake_us && t->seq < next->seq)) next = t;
+        }
+        if (next) {
+            next->wake_us = INT64_MAX;
+            resume(next);
+            if (next->done) reap(next);
+            continue;
+        }
+
+        int64_t due = mock_timers_next_deadline_us();
+        for (auto & p : s_posts) due = std::min(due, p.due_us);
+        for (auto * t : s_tasks) if (!t->done && t->thread.joinable()) due = std::min(due, t->wake_us);
+        if (due > t_end_us) {
+            if (t_end_us > s_now_us) s_now_us = t_end_us;
+            break;
+        }
+        s_now_us = due;
+    }
+    s_in_scheduler = false;
+}
+
+void mock_sim_run_for(int64_t us) { mock_sim_run_until(s_now_us + us); }
+
+void mock_sim_shutdown()
+{
+    while (!s_tasks.empty()) vTaskDelete(s_tasks.back());
+    s_posts.clear();
+}
@@ -0,0 +1,17 @@
+/* Host mock: ScheduleWork() queues onto a FIFO drained by mock_matter_run_pending() (the "Matter thread"). */
+#pragma once
+#include <stdint.h>
+#include <lib/core/CHIPError.h>
+#include <lib/support/CHIPMem.h>
+namespace chip {
+namespace DeviceLayer {
+typedef void (*AsyncWorkFunct)(intptr_t arg);
+class PlatformManager {
+public:
+    CHIP_ERROR ScheduleWork(AsyncWorkFunct fn, intptr_t arg = 0);
+    void LockChipStack() {}
+    void UnlockChipStack() {}
+};
+PlatformManager & PlatformMgr();
+} // namespace DeviceLayer
+} // namespace chip
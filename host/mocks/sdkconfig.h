@@ -0,0 +1,5 @@
+/* Host build configuration (forced-included into every translation unit). */
+#pragma once
+#define CONFIG_ENABLE_CHIP_SHELL 1
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE 4096
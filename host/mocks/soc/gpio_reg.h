@@ -0,0 +1,7 @@
+/* Host mock: GPIO register addresses as on ESP32-C6 (one bank, pins 0..30). */
+#pragma once
+#define DR_REG_GPIO_BASE 0x60091000
+#define GPIO_OUT_REG (DR_REG_GPIO_BASE + 0x4)
+#define GPIO_OUT_W1TS_REG (DR_REG_GPIO_BASE + 0x8)
+#define GPIO_OUT_W1TC_REG (DR_REG_GPIO_BASE + 0xc)
+#define GPIO_IN_REG (DR_REG_GPIO_BASE + 0x3c)
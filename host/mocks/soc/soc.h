@@ -0,0 +1,13 @@
+/* Host mock of the register accessors; GPIO registers are backed by the mock pin state (mock_hw.h). */
+#pragma once
+#include <stdint.h>
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint32_t mock_reg_read(uint32_t addr);
+void mock_reg_write(uint32_t addr, uint32_t value);
+#ifdef __cplusplus
+}
+#endif
+#define REG_READ(r) mock_reg_read((uint32_t)(r))
+#define REG_WRITE(r, v) mock_reg_write((uint32_t)(r), (uint32_t)(v))
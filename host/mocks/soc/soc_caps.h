@@ -0,0 +1,4 @@
+#pragma once
+#define SOC_GPIO_PIN_COUNT 31
+#define SOC_LEDC_CHANNEL_NUM 6
+#define SOC_LEDC_TIMER_BIT_WIDTH 20
@@ -0,0 +1,387 @@
+/*
+ * Virtual-time scenario runner: boots the light manager (real button / action / sensor tasks,
+ * esp_timers, Matter queue) on the deterministic scheduler in host/mocks/mock_sim.cpp and plays a
+ * scenario script against it. Hours of simulated operation run in seconds, and the same script +
+ * seed always produces the same interleaving.
+ *
+ *   host_sim <scenario.sim> [...]       (see host/sim/scenarios/ for the command reference)
+ *
+ * Exit status is non-zero if any `expect` fails or a fuzz invariant is violated.
+ */
+#include <chrono>
+#include <cstdarg>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <app-common/zap-generated/cluster-objects.h>
+#include <esp_log.h>
+#include "mock_hw.h"
+#include "host_app.h"
+#include "channels.h"
+#include "led_engine.h"
+#include "scene_engine.h"
+#include "temp_manager.h"
+#include "rules.h"
+#include "diag/metrics.h"
+#include "diag/trace.h"
+
+static constexpr const gpio_num_t (&k_buttons)[16] = channels::kButtonPins;
+static constexpr const gpio_num_t (&k_leds)[16] = channels::kLedPins;
+
+static int s_failures = 0;
+static bool s_started = false;
+
+// ---- scenario parsing helpers ----
+struct Line {
+    const char * file;
+    int no;
+    std::vector<std::string> w;
+};
+
+static void fail(const Line & l, const char * fmt, ...) __attribute__((format(printf, 2, 3)));
+static void fail(const Line & l, const char * fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s:%d: [t=%.3fs] ", l.file, l.no, mock_clock_now_us() / 1e6);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    s_failures++;
+}
+
+// "250" (ms), "250ms", "40us", "2s", "5m", "1h"
+static int64_t parse_dur_us(const std::string & s)
+{
+    char * end = nullptr;
+    double v = strtod(s.c_str(), &end);
+    std::string unit = end ? end : "";
+    if (unit == "us") return (int64_t)v;
+    if (unit == "s") return (int64_t)(v * 1e6);
+    if (unit == "m") return (int64_t)(v * 60e6);
+    if (unit == "h") return (int64_t)(v * 3600e6);
+    return (int64_t)(v * 1e3);
+}
+
+static uint64_t parse_u64(const std::string & s) { return strtoull(s.c_str(), nullptr, 0); }
+
+static bool parse_on(const std::string & s) { return s == "on" || s == "1" || s == "true"; }
+
+static const char * fx_name(LedFx fx)
+{
+    switch (fx) {
+    case LedFx::Pending: return "pending";
+    case LedFx::Error: return "error";
+    case LedFx::Identify: return "identify";
+    default: return "none";
+    }
+}
+
+static bool led_out(uint8_t ch) { return mock_gpio_get_output(k_leds[ch]) != 0; }
+static bool has_led(uint8_t ch) { return (channels::kLedChannels >> ch) & 1u; }
+
+// Button level: a GPIO pin, or an expander input in BUTTON_IO expander builds.
+static void set_button(uint8_t ch, int level)
+{
+#if BUTTON_IO == BUTTON_IO_GPIO
+    mock_gpio_set_input(k_buttons[ch], level);
+#else
+    mock_iox_set_input(ch, level);
+#endif
+}
+
+// ---- deterministic PRNG (xorshift64*) ----
+struct Rng {
+    uint64_t s;
+    uint64_t next()
+    {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+    uint32_t below(uint32_t n) { return (uint32_t)(next() % n); }
+};
+
+static void start_firmware()
+{
+    if (s_started) return;
+    s_started = true;
+    light_manager_init();
+    temp_manager_start();
+}
+
+static void press(uint8_t ch, int64_t hold_us)
+{
+    set_button(ch, 0);
+    mock_sim_run_for(hold_us);
+    set_button(ch, 1);
+}
+
+// Settle, run one LED sync round and check every bound channel's LED against its targets.
+static int check_led_invariant(const Line & l)
+{
+    mock_sim_run_for(2000000);
+    light_manager_sync_initial_state();
+    mock_sim_run_for(2000000);
+    int bad = 0;
+    for (uint8_t ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        const ShadowBindingList * list = shadow_binding_get_list(ch);
+        bool any = false, unicast = false;
+        for (int i = 0; list && i < list->count; i++) {
+            if (list->entries[i].is_group) continue;
+            unicast = true;
+            any |= host_target_on(list->entries[i].node_id, list->entries[i].endpoint);
+        }
+        if (!unicast) continue;
+        if ((has_led(ch) && led_out(ch) != any) || light_manager_get(ch) != any) {
+            fail(l, "ch%u: led=%d state=%d but targets any_on=%d", ch, led_out(ch), light_manager_get(ch), any);
+            bad++;
+        }
+    }
+    return bad;
+}
+
+// fuzz <seed> <events> [max_gap]: random presses (incl. sub-debounce glitches), remote target
+// flips, RTT changes and sync rounds; then settle and check LED == any bound target on.
+static void fuzz(const Line & l, uint64_t seed, uint32_t events, int64_t max_gap_us)
+{
+    Rng rng{ seed ? seed : 1 };
+    std::vector<std::pair<uint64_t, uint16_t>> targets;
+    for (uint8_t ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        const ShadowBindingList * list = shadow_binding_get_list(ch);
+        for (int i = 0; list && i < list->count; i++)
+            if (!list->entries[i].is_group) targets.push_back({ list->entries[i].node_id, list->entries[i].endpoint });
+    }
+    uint32_t presses = 0, glitches = 0, flips = 0, syncs = 0;
+    for (uint32_t e = 0; e < events; e++) {
+        uint32_t kind = rng.below(100);
+        if (kind < 55) {
+            press((uint8_t)rng.below(LIGHT_CHANNELS), 80000 + rng.below(400) * 1000);
+            presses++;
+        } else if (kind < 70) {
+            press((uint8_t)rng.below(LIGHT_CHANNELS), (1 + rng.below(BUTTON_STABLE_CNT * BUTTON_POLL_MS - 1)) * 1000);
+            glitches++;
+        } else if (kind < 85 && !targets.empty()) {
+            auto & t = targets[rng.below((uint32_t)targets.size())];
+            host_target_set(t.first, t.second, !host_target_on(t.first, t.second));
+            flips++;
+        } else if (kind < 93 && !targets.empty()) {
+            auto & t = targets[rng.below((uint32_t)targets.size())];
+            host_target_set_rtt(t.first, t.second, (int64_t)rng.below(300) * 1000);
+        } else {
+            light_manager_sync_initial_state();
+            syncs++;
+        }
+        mock_sim_run_for((int64_t)(rng.next() % (uint64_t)(max_gap_us + 1)));
+    }
+    int bad = check_led_invariant(l);
+    printf("fuzz seed=%" PRIu64 " events=%u presses=%u glitches=%u flips=%u syncs=%u -> %s\n", seed, events, presses, glitches, flips,
+           syncs, bad ? "FAIL" : "ok");
+}
+
+static int64_t metric_value(const metrics::Metric * m)
+{
+    switch (m->kind()) {
+    case metrics::Kind::Counter: return static_cast<const metrics::Counter *>(m)->value();
+    case metrics::Kind::Gauge: return static_cast<const metrics::Gauge *>(m)->value();
+    case metrics::Kind::Histogram: return static_cast<const metrics::Histogram *>(m)->count();
+    }
+    return 0;
+}
+
+static bool compare(int64_t a, const std::string & op, int64_t b)
+{
+    if (op == "==") return a == b;
+    if (op == "!=") return a != b;
+    if (op == ">=") return a >= b;
+    if (op == "<=") return a <= b;
+    if (op == ">") return a > b;
+    if (op == "<") return a < b;
+    return false;
+}
+
+// `expect switch` spelling of a logged Generic Switch event.
+static std::string switch_event_name(const HostSwitchEvent & e)
+{
+    switch (e.ev) {
+    case SwitchEvent::InitialPress: return "press";
+    case SwitchEvent::LongPress: return "long";
+    case SwitchEvent::ShortRelease: return "release";
+    case SwitchEvent::LongRelease: return "long_release";
+    case SwitchEvent::MultiPressOngoing: return "multi:" + std::to_string(e.count);
+    case SwitchEvent::MultiPressComplete: return "complete:" + std::to_string(e.count);
+    }
+    return "?";
+}
+
+static void run_line(const Line & l)
+{
+    const auto & w = l.w;
+    const std::string & cmd = w[0];
+    auto need = [&](size_t n) {
+        if (w.size() >= n) return true;
+        fail(l, "'%s' needs %zu argument(s)", cmd.c_str(), n - 1);
+        return false;
+    };
+    if (cmd == "bind" && need(3)) {
+        if (host_bind_unicast((uint8_t)parse_u64(w[1]), parse_u64(w[2]), w.size() > 3 ? (uint16_t)parse_u64(w[3]) : 1,
+                              w.size() > 4 ? (uint32_t)parse_u64(w[4]) : chip::app::Clusters::OnOff::Id) != SHADOW_IMPORT_ADDED)
+            fail(l, "bind failed");
+    } else if (cmd == "group" && need(3)) {
+        host_bind_group((uint8_t)parse_u64(w[1]), (uint16_t)parse_u64(w[2]), w.size() > 3 ? (uint32_t)parse_u64(w[3]) : chip::app::Clusters::OnOff::Id);
+    } else if (cmd == "member" && need(3)) {
+        host_group_add_member((uint16_t)parse_u64(w[1]), parse_u64(w[2]), w.size() > 3 ? (uint16_t)parse_u64(w[3]) : 1);
+    } else if (cmd == "target" && need(4)) {
+        uint64_t node = parse_u64(w[1]);
+        uint16_t ep = (uint16_t)parse_u64(w[2]);
+        bool reachable = !(w.size() > 5 && w[5] == "down");
+        host_target_set(node, ep, parse_on(w[3]), reachable);
+        host_target_set_lost(node, ep, w.size() > 5 && w[5] == "lost");
+        if (w.size() > 4) host_target_set_rtt(node, ep, parse_dur_us(w[4]));
+    } else if (cmd == "start") {
+        start_firmware();
+    } else if (cmd == "press" && need(2)) {
+        press((uint8_t)parse_u64(w[1]), w.size() > 2 ? parse_dur_us(w[2]) : 100000);
+    } else if ((cmd == "down" || cmd == "up") && need(2)) {
+        set_button((uint8_t)(parse_u64(w[1]) % LIGHT_CHANNELS), cmd == "up");
+    } else if (cmd == "identify" && need(3)) {
+        light_manager_identify(g_onoff_endpoint_ids[parse_u64(w[1]) % LIGHT_CHANNELS], parse_on(w[2]));
+    } else if (cmd == "sync") {
+        light_manager_sync_initial_state();
+    } else if (cmd == "dht" && need(2)) {
+        if (w[1] == "absent") mock_dht22_set_absent();
+        else if (need(3)) mock_dht22_set_reading((int16_t)atoi(w[1].c_str()), (uint16_t)atoi(w[2].c_str()));
+    } else if (cmd == "wait" && need(2)) {
+        mock_sim_run_for(parse_dur_us(w[1]));
+    } else if (cmd == "scene" && need(2)) {
+        std::vector<char *> argv;
+        for (size_t i = 1; i < w.size(); i++) argv.push_back(const_cast<char *>(w[i].c_str()));
+        if (scene_engine_command((int)argv.size(), argv.data()) != 0) fail(l, "scene command failed");
+    } else if (cmd == "rule" && need(2)) {
+        std::vector<char *> argv;
+        for (size_t i = 1; i < w.size(); i++) argv.push_back(const_cast<char *>(w[i].c_str()));
+        if (rules_command((int)argv.size(), argv.data()) != 0) fail(l, "rule command failed");
+    } else if (cmd == "health") {
+        std::vector<char *> argv;
+        for (size_t i = 1; i < w.size(); i++) argv.push_back(const_cast<char *>(w[i].c_str()));
+        if (light_manager_health_command((int)argv.size(), argv.data()) != 0) fail(l, "health command failed");
+    } else if (cmd == "link" && need(2)) {
+        host_set_link(parse_on(w[1]) || w[1] == "up");
+        light_manager_connectivity_changed();
+    } else if (cmd == "workq" && need(2)) {
+        if (w[1] == "stall") mock_matter_stall(true);
+        else if (w[1] == "run") mock_matter_stall(false);
+        else if (w[1] == "limit" && w.size() > 2) mock_matter_set_limit((size_t)strtoul(w[2].c_str(), nullptr, 0));
+        else fail(l, "workq stall|run|limit <n>");
+    } else if (cmd == "trace" && need(2)) {
+        if (w[1] == "start") trace_start();
+        else if (w[1] == "dump") trace_dump();
+        else trace_stop();
+    } else if (cmd == "metrics") {
+        metrics::print_snapshot(w.size() > 1 ? w[1].c_str() : nullptr);
+    } else if (cmd == "log" && need(2)) {
+        esp_log_level_set("*", w[1] == "info" ? ESP_LOG_INFO : w[1] == "debug" ? ESP_LOG_DEBUG : w[1] == "error" ? ESP_LOG_ERROR : ESP_LOG_WARN);
+    } else if (cmd == "expect" && need(2)) {
+        if (w[1] == "led" && need(4)) {
+            uint8_t ch = (uint8_t)parse_u64(w[2]);
+            if (led_out(ch) != parse_on(w[3])) fail(l, "expected LED%u %s, GPIO is %s", ch, w[3].c_str(), led_out(ch) ? "on" : "off");
+        } else if (w[1] == "ledfx" && need(4)) {
+            const char * fx = fx_name(led_engine_active_fx((uint8_t)parse_u64(w[2])));
+            if (w[3] != fx) fail(l, "expected LED%s effect %s, is %s", w[2].c_str(), w[3].c_str(), fx);
+        } else if (w[1] == "target" && need(5)) {
+            bool on = host_target_on(parse_u64(w[2]), (uint16_t)parse_u64(w[3]));
+            if (on != parse_on(w[4])) fail(l, "expected target %s/%s %s, is %s", w[2].c_str(), w[3].c_str(), w[4].c_str(), on ? "on" : "off");
+        } else if (w[1] == "metric" && need(5)) {
+            const metrics::Metric * m = metrics::find(w[2].c_str());
+            int64_t v = m ? metric_value(m) : 0;
+            if (!m || !compare(v, w[3], strtoll(w[4].c_str(), nullptr, 0)))
+                fail(l, "expected %s %s %s, got %" PRId64 "%s", w[2].c_str(), w[3].c_str(), w[4].c_str(), v, m ? "" : " (no such metric)");
+        } else if (w[1] == "level" && need(6)) {
+            int v = host_target_level(parse_u64(w[2]), (uint16_t)parse_u64(w[3]));
+            if (!compare(v, w[4], strtoll(w[5].c_str(), nullptr, 0))) fail(l, "expected level %s/%s %s %s, is %d", w[2].c_str(), w[3].c_str(), w[4].c_str(), w[5].c_str(), v);
+        } else if (w[1] == "ctemp" && need(6)) {
+            int v = host_target_mireds(parse_u64(w[2]), (uint16_t)parse_u64(w[3]));
+            if (!compare(v, w[4], strtoll(w[5].c_str(), nullptr, 0))) fail(l, "expected ctemp %s/%s %s %s, is %d", w[2].c_str(), w[3].c_str(), w[4].c_str(), w[5].c_str(), v);
+        } else if (w[1] == "switch" && need(4)) {
+            uint8_t ch = (uint8_t)(parse_u64(w[2]) % LIGHT_CHANNELS);
+            std::string got, want;
+            for (const HostSwitchEvent & e : host_switch_events(ch)) got += (got.empty() ? "" : " ") + switch_event_name(e);
+            for (size_t i = 3; i < w.size(); i++)
+                if (w[i] != "none") want += (want.empty() ? "" : " ") + w[i];
+            if (got != want) fail(l, "expected switch %u events '%s', got '%s'", ch, want.c_str(), got.c_str());
+            host_switch_events_clear(ch);
+        } else if (w[1] == "health" && need(5)) {
+            uint64_t node = parse_u64(w[2]);
+            uint16_t ep = (uint16_t)parse_u64(w[3]);
+            const char * st = "unknown";
+            const TargetHealthTable & h = light_target_health();
+            for (int i = 0; i < h.size(); i++) {
+                const TargetHealth & t = h.entries()[i];
+                if (t.node_id == node && t.endpoint == ep) st = t.state == TargetHealth::Closed ? "ok" : t.state == TargetHealth::Open ? "open" : "probing";
+            }
+            if (w[4] != st) fail(l, "expected health %s/%s %s, is %s", w[2].c_str(), w[3].c_str(), w[4].c_str(), st);
+        } else if (w[1] == "consistent") {
+            check_led_invariant(l);
+        } else {
+            fail(l, "unknown expect '%s'", w[1].c_str());
+        }
+    } else if (cmd == "fuzz" && need(3)) {
+        fuzz(l, parse_u64(w[1]), (uint32_t)parse_u64(w[2]), w.size() > 3 ? parse_dur_us(w[3]) : 2000000);
+    } else {
+        static const char * known[] = { "bind", "group", "member", "target", "start", "press", "down", "up", "identify", "sync", "dht", "wait", "scene", "rule", "link", "workq", "health", "trace",
+                                        "metrics", "log", "expect", "fuzz" };
+        bool k = false;
+        for (const char * n : known) k |= (cmd == n);
+        if (!k) fail(l, "unknown command '%s'", cmd.c_str()); // known ones already reported a missing argument
+    }
+}
+
+static bool run_file(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char buf[512];
+    int no = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        no++;
+        Line l{ path, no, {} };
+        char * hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        for (char * tok = strtok(buf, " \t\r\n"); tok; tok = strtok(nullptr, " \t\r\n")) l.w.push_back(tok);
+        if (!l.w.empty()) run_line(l);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <scenario.sim> [...]\n", argv[0]);
+        return 2;
+    }
+    esp_log_level_set("*", ESP_LOG_ERROR); // scenarios opt in with `log warn|info|debug`
+    host_app_reset();
+    mock_sim_enable();
+    auto wall0 = std::chrono::steady_clock::now();
+    for (int i = 1; i < argc; i++) {
+        if (!run_file(argv[i])) return 2;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    double sim = mock_clock_now_us() / 1e6;
+    const MockSimStats & st = mock_sim_stats();
+    printf("simulated %.3f s in %.3f s wall (%.0fx) | task switches %" PRIu64 ", timers %" PRIu64 ", matter work %" PRIu64
+           ", delayed posts %" PRIu64 " | %s\n",
+           sim, wall, wall > 0 ? sim / wall : 0.0, st.task_switches, st.timers_fired, st.work_items, st.timed_posts,
+           s_failures ? "FAILED" : "ok");
+    mock_sim_shutdown();
+    return s_failures ? 1 : 0;
+}
@@ -1,5 +1,5 @@
 /*
- * Project configuration for the Smart Light Switch (up to 4 gangs) with DHT22 sensor.
+ * Project configuration for the Smart Light Switch (1-16 gangs) with DHT22 sensor.
  * Adjust GPIO pins to match your custom hardware.
  */
 
@@ -7,7 +7,7 @@
 
 #include "driver/gpio.h"
 
-// Number of light channels (1..4)
+// Number of light channels (1..16). Channels 4+ need BUTTON_GPIO_n / LED_GPIO_n below.
 #ifndef LIGHT_CHANNELS
 #define LIGHT_CHANNELS 4
 #endif
@@ -52,6 +52,81 @@
 #define BUTTON_GPIO_3 GPIO_NUM_17
 #endif
 
+// Gangs 4..15 are unconnected unless overridden (a channel without a button pin never presses,
+// one without an LED pin skips the indicator). See main/lights/channels.h.
+#ifndef LED_GPIO_4
+#define LED_GPIO_4 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_4
+#define BUTTON_GPIO_4 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_5
+#define LED_GPIO_5 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_5
+#define BUTTON_GPIO_5 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_6
+#define LED_GPIO_6 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_6
+#define BUTTON_GPIO_6 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_7
+#define LED_GPIO_7 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_7
+#define BUTTON_GPIO_7 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_8
+#define LED_GPIO_8 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_8
+#define BUTTON_GPIO_8 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_9
+#define LED_GPIO_9 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_9
+#define BUTTON_GPIO_9 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_10
+#define LED_GPIO_10 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_10
+#define BUTTON_GPIO_10 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_11
+#define LED_GPIO_11 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_11
+#define BUTTON_GPIO_11 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_12
+#define LED_GPIO_12 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_12
+#define BUTTON_GPIO_12 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_13
+#define LED_GPIO_13 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_13
+#define BUTTON_GPIO_13 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_14
+#define LED_GPIO_14 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_14
+#define BUTTON_GPIO_14 GPIO_NUM_NC
+#endif
+#ifndef LED_GPIO_15
+#define LED_GPIO_15 GPIO_NUM_NC
+#endif
+#ifndef BUTTON_GPIO_15
+#define BUTTON_GPIO_15 GPIO_NUM_NC
+#endif
+
 // DHT22 (AM2302) data pin
 #ifndef DHT22_GPIO
 #define DHT22_GPIO GPIO_NUM_16
@@ -180,9 +255,428 @@
 #define BUTTON_POLL_MS    20
 #define BUTTON_STABLE_CNT 3   // 3*20ms = ~60ms debounce
 
+// Where the buttons are read from. With an expander, channel i is expander input i and the
+// BUTTON_GPIO_n pins are ignored (LEDs stay on LED_GPIO_n). See main/lights/io_expander.h.
+#define BUTTON_IO_GPIO     0 // direct GPIO inputs (default)
+#define BUTTON_IO_MCP23017 1 // MCP23017 16-bit I2C expander
+#define BUTTON_IO_74HC165  2 // 74HC165 shift-register chain on SPI
+#ifndef BUTTON_IO
+#define BUTTON_IO BUTTON_IO_GPIO
+#endif
+
+// MCP23017 bus and address (A2..A0 strapped low = 0x20). The INT default reuses BUTTON_GPIO_0's pin.
+#ifndef IOX_I2C_PORT
+#define IOX_I2C_PORT I2C_NUM_0
+#endif
+#ifndef IOX_I2C_SDA_GPIO
+#define IOX_I2C_SDA_GPIO GPIO_NUM_22
+#endif
+#ifndef IOX_I2C_SCL_GPIO
+#define IOX_I2C_SCL_GPIO GPIO_NUM_23
+#endif
+#ifndef IOX_I2C_ADDR
+#define IOX_I2C_ADDR 0x20
+#endif
+#ifndef IOX_I2C_HZ
+#define IOX_I2C_HZ 400000
+#endif
+
+// 74HC165 chain: clock, serial out of the last register, and the shared parallel-load (SH/LD) line.
+// The defaults reuse the direct button pins, which are free when the buttons sit on the chain.
+#ifndef IOX_SPI_HOST
+#define IOX_SPI_HOST SPI2_HOST
+#endif
+#ifndef IOX_SPI_SCLK_GPIO
+#define IOX_SPI_SCLK_GPIO GPIO_NUM_20
+#endif
+#ifndef IOX_SPI_MISO_GPIO
+#define IOX_SPI_MISO_GPIO GPIO_NUM_21
+#endif
+#ifndef IOX_SR_LOAD_GPIO
+#define IOX_SR_LOAD_GPIO GPIO_NUM_17
+#endif
+#ifndef IOX_SPI_HZ
+#define IOX_SPI_HZ 1000000
+#endif
+
+// Expander interrupt line (active low, open drain). GPIO_NUM_NC polls every BUTTON_POLL_MS instead.
+// The 74HC165 has no interrupt output; wire a diode-OR of the inputs here to avoid polling it.
+#ifndef IOX_INT_GPIO
+#if BUTTON_IO == BUTTON_IO_MCP23017
+#define IOX_INT_GPIO GPIO_NUM_1
+#else
+#define IOX_INT_GPIO GPIO_NUM_NC
+#endif
+#endif
+
+// Timeout for one expander bus transaction (ms).
+#ifndef IOX_BUS_TIMEOUT_MS
+#define IOX_BUS_TIMEOUT_MS 10
+#endif
+
+// Interrupt-driven scanning: with no button held, rescan at least this often even without an edge,
+// so a lost interrupt cannot leave the panel dead.
+#ifndef IOX_IDLE_RESCAN_MS
+#define IOX_IDLE_RESCAN_MS 1000
+#endif
+
+// Indicator LED driver. LEDC gives dimming, hardware fades and hardware blink patterns (see
+// main/lights/led_engine.h); LEDs beyond the LEDC channel count fall back to plain GPIO.
+#define LED_DRIVER_GPIO 0
+#define LED_DRIVER_LEDC 1
+#ifndef LED_DRIVER
+#define LED_DRIVER LED_DRIVER_LEDC
+#endif
+// Steady "on" brightness of the indicator LEDs (percent, LEDC only).
+#ifndef LED_BRIGHTNESS_PCT
+#define LED_BRIGHTNESS_PCT 100
+#endif
+#if LED_BRIGHTNESS_PCT < 1 || LED_BRIGHTNESS_PCT > 100
+#error "LED_BRIGHTNESS_PCT must be 1..100"
+#endif
+// PWM carrier for the steady level (Hz).
+#ifndef LED_PWM_HZ
+#define LED_PWM_HZ 4000
+#endif
+// Press acknowledgement: hardware fade to the new level (ms, 0 = switch instantly).
+#ifndef LED_ACK_FADE_MS
+#define LED_ACK_FADE_MS 120
+#endif
+// Blink rates (Hz, 50% duty) of the Pending, Error and Identify patterns.
+#ifndef LED_PENDING_HZ
+#define LED_PENDING_HZ 2
+#endif
+#ifndef LED_ERROR_HZ
+#define LED_ERROR_HZ 6
+#endif
+#ifndef LED_IDENTIFY_HZ
+#define LED_IDENTIFY_HZ 1
+#endif
+// How long an Identify TriggerEffect (blink / breathe / okay / channel change) blinks (ms).
+#ifndef LED_IDENTIFY_EFFECT_MS
+#define LED_IDENTIFY_EFFECT_MS 3000
+#endif
+
+// OnOff jobs waiting for the Matter thread (light_manager.cpp). All-off posts one per channel at once and
+// the rules engine posts from its own task; a job finding every slot taken is refused, never overwritten.
+#ifndef LIGHT_TOGGLE_JOBS
+#define LIGHT_TOGGLE_JOBS (2 * LIGHT_CHANNELS)
+#endif
+
+// Press transactions (main/lights/press_txn.h): presses whose target responses are still being
+// tracked, and how long to wait for all of them before rolling the LED back / flagging an error.
+#ifndef LIGHT_PRESS_TXN_MAX
+#define LIGHT_PRESS_TXN_MAX 8
+#endif
+#ifndef LIGHT_PRESS_TXN_TIMEOUT_MS
+#define LIGHT_PRESS_TXN_TIMEOUT_MS 3000
+#endif
+
+// Target health (main/lights/target_health.h, `matter health`): after LIGHT_BREAKER_FAILS consecutive
+// failures a bound light is skipped by presses and sync reads, and probed again after a backoff that
+// doubles from LIGHT_BREAKER_BACKOFF_MIN_MS to _MAX_MS. LIGHT_HEALTH_TARGETS targets are tracked, by
+// default one per unicast binding slot so the fan-out knows every bound target's RTT (~64 B each).
+#ifndef LIGHT_HEALTH_TARGETS
+#define LIGHT_HEALTH_TARGETS (LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH)
+#endif
+#ifndef LIGHT_BREAKER_FAILS
+#define LIGHT_BREAKER_FAILS 3
+#endif
+#ifndef LIGHT_BREAKER_BACKOFF_MIN_MS
+#define LIGHT_BREAKER_BACKOFF_MIN_MS 20000
+#endif
+#ifndef LIGHT_BREAKER_BACKOFF_MAX_MS
+#define LIGHT_BREAKER_BACKOFF_MAX_MS 600000
+#endif
+
+// Press fan-out (main/lights/fanout.h): a press's unicast commands go out slowest target first, at
+// most LIGHT_FANOUT_MAX_INFLIGHT exchanges at a time and LIGHT_FANOUT_MAX_CASE of them to targets
+// still needing a CASE session. LIGHT_FANOUT_QUEUE commands can wait. 0 = the binding manager sends.
+#ifndef LIGHT_FANOUT_ENABLE
+#define LIGHT_FANOUT_ENABLE 1
+#endif
+#ifndef LIGHT_FANOUT_MAX_INFLIGHT
+#define LIGHT_FANOUT_MAX_INFLIGHT 4
+#endif
+#ifndef LIGHT_FANOUT_MAX_CASE
+#define LIGHT_FANOUT_MAX_CASE 2
+#endif
+#ifndef LIGHT_FANOUT_QUEUE
+#define LIGHT_FANOUT_QUEUE (2 * MAX_SHADOW_BINDINGS_PER_CH)
+#endif
+
+// Press coalescing (main/lights/press_coalesce.h): presses within one batch window become one net
+// Toggle. The window follows the recent press response time, clamped to MIN..MAX (MAX 0 = off).
+#ifndef LIGHT_PRESS_COALESCE_MIN_MS
+#define LIGHT_PRESS_COALESCE_MIN_MS 300
+#endif
+#ifndef LIGHT_PRESS_COALESCE_MAX_MS
+#define LIGHT_PRESS_COALESCE_MAX_MS 1000
+#endif
+#if LIGHT_PRESS_COALESCE_MIN_MS > LIGHT_PRESS_COALESCE_MAX_MS && LIGHT_PRESS_COALESCE_MAX_MS != 0
+#error "LIGHT_PRESS_COALESCE_MIN_MS must not exceed LIGHT_PRESS_COALESCE_MAX_MS"
+#endif
+
+// Button gestures (main/lights/gesture.h). A single press always toggles, dispatched at the press.
+// Double / triple / long press run one of the GESTURE_ACTION_* actions, which supersede the single
+// press. NONE leaves the gesture off (no release tracking at all when every gesture is NONE and
+// LIGHT_SWITCH_EVENTS is 0).
+#define GESTURE_ACTION_NONE    0
+#define GESTURE_ACTION_ALL_OFF 1 // Off to every channel's bindings
+#define GESTURE_ACTION_SCENE   2
+#define GESTURE_ACTION_DIM     3
+#ifndef LIGHT_GESTURE_DOUBLE
+#define LIGHT_GESTURE_DOUBLE GESTURE_ACTION_NONE
+#endif
+#ifndef LIGHT_GESTURE_TRIPLE
+#define LIGHT_GESTURE_TRIPLE GESTURE_ACTION_NONE
+#endif
+#ifndef LIGHT_GESTURE_LONG
+#define LIGHT_GESTURE_LONG GESTURE_ACTION_NONE
+#endif
+// Longest release -> next press gap within a multi-press, and the hold time of a long press (ms).
+#ifndef LIGHT_GESTURE_GAP_MS
+#define LIGHT_GESTURE_GAP_MS 350
+#endif
+#ifndef LIGHT_GESTURE_LONG_MS
+#define LIGHT_GESTURE_LONG_MS 600
+#endif
+// Hold-to-dim (GESTURE_ACTION_DIM): LevelControl MoveWithOnOff rate in level units per second (1..254 is
+// the full range), and whether a channel with a LevelControl group binding dims through the group only.
+#ifndef LIGHT_DIM_RATE
+#define LIGHT_DIM_RATE 80
+#endif
+#ifndef LIGHT_DIM_PREFER_GROUP
+#define LIGHT_DIM_PREFER_GROUP 1
+#endif
+// A level Stop that could not be queued or sent is retried every LIGHT_DIM_STOP_RETRY_MS, at most
+// LIGHT_DIM_STOP_RETRIES times (`level.stop_retries`); a lost Stop leaves the lights ramping.
+#ifndef LIGHT_DIM_STOP_RETRY_MS
+#define LIGHT_DIM_STOP_RETRY_MS 100
+#endif
+#ifndef LIGHT_DIM_STOP_RETRIES
+#define LIGHT_DIM_STOP_RETRIES 5
+#endif
+
+// Generic Switch (0x003B) server on every channel endpoint: the buttons also appear as momentary
+// switches emitting InitialPress / ShortRelease / LongPress / LongRelease / MultiPressOngoing /
+// MultiPressComplete events (0 = client-only endpoints). Long press and multi-press timing follow
+// LIGHT_GESTURE_LONG_MS / LIGHT_GESTURE_GAP_MS; LIGHT_SWITCH_MULTI_PRESS_MAX is 2 or 3.
+#ifndef LIGHT_SWITCH_EVENTS
+#define LIGHT_SWITCH_EVENTS 1
+#endif
+#ifndef LIGHT_SWITCH_MULTI_PRESS_MAX
+#define LIGHT_SWITCH_MULTI_PRESS_MAX 2
+#endif
+#if LIGHT_SWITCH_MULTI_PRESS_MAX < 2 || LIGHT_SWITCH_MULTI_PRESS_MAX > 3
+#error "LIGHT_SWITCH_MULTI_PRESS_MAX must be 2 or 3"
+#endif
+// Switch events share the Info-priority event buffer (CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE). A press
+// logs about three events of roughly SWITCH_EVENT_BYTES each; once the buffer is full every new event
+// evicts the oldest. An evicted event younger than SWITCH_EVENT_RETENTION_WARN_S seconds is logged
+// as a warning: a subscriber offline that long would miss presses.
+#ifndef SWITCH_EVENT_BUFFER_BYTES
+#ifdef CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE
+#define SWITCH_EVENT_BUFFER_BYTES CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE
+#else
+#define SWITCH_EVENT_BUFFER_BYTES 1024
+#endif
+#endif
+#ifndef SWITCH_EVENT_BYTES
+#define SWITCH_EVENT_BYTES 48
+#endif
+#ifndef SWITCH_EVENT_RETENTION_WARN_S
+#define SWITCH_EVENT_RETENTION_WARN_S 60
+#endif
+
+// Scenes (main/lights/scene.h, GESTURE_ACTION_SCENE, `matter scene`): SCENE_COUNT scenes in NVS, each
+// setting on/off, level and colour temperature on up to SCENE_MAX_ACTIONS targets (nodes or groups).
+// The scene gesture of channel ch runs scene ch % SCENE_COUNT. A run that still misses responses
+// after SCENE_TIMEOUT_MS ends with those commands failed. SCENE_TRANSITION_DS is the level / colour
+// temperature transition time (tenths of a second).
+#ifndef SCENE_COUNT
+#define SCENE_COUNT 4
+#endif
+#ifndef SCENE_MAX_ACTIONS
+#define SCENE_MAX_ACTIONS 12
+#endif
+#ifndef SCENE_TIMEOUT_MS
+#define SCENE_TIMEOUT_MS 3000
+#endif
+#ifndef SCENE_TRANSITION_DS
+#define SCENE_TRANSITION_DS 0
+#endif
+
+// Sensor rules (main/temp/rules.h, `matter rule`): up to RULES_MAX threshold rules on the DHT22
+// temperature / humidity, each sending On or Off to a channel's bindings. Kept in NVS.
+#ifndef RULES_MAX
+#define RULES_MAX 8
+#endif
+
+// Offline command queue (main/lights/offline_queue.h): presses made while the link is down are held
+// as each channel's final state and replayed when it comes back. Held presses older than
+// OFFLINE_QUEUE_MAX_AGE_S are dropped; the queue is journalled to NVS OFFLINE_JOURNAL_DELAY_MS
+// after its last change so a reboot does not lose it.
+#ifndef OFFLINE_QUEUE_ENABLE
+#define OFFLINE_QUEUE_ENABLE 1
+#endif
+#ifndef OFFLINE_QUEUE_MAX_AGE_S
+#define OFFLINE_QUEUE_MAX_AGE_S 900
+#endif
+#ifndef OFFLINE_JOURNAL_DELAY_MS
+#define OFFLINE_JOURNAL_DELAY_MS 2000
+#endif
+
 // Periodic LED state resync interval (ms). The initial implementation performed
 // a single sync ~10s after boot; now we repeat every 10s until proper
 // subscription-based tracking is implemented. Guarded for override.
 #ifndef LED_PERIODIC_SYNC_MS
 #define LED_PERIODIC_SYNC_MS 10000
 #endif
+// Attribute paths per LED sync read request (main/lights/sync_batch.h): a node's bound endpoints
+// are read in one request, split beyond this. Matter servers accept at least 9 paths per read.
+#ifndef LIGHT_SYNC_MAX_PATHS
+#define LIGHT_SYNC_MAX_PATHS 9
+#endif
+// Sync read requests in flight (main/lights/sync_reads.h); more wait for a free slot. A request not
+// answered within LIGHT_SYNC_READ_TIMEOUT_MS (session setup included) counts as failed.
+#ifndef LIGHT_SYNC_MAX_READS
+#define LIGHT_SYNC_MAX_READS 8
+#endif
+#ifndef LIGHT_SYNC_READ_TIMEOUT_MS
+#define LIGHT_SYNC_READ_TIMEOUT_MS 8000
+#endif
+// Coroutine frames of the Matter transports (main/lights/frame_pool.h): one per fan-out send and sync
+// read in flight (a timed-out read keeps its sync slot until its frame ends), plus one per transport
+// for the frame finishing while its successor starts. A frame above LIGHT_CORO_FRAME_BYTES fails its
+// operation (`coro.frames_oversize`, logged as an error); `coro.frame_bytes_max` is the largest frame
+// asked for. The default block is not yet measured against an SDK build: set it from that gauge.
+// Static RAM: LIGHT_CORO_FRAMES * LIGHT_CORO_FRAME_BYTES.
+#ifndef LIGHT_CORO_FRAMES
+#define LIGHT_CORO_FRAMES (LIGHT_FANOUT_MAX_INFLIGHT + LIGHT_SYNC_MAX_READS + 2)
+#endif
+#ifndef LIGHT_CORO_FRAME_BYTES
+#define LIGHT_CORO_FRAME_BYTES 1024
+#endif
+
+// ---- Runtime metrics (main/diag/metrics.*) ----
+// Registry capacity; metrics declared beyond this are not reported (warning at boot).
+#ifndef METRICS_MAX_COUNT
+#define METRICS_MAX_COUNT 160
+#endif
+// Maximum bucket bounds per histogram (one extra overflow bucket is always added).
+#ifndef METRICS_HIST_MAX_BUCKETS
+#define METRICS_HIST_MAX_BUCKETS 10
+#endif
+// Period of the "changed metrics" log line (replaces the old 30s ReqCB counter log). 0 disables.
+#ifndef METRICS_LOG_PERIOD_MS
+#define METRICS_LOG_PERIOD_MS 30000
+#endif
+// Vendor-specific diagnostics cluster on endpoint 0 (test vendor prefix 0xFFF1, MS cluster range).
+#ifndef METRICS_DIAG_CLUSTER_ID
+#define METRICS_DIAG_CLUSTER_ID 0xFFF1FC01
+#endif
+// Refresh interval for diagnostics cluster attributes. 0 disables the cluster refresh.
+#ifndef METRICS_DIAG_PERIOD_MS
+#define METRICS_DIAG_PERIOD_MS 60000
+#endif
+
+// ---- Task stack budgets (bytes) ----
+// Sized from `matter resmon` budget reports; shrink only with a report from a
+// representative soak (commissioning + binding sync + sensor reads) in hand.
+#ifndef BTN_POLL_TASK_STACK
+#define BTN_POLL_TASK_STACK 2048
+#endif
+#ifndef BTN_ACT_TASK_STACK
+#define BTN_ACT_TASK_STACK 3072
+#endif
+#ifndef TEMP_TASK_STACK
+#define TEMP_TASK_STACK 4096
+#endif
+// Also runs the deferred relay/reed-switch GPIO init before it starts polling.
+#ifndef GARAGE_SENSOR_TASK_STACK
+#define GARAGE_SENSOR_TASK_STACK 4096
+#endif
+// Relay pulse worker (one persistent task, woken per pulse).
+#ifndef GARAGE_RELAY_TASK_STACK
+#define GARAGE_RELAY_TASK_STACK 2048
+#endif
+
+// ---- Static RTOS objects (main/rtos_static.*) ----
+// main/lock is not in SRC_DIRS; set to 1 together with adding it so its tasks get static storage.
+#ifndef GARAGE_DOOR_ENABLE
+#define GARAGE_DOOR_ENABLE 0
+#endif
+// Depth of the debounced-press queue between btn_poll and btn_act.
+#ifndef BTN_EVT_QUEUE_LEN
+#define BTN_EVT_QUEUE_LEN 8
+#endif
+// Compile-time ceiling for all static stacks, TCBs and queue storage (see `matter resmon map`).
+#ifndef RTOS_STATIC_BUDGET_BYTES
+#define RTOS_STATIC_BUDGET_BYTES (24 * 1024)
+#endif
+
+// ---- Resource monitor (main/diag/resource_monitor.*) ----
+#ifndef RESMON_PERIOD_MS
+#define RESMON_PERIOD_MS 10000
+#endif
+#ifndef RESMON_MAX_TASKS
+#define RESMON_MAX_TASKS 16
+#endif
+// Warn when a task's minimum-ever free stack drops below this many bytes.
+#ifndef RESMON_STACK_WARN_BYTES
+#define RESMON_STACK_WARN_BYTES 256
+#endif
+// Warn when the internal heap minimum-ever free size drops below this.
+#ifndef RESMON_HEAP_WARN_BYTES
+#define RESMON_HEAP_WARN_BYTES (16 * 1024)
+#endif
+// Warn when the largest free internal block drops below this (fragmentation).
+#ifndef RESMON_LARGEST_BLOCK_WARN_BYTES
+#define RESMON_LARGEST_BLOCK_WARN_BYTES (4 * 1024)
+#endif
+// Headroom kept above the measured peak when suggesting a stack size in the budget report.
+#ifndef RESMON_STACK_MARGIN_BYTES
+#define RESMON_STACK_MARGIN_BYTES 512
+#endif
+
+// ---- Matter work-queue probe (main/diag/work_probe.*) ----
+// Concurrent tracked jobs; beyond this jobs are scheduled untracked (counted in wq.untracked).
+#ifndef WORK_PROBE_SLOTS
+#define WORK_PROBE_SLOTS 16
+#endif
+// A single job running longer than this on the Matter thread logs a warning (per source, rate limited).
+#ifndef WORK_PROBE_EXEC_BUDGET_US
+#define WORK_PROBE_EXEC_BUDGET_US 20000
+#endif
+
+// ---- On-device toggle benchmark (main/diag/bench.*, `matter bench`) ----
+// Upper bound on toggles per run; sample buffers are heap-allocated for the run only.
+#ifndef BENCH_MAX_COUNT
+#define BENCH_MAX_COUNT 500
+#endif
+#ifndef BENCH_MIN_INTERVAL_MS
+#define BENCH_MIN_INTERVAL_MS 20
+#endif
+// Time allowed for outstanding responses after the last toggle before the report is printed.
+#ifndef BENCH_SETTLE_MS
+#define BENCH_SETTLE_MS 5000
+#endif
+
+// ---- Trace-event recorder (main/diag/trace.*, `matter trace`) ----
+// 0 compiles every TRACE_* macro out.
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+// Ring capacity in events (16 bytes each, heap-allocated on first `trace start`).
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 1024
+#endif
+// Distinct tasks named in a dump; later tasks are folded into tid 0.
+#ifndef TRACE_MAX_THREADS
+#define TRACE_MAX_THREADS 24
+#endif
+// 1 = start recording in app_main() to capture boot, commissioning and the first binding commit.
+#ifndef TRACE_AUTOSTART
+#define TRACE_AUTOSTART 0
+#endif
@@ -24,6 +24,8 @@ static const char *TAG = "app_main"; // log tag
 #include <esp_matter_client.h>
 // CHIP cluster ids & command ids
 #include <app-common/zap-generated/cluster-objects.h>
+#include <app/InteractionModelEngine.h>
+#include <controller/InvokeInteraction.h>
 // TLV utilities (header name differs across versions: prefer TLV.h)
 #include <lib/core/TLV.h>
 // For direct BindingTable enumeration (controller shadow import). Header name is app/util/binding-table.h
@@ -33,6 +35,15 @@ static const char *TAG = "app_main"; // log tag
 #include <app_priv.h>
 #include "app_config.h"
 #include "lights/light_manager.h"
+#include "lights/light_internal.h"
+#include "lights/shadow_binding.h"
+#include "lights/scene_engine.h"
+#include "temp/rules.h"
+#include "diag/metrics.h"
+#include "diag/resource_monitor.h"
+#include "diag/work_probe.h"
+#include "diag/bench.h"
+#include "diag/trace.h"
 #if CHIP_DEVICE_CONFIG_ENABLE_THREAD
 #include <platform/ESP32/OpenthreadLauncher.h>
 #endif
@@ -52,9 +63,20 @@ static esp_pm_lock_handle_t s_pm_no_ls_lock = nullptr;
 #endif
 // Endpoint IDs for our new device
 extern uint16_t g_onoff_endpoint_ids[LIGHT_CHANNELS];
-// Instrumentation counters for request callbacks
-volatile uint32_t g_reqcb_unicast_count = 0;
-volatile uint32_t g_reqcb_group_count = 0;
+// Binding / request-callback metrics (snapshot via `matter metrics binding.`)
+static metrics::Counter s_m_reqcb_unicast("binding.reqcb_unicast");
+static metrics::Counter s_m_reqcb_group("binding.reqcb_group");
+static metrics::Counter s_m_reqcb_level_skipped("binding.reqcb_level_skipped");
+static metrics::Counter s_m_reqcb_breaker_skipped("binding.reqcb_breaker_skipped");
+static metrics::Counter s_m_group_send_fail("binding.group_send_fail");
+static metrics::Counter s_m_toggle_resp_ok("binding.toggle_resp_ok");
+static metrics::Counter s_m_toggle_resp_err("binding.toggle_resp_err");
+static metrics::Counter s_m_toggle_send_fail("binding.toggle_send_fail");
+static metrics::Counter s_m_refreshes("binding.refreshes");
+static metrics::Counter s_m_commits("binding.commits");
+static metrics::Counter s_m_nvs_save_fail("binding.nvs_save_fail");
+static metrics::Gauge s_m_unicast_entries("binding.unicast_entries");
+static metrics::Gauge s_m_group_entries("binding.group_entries");
 extern uint16_t g_temp_endpoint_id;
 extern uint16_t g_humidity_endpoint_id;
 
@@ -83,6 +105,7 @@ static esp_err_t shadow_binding_commit_impl(int ch) {
     if (ch < 0 || ch >= LIGHT_CHANNELS) return ESP_ERR_INVALID_ARG;
     uint16_t ep = g_onoff_endpoint_ids[ch];
     ESP_LOGI(TAG, "Committing shadow bindings (Option C external writes) -> ep %u entries=%d", ep, s_shadow_lists[ch].count);
+    s_m_commits.inc();
     shadow_binding_log(ch);
     shadow_binding_save_nvs(ch);
     return ESP_OK;
@@ -98,7 +121,7 @@ static void perform_deferred_binding_init();
 static void deferred_commit_timer_cb(void *arg) {
     if (s_shadow_bindings_committed) return;
     ESP_LOGI(TAG, "Deferred commit timer fired: scheduling binding manager init & LED sync on Matter thread");
-    chip::DeviceLayer::PlatformMgr().ScheduleWork(+[](intptr_t){ perform_deferred_binding_init(); });
+    work_probe_schedule(WorkSource::BindingRefresh, +[](intptr_t){ perform_deferred_binding_init(); });
 }
 
 static void schedule_binding_commit_timer(const char * reason) {
@@ -120,6 +143,7 @@ static void schedule_binding_commit_timer(const char * reason) {
 
 static void perform_deferred_binding_init() {
     if (s_shadow_bindings_committed) return;
+    TRACE_SCOPE("binding.commit");
     uint64_t now = esp_timer_get_time();
     ESP_LOGI(TAG, "Initializing binding manager & committing shadow bindings now (t=%llu ms since boot)", (unsigned long long)(now/1000));
     esp_matter::client::binding_manager_init();
@@ -129,6 +153,8 @@ static void perform_deferred_binding_init() {
         if (s_shadow_lists[ch].count > 0) shadow_binding_commit(ch);
     }
     light_manager_sync_initial_state();
+    // Open the sessions stored scenes use now, so the first scene press does not wait on CASE.
+    scene_engine_prewarm();
     // Schedule periodic LED state re-sync while we do not yet have a subscription-based
     // remote state tracker. This is lightweight (issues unicast reads similar to the
     // boot-time sync). Design: one esp_timer periodic callback that schedules the work
@@ -138,18 +164,19 @@ static void perform_deferred_binding_init() {
     if (!s_led_periodic_sync_timer) {
         esp_timer_create_args_t args = {
             .callback = [](void*){
-                chip::DeviceLayer::PlatformMgr().ScheduleWork(+[](intptr_t){
+                work_probe_schedule(WorkSource::LedSync, +[](intptr_t){
                     // Re-enumerate live BindingTable to keep shadow lists in sync with any changes
                     shadow_binding_refresh_from_table();
                     // Optional debug: summarize counts so intermittent 'no bindings' can be diagnosed
                     bool anyEmpty = false;
                     for (int ch=0; ch<LIGHT_CHANNELS; ++ch) { if (s_shadow_lists[ch].count == 0) anyEmpty = true; }
                     if (anyEmpty) {
-                        ESP_LOGD(TAG, "Periodic sync: channel binding counts: %d %d %d %d", 
-                                 (LIGHT_CHANNELS>0)?s_shadow_lists[0].count:0,
-                                 (LIGHT_CHANNELS>1)?s_shadow_lists[1].count:0,
-                                 (LIGHT_CHANNELS>2)?s_shadow_lists[2].count:0,
-                                 (LIGHT_CHANNELS>3)?s_shadow_lists[3].count:0);
+                        char counts[LIGHT_CHANNELS * 4 + 1];
+                        int len = 0;
+                        for (int ch = 0; ch < LIGHT_CHANNELS; ++ch) {
+                            len += snprintf(counts + len, sizeof(counts) - len, " %d", s_shadow_lists[ch].count);
+                        }
+                        ESP_LOGD(TAG, "Periodic sync: channel binding counts:%s", counts);
                     }
                     light_manager_sync_initial_state();
                 });
@@ -179,6 +206,7 @@ static const char *k_bind_nvs_namespace = "bindcfg";
 
 static esp_err_t shadow_binding_save_nvs(int ch) {
     if (ch < 0 || ch >= LIGHT_CHANNELS) return ESP_ERR_INVALID_ARG;
+    TRACE_SCOPE("nvs.save");
     nvs_handle_t h;
     esp_err_t err = nvs_open(k_bind_nvs_namespace, NVS_READWRITE, &h);
     if (err != ESP_OK) return err;
@@ -190,6 +218,7 @@ static esp_err_t shadow_binding_save_nvs(int ch) {
     if (err == ESP_OK) {
         ESP_LOGI(TAG, "Saved shadow bindings ch%d to NVS (count=%d)", ch, s_shadow_lists[ch].count);
     } else {
+        s_m_nvs_save_fail.inc();
         ESP_LOGE(TAG, "Failed saving shadow bindings ch%d err=%d", ch, (int)err);
     }
     return err;
@@ -240,50 +269,97 @@ static void shadow_binding_log(int ch) {
 
 // Enumerate CHIP BindingTable and rebuild per-channel shadow lists.
 static void shadow_binding_refresh_from_table() {
+    TRACE_SCOPE("binding.refresh");
     // Reset counts
     for (int ch=0; ch<LIGHT_CHANNELS; ++ch) { s_shadow_lists[ch].count = 0; }
     auto & table = chip::BindingTable::GetInstance();
     ESP_LOGI(TAG, "Enumerating BindingTable (size=%u)", (unsigned)table.Size());
-    // Simple per-channel de-dup (node,ep,cluster) to avoid duplicate scheduling later.
-    struct Key { uint64_t node; uint16_t ep; uint32_t cluster; bool operator==(const Key &o) const { return node==o.node && ep==o.ep && cluster==o.cluster; } };
+    // Per-channel de-dup (node,ep,cluster) and capacity handled by shadow_binding_import().
     for (auto iter = table.begin(); iter != table.end(); ++iter) {
         const EmberBindingTableEntry & e = *iter;
         if (!e.type) continue; // empty slot
-        chip::EndpointId localEp = e.local;
-        int chIndex = -1;
-        for (int ch=0; ch<LIGHT_CHANNELS; ++ch) { if (g_onoff_endpoint_ids[ch] == localEp) { chIndex = ch; break; } }
-        if (chIndex < 0) continue; // not our on/off endpoints
-        constexpr uint8_t kMulticast = MATTER_MULTICAST_BINDING;
-        constexpr uint8_t kUnicast   = MATTER_UNICAST_BINDING;
-        uint32_t cluster_id = e.clusterId.has_value() ? static_cast<uint32_t>(*e.clusterId) : 0;
-        if (e.type == kUnicast) {
-            uint64_t node_id = e.nodeId; // verify looks like an operational node id (random > small fabric indexes)
-            if (node_id <= 0xFFFFULL) {
-                ESP_LOGW(TAG, "Binding entry with suspicious small node id=0x%" PRIX64 " (raw). Will still add.", node_id);
+        ShadowBindingSource src = {};
+        src.kind = e.type == MATTER_UNICAST_BINDING ? SHADOW_SRC_UNICAST : e.type == MATTER_MULTICAST_BINDING ? SHADOW_SRC_GROUP : SHADOW_SRC_OTHER;
+        src.local_ep = e.local;
+        src.cluster_id = e.clusterId.has_value() ? static_cast<uint32_t>(*e.clusterId) : 0;
+        src.fabric_index = e.fabricIndex;
+        if (src.kind == SHADOW_SRC_UNICAST) {
+            src.node_id = e.nodeId; src.remote_ep = e.remote;
+            if (src.node_id <= 0xFFFFULL) { // verify looks like an operational node id (random > small fabric indexes)
+                ESP_LOGW(TAG, "Binding entry with suspicious small node id=0x%" PRIX64 " (raw). Will still add.", src.node_id);
             }
-            // De-dup check
-            bool dup=false; for (int i=0;i<s_shadow_lists[chIndex].count;i++){ auto &sb = s_shadow_lists[chIndex].entries[i]; if(!sb.is_group && sb.node_id==node_id && sb.endpoint==e.remote && sb.cluster_id==cluster_id){ dup=true; break; } }
-            if (dup) { ESP_LOGI(TAG, "Skip duplicate unicast binding ch%u node=0x%016" PRIX64 " ep=%u cl=0x%04X", chIndex, (uint64_t)node_id, (unsigned)e.remote, (unsigned)cluster_id); continue; }
-            if (s_shadow_lists[chIndex].count >= MAX_SHADOW_BINDINGS_PER_CH) { ESP_LOGW(TAG, "Shadow list full ch%u (max=%d)", chIndex, MAX_SHADOW_BINDINGS_PER_CH); continue; }
-            auto & dst = s_shadow_lists[chIndex].entries[s_shadow_lists[chIndex].count++];
-            dst.is_group=false; dst.node_id=node_id; dst.endpoint=e.remote; dst.cluster_id=cluster_id; dst.group_id=0; dst.fabric_index = e.fabricIndex;
-            ESP_LOGI(TAG, "Added UNICAST ch%u node=0x%016" PRIX64 " ep=%u cl=0x%04X", chIndex, (uint64_t)node_id, (unsigned)e.remote, (unsigned)cluster_id);
-        } else if (e.type == kMulticast) {
-            if (s_shadow_lists[chIndex].count >= MAX_SHADOW_BINDINGS_PER_CH) { ESP_LOGW(TAG, "Shadow list full ch%u (max=%d)", chIndex, MAX_SHADOW_BINDINGS_PER_CH); continue; }
-            auto & dst = s_shadow_lists[chIndex].entries[s_shadow_lists[chIndex].count++];
-            dst.is_group=true; dst.group_id = e.groupId; dst.cluster_id=cluster_id; dst.node_id=0; dst.endpoint=0; dst.fabric_index=e.fabricIndex;
-            ESP_LOGI(TAG, "Added GROUP ch%u group=0x%04X cl=0x%04X", chIndex, (unsigned)e.groupId, (unsigned)cluster_id);
-        } else {
-            ESP_LOGI(TAG, "Skip unsupported binding type=%u localEp=%u", (unsigned)e.type, (unsigned)localEp);
+        } else if (src.kind == SHADOW_SRC_GROUP) {
+            src.group_id = e.groupId;
         }
+        int chIndex = -1;
+        switch (shadow_binding_import(s_shadow_lists, g_onoff_endpoint_ids, &src, &chIndex)) {
+        case SHADOW_IMPORT_ADDED:
+            if (src.kind == SHADOW_SRC_GROUP) ESP_LOGI(TAG, "Added GROUP ch%u group=0x%04X cl=0x%04X", chIndex, (unsigned)src.group_id, (unsigned)src.cluster_id);
+            else ESP_LOGI(TAG, "Added UNICAST ch%u node=0x%016" PRIX64 " ep=%u cl=0x%04X", chIndex, src.node_id, (unsigned)src.remote_ep, (unsigned)src.cluster_id);
+            break;
+        case SHADOW_IMPORT_DUPLICATE:
+            ESP_LOGI(TAG, "Skip duplicate unicast binding ch%u node=0x%016" PRIX64 " ep=%u cl=0x%04X", chIndex, src.node_id, (unsigned)src.remote_ep, (unsigned)src.cluster_id);
+            break;
+        case SHADOW_IMPORT_FULL:
+            ESP_LOGW(TAG, "Shadow list full ch%u (max=%d)", chIndex, MAX_SHADOW_BINDINGS_PER_CH);
+            break;
+        case SHADOW_IMPORT_UNSUPPORTED:
+            ESP_LOGI(TAG, "Skip unsupported binding type=%u localEp=%u", (unsigned)e.type, (unsigned)src.local_ep);
+            break;
+        case SHADOW_IMPORT_NOT_OURS:
+            break; // not our on/off endpoints
+        }
+    }
+    int unicast = 0, group = 0;
+    for (int ch=0; ch<LIGHT_CHANNELS; ++ch) {
+        for (int i=0; i<s_shadow_lists[ch].count; i++) { if (s_shadow_lists[ch].entries[i].is_group) group++; else unicast++; }
+        if (s_shadow_lists[ch].count > 0) shadow_binding_log(ch);
     }
-    for (int ch=0; ch<LIGHT_CHANNELS; ++ch) { if (s_shadow_lists[ch].count > 0) shadow_binding_log(ch); }
+    s_m_refreshes.inc();
+    s_m_unicast_entries.set(unicast);
+    s_m_group_entries.set(group);
 }
 
 // shadow_binding_add_unicast removed (console commands disabled); add later if interactive add required.
 
 // (Console binding commands removed to simplify build and suppress unused warnings.)
 
+// Commands light_manager sends through the binding manager: presses and gestures (OnOff) and hold-to-dim (LevelControl).
+static bool is_switch_command(chip::ClusterId cluster, chip::CommandId cmd)
+{
+    using namespace chip::app::Clusters;
+    if (cluster == OnOff::Id) return cmd == OnOff::Commands::Toggle::Id || cmd == OnOff::Commands::On::Id || cmd == OnOff::Commands::Off::Id;
+    if (cluster == LevelControl::Id) return cmd == LevelControl::Commands::MoveWithOnOff::Id || cmd == LevelControl::Commands::Stop::Id;
+    return false;
+}
+
+// MoveWithOnOff payload from the LightLevelReq packed into request_data (light_internal.h).
+static chip::app::Clusters::LevelControl::Commands::MoveWithOnOff::Type level_move(const void * request_data)
+{
+    using namespace chip::app::Clusters;
+    LightLevelReq r = light_level_unpack(request_data);
+    LevelControl::Commands::MoveWithOnOff::Type d;
+    d.moveMode = r.mode == kLevelMoveUp ? LevelControl::MoveModeEnum::kUp : LevelControl::MoveModeEnum::kDown;
+    d.rate.SetNonNull(r.rate);
+    return d;
+}
+
+// One groupcast of a switch command. Groupcasts carry no response, so there is nothing to report back.
+static CHIP_ERROR send_group_command(chip::FabricIndex fabric, chip::GroupId group, chip::ClusterId cluster, chip::CommandId cmd,
+                                     const void * request_data)
+{
+    using namespace chip::app::Clusters;
+    chip::Messaging::ExchangeManager * em = chip::app::InteractionModelEngine::GetInstance()->GetExchangeManager();
+    if (cluster == LevelControl::Id) {
+        if (cmd == LevelControl::Commands::MoveWithOnOff::Id)
+            return chip::Controller::InvokeGroupCommandRequest(em, fabric, group, level_move(request_data));
+        return chip::Controller::InvokeGroupCommandRequest(em, fabric, group, LevelControl::Commands::Stop::Type());
+    }
+    if (cmd == OnOff::Commands::On::Id) return chip::Controller::InvokeGroupCommandRequest(em, fabric, group, OnOff::Commands::On::Type());
+    if (cmd == OnOff::Commands::Off::Id) return chip::Controller::InvokeGroupCommandRequest(em, fabric, group, OnOff::Commands::Off::Type());
+    return chip::Controller::InvokeGroupCommandRequest(em, fabric, group, OnOff::Commands::Toggle::Type());
+}
+
 static void init_watchdog_callback(void* arg)
 {
     if (!matter_started) {
@@ -312,11 +388,18 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 {
     // No need to check for contact sensor updates here anymore
     // Updates are now scheduled directly on the Matter thread
-    
+    TRACE_INSTANT("chip.event", event->Type);
+
     switch (event->Type) {
     case chip::DeviceLayer::DeviceEventType::kInterfaceIpAddressChanged:
         ESP_LOGI(TAG, "Interface IP Address changed");
         if (!s_ip_event_seen) { s_ip_event_seen = true; schedule_binding_commit_timer("ip_addr_changed"); }
+        light_manager_connectivity_changed();
+        break;
+
+    case chip::DeviceLayer::DeviceEventType::kWiFiConnectivityChange:
+        ESP_LOGI(TAG, "WiFi connectivity changed");
+        light_manager_connectivity_changed();
         break;
 
     case chip::DeviceLayer::DeviceEventType::kCommissioningComplete:
@@ -416,12 +499,14 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
         
     case chip::DeviceLayer::DeviceEventType::kSecureSessionEstablished:
         ESP_LOGI(TAG, "Secure session established");
+        light_manager_connectivity_changed();
         break;
         
     // Thread/OpenThread events
     case chip::DeviceLayer::DeviceEventType::kThreadConnectivityChange:
         ESP_LOGI(TAG, "Thread connectivity changed");
         if (!s_commit_timer_started) schedule_binding_commit_timer("thread_connectivity");
+        light_manager_connectivity_changed();
         break;
         
     case chip::DeviceLayer::DeviceEventType::kThreadStateChange:
@@ -441,12 +526,31 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
     }
 }
 
+static void identify_effect_done(chip::System::Layer *, void * ctx)
+{
+    light_manager_identify((uint16_t)(uintptr_t)ctx, false);
+}
+
 // This callback is invoked when clients interact with the Identify Cluster.
-// In the callback implementation, an endpoint can identify itself. (e.g., by flashing an LED or light).
+// The endpoint's indicator LED blinks (LEDC Identify pattern) while IdentifyTime runs; a
+// TriggerEffect blinks it for LED_IDENTIFY_EFFECT_MS on a Matter system-layer timer.
 static esp_err_t app_identification_cb(identification::callback_type_t type, uint16_t endpoint_id, uint8_t effect_id,
                                        uint8_t effect_variant, void *priv_data)
 {
     ESP_LOGI(TAG, "Identification callback: type: %u, effect: %u, variant: %u", type, effect_id, effect_variant);
+    using chip::app::Clusters::Identify::EffectIdentifierEnum;
+    void * ctx = (void *)(uintptr_t)endpoint_id;
+    if (type == identification::callback_type_t::START) {
+        light_manager_identify(endpoint_id, true);
+    } else if (type == identification::callback_type_t::STOP) {
+        chip::DeviceLayer::SystemLayer().CancelTimer(identify_effect_done, ctx);
+        light_manager_identify(endpoint_id, false);
+    } else if (type == identification::callback_type_t::EFFECT) {
+        bool stop = effect_id == (uint8_t)EffectIdentifierEnum::kFinishEffect || effect_id == (uint8_t)EffectIdentifierEnum::kStopEffect;
+        light_manager_identify(endpoint_id, !stop);
+        chip::DeviceLayer::SystemLayer().CancelTimer(identify_effect_done, ctx);
+        if (!stop) chip::DeviceLayer::SystemLayer().StartTimer(chip::System::Clock::Milliseconds32(LED_IDENTIFY_EFFECT_MS), identify_effect_done, ctx);
+    }
     return ESP_OK;
 }
 
@@ -475,7 +579,7 @@ static esp_err_t app_attribute_update_cb(attribute::callback_type_t type, uint16
         } else if (type == attribute::POST_UPDATE) {
             ESP_LOGI(TAG, "Binding POST_UPDATE ep=%u (refresh shadow from live table)", endpoint_id);
             // Re-import asynchronously on Matter thread to avoid doing table ops in attribute callback context
-            chip::DeviceLayer::PlatformMgr().ScheduleWork(+[](intptr_t){
+            work_probe_schedule(WorkSource::BindingRefresh, +[](intptr_t){
                 shadow_binding_refresh_from_table();
                 // Persist & optionally retrigger initial sync logic (does not harm if repeated)
                 for (int ch=0; ch<LIGHT_CHANNELS; ++ch) { if (s_shadow_lists[ch].count > 0) shadow_binding_commit(ch); }
@@ -517,6 +621,10 @@ extern "C" void app_main()
 
     esp_err_t err = ESP_OK;
 
+#if TRACE_AUTOSTART
+    trace_start();
+#endif
+
 #if CONFIG_PM_ENABLE
     // Acquire a PM lock to disable light sleep; helps OpenOCD keep JTAG connected
     if (s_pm_no_ls_lock == nullptr) {
@@ -590,18 +698,41 @@ extern "C" void app_main()
     node_t *node = node::create(&node_config, app_attribute_update_cb, app_identification_cb);
     ABORT_APP_ON_FAILURE(node != nullptr, ESP_LOGE(TAG, "Failed to create Matter node"));
 
-    // Create up to 4 On/Off Light Switch controller endpoints (OnOff CLIENT + Binding SERVER + Binding CLIENT)
+    // Create LIGHT_CHANNELS (1..16) On/Off Light Switch controller endpoints (OnOff CLIENT + Binding SERVER + Binding CLIENT)
     for (int i = 0; i < LIGHT_CHANNELS; i++) {
         // Use generic endpoint creator then add desired clusters manually for clarity.
         endpoint_t *ep = endpoint::create(node, ENDPOINT_FLAG_NONE, NULL);
         ABORT_APP_ON_FAILURE(ep != nullptr, ESP_LOGE(TAG, "Failed to create endpoint for switch %d", i));
         g_onoff_endpoint_ids[i] = endpoint::get_id(ep);
-        // Add device type: On/Off Light Switch (0x0103) so ecosystems show a switch, not a lamp.
-        endpoint::add_device_type(ep, 0x0103, 1 /*rev*/);
+        // Add device type: On/Off Light Switch (0x0103) so ecosystems show a switch, not a lamp;
+        // Dimmer Switch (0x0104) when a long press dims.
+        endpoint::add_device_type(ep, LIGHT_GESTURE_LONG == GESTURE_ACTION_DIM ? 0x0104 : 0x0103, 1 /*rev*/);
     // Add OnOff client cluster (needs config struct, then flags)
     cluster::on_off::config_t onoff_cfg = {};
     cluster_t *onoff_client = cluster::on_off::create(ep, &onoff_cfg, CLUSTER_FLAG_CLIENT, 0);
         (void)onoff_client;
+#if LIGHT_GESTURE_LONG == GESTURE_ACTION_DIM
+    // LevelControl client: hold-to-dim sends MoveWithOnOff / Stop to the bound lights
+    cluster::level_control::config_t level_cfg = {};
+    cluster_t *level_client = cluster::level_control::create(ep, &level_cfg, CLUSTER_FLAG_CLIENT, 0);
+        (void)level_client;
+#endif
+#if LIGHT_SWITCH_EVENTS
+    // Generic Switch server: the button as a momentary switch (press / release / long / multi-press events,
+    // logged by light_manager through lights/switch_event_log.cpp) for ecosystem automations
+    endpoint::add_device_type(ep, 0x000F /* Generic Switch */, 3 /*rev*/);
+    cluster::switch_cluster::config_t switch_cfg = {};
+    switch_cfg.number_of_positions = 2;
+    cluster_t *switch_srv = cluster::switch_cluster::create(ep, &switch_cfg, CLUSTER_FLAG_SERVER,
+                                                            cluster::switch_cluster::feature::momentary_switch::get_id());
+    if (switch_srv) {
+        cluster::switch_cluster::feature::momentary_switch_release::add(switch_srv);
+        cluster::switch_cluster::feature::momentary_switch_long_press::add(switch_srv);
+        cluster::switch_cluster::feature::momentary_switch_multi_press::config_t multi_cfg;
+        multi_cfg.multi_press_max = LIGHT_SWITCH_MULTI_PRESS_MAX;
+        cluster::switch_cluster::feature::momentary_switch_multi_press::add(switch_srv, &multi_cfg);
+    }
+#endif
     // Add Binding server & client clusters (client will allow issuing Bind/Unbind commands later)
     cluster::common::config_t binding_srv_cfg = {};
     cluster_t *binding_srv = cluster::binding::create(ep, &binding_srv_cfg, CLUSTER_FLAG_SERVER);
@@ -609,7 +740,8 @@ extern "C" void app_main()
     cluster::common::config_t binding_cli_cfg = {};
     cluster_t *binding_cli = cluster::binding::create(ep, &binding_cli_cfg, CLUSTER_FLAG_CLIENT);
         (void)binding_cli;
-        ESP_LOGI(TAG, "Switch channel %d endpoint_id=%d (OnOff client)", i, g_onoff_endpoint_ids[i]);
+        ESP_LOGI(TAG, "Switch channel %d endpoint_id=%d (OnOff + LevelControl client%s)", i, g_onoff_endpoint_ids[i],
+                 LIGHT_SWITCH_EVENTS ? ", Switch server" : "");
     }
 
     // Standard temperature & humidity sensor endpoints (helper creates clusters & attributes)
@@ -628,6 +760,10 @@ extern "C" void app_main()
         ESP_LOGI(TAG, "Humidity sensor endpoint_id=%d", g_humidity_endpoint_id);
     }
 
+    // Vendor diagnostics cluster exposing the metrics registry on endpoint 0 (all modules registered statically)
+    err = metrics_diag_cluster_create(node);
+    if (err != ESP_OK) ESP_LOGW(TAG, "Metrics diagnostics cluster not created, err:%d", err);
+
 #if CHIP_DEVICE_CONFIG_ENABLE_THREAD
     /* Set OpenThread platform config */
     esp_openthread_platform_config_t config = {
@@ -643,6 +779,7 @@ extern "C" void app_main()
 
     // Load any persisted shadow bindings before starting Matter (will commit after start)
     shadow_binding_load_all_nvs();
+    scene_store_load();
 
     // Start a watchdog timer to detect if Matter initialization gets stuck
     esp_timer_create_args_t timer_args = {
@@ -663,60 +800,97 @@ extern "C" void app_main()
     esp_matter::client::set_request_callback(
         [](chip::DeviceProxy * device, esp_matter::client::request_handle * req, void *){
             if (!device || !req) return;
-            if (req->command_path.mClusterId != chip::app::Clusters::OnOff::Id ||
-                req->command_path.mCommandId != chip::app::Clusters::OnOff::Commands::Toggle::Id) {
-                return; // only handle Toggle
-            }
+            s_m_reqcb_unicast.inc();
+            TRACE_INSTANT("binding.reqcb", req->command_path.mEndpointId);
+            const chip::ClusterId cluster = req->command_path.mClusterId;
+            const chip::CommandId cmd = req->command_path.mCommandId;
+            const bool level = cluster == chip::app::Clusters::LevelControl::Id;
+            if (!is_switch_command(cluster, cmd)) return; // OnOff Toggle / On / Off, LevelControl MoveWithOnOff / Stop
+            if (level && light_level_unpack(req->request_data).group_only) { s_m_reqcb_level_skipped.inc(); return; } // the group binding carries it
             using namespace chip::app;
+            // Press transaction of the dispatch (OnOff only); every target's outcome is reported back to it.
+            void * txn = level ? nullptr : req->request_data;
+            const uint64_t node = (uint64_t)device->GetDeviceId();
+            const uint16_t ep = req->command_path.mEndpointId;
+            if (light_target_blocked(node, ep, (intptr_t)txn)) { s_m_reqcb_breaker_skipped.inc(); return; } // breaker open: the dispatch already failed it
             class CB : public CommandSender::Callback {
             public:
+                CB(void * t, uint64_t n, uint16_t e) : mTxn(t), mNode(n), mEp(e) {}
+                int64_t mSentUs = 0;
+                void Report(bool ok) {
+                    if (mReported) return;
+                    mReported = true;
+                    LightToggleResult r = { mNode, mEp, ok, mSentUs ? (uint32_t)(esp_timer_get_time() - mSentUs) : 0 };
+                    light_toggle_target_result(mTxn, &r);
+                }
                 void OnResponse(CommandSender *, const ConcreteCommandPath & path, const StatusIB & status, TLV::TLVReader *) override {
+                    bool ok = status.mStatus == chip::Protocols::InteractionModel::Status::Success;
+                    if (ok) s_m_toggle_resp_ok.inc(); else s_m_toggle_resp_err.inc();
+                    TRACE_ASYNC_END("toggle.rtt", this);
+                    Report(ok);
                     ESP_LOGI("ToggleSend","Resp ep=%u status=0x%02X", (unsigned)path.mEndpointId, (unsigned)status.mStatus);
                 }
                 void OnError(const CommandSender *, CHIP_ERROR err) override {
+                    s_m_toggle_resp_err.inc();
+                    TRACE_ASYNC_END("toggle.rtt", this);
+                    Report(false);
                     ESP_LOGE("ToggleSend","Error %" CHIP_ERROR_FORMAT, err.Format());
                 }
                 void OnDone(CommandSender * cs) override { chip::Platform::Delete(cs); chip::Platform::Delete(this); }
+            private:
+                void * mTxn;
+                uint64_t mNode;
+                uint16_t mEp;
+                bool mReported = false;
             };
-            auto * cb = chip::Platform::New<CB>();
+            auto * cb = chip::Platform::New<CB>(txn, node, ep);
             if (!cb) return;
             auto * sender = chip::Platform::New<CommandSender>(cb, InteractionModelEngine::GetInstance()->GetExchangeManager());
             if (!sender) { chip::Platform::Delete(cb); return; }
-            CommandPathParams cp(req->command_path.mEndpointId, 0,
-                                 chip::app::Clusters::OnOff::Id,
-                                 chip::app::Clusters::OnOff::Commands::Toggle::Id,
-                                 CommandPathFlags::kEndpointIdValid);
-            CHIP_ERROR e = sender->PrepareCommand(cp);
-            if (e == CHIP_NO_ERROR) e = sender->FinishCommand();
+            CommandPathParams cp(req->command_path.mEndpointId, 0, cluster, cmd, CommandPathFlags::kEndpointIdValid);
+            CHIP_ERROR e;
+            if (cmd == chip::app::Clusters::LevelControl::Commands::MoveWithOnOff::Id && level) e = sender->AddRequestData(cp, level_move(req->request_data));
+            else if (level) e = sender->AddRequestData(cp, chip::app::Clusters::LevelControl::Commands::Stop::Type());
+            else {
+                e = sender->PrepareCommand(cp);
+                if (e == CHIP_NO_ERROR) e = sender->FinishCommand();
+            }
             if (e == CHIP_NO_ERROR) {
                 auto session = device->GetSecureSession();
+                cb->mSentUs = esp_timer_get_time();
+                TRACE_ASYNC_BEGIN("toggle.rtt", cb);
                 if (session.HasValue()) e = sender->SendCommandRequest(session.Value()); else e = CHIP_ERROR_INCORRECT_STATE;
             }
             if (e != CHIP_NO_ERROR) {
+                s_m_toggle_send_fail.inc();
                 ESP_LOGE("ToggleSend","Send path failed %" CHIP_ERROR_FORMAT, e.Format());
+                cb->mSentUs = 0;
+                cb->Report(false);
                 chip::Platform::Delete(sender); chip::Platform::Delete(cb);
             } else {
-                ESP_LOGD("ToggleSend","Sent Toggle to node=0x%016" PRIx64, (uint64_t)device->GetDeviceId());
+                ESP_LOGD("ToggleSend","Sent 0x%04" PRIx32 "/0x%02" PRIx32 " to node=0x%016" PRIx64, cluster, cmd, node);
             }
         },
-        [](uint8_t, esp_matter::client::request_handle *, void *){}, nullptr);
+        // Group bindings: one groupcast per group (no response, so no press transaction outcome).
+        [](uint8_t fabric_index, esp_matter::client::request_handle * req, void *){
+            s_m_reqcb_group.inc();
+            if (!req || !is_switch_command(req->command_path.mClusterId, req->command_path.mCommandId)) return;
+            TRACE_INSTANT("binding.reqcb_group", req->command_path.mGroupId);
+            CHIP_ERROR e = send_group_command(fabric_index, req->command_path.mGroupId, req->command_path.mClusterId,
+                                              req->command_path.mCommandId, req->request_data);
+            if (e != CHIP_NO_ERROR) {
+                s_m_group_send_fail.inc();
+                ESP_LOGW("ToggleSend", "Groupcast to 0x%04X failed %" CHIP_ERROR_FORMAT, (unsigned)req->command_path.mGroupId, e.Format());
+            }
+        }, nullptr);
     // Commit any restored shadow bindings to live Binding attribute (placeholder writer)
     // Defer committing & LED sync until post-IP delay (handled in app_event_cb)
     ESP_LOGI(TAG, "Deferring shadow binding commit & LED sync until IP event + %d ms", BINDING_COMMIT_DELAY_MS);
 
-    // Periodic instrumentation log (every 30s) for request callback counters
-    static esp_timer_handle_t reqcb_timer;
-    esp_timer_create_args_t reqcb_args = {
-        .callback = [](void*){
-            ESP_LOGI("ReqCB","Counts: unicast=%lu group=%lu", (unsigned long)g_reqcb_unicast_count, (unsigned long)g_reqcb_group_count);
-        },
-        .arg = nullptr,
-        .dispatch_method = ESP_TIMER_TASK,
-        .name = "reqcb_tmr"
-    };
-    if (esp_timer_create(&reqcb_args, &reqcb_timer) == ESP_OK) {
-        esp_timer_start_periodic(reqcb_timer, 30000000); // 30s
-    }
+    // Periodic metrics change log (replaces the old 30s ReqCB counter log) + diagnostics cluster refresh
+    metrics_start();
+    // Stack high-water marks + heap minimums (warnings at RESMON_* thresholds, `matter resmon` report)
+    resource_monitor_start();
     
     // Start DHT22 task after Matter start
     dht22_start_task();
@@ -739,6 +913,12 @@ extern "C" void app_main()
     esp_matter::console::diagnostics_register_commands();
     esp_matter::console::wifi_register_commands();
     esp_matter::console::factoryreset_register_commands();
+    metrics_register_console();
+    bench_register_console();
+    trace_register_console();
+    scene_engine_register_console();
+    light_manager_register_console();
+    rules_register_console();
 #if CONFIG_OPENTHREAD_CLI
     esp_matter::console::otcli_register_commands();
 #endif
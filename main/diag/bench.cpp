@@ -0,0 +1,291 @@
+/* On-device toggle benchmark (`matter bench toggle <ch> <count> <interval_ms>`). */
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#if CONFIG_ENABLE_CHIP_SHELL
+#include <esp_matter_console.h>
+#endif
+
+#include "app_config.h"
+#include "lights/light_manager.h"
+#include "work_probe.h"
+
+static const char *TAG = "bench";
+
+namespace {
+
+enum class State : uint8_t { Idle, Running, Settling };
+
+// Per-toggle record. Times are offsets from the run start so the buffer stays small.
+struct Iter {
+    uint32_t start_off_us;  // when the toggle was dispatched
+    uint32_t done_lat_us;   // dispatch -> last target result (0 until complete)
+    uint8_t results;
+    uint8_t fails;
+};
+
+struct Target {
+    uint64_t node;
+    uint16_t endpoint;
+    uint32_t ok;
+    uint32_t fail;
+    uint32_t n_rtt;
+    uint32_t *rtt_us;       // points into s_rtt_pool
+};
+
+std::atomic<State> s_state{State::Idle};
+uint8_t s_channel;
+uint32_t s_count;
+uint32_t s_interval_ms;
+uint8_t s_expected;         // unicast targets bound to the channel when the run started
+std::atomic<uint32_t> s_dispatched{0};
+uint32_t s_completed;
+uint32_t s_dispatch_fail;
+uint32_t s_unknown;         // results from a target not in the binding list at start
+uint32_t s_late;            // results that arrived after the report
+int64_t s_run_start_us;
+int64_t s_run_end_us;
+
+Iter *s_iters = nullptr;
+uint32_t *s_rtt_pool = nullptr;
+Target s_targets[MAX_SHADOW_BINDINGS_PER_CH];
+
+// Observers are handed out by address and may be dereferenced by responses that arrive after
+// the run ends, so they are allocated once on first use and never freed.
+LightToggleObserver *s_observers = nullptr;
+
+esp_timer_handle_t s_tick_timer = nullptr;
+esp_timer_handle_t s_settle_timer = nullptr;
+
+uint32_t now_off_us() { return (uint32_t)(esp_timer_get_time() - s_run_start_us); }
+
+// Sorts `v` in place; prints "min p50 p90 p99 max" or "-" when empty.
+void print_dist(const char *label, uint32_t *v, uint32_t n)
+{
+    if (n == 0) {
+        printf("  %-28s n=0\n", label);
+        return;
+    }
+    std::sort(v, v + n);
+    auto pct = [&](uint32_t p) { uint32_t rank = (n * p + 99) / 100; return v[rank ? rank - 1 : 0]; };
+    printf("  %-28s n=%" PRIu32 " min=%" PRIu32 " p50=%" PRIu32 " p90=%" PRIu32 " p99=%" PRIu32 " max=%" PRIu32 "\n",
+           label, n, v[0], pct(50), pct(90), pct(99), v[n - 1]);
+}
+
+void free_buffers()
+{
+    free(s_iters);
+    free(s_rtt_pool);
+    s_iters = nullptr;
+    s_rtt_pool = nullptr;
+}
+
+// Matter thread.
+void finish(intptr_t)
+{
+    if (s_state.load() != State::Settling) return;
+    if (s_tick_timer) esp_timer_stop(s_tick_timer);
+    if (s_settle_timer) esp_timer_stop(s_settle_timer);
+    uint32_t dispatched = s_dispatched.load();
+    uint32_t ok = 0, fail = 0;
+    for (uint8_t t = 0; t < s_expected; t++) { ok += s_targets[t].ok; fail += s_targets[t].fail; }
+    uint32_t missing = dispatched * s_expected - std::min(dispatched * s_expected, ok + fail);
+
+    printf("bench toggle ch%u: %" PRIu32 "/%" PRIu32 " dispatched, interval %" PRIu32 " ms, %u target(s), %.1f s\n",
+           s_channel, dispatched, s_count, s_interval_ms, s_expected,
+           (double)(s_run_end_us - s_run_start_us) / 1e6);
+    uint32_t incomplete = dispatched - std::min(dispatched, s_completed + s_dispatch_fail);
+    printf("  complete=%" PRIu32 " incomplete=%" PRIu32 " dispatch_fail=%" PRIu32 "\n", s_completed, incomplete,
+           s_dispatch_fail);
+    printf("  results ok=%" PRIu32 " fail=%" PRIu32 " missing=%" PRIu32 " unknown_target=%" PRIu32 "\n", ok, fail,
+           missing, s_unknown);
+
+    // Compact completed latencies to the front of the iteration buffer (reuses its memory).
+    uint32_t *lat = reinterpret_cast<uint32_t *>(s_iters);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < dispatched; i++) {
+        if (s_iters[i].done_lat_us && s_iters[i].fails == 0) lat[n++] = s_iters[i].done_lat_us;
+    }
+    print_dist("latency us (all targets ok)", lat, n);
+    for (uint8_t t = 0; t < s_expected; t++) {
+        Target &tg = s_targets[t];
+        char label[48];
+        snprintf(label, sizeof(label), "rtt us 0x%016" PRIX64 "/%u", tg.node, tg.endpoint);
+        print_dist(label, tg.rtt_us, tg.n_rtt);
+        printf("  %-28s ok=%" PRIu32 " fail=%" PRIu32 "\n", "", tg.ok, tg.fail);
+    }
+    free_buffers();
+    s_state.store(State::Idle);
+}
+
+// Matter thread. Report as soon as every dispatched toggle is accounted for.
+void maybe_finish()
+{
+    if (s_state.load() == State::Settling && s_completed + s_dispatch_fail >= s_dispatched.load()) finish(0);
+}
+
+// Matter thread (observer callback from the binding request path).
+void on_result(void *ctx, const LightToggleResult *r)
+{
+    if (s_state.load() == State::Idle || !s_iters) { s_late++; return; }
+    uint32_t i = (uint32_t)(uintptr_t)ctx;
+    if (i >= s_dispatched.load()) return;
+    Iter &it = s_iters[i];
+    if (r->node_id == 0) {
+        // Local dispatch failed: no target will answer for this toggle.
+        s_dispatch_fail++;
+        maybe_finish();
+        return;
+    }
+    Target *tg = nullptr;
+    for (uint8_t t = 0; t < s_expected; t++) {
+        if (s_targets[t].node == r->node_id && s_targets[t].endpoint == r->endpoint) { tg = &s_targets[t]; break; }
+    }
+    if (!tg) { s_unknown++; return; }
+    if (r->ok) {
+        tg->ok++;
+        if (r->rtt_us && tg->n_rtt < s_count) tg->rtt_us[tg->n_rtt++] = r->rtt_us;
+    } else {
+        tg->fail++;
+        it.fails++;
+    }
+    if (++it.results == s_expected) {
+        it.done_lat_us = std::max<uint32_t>(1, now_off_us() - it.start_off_us);
+        s_completed++;
+        maybe_finish();
+    }
+}
+
+void begin_settle()
+{
+    State expected = State::Running;
+    if (!s_state.compare_exchange_strong(expected, State::Settling)) return;
+    esp_timer_stop(s_tick_timer);
+    s_run_end_us = esp_timer_get_time();
+    esp_timer_start_once(s_settle_timer, (uint64_t)BENCH_SETTLE_MS * 1000ULL);
+}
+
+// esp_timer task: one toggle per tick.
+void tick_cb(void *)
+{
+    if (s_state.load() != State::Running) return;
+    uint32_t i = s_dispatched.load();
+    if (i >= s_count) { begin_settle(); return; }
+    s_iters[i].start_off_us = now_off_us();
+    s_dispatched.store(i + 1);
+    light_manager_toggle_dispatch(s_channel, &s_observers[i]);
+    if (i + 1 >= s_count) begin_settle();
+}
+
+} // namespace
+
+esp_err_t bench_toggle_start(uint8_t channel, uint32_t count, uint32_t interval_ms)
+{
+    if (channel >= LIGHT_CHANNELS || count == 0 || count > BENCH_MAX_COUNT || interval_ms < BENCH_MIN_INTERVAL_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_state.load() != State::Idle) return ESP_ERR_INVALID_STATE;
+
+    const ShadowBindingList *list = shadow_binding_get_list(channel);
+    s_expected = 0;
+    memset(s_targets, 0, sizeof(s_targets));
+    if (list) {
+        for (int i = 0; i < list->count && s_expected < MAX_SHADOW_BINDINGS_PER_CH; i++) {
+            if (list->entries[i].is_group) continue;
+            s_targets[s_expected].node = list->entries[i].node_id;
+            s_targets[s_expected].endpoint = list->entries[i].endpoint;
+            s_expected++;
+        }
+    }
+    if (s_expected == 0) {
+        ESP_LOGW(TAG, "CH%u has no unicast bindings (group-only targets send no responses)", channel);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!s_observers) {
+        s_observers = static_cast<LightToggleObserver *>(calloc(BENCH_MAX_COUNT, sizeof(LightToggleObserver)));
+        if (!s_observers) return ESP_ERR_NO_MEM;
+        for (uint32_t i = 0; i < BENCH_MAX_COUNT; i++) s_observers[i] = { on_result, (void *)(uintptr_t)i };
+    }
+    s_iters = static_cast<Iter *>(calloc(count, sizeof(Iter)));
+    s_rtt_pool = static_cast<uint32_t *>(calloc((size_t)count * s_expected, sizeof(uint32_t)));
+    if (!s_iters || !s_rtt_pool) { free_buffers(); return ESP_ERR_NO_MEM; }
+    for (uint8_t t = 0; t < s_expected; t++) s_targets[t].rtt_us = s_rtt_pool + (size_t)t * count;
+
+    if (!s_tick_timer) {
+        esp_timer_create_args_t tick = { .callback = tick_cb, .arg = nullptr, .dispatch_method = ESP_TIMER_TASK, .name = "bench_tick" };
+        esp_timer_create_args_t settle = {
+            .callback = [](void *) { work_probe_schedule(WorkSource::Diagnostics, finish); },
+            .arg = nullptr,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "bench_settle"
+        };
+        if (esp_timer_create(&tick, &s_tick_timer) != ESP_OK || esp_timer_create(&settle, &s_settle_timer) != ESP_OK) {
+            free_buffers();
+            return ESP_FAIL;
+        }
+    }
+
+    s_channel = channel;
+    s_count = count;
+    s_interval_ms = interval_ms;
+    s_dispatched.store(0);
+    s_completed = 0;
+    s_dispatch_fail = 0;
+    s_unknown = 0;
+    s_run_start_us = esp_timer_get_time();
+    s_state.store(State::Running);
+    ESP_LOGI(TAG, "Toggle bench CH%u: %" PRIu32 " x %" PRIu32 " ms, %u unicast target(s)", channel, count, interval_ms,
+             s_expected);
+    tick_cb(nullptr);
+    if (s_state.load() == State::Running) esp_timer_start_periodic(s_tick_timer, (uint64_t)interval_ms * 1000ULL);
+    return ESP_OK;
+}
+
+void bench_stop()
+{
+    begin_settle();
+}
+
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t bench_console_handler(int argc, char **argv)
+{
+    if (argc >= 1 && strcmp(argv[0], "stop") == 0) {
+        bench_stop();
+        printf("bench stopping (report after %d ms settle)\n", BENCH_SETTLE_MS);
+        return ESP_OK;
+    }
+    if (argc == 4 && strcmp(argv[0], "toggle") == 0) {
+        esp_err_t err = bench_toggle_start((uint8_t)atoi(argv[1]), (uint32_t)strtoul(argv[2], nullptr, 10),
+                                           (uint32_t)strtoul(argv[3], nullptr, 10));
+        if (err != ESP_OK) printf("bench not started: %s\n", esp_err_to_name(err));
+        return ESP_OK;
+    }
+    printf("Usage: matter bench toggle <ch> <count 1-%d> <interval_ms >=%d> | matter bench stop\n", BENCH_MAX_COUNT,
+           BENCH_MIN_INTERVAL_MS);
+    printf("late results (after a report) since boot: %" PRIu32 "\n", s_late);
+    if (s_state.load() != State::Idle) {
+        printf("running: ch%u %" PRIu32 "/%" PRIu32 " dispatched, %" PRIu32 " complete\n", s_channel,
+               s_dispatched.load(), s_count, s_completed);
+    }
+    return ESP_OK;
+}
+#endif
+
+void bench_register_console()
+{
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "bench", .description = "Toggle benchmark. Usage: matter bench toggle <ch> <count> <interval_ms> | stop", .handler = bench_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
@@ -0,0 +1,21 @@
+/*
+ * On-device toggle benchmark.
+ *
+ * `matter bench toggle <ch> <count> <interval_ms>` drives the button-press dispatch path
+ * (light_manager_toggle_dispatch) `count` times and prints response latency, success /
+ * failure counts and per-target RTT as min/p50/p90/p99/max, so firmware builds and network
+ * conditions can be compared on a deployed unit.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+// Start a run (fails with ESP_ERR_INVALID_STATE while another run is active).
+esp_err_t bench_toggle_start(uint8_t channel, uint32_t count, uint32_t interval_ms);
+
+// Stop dispatching; the report is printed once outstanding responses settle.
+void bench_stop();
+
+// Register the `bench` console command (no-op without CONFIG_ENABLE_CHIP_SHELL).
+void bench_register_console();
@@ -0,0 +1,296 @@
+/* Runtime metrics registry, snapshot console command and vendor diagnostics cluster. */
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_matter.h>
+#if CONFIG_ENABLE_CHIP_SHELL
+#include <esp_matter_console.h>
+#endif
+#include "work_probe.h"
+
+static const char *TAG = "metrics";
+
+namespace metrics {
+
+// Registry storage is zero-initialised (constant init) so it is valid before any
+// metric constructor runs during static initialisation.
+static const Metric * s_registry[METRICS_MAX_COUNT];
+static std::atomic<uint16_t> s_registry_count{0};
+static bool s_registry_overflow = false;
+
+Metric::Metric(const char * name, Kind kind) : mName(name), mKind(kind), mIndex(-1)
+{
+    uint16_t idx = s_registry_count.fetch_add(1, std::memory_order_relaxed);
+    if (idx < METRICS_MAX_COUNT) {
+        s_registry[idx] = this;
+        mIndex = (int16_t)idx;
+    } else {
+        s_registry_count.store(METRICS_MAX_COUNT, std::memory_order_relaxed);
+        s_registry_overflow = true; // reported once from metrics_start() (logging not ready yet)
+    }
+}
+
+Histogram::Histogram(const char * name, const uint32_t * bounds, uint8_t bound_count)
+    : Metric(name, Kind::Histogram), mBounds(bounds),
+      mBoundCount(bound_count > METRICS_HIST_MAX_BUCKETS ? METRICS_HIST_MAX_BUCKETS : bound_count)
+{
+    for (auto & b : mBuckets) b.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::record(uint32_t v)
+{
+    uint8_t i = 0;
+    while (i < mBoundCount && v > mBounds[i]) i++;
+    mBuckets[i].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    uint32_t lo = mSumLo.fetch_add(v, std::memory_order_relaxed);
+    if (lo + v < lo) mSumHi.fetch_add(1, std::memory_order_relaxed); // carry, exact per add
+    uint32_t cur = mMax.load(std::memory_order_relaxed);
+    while (v > cur && !mMax.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+    cur = mMin.load(std::memory_order_relaxed);
+    while (v < cur && !mMin.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+void Histogram::reset()
+{
+    for (auto & b : mBuckets) b.store(0, std::memory_order_relaxed);
+    mCount.store(0, std::memory_order_relaxed);
+    mSumLo.store(0, std::memory_order_relaxed);
+    mSumHi.store(0, std::memory_order_relaxed);
+    mMin.store(UINT32_MAX, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+uint32_t Histogram::percentile(uint8_t p) const
+{
+    uint32_t total = count();
+    if (total == 0) return 0;
+    if (p > 100) p = 100;
+    uint64_t target = ((uint64_t)total * p + 99) / 100; // rank (1-based, rounded up)
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < bucket_count(); i++) {
+        seen += bucket(i);
+        if (seen >= target) {
+            uint32_t b = bound(i);
+            return b < max() ? b : max();
+        }
+    }
+    return max();
+}
+
+size_t count() { return s_registry_count.load(std::memory_order_relaxed); }
+
+const Metric * at(size_t index) { return index < count() ? s_registry[index] : nullptr; }
+
+const Metric * find(const char * name)
+{
+    for (size_t i = 0; i < count(); i++) {
+        if (s_registry[i] && strcmp(s_registry[i]->name(), name) == 0) return s_registry[i];
+    }
+    return nullptr;
+}
+
+void reset_all()
+{
+    for (size_t i = 0; i < count(); i++) {
+        // Registry holds const pointers for readers; reset is the single sanctioned mutation.
+        Metric * m = const_cast<Metric *>(s_registry[i]);
+        switch (m->kind()) {
+        case Kind::Counter: static_cast<Counter *>(m)->reset(); break;
+        case Kind::Histogram: static_cast<Histogram *>(m)->reset(); break;
+        case Kind::Gauge: break; // gauges reflect live state; never reset
+        }
+    }
+}
+
+// Scalar used for change detection / single-value export (count for histograms).
+static uint32_t scalar_value(const Metric * m)
+{
+    switch (m->kind()) {
+    case Kind::Counter: return static_cast<const Counter *>(m)->value();
+    case Kind::Gauge: return (uint32_t) static_cast<const Gauge *>(m)->value();
+    case Kind::Histogram: return static_cast<const Histogram *>(m)->count();
+    }
+    return 0;
+}
+
+void log_changed()
+{
+    static uint32_t s_last[METRICS_MAX_COUNT];
+    for (size_t i = 0; i < count(); i++) {
+        const Metric * m = s_registry[i];
+        uint32_t v = scalar_value(m);
+        if (v == s_last[i]) continue;
+        s_last[i] = v;
+        if (m->kind() == Kind::Histogram) {
+            auto * h = static_cast<const Histogram *>(m);
+            ESP_LOGI(TAG, "%s n=%" PRIu32 " mean=%" PRIu32 " p99<=%" PRIu32 " max=%" PRIu32,
+                     m->name(), h->count(), h->mean(), h->percentile(99), h->max());
+        } else if (m->kind() == Kind::Gauge) {
+            ESP_LOGI(TAG, "%s=%" PRId32, m->name(), static_cast<const Gauge *>(m)->value());
+        } else {
+            ESP_LOGI(TAG, "%s=%" PRIu32, m->name(), v);
+        }
+    }
+}
+
+void print_snapshot(const char * prefix_filter)
+{
+    size_t plen = prefix_filter ? strlen(prefix_filter) : 0;
+    for (size_t i = 0; i < count(); i++) {
+        const Metric * m = s_registry[i];
+        if (plen && strncmp(m->name(), prefix_filter, plen) != 0) continue;
+        switch (m->kind()) {
+        case Kind::Counter:
+            printf("counter %-32s %" PRIu32 "\n", m->name(), static_cast<const Counter *>(m)->value());
+            break;
+        case Kind::Gauge:
+            printf("gauge   %-32s %" PRId32 "\n", m->name(), static_cast<const Gauge *>(m)->value());
+            break;
+        case Kind::Histogram: {
+            auto * h = static_cast<const Histogram *>(m);
+            printf("hist    %-32s n=%" PRIu32 " min=%" PRIu32 " mean=%" PRIu32 " p50<=%" PRIu32
+                   " p90<=%" PRIu32 " p99<=%" PRIu32 " max=%" PRIu32 "\n",
+                   m->name(), h->count(), h->min(), h->mean(), h->percentile(50), h->percentile(90),
+                   h->percentile(99), h->max());
+            break;
+        }
+        }
+    }
+}
+
+} // namespace metrics
+
+// ---- Console ----
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t metrics_console_handler(int argc, char **argv)
+{
+    if (argc >= 1 && strcmp(argv[0], "reset") == 0) {
+        metrics::reset_all();
+        printf("metrics reset (gauges untouched)\n");
+        return ESP_OK;
+    }
+    metrics::print_snapshot(argc >= 1 ? argv[0] : nullptr);
+    return ESP_OK;
+}
+#endif
+
+void metrics_register_console()
+{
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "metrics", .description = "Runtime metrics. Usage: matter metrics [prefix|reset]", .handler = metrics_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
+
+// ---- Vendor diagnostics cluster ----
+// Attribute layout: metric index i owns attribute ids [i*4, i*4+3].
+//   counter/gauge: +0 value
+//   histogram:     +0 count, +1 mean, +2 p99 bucket bound, +3 max
+// `matter metrics` prints names in registry order so ids can be mapped on the host side.
+static constexpr uint32_t kAttrsPerMetric = 4;
+static bool s_diag_cluster_created = false;
+
+static uint32_t diag_attr_id(size_t index, uint32_t field) { return (uint32_t)index * kAttrsPerMetric + field; }
+
+esp_err_t metrics_diag_cluster_create(esp_matter::node_t * node)
+{
+    using namespace esp_matter;
+    if (!node) return ESP_ERR_INVALID_ARG;
+    endpoint_t * root = endpoint::get(node, 0);
+    if (!root) return ESP_ERR_NOT_FOUND;
+    cluster_t * cl = cluster::create(root, METRICS_DIAG_CLUSTER_ID, CLUSTER_FLAG_SERVER);
+    if (!cl) return ESP_ERR_NO_MEM;
+    cluster::global::attribute::create_cluster_revision(cl, 1);
+    cluster::global::attribute::create_feature_map(cl, 0);
+    for (size_t i = 0; i < metrics::count(); i++) {
+        const metrics::Metric * m = metrics::at(i);
+        if (m->kind() == metrics::Kind::Gauge) {
+            attribute::create(cl, diag_attr_id(i, 0), ATTRIBUTE_FLAG_NONE, esp_matter_int32(0));
+        } else {
+            attribute::create(cl, diag_attr_id(i, 0), ATTRIBUTE_FLAG_NONE, esp_matter_uint32(0));
+        }
+        if (m->kind() == metrics::Kind::Histogram) {
+            for (uint32_t f = 1; f < kAttrsPerMetric; f++) {
+                attribute::create(cl, diag_attr_id(i, f), ATTRIBUTE_FLAG_NONE, esp_matter_uint32(0));
+            }
+        }
+    }
+    s_diag_cluster_created = true;
+    ESP_LOGI(TAG, "Diagnostics cluster 0x%08" PRIX32 " on ep0 with %u metrics", (uint32_t)METRICS_DIAG_CLUSTER_ID,
+             (unsigned)metrics::count());
+    return ESP_OK;
+}
+
+// Runs on the Matter thread (attribute::report is not thread-safe).
+static void diag_cluster_refresh(intptr_t)
+{
+    for (size_t i = 0; i < metrics::count(); i++) {
+        const metrics::Metric * m = metrics::at(i);
+        esp_matter_attr_val_t v;
+        switch (m->kind()) {
+        case metrics::Kind::Counter:
+            v = esp_matter_uint32(static_cast<const metrics::Counter *>(m)->value());
+            esp_matter::attribute::report(0, METRICS_DIAG_CLUSTER_ID, diag_attr_id(i, 0), &v);
+            break;
+        case metrics::Kind::Gauge:
+            v = esp_matter_int32(static_cast<const metrics::Gauge *>(m)->value());
+            esp_matter::attribute::report(0, METRICS_DIAG_CLUSTER_ID, diag_attr_id(i, 0), &v);
+            break;
+        case metrics::Kind::Histogram: {
+            auto * h = static_cast<const metrics::Histogram *>(m);
+            const uint32_t fields[kAttrsPerMetric] = { h->count(), h->mean(), h->percentile(99), h->max() };
+            for (uint32_t f = 0; f < kAttrsPerMetric; f++) {
+                v = esp_matter_uint32(fields[f]);
+                esp_matter::attribute::report(0, METRICS_DIAG_CLUSTER_ID, diag_attr_id(i, f), &v);
+            }
+            break;
+        }
+        }
+    }
+}
+
+void metrics_start()
+{
+    static bool s_started = false;
+    if (s_started) return;
+    s_started = true;
+    if (metrics::s_registry_overflow) {
+        ESP_LOGW(TAG, "Metric registry full (METRICS_MAX_COUNT=%d); some metrics are not reported", METRICS_MAX_COUNT);
+    }
+    ESP_LOGI(TAG, "%u metrics registered", (unsigned)metrics::count());
+#if METRICS_LOG_PERIOD_MS > 0
+    static esp_timer_handle_t s_log_timer = nullptr;
+    esp_timer_create_args_t log_args = {
+        .callback = [](void*){ metrics::log_changed(); },
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "metrics_log"
+    };
+    if (esp_timer_create(&log_args, &s_log_timer) == ESP_OK) {
+        esp_timer_start_periodic(s_log_timer, (uint64_t)METRICS_LOG_PERIOD_MS * 1000ULL);
+    }
+#endif
+#if METRICS_DIAG_PERIOD_MS > 0
+    if (s_diag_cluster_created) {
+        static esp_timer_handle_t s_diag_timer = nullptr;
+        esp_timer_create_args_t diag_args = {
+            .callback = [](void*){ work_probe_schedule(WorkSource::Diagnostics, diag_cluster_refresh); },
+            .arg = nullptr,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "metrics_diag"
+        };
+        if (esp_timer_create(&diag_args, &s_diag_timer) == ESP_OK) {
+            esp_timer_start_periodic(s_diag_timer, (uint64_t)METRICS_DIAG_PERIOD_MS * 1000ULL);
+        }
+    }
+#endif
+}
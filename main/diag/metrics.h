@@ -0,0 +1,138 @@
+/*
+ * Runtime metrics registry: typed counters, gauges and fixed-bucket histograms.
+ *
+ * Metrics are declared as file-scope statics in the owning module, e.g.
+ *     static metrics::Counter s_m_presses("light.presses");
+ * and self-register into a fixed-size static registry before app_main() runs.
+ * All update paths are single atomic RMW operations (no locks, no allocation)
+ * so they are safe from ISRs, FreeRTOS tasks, esp_timer callbacks and the
+ * Matter thread alike.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include <esp_err.h>
+#include <esp_matter.h>
+
+#include "app_config.h"
+
+namespace metrics {
+
+enum class Kind : uint8_t { Counter, Gauge, Histogram };
+
+class Metric {
+public:
+    const char * name() const { return mName; }
+    Kind kind() const { return mKind; }
+    // Registry index (stable for the lifetime of the firmware image); -1 if registry was full.
+    int index() const { return mIndex; }
+
+protected:
+    Metric(const char * name, Kind kind);
+    Metric(const Metric &) = delete;
+    Metric & operator=(const Metric &) = delete;
+
+private:
+    const char * mName;
+    Kind mKind;
+    int16_t mIndex;
+};
+
+// Monotonic event count (wraps at 2^32).
+class Counter : public Metric {
+public:
+    explicit Counter(const char * name) : Metric(name, Kind::Counter) {}
+    void inc(uint32_t n = 1) { mValue.fetch_add(n, std::memory_order_relaxed); }
+    uint32_t value() const { return mValue.load(std::memory_order_relaxed); }
+    void reset() { mValue.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> mValue{0};
+};
+
+// Instantaneous signed level (queue depth, last reading, free bytes...).
+class Gauge : public Metric {
+public:
+    explicit Gauge(const char * name) : Metric(name, Kind::Gauge) {}
+    void set(int32_t v) { mValue.store(v, std::memory_order_relaxed); }
+    void add(int32_t d) { mValue.fetch_add(d, std::memory_order_relaxed); }
+    void sub(int32_t d) { mValue.fetch_sub(d, std::memory_order_relaxed); }
+    int32_t value() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int32_t> mValue{0};
+};
+
+// Fixed-bucket histogram. `bounds` are inclusive upper bounds in ascending order and
+// must outlive the histogram (use a static const array); values above the last bound
+// land in an implicit overflow bucket.
+class Histogram : public Metric {
+public:
+    Histogram(const char * name, const uint32_t * bounds, uint8_t bound_count);
+    template <size_t N>
+    Histogram(const char * name, const uint32_t (&bounds)[N]) : Histogram(name, bounds, (uint8_t)N)
+    {
+        static_assert(N <= METRICS_HIST_MAX_BUCKETS, "too many histogram buckets");
+    }
+    void record(uint32_t v);
+    void reset();
+
+    uint32_t count() const { return mCount.load(std::memory_order_relaxed); }
+    // Read as two words: a reader racing a carry may see the low word wrapped before the high one
+    // catches up, off by 2^32 for that one snapshot.
+    uint64_t sum() const
+    {
+        return ((uint64_t)mSumHi.load(std::memory_order_relaxed) << 32) | mSumLo.load(std::memory_order_relaxed);
+    }
+    uint32_t min() const { return count() ? mMin.load(std::memory_order_relaxed) : 0; }
+    uint32_t max() const { return mMax.load(std::memory_order_relaxed); }
+    uint32_t mean() const { uint32_t c = count(); return c ? (uint32_t)(sum() / c) : 0; }
+    // Upper bound of the bucket holding the p-th percentile (0..100); max() for the overflow bucket.
+    uint32_t percentile(uint8_t p) const;
+
+    uint8_t bucket_count() const { return (uint8_t)(mBoundCount + 1); }
+    uint32_t bucket(uint8_t i) const { return i < bucket_count() ? mBuckets[i].load(std::memory_order_relaxed) : 0; }
+    // Upper bound for bucket i (UINT32_MAX for the overflow bucket).
+    uint32_t bound(uint8_t i) const { return i < mBoundCount ? mBounds[i] : UINT32_MAX; }
+
+private:
+    const uint32_t * mBounds;
+    uint8_t mBoundCount;
+    std::atomic<uint32_t> mBuckets[METRICS_HIST_MAX_BUCKETS + 1];
+    std::atomic<uint32_t> mCount{0};
+    // 64-bit sum as two 32-bit words: 64-bit atomics are not lock-free on the riscv32 targets.
+    std::atomic<uint32_t> mSumLo{0};
+    std::atomic<uint32_t> mSumHi{0};
+    std::atomic<uint32_t> mMin{UINT32_MAX};
+    std::atomic<uint32_t> mMax{0};
+};
+
+// Shared bucket layout (microseconds) so latency dashboards line up across modules.
+inline constexpr uint32_t kLatencyBucketsUs[] = { 1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 5000000 };
+
+// Registry access (read-only iteration for reporting).
+size_t count();
+const Metric * at(size_t index);
+const Metric * find(const char * name);
+void reset_all();
+
+// Log every metric whose value changed since the previous call (INFO level).
+void log_changed();
+// Print a full snapshot to stdout (console command output).
+void print_snapshot(const char * prefix_filter = nullptr);
+
+} // namespace metrics
+
+// Register `metrics` console command (requires CONFIG_ENABLE_CHIP_SHELL).
+void metrics_register_console();
+
+// Add the vendor-specific diagnostics cluster (METRICS_DIAG_CLUSTER_ID) to the root endpoint.
+// Must be called after all modules have been linked in (i.e. from app_main before esp_matter::start()).
+esp_err_t metrics_diag_cluster_create(esp_matter::node_t * node);
+
+// Start the periodic change log (METRICS_LOG_PERIOD_MS) and diagnostics cluster refresh
+// (METRICS_DIAG_PERIOD_MS). Call once after esp_matter::start().
+void metrics_start();
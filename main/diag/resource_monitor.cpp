@@ -0,0 +1,245 @@
+/* Task stack and heap high-water-mark monitor (periodic sampling + budget report). */
+#include "resource_monitor.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#if CONFIG_ENABLE_CHIP_SHELL
+#include <esp_matter_console.h>
+#endif
+
+#include "app_config.h"
+#include "metrics.h"
+#include "rtos_static.h"
+
+static const char *TAG = "resmon";
+
+namespace {
+
+struct TaskSlot {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskHandle_t handle;   // null for transient tasks (only sampled at exit) and unresolved system tasks
+    uint32_t stack_bytes;  // 0 when unknown
+    uint32_t min_free;     // minimum-ever free stack observed (bytes)
+    bool system;           // resolved by name (not created by this firmware)
+    bool warned;
+};
+
+TaskSlot s_slots[RESMON_MAX_TASKS];
+int s_slot_count = 0;
+portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+bool s_heap_warned = false;
+bool s_block_warned = false;
+
+// Persistent tasks owned by IDF / the Matter SDK; looked up by name each sample (never cached,
+// xTaskGetHandle returns null once a task is gone).
+struct SystemTask { const char *name; uint32_t stack_bytes; };
+const SystemTask k_system_tasks[] = {
+#ifdef CONFIG_CHIP_TASK_STACK_SIZE
+    { "CHIP", CONFIG_CHIP_TASK_STACK_SIZE },
+#else
+    { "CHIP", 0 },
+#endif
+#ifdef CONFIG_ESP_TIMER_TASK_STACK_SIZE
+    { "esp_timer", CONFIG_ESP_TIMER_TASK_STACK_SIZE },
+#else
+    { "esp_timer", 0 },
+#endif
+#ifdef CONFIG_LWIP_TCPIP_TASK_STACK_SIZE
+    { "tiT", CONFIG_LWIP_TCPIP_TASK_STACK_SIZE },
+#else
+    { "tiT", 0 },
+#endif
+};
+
+metrics::Gauge s_m_heap_free("sys.heap_int_free");
+metrics::Gauge s_m_heap_min("sys.heap_int_min_ever");
+metrics::Gauge s_m_heap_largest("sys.heap_int_largest_block");
+metrics::Gauge s_m_psram_min("sys.heap_psram_min_ever");
+metrics::Gauge s_m_stack_min("sys.stack_min_free");
+metrics::Counter s_m_stack_warnings("sys.stack_warnings");
+metrics::Counter s_m_heap_warnings("sys.heap_warnings");
+
+// Caller must hold s_lock.
+TaskSlot * find_or_add_slot(const char *name)
+{
+    for (int i = 0; i < s_slot_count; i++) {
+        if (strncmp(s_slots[i].name, name, sizeof(s_slots[i].name)) == 0) return &s_slots[i];
+    }
+    if (s_slot_count >= RESMON_MAX_TASKS) return nullptr;
+    // Fill before publishing the new count: the sampler iterates without taking the lock.
+    TaskSlot *s = &s_slots[s_slot_count];
+    memset(s, 0, sizeof(*s));
+    strncpy(s->name, name, sizeof(s->name) - 1);
+    s->min_free = UINT32_MAX;
+    s_slot_count++;
+    return s;
+}
+
+void note_free(TaskSlot *s, uint32_t free_bytes)
+{
+    if (free_bytes < s->min_free) s->min_free = free_bytes;
+    if (!s->warned && s->min_free < RESMON_STACK_WARN_BYTES) {
+        s->warned = true;
+        s_m_stack_warnings.inc();
+        ESP_LOGW(TAG, "Task '%s' stack nearly exhausted: %" PRIu32 " bytes free (size %" PRIu32 ")", s->name,
+                 s->min_free, s->stack_bytes);
+    }
+}
+
+uint32_t suggested_stack(const TaskSlot &s)
+{
+    if (!s.stack_bytes || s.min_free == UINT32_MAX) return s.stack_bytes;
+    uint32_t used = s.stack_bytes > s.min_free ? s.stack_bytes - s.min_free : 0;
+    uint32_t want = used + RESMON_STACK_MARGIN_BYTES;
+    return (want + 255u) & ~255u; // round up to 256 bytes
+}
+
+} // namespace
+
+void resource_monitor_track_task(TaskHandle_t task, const char *name, uint32_t stack_bytes)
+{
+    if (!task || !name) return;
+    taskENTER_CRITICAL(&s_lock);
+    TaskSlot *s = find_or_add_slot(name);
+    if (s) {
+        s->handle = task;
+        s->stack_bytes = stack_bytes;
+        s->system = false;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (!s) ESP_LOGW(TAG, "Task table full (RESMON_MAX_TASKS=%d); '%s' not tracked", RESMON_MAX_TASKS, name);
+}
+
+void resource_monitor_record_exit(uint32_t stack_bytes)
+{
+    uint32_t free_bytes = (uint32_t)uxTaskGetStackHighWaterMark(nullptr);
+    const char *name = pcTaskGetName(nullptr);
+    taskENTER_CRITICAL(&s_lock);
+    TaskSlot *s = find_or_add_slot(name);
+    if (s) {
+        s->handle = nullptr; // transient: never sampled asynchronously
+        s->stack_bytes = stack_bytes;
+        if (free_bytes < s->min_free) s->min_free = free_bytes;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    if (s && s->min_free < RESMON_STACK_WARN_BYTES && !s->warned) {
+        s->warned = true;
+        s_m_stack_warnings.inc();
+        ESP_LOGW(TAG, "Transient task '%s' exited with only %" PRIu32 " bytes stack free", name, s->min_free);
+    }
+}
+
+void resource_monitor_sample()
+{
+    // Firmware-owned persistent tasks (handles never deleted while tracked).
+    uint32_t stack_min = UINT32_MAX;
+    for (int i = 0; i < s_slot_count; i++) {
+        TaskSlot &s = s_slots[i];
+        if (s.system) {
+            TaskHandle_t h = xTaskGetHandle(s.name);
+            if (h) note_free(&s, (uint32_t)uxTaskGetStackHighWaterMark(h));
+        } else if (s.handle) {
+            note_free(&s, (uint32_t)uxTaskGetStackHighWaterMark(s.handle));
+        }
+        if (s.min_free < stack_min) stack_min = s.min_free;
+    }
+    s_m_stack_min.set(stack_min == UINT32_MAX ? 0 : (int32_t)stack_min);
+
+    uint32_t heap_free = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t heap_min = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t largest = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    s_m_heap_free.set((int32_t)heap_free);
+    s_m_heap_min.set((int32_t)heap_min);
+    s_m_heap_largest.set((int32_t)largest);
+    s_m_psram_min.set((int32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+
+    if (!s_heap_warned && heap_min < RESMON_HEAP_WARN_BYTES) {
+        s_heap_warned = true;
+        s_m_heap_warnings.inc();
+        ESP_LOGW(TAG, "Internal heap minimum-ever %" PRIu32 " bytes (< %d)", heap_min, RESMON_HEAP_WARN_BYTES);
+    }
+    if (!s_block_warned && largest < RESMON_LARGEST_BLOCK_WARN_BYTES) {
+        s_block_warned = true;
+        s_m_heap_warnings.inc();
+        ESP_LOGW(TAG, "Largest free internal block %" PRIu32 " bytes (< %d): heap fragmented", largest,
+                 RESMON_LARGEST_BLOCK_WARN_BYTES);
+    }
+}
+
+void resource_monitor_print_report()
+{
+    resource_monitor_sample();
+    printf("%-24s %8s %8s %8s %9s\n", "task", "size", "min_free", "peak", "suggest");
+    int32_t reclaimable = 0;
+    for (int i = 0; i < s_slot_count; i++) {
+        const TaskSlot &s = s_slots[i];
+        if (s.min_free == UINT32_MAX) {
+            printf("%-24s %8" PRIu32 " %8s %8s %9s\n", s.name, s.stack_bytes, "-", "-", "-");
+            continue;
+        }
+        uint32_t peak = s.stack_bytes > s.min_free ? s.stack_bytes - s.min_free : 0;
+        uint32_t suggest = suggested_stack(s);
+        printf("%-24s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %9" PRIu32 "%s\n", s.name, s.stack_bytes, s.min_free, peak,
+               suggest, s.system ? " (system)" : "");
+        if (!s.system && s.stack_bytes > suggest) reclaimable += (int32_t)(s.stack_bytes - suggest);
+    }
+    printf("stack reclaimable (firmware tasks, margin %d): %" PRId32 " bytes\n", RESMON_STACK_MARGIN_BYTES, reclaimable);
+    printf("heap internal: free=%" PRId32 " min_ever=%" PRId32 " largest_block=%" PRId32 "\n",
+           s_m_heap_free.value(), s_m_heap_min.value(), s_m_heap_largest.value());
+    printf("heap psram:    free=%u min_ever=%" PRId32 "\n", (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+           s_m_psram_min.value());
+}
+
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t resmon_console_handler(int argc, char **argv)
+{
+    if (argc >= 1 && strcmp(argv[0], "sample") == 0) {
+        resource_monitor_sample();
+        printf("sampled\n");
+        return ESP_OK;
+    }
+    if (argc >= 1 && strcmp(argv[0], "map") == 0) {
+        rtos_static_print_map();
+        return ESP_OK;
+    }
+    resource_monitor_print_report();
+    return ESP_OK;
+}
+#endif
+
+void resource_monitor_start()
+{
+    static esp_timer_handle_t s_timer = nullptr;
+    if (s_timer) return;
+    taskENTER_CRITICAL(&s_lock);
+    for (const auto &st : k_system_tasks) {
+        TaskSlot *s = find_or_add_slot(st.name);
+        if (s && !s->handle) { s->system = true; s->stack_bytes = st.stack_bytes; }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    resource_monitor_sample();
+    esp_timer_create_args_t args = {
+        .callback = [](void*){ resource_monitor_sample(); },
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "resmon"
+    };
+    if (esp_timer_create(&args, &s_timer) == ESP_OK) {
+        esp_timer_start_periodic(s_timer, (uint64_t)RESMON_PERIOD_MS * 1000ULL);
+        ESP_LOGI(TAG, "Resource monitor sampling every %d ms (%d tasks tracked, %" PRIu32 " bytes static RTOS objects)",
+                 RESMON_PERIOD_MS, s_slot_count, rtos_static::total_bytes());
+    } else {
+        ESP_LOGW(TAG, "Failed to create resource monitor timer");
+    }
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "resmon", .description = "Stack/heap budget report. Usage: matter resmon [sample|map]", .handler = resmon_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
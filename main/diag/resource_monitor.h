@@ -0,0 +1,33 @@
+/*
+ * Task stack / heap high-water-mark monitor with a memory budget report.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Track a long-lived task created by this firmware. `stack_bytes` is the size passed to
+// xTaskCreate so the budget report can compute used/suggested sizes.
+void resource_monitor_track_task(TaskHandle_t task, const char *name, uint32_t stack_bytes);
+
+// Record the calling task's stack high-water mark. Transient tasks (one-shot workers that
+// vTaskDelete(NULL) themselves) call this right before deleting so their peak is kept.
+void resource_monitor_record_exit(uint32_t stack_bytes);
+
+// Start periodic sampling (RESMON_PERIOD_MS) and register the `resmon` console command.
+void resource_monitor_start();
+
+// Take one sample now (also used by the periodic timer).
+void resource_monitor_sample();
+
+// Print per-task stack usage, suggested sizes and heap minimums to stdout.
+void resource_monitor_print_report();
+
+#ifdef __cplusplus
+}
+#endif
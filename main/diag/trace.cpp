@@ -0,0 +1,150 @@
+/* Trace-event recorder: RAM ring + console dump (convert with tools/trace2chrome.py). */
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#if CONFIG_ENABLE_CHIP_SHELL
+#include <esp_matter_console.h>
+#endif
+
+static const char *TAG = "trace";
+
+bool g_trace_on = false;
+
+namespace {
+
+struct Event {
+    uint32_t ts_us;       // esp_timer time, low 32 bits (wraps after ~71 min; the converter unwraps)
+    const char *name;
+    uint32_t arg;         // instant/counter value or async id
+    uint8_t tid;          // index into s_threads
+    uint8_t ph;           // TracePhase
+};
+
+struct Thread {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+};
+
+Event *s_ring = nullptr;
+uint32_t s_head = 0;      // next write position (monotonic; index = head % TRACE_RING_EVENTS)
+uint32_t s_dropped_threads = 0;
+Thread s_threads[TRACE_MAX_THREADS]; // slot 0 is "isr"
+uint8_t s_thread_count = 1;
+portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Caller holds s_lock. Task names are copied on first sight so deleted tasks still dump by name.
+uint8_t thread_index(TaskHandle_t h)
+{
+    for (uint8_t i = 1; i < s_thread_count; i++) {
+        if (s_threads[i].handle == h) return i;
+    }
+    if (s_thread_count >= TRACE_MAX_THREADS) { s_dropped_threads++; return 0; }
+    Thread &t = s_threads[s_thread_count];
+    t.handle = h;
+    const char *n = pcTaskGetName(h);
+    strncpy(t.name, n ? n : "?", sizeof(t.name) - 1);
+    t.name[sizeof(t.name) - 1] = '\0';
+    return s_thread_count++;
+}
+
+} // namespace
+
+void trace_record(TracePhase ph, const char *name, uint32_t arg)
+{
+    if (!s_ring) return;
+    uint32_t ts = (uint32_t)esp_timer_get_time();
+    if (xPortInIsrContext()) {
+        taskENTER_CRITICAL_ISR(&s_lock);
+        Event &e = s_ring[s_head++ % TRACE_RING_EVENTS];
+        e = Event{ ts, name, arg, 0, (uint8_t)ph };
+        taskEXIT_CRITICAL_ISR(&s_lock);
+        return;
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    taskENTER_CRITICAL(&s_lock);
+    Event &e = s_ring[s_head++ % TRACE_RING_EVENTS];
+    e = Event{ ts, name, arg, thread_index(self), (uint8_t)ph };
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t trace_start()
+{
+    if (!s_ring) {
+        s_ring = static_cast<Event *>(calloc(TRACE_RING_EVENTS, sizeof(Event)));
+        if (!s_ring) return ESP_ERR_NO_MEM;
+        strncpy(s_threads[0].name, "isr", sizeof(s_threads[0].name) - 1);
+    }
+    __atomic_store_n(&g_trace_on, true, __ATOMIC_RELAXED);
+    ESP_LOGI(TAG, "Recording (%d events, %u bytes)", TRACE_RING_EVENTS, (unsigned)(TRACE_RING_EVENTS * sizeof(Event)));
+    return ESP_OK;
+}
+
+void trace_stop() { __atomic_store_n(&g_trace_on, false, __ATOMIC_RELAXED); }
+
+bool trace_enabled() { return __atomic_load_n(&g_trace_on, __ATOMIC_RELAXED); }
+
+void trace_clear()
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_head = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void trace_dump()
+{
+    if (!s_ring) { printf("trace: nothing recorded (matter trace start)\n"); return; }
+    bool was_on = trace_enabled();
+    trace_stop();
+    uint32_t head = s_head;
+    uint32_t n = head < TRACE_RING_EVENTS ? head : TRACE_RING_EVENTS;
+    // Format (parsed by tools/trace2chrome.py):
+    //   N,<tid>,<thread name>
+    //   E,<ts_us>,<phase>,<tid>,<arg>,<name>
+    printf("=== TRACE BEGIN events=%" PRIu32 " overwritten=%" PRIu32 " ===\n", n, head - n);
+    for (uint8_t i = 0; i < s_thread_count; i++) printf("N,%u,%s\n", i, s_threads[i].name);
+    for (uint32_t k = head - n; k != head; k++) {
+        const Event &e = s_ring[k % TRACE_RING_EVENTS];
+        printf("E,%" PRIu32 ",%c,%u,%" PRIu32 ",%s\n", e.ts_us, (char)e.ph, e.tid, e.arg, e.name ? e.name : "?");
+    }
+    printf("=== TRACE END ===\n");
+    if (s_dropped_threads) printf("trace: %" PRIu32 " events from untracked threads attributed to tid 0\n", s_dropped_threads);
+    if (was_on) __atomic_store_n(&g_trace_on, true, __ATOMIC_RELAXED);
+}
+
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t trace_console_handler(int argc, char **argv)
+{
+    const char *sub = argc >= 1 ? argv[0] : "";
+    if (strcmp(sub, "start") == 0) {
+        if (trace_start() != ESP_OK) printf("trace: out of memory\n");
+    } else if (strcmp(sub, "stop") == 0) {
+        trace_stop();
+    } else if (strcmp(sub, "clear") == 0) {
+        trace_clear();
+    } else if (strcmp(sub, "dump") == 0) {
+        trace_dump();
+    } else {
+        printf("trace %s, %" PRIu32 " events recorded. Usage: matter trace start|stop|clear|dump\n",
+               trace_enabled() ? "on" : "off", s_head < TRACE_RING_EVENTS ? s_head : (uint32_t)TRACE_RING_EVENTS);
+    }
+    return ESP_OK;
+}
+#endif
+
+void trace_register_console()
+{
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "trace", .description = "Event trace ring. Usage: matter trace start|stop|clear|dump", .handler = trace_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
@@ -0,0 +1,57 @@
+/*
+ * Lightweight trace-event recorder (RAM ring, runtime on/off).
+ *
+ * Events are Chrome Trace phases: duration begin/end (B/E), instant (i), async begin/end
+ * (b/e, matched by id across callbacks/threads) and counters (C). Names must be string
+ * literals (only the pointer is stored). `matter trace dump` prints the ring between
+ * TRACE BEGIN/END markers; tools/trace2chrome.py turns a captured log into Chrome /
+ * Perfetto JSON.
+ *
+ * Recording costs one relaxed load while stopped; the macros compile out with TRACE_ENABLE=0.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+#include "app_config.h"
+
+enum class TracePhase : uint8_t { Begin = 'B', End = 'E', Instant = 'i', AsyncBegin = 'b', AsyncEnd = 'e', Counter = 'C' };
+
+// Allocate the ring (TRACE_RING_EVENTS) on first use and start recording.
+esp_err_t trace_start();
+void trace_stop();
+void trace_clear();
+bool trace_enabled();
+// Print the ring (oldest first) to stdout. Recording is paused while dumping.
+void trace_dump();
+// Register the `trace` console command (no-op without CONFIG_ENABLE_CHIP_SHELL).
+void trace_register_console();
+
+// Task, esp_timer or ISR context. Prefer the macros below.
+void trace_record(TracePhase ph, const char * name, uint32_t arg);
+
+#if TRACE_ENABLE
+extern bool g_trace_on;
+#define TRACE_EVENT_(ph, name, arg) do { if (__atomic_load_n(&g_trace_on, __ATOMIC_RELAXED)) trace_record((ph), (name), (uint32_t)(arg)); } while (0)
+#else
+#define TRACE_EVENT_(ph, name, arg) do { } while (0)
+#endif
+
+#define TRACE_BEGIN(name)              TRACE_EVENT_(TracePhase::Begin, name, 0)
+#define TRACE_END(name)                TRACE_EVENT_(TracePhase::End, name, 0)
+#define TRACE_INSTANT(name, arg)       TRACE_EVENT_(TracePhase::Instant, name, arg)
+#define TRACE_ASYNC_BEGIN(name, id)    TRACE_EVENT_(TracePhase::AsyncBegin, name, (uintptr_t)(id))
+#define TRACE_ASYNC_END(name, id)      TRACE_EVENT_(TracePhase::AsyncEnd, name, (uintptr_t)(id))
+#define TRACE_COUNTER(name, value)     TRACE_EVENT_(TracePhase::Counter, name, value)
+
+// Begin/end pair for the enclosing C++ scope.
+struct TraceScope {
+    explicit TraceScope(const char * name) : mName(name) { TRACE_BEGIN(mName); }
+    ~TraceScope() { TRACE_END(mName); }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope & operator=(const TraceScope &) = delete;
+    const char * mName;
+};
+#define TRACE_CAT2_(a, b) a##b
+#define TRACE_CAT_(a, b) TRACE_CAT2_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CAT_(_trace_scope_, __LINE__)(name)
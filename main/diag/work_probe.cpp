@@ -0,0 +1,135 @@
+/* Matter work-queue latency probe (per-source queue delay / execution time histograms). */
+#include "work_probe.h"
+
+#include <atomic>
+#include <inttypes.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "app_config.h"
+#include "metrics.h"
+#include "trace.h"
+
+static const char *TAG = "work_probe";
+
+namespace {
+
+struct Slot {
+    std::atomic<bool> busy{false};
+    chip::DeviceLayer::AsyncWorkFunct fn;
+    intptr_t arg;
+    int64_t enqueue_us;
+    WorkSource src;
+};
+
+struct SourceStats {
+    metrics::Histogram delay;
+    metrics::Histogram exec;
+    metrics::Counter over_budget;
+    int64_t last_warn_us;
+};
+
+constexpr uint32_t k_exec_buckets_us[] = { 100, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+
+const char * const k_source_names[] = { "toggle", "sensor", "binding", "contact", "ledsync", "diag", "switch" };
+static_assert(sizeof(k_source_names) / sizeof(k_source_names[0]) == (size_t)WorkSource::Count,
+              "k_source_names must cover every WorkSource");
+// Trace slice names (string literals: the trace ring stores pointers only).
+const char * const k_trace_names[] = { "wq.toggle", "wq.sensor", "wq.binding", "wq.contact", "wq.ledsync", "wq.diag", "wq.switch" };
+static_assert(sizeof(k_trace_names) / sizeof(k_trace_names[0]) == (size_t)WorkSource::Count,
+              "k_trace_names must cover every WorkSource");
+
+#define WQ_SOURCE_STATS(n) { { "wq." n ".delay_us", metrics::kLatencyBucketsUs }, \
+                             { "wq." n ".exec_us", k_exec_buckets_us }, metrics::Counter("wq." n ".over_budget"), 0 }
+SourceStats s_stats[] = {
+    WQ_SOURCE_STATS("toggle"), WQ_SOURCE_STATS("sensor"), WQ_SOURCE_STATS("binding"),
+    WQ_SOURCE_STATS("contact"), WQ_SOURCE_STATS("ledsync"), WQ_SOURCE_STATS("diag"), WQ_SOURCE_STATS("switch"),
+};
+#undef WQ_SOURCE_STATS
+static_assert(sizeof(s_stats) / sizeof(s_stats[0]) == (size_t)WorkSource::Count, "s_stats must cover every WorkSource");
+
+Slot s_slots[WORK_PROBE_SLOTS];
+metrics::Gauge s_m_inflight("wq.inflight");
+metrics::Gauge s_m_inflight_peak("wq.inflight_peak");
+metrics::Counter s_m_untracked("wq.untracked");
+metrics::Counter s_m_rejected("wq.rejected");
+
+constexpr int64_t k_warn_interval_us = 1000000; // at most one over-budget log per source per second
+
+int claim_slot()
+{
+    for (int i = 0; i < WORK_PROBE_SLOTS; i++) {
+        bool expected = false;
+        if (s_slots[i].busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) return i;
+    }
+    return -1;
+}
+
+void trampoline(intptr_t idx)
+{
+    Slot & slot = s_slots[idx];
+    auto fn = slot.fn;
+    intptr_t arg = slot.arg;
+    WorkSource src = slot.src;
+    int64_t start = esp_timer_get_time();
+    int64_t enqueued = slot.enqueue_us;
+    slot.busy.store(false, std::memory_order_release);
+    s_m_inflight.sub(1);
+
+    TRACE_BEGIN(k_trace_names[(size_t)src]);
+    fn(arg);
+    TRACE_END(k_trace_names[(size_t)src]);
+
+    int64_t end = esp_timer_get_time();
+    SourceStats & st = s_stats[(size_t)src];
+    st.delay.record((uint32_t)(start - enqueued));
+    uint32_t exec_us = (uint32_t)(end - start);
+    st.exec.record(exec_us);
+    if (exec_us > WORK_PROBE_EXEC_BUDGET_US) {
+        st.over_budget.inc();
+        if (end - st.last_warn_us > k_warn_interval_us) {
+            st.last_warn_us = end;
+            ESP_LOGW(TAG, "%s job held Matter thread %" PRIu32 " us (budget %d us, queued %" PRId64 " us)",
+                     k_source_names[(size_t)src], exec_us, WORK_PROBE_EXEC_BUDGET_US, start - enqueued);
+        }
+    }
+}
+
+} // namespace
+
+const char * work_probe_source_name(WorkSource src)
+{
+    return (size_t)src < (size_t)WorkSource::Count ? k_source_names[(size_t)src] : "?";
+}
+
+esp_err_t work_probe_schedule(WorkSource src, chip::DeviceLayer::AsyncWorkFunct fn, intptr_t arg)
+{
+    if (!fn || (size_t)src >= (size_t)WorkSource::Count) return ESP_ERR_INVALID_ARG;
+    int idx = claim_slot();
+    if (idx < 0) {
+        // Pool exhausted: still run the job, just without timing.
+        s_m_untracked.inc();
+        if (chip::DeviceLayer::PlatformMgr().ScheduleWork(fn, arg) != CHIP_NO_ERROR) {
+            s_m_rejected.inc();
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+    Slot & slot = s_slots[idx];
+    slot.fn = fn;
+    slot.arg = arg;
+    slot.src = src;
+    slot.enqueue_us = esp_timer_get_time();
+    s_m_inflight.add(1);
+    int32_t depth = s_m_inflight.value();
+    if (depth > s_m_inflight_peak.value()) s_m_inflight_peak.set(depth);
+    TRACE_COUNTER("wq.inflight", depth);
+    if (chip::DeviceLayer::PlatformMgr().ScheduleWork(trampoline, (intptr_t)idx) != CHIP_NO_ERROR) {
+        s_m_inflight.sub(1);
+        slot.busy.store(false, std::memory_order_release);
+        s_m_rejected.inc();
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,32 @@
+/*
+ * Matter work-queue latency probe.
+ *
+ * Drop-in wrapper for chip::DeviceLayer::PlatformMgr().ScheduleWork() that tags each
+ * job with its source and enqueue time, then records per-source queue delay and
+ * execution time histograms (`wq.<source>.delay_us` / `wq.<source>.exec_us`).
+ * Jobs that hold the Matter thread longer than WORK_PROBE_EXEC_BUDGET_US are counted
+ * (`wq.<source>.over_budget`) and logged.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+#include <platform/PlatformManager.h>
+
+enum class WorkSource : uint8_t {
+    ButtonToggle = 0,  // press -> Toggle dispatch
+    SensorReport,      // DHT22 temperature / humidity attribute reports
+    BindingRefresh,    // binding table import, deferred commit
+    ContactSensor,     // garage door contact sensor / lock state updates
+    LedSync,           // periodic LED state sync reads
+    Diagnostics,       // metrics cluster refresh and other housekeeping
+    SwitchEvent,       // Generic Switch press events (after the press's own dispatch)
+    Count
+};
+
+// Schedule `fn(arg)` on the Matter thread. Safe from any task or esp_timer callback (not ISRs).
+// Returns ESP_FAIL if the Matter work queue rejected the job.
+esp_err_t work_probe_schedule(WorkSource src, chip::DeviceLayer::AsyncWorkFunct fn, intptr_t arg = 0);
+
+// Short name used in metric names and logs ("toggle", "sensor", ...).
+const char * work_probe_source_name(WorkSource src);
@@ -0,0 +1,148 @@
+/*
+ * Compile-time channel configuration for 1..16 gangs.
+ *
+ * The pin tables come from BUTTON_GPIO_n / LED_GPIO_n (app_config.h); the register masks and the
+ * gather (input register bits -> channel bits) / scatter (channel bits -> output register bits)
+ * are constexpr and unrolled, so a button poll is one input-register read and an LED update one
+ * set + one clear write regardless of LIGHT_CHANNELS. When the pins of all channels are
+ * consecutive, gather and scatter reduce to a shift and a mask. With BUTTON_IO set to an expander
+ * only the LED half applies; buttons are read by io_expander.h.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+#include "app_config.h"
+
+static_assert(LIGHT_CHANNELS >= 1 && LIGHT_CHANNELS <= 16, "LIGHT_CHANNELS must be 1..16");
+
+namespace channels {
+
+constexpr int kCount = LIGHT_CHANNELS;
+constexpr uint32_t kChannelMask = (1u << kCount) - 1u;
+
+using PinTable = gpio_num_t[16];
+constexpr PinTable kButtonPins = {
+    BUTTON_GPIO_0,  BUTTON_GPIO_1,  BUTTON_GPIO_2,  BUTTON_GPIO_3,  BUTTON_GPIO_4,  BUTTON_GPIO_5,
+    BUTTON_GPIO_6,  BUTTON_GPIO_7,  BUTTON_GPIO_8,  BUTTON_GPIO_9,  BUTTON_GPIO_10, BUTTON_GPIO_11,
+    BUTTON_GPIO_12, BUTTON_GPIO_13, BUTTON_GPIO_14, BUTTON_GPIO_15,
+};
+constexpr PinTable kLedPins = {
+    LED_GPIO_0,  LED_GPIO_1,  LED_GPIO_2,  LED_GPIO_3,  LED_GPIO_4,  LED_GPIO_5,  LED_GPIO_6,  LED_GPIO_7,
+    LED_GPIO_8,  LED_GPIO_9,  LED_GPIO_10, LED_GPIO_11, LED_GPIO_12, LED_GPIO_13, LED_GPIO_14, LED_GPIO_15,
+};
+
+constexpr uint64_t pin_mask(const PinTable & pins)
+{
+    uint64_t m = 0;
+    for (int i = 0; i < kCount; i++)
+        if (pins[i] != GPIO_NUM_NC) m |= 1ULL << pins[i];
+    return m;
+}
+
+constexpr uint32_t wired_channels(const PinTable & pins)
+{
+    uint32_t m = 0;
+    for (int i = 0; i < kCount; i++)
+        if (pins[i] != GPIO_NUM_NC) m |= 1u << i;
+    return m;
+}
+
+constexpr bool pins_valid(const PinTable & pins)
+{
+    for (int i = 0; i < kCount; i++) {
+        if (pins[i] == GPIO_NUM_NC) continue;
+        if (pins[i] < 0 || pins[i] >= SOC_GPIO_PIN_COUNT) return false;
+        for (int j = 0; j < i; j++)
+            if (pins[j] == pins[i]) return false;
+    }
+    return true;
+}
+
+// Channel i sits on pin first + i for every channel (and none is unconnected).
+constexpr bool contiguous(const PinTable & pins)
+{
+    for (int i = 0; i < kCount; i++)
+        if (pins[i] == GPIO_NUM_NC || pins[i] != pins[0] + i) return false;
+    return true;
+}
+
+#if BUTTON_IO == BUTTON_IO_GPIO
+constexpr uint64_t kButtonMask = pin_mask(kButtonPins);
+constexpr uint32_t kButtonChannels = wired_channels(kButtonPins);
+static_assert(pins_valid(kButtonPins), "BUTTON_GPIO_n out of range or duplicated");
+#else
+// Buttons sit on the I/O expander (io_expander.h): no button GPIOs, every channel has an input.
+constexpr uint64_t kButtonMask = 0;
+constexpr uint32_t kButtonChannels = kChannelMask;
+#endif
+constexpr uint64_t kLedMask = pin_mask(kLedPins);
+constexpr uint32_t kLedChannels = wired_channels(kLedPins);
+
+static_assert(pins_valid(kLedPins), "LED_GPIO_n out of range or duplicated");
+static_assert((kButtonMask & kLedMask) == 0, "a pin is used as both button and LED");
+
+namespace detail {
+constexpr unsigned shift(gpio_num_t pin) { return pin == GPIO_NUM_NC ? 0u : (unsigned)pin; }
+constexpr uint32_t wired(gpio_num_t pin) { return pin == GPIO_NUM_NC ? 0u : 1u; }
+template <size_t... I>
+constexpr uint32_t gather(uint64_t reg, const PinTable & pins, std::index_sequence<I...>)
+{
+    return (0u | ... | (((uint32_t)(reg >> shift(pins[I])) & wired(pins[I])) << I));
+}
+template <size_t... I>
+constexpr uint64_t scatter(uint32_t bits, const PinTable & pins, std::index_sequence<I...>)
+{
+    return (0ULL | ... | ((uint64_t)((bits >> I) & wired(pins[I])) << shift(pins[I])));
+}
+} // namespace detail
+
+// Input register bits -> channel bits (bit i = level of button i).
+constexpr uint32_t button_bits(uint64_t reg)
+{
+    if constexpr (contiguous(kButtonPins)) return (uint32_t)(reg >> kButtonPins[0]) & kChannelMask;
+    else return detail::gather(reg, kButtonPins, std::make_index_sequence<kCount>{});
+}
+
+// Channel bits -> output register bits of their LEDs.
+constexpr uint64_t led_reg_bits(uint32_t bits)
+{
+    if constexpr (contiguous(kLedPins)) return (uint64_t)(bits & kChannelMask) << kLedPins[0];
+    else return detail::scatter(bits, kLedPins, std::make_index_sequence<kCount>{});
+}
+
+// All input levels in one read (two on parts with more than 32 GPIOs and a button above 31).
+inline uint64_t read_inputs()
+{
+    uint64_t v = (uint32_t)REG_READ(GPIO_IN_REG);
+#if SOC_GPIO_PIN_COUNT > 32
+    if constexpr ((kButtonMask >> 32) != 0) v |= (uint64_t)(uint32_t)REG_READ(GPIO_IN1_REG) << 32;
+#endif
+    return v;
+}
+
+// Channels whose button is held right now (active low, pull-ups); unwired channels read released.
+inline uint32_t read_pressed() { return button_bits(~read_inputs()) & kButtonChannels; }
+
+// Drive the LEDs of the channels in `touch` to the matching bits of `on` with one set and one clear
+// write per register bank. Channels outside `touch` (and unwired ones) are left alone.
+inline void write_leds(uint32_t on, uint32_t touch = kChannelMask)
+{
+    uint64_t set = led_reg_bits(on & touch);
+    uint64_t clr = led_reg_bits(~on & touch);
+    if ((uint32_t)set) REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)set);
+    if ((uint32_t)clr) REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)clr);
+#if SOC_GPIO_PIN_COUNT > 32
+    if constexpr ((kLedMask >> 32) != 0) {
+        if (set >> 32) REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(set >> 32));
+        if (clr >> 32) REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(clr >> 32));
+    }
+#endif
+}
+
+} // namespace channels
@@ -0,0 +1,49 @@
+/*
+ * Minimal C++20 coroutines for the Matter transports (light_sync.cpp, fanout_transport.cpp).
+ *
+ * A transport operation is one coroutine returning coro::Task. It co_awaits its session, then its
+ * read or invoke (matter_await.h), and reports the outcome at its end. Before, the same operation was
+ * split across heap-allocated callback objects with their cleanup on every path. A Task is
+ * fire-and-forget: the body runs at once up to its first suspension, and the frame frees itself when
+ * the body returns. Frames come from the fixed pool (frame_pool.h). When the pool is exhausted the
+ * body never runs and the Task tests false, so the caller fails the operation right away.
+ *
+ * Nothing cancels a Task, so every awaitable must resume its coroutine exactly once. The Matter
+ * clients guarantee this: they always end with OnDone, or with a failure callback.
+ *
+ * Requires C++20 (main/CMakeLists.txt builds the files using it as gnu++20). Not thread safe:
+ * coroutines start and resume on the Matter thread only.
+ */
+#pragma once
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "frame_pool.h"
+
+namespace coro {
+
+class [[nodiscard]] Task {
+public:
+    struct promise_type {
+        static void * operator new(size_t n) noexcept { return coro_frame_alloc(n); }
+        static void operator delete(void * p) noexcept { coro_frame_free(p); }
+        static Task get_return_object_on_allocation_failure() noexcept { return Task(false); }
+
+        Task get_return_object() noexcept { return Task(true); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { abort(); }
+    };
+
+    // False if no frame was available: the body never ran.
+    explicit operator bool() const { return m_started; }
+
+private:
+    explicit Task(bool started) : m_started(started) {}
+    bool m_started;
+};
+
+} // namespace coro
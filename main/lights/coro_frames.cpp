@@ -0,0 +1,43 @@
+/* Frame pool of the transport coroutines (coro.h): LIGHT_CORO_FRAMES blocks of LIGHT_CORO_FRAME_BYTES, with metrics. */
+#include "frame_pool.h"
+#include "app_config.h"
+#include <esp_log.h>
+#include "diag/metrics.h"
+
+static const char * TAG = "coro";
+
+static FramePool<LIGHT_CORO_FRAMES, LIGHT_CORO_FRAME_BYTES> s_frames;
+
+static metrics::Gauge s_m_frames("coro.frames");
+static metrics::Gauge s_m_frames_peak("coro.frames_peak");
+static metrics::Gauge s_m_frame_max("coro.frame_bytes_max");
+static metrics::Counter s_m_refused("coro.frames_refused");
+static metrics::Counter s_m_oversize("coro.frames_oversize");
+
+void * coro_frame_alloc(size_t n)
+{
+    void * p = s_frames.alloc(n);
+    s_m_frame_max.set((int32_t)s_frames.largest());
+    if (!p && n > LIGHT_CORO_FRAME_BYTES) {
+        // A build whose frames outgrew the blocks: every such operation fails until
+        // LIGHT_CORO_FRAME_BYTES is raised to at least coro.frame_bytes_max.
+        s_m_oversize.inc();
+        ESP_LOGE(TAG, "frame of %u B exceeds LIGHT_CORO_FRAME_BYTES (%u): raise it", (unsigned)n, (unsigned)LIGHT_CORO_FRAME_BYTES);
+        return nullptr;
+    }
+    if (!p) {
+        s_m_refused.inc();
+        ESP_LOGW(TAG, "frame of %u B refused (%d/%d in use, %u B each)", (unsigned)n, s_frames.in_use(), LIGHT_CORO_FRAMES,
+                 (unsigned)LIGHT_CORO_FRAME_BYTES);
+        return nullptr;
+    }
+    s_m_frames.set(s_frames.in_use());
+    s_m_frames_peak.set(s_frames.peak());
+    return p;
+}
+
+void coro_frame_free(void * p)
+{
+    if (!s_frames.free(p)) ESP_LOGE(TAG, "free of unknown frame %p", p);
+    s_m_frames.set(s_frames.in_use());
+}
@@ -0,0 +1,69 @@
+/*
+ * Vertical-counter button debounce for up to 32 channels.
+ *
+ * Each channel's "polls since the level last changed" counter is stored bit-sliced across
+ * kBits words (bit i of every plane belongs to channel i), so one step updates all channels with a
+ * handful of word operations instead of a loop over channels. The counter saturates at kStable;
+ * a press is reported on the poll where a held (low) level reaches kStable, i.e. after kStable + 1
+ * identical samples, matching the per-channel counters this replaces. A release is reported the
+ * same way, once per reported press.
+ */
+#pragma once
+
+#include <stdint.h>
+
+template <unsigned kStable>
+class VerticalDebounce {
+    static_assert(kStable >= 1 && kStable < 256, "stable count must be 1..255");
+
+    static constexpr unsigned bits_for(unsigned v) { return v ? 1 + bits_for(v >> 1) : 0; }
+    static constexpr unsigned kBits = bits_for(kStable);
+
+public:
+    void reset()
+    {
+        for (uint32_t & p : m_planes) p = 0;
+        m_held = 0;
+        m_down = 0;
+        m_released = 0;
+    }
+
+    // `held`: bit i set when channel i reads pressed on this poll. Returns the channels whose press
+    // became stable on this poll.
+    uint32_t step(uint32_t held)
+    {
+        uint32_t changed = held ^ m_held;
+        m_held = held;
+        uint32_t inc = ~changed & ~equals_stable();
+        uint32_t carry = inc;
+        for (unsigned k = 0; k < kBits; k++) {
+            uint32_t next = m_planes[k] & carry;
+            m_planes[k] = (m_planes[k] ^ carry) & ~changed;
+            carry = next;
+        }
+        uint32_t settled = equals_stable() & inc;
+        m_released = settled & ~m_held & m_down;
+        m_down = (m_down | (settled & m_held)) & ~m_released;
+        return settled & m_held;
+    }
+
+    // Channels that read pressed on the last step.
+    uint32_t held() const { return m_held; }
+    // Channels whose release became stable on the last step (only after a reported press).
+    uint32_t released() const { return m_released; }
+    // Channels with a reported press and no stable release yet.
+    uint32_t down() const { return m_down; }
+
+private:
+    uint32_t equals_stable() const
+    {
+        uint32_t eq = ~0u;
+        for (unsigned k = 0; k < kBits; k++) eq &= ((kStable >> k) & 1u) ? m_planes[k] : ~m_planes[k];
+        return eq;
+    }
+
+    uint32_t m_planes[kBits] = {};
+    uint32_t m_held = 0;
+    uint32_t m_down = 0;
+    uint32_t m_released = 0;
+};
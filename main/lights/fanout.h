@@ -0,0 +1,181 @@
+/*
+ * Fan-out scheduler for a press's unicast commands.
+ *
+ * The binding manager sends to every unicast binding at once, in binding-table order, each with its
+ * own CASE setup. On a large channel that can exhaust the CHIP exchange and session pools. Instead
+ * the light manager queues one item per target here, and the scheduler releases them under two caps:
+ * LIGHT_FANOUT_MAX_INFLIGHT exchanges in flight (session setup included), of which at most
+ * LIGHT_FANOUT_MAX_CASE are to targets without a session. Each finished exchange releases the next
+ * item, so the pipeline stays full.
+ *
+ * Order: slowest expected exchange first (RTT EWMA from the health table, about three RTTs for a
+ * target that still needs CASE; unknown counts as slowest). Under a concurrency cap, starting the
+ * longest exchanges first shortens the time until the last light has answered (longest-processing-
+ * time rule); the fast ones fill the slots the slow ones leave. Items of later presses join the same
+ * ordering. The caller's batch (one per dispatch) records that time.
+ *
+ * Fixed tables, no allocation. Not thread safe: the light manager only touches it on the Matter thread.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+#include "light_manager.h" // MAX_SHADOW_BINDINGS_PER_CH (LIGHT_FANOUT_QUEUE default)
+
+struct FanoutItem {
+    uint64_t node_id;
+    intptr_t txn;    // press transaction the outcome is reported to
+    uint32_t cmd;    // OnOff command id
+    uint32_t est_us; // expected exchange time (sort key)
+    uint16_t endpoint;
+    uint8_t fabric_index;
+    bool cold;       // no session yet: the exchange includes CASE setup
+    uint8_t batch;   // set by push()
+    uint8_t batch_gen;
+    bool deferred;   // held back by the CASE cap at least once (counted once in cold_deferred())
+};
+
+class FanoutScheduler {
+public:
+    static constexpr intptr_t kNone = 0;
+    static constexpr uint32_t kUnknownUs = UINT32_MAX;
+
+    void reset()
+    {
+        m_head = 0;
+        m_queued = 0;
+        for (Slot & s : m_slots) s.used = false;
+        for (Batch & b : m_batches) b.left = 0;
+        m_cold = 0;
+        m_inflight = 0;
+    }
+
+    // Expected exchange time for sorting: the RTT EWMA (0 = unknown), about three RTTs with CASE.
+    static uint32_t estimate(uint32_t rtt_ewma_us, bool cold)
+    {
+        if (!rtt_ewma_us) return kUnknownUs;
+        return cold ? (rtt_ewma_us > kUnknownUs / 4 ? kUnknownUs - 1 : rtt_ewma_us * 3) : rtt_ewma_us;
+    }
+
+    // Open a batch (one dispatch) started at now_us; its items are pushed with it.
+    uint8_t begin_batch(int64_t now_us)
+    {
+        uint8_t idx = 0;
+        for (uint8_t i = 0; i < kBatches; i++) {
+            if (!m_batches[i].left) {
+                idx = i;
+                break;
+            }
+            if (m_batches[i].start_us < m_batches[idx].start_us) idx = i; // all busy: reuse the oldest, unrecorded
+        }
+        m_batches[idx] = Batch{ now_us, 0, (uint8_t)(m_batches[idx].gen + 1) };
+        return idx;
+    }
+
+    // Queue `it` by its estimate (slowest first; equal estimates keep push order). False if full.
+    bool push(FanoutItem it, uint8_t batch)
+    {
+        if (m_queued >= kQueue) return false;
+        it.batch = batch;
+        it.deferred = false;
+        it.batch_gen = batch < kBatches ? m_batches[batch].gen : 0;
+        if (m_head + m_queued == kQueue) { // room is at the front: slide the queue down
+            for (int i = 0; i < m_queued; i++) m_queue[i] = m_queue[m_head + i];
+            m_head = 0;
+        }
+        int pos = m_head + m_queued;
+        while (pos > m_head && m_queue[pos - 1].est_us < it.est_us) {
+            m_queue[pos] = m_queue[pos - 1];
+            pos--;
+        }
+        m_queue[pos] = it;
+        m_queued++;
+        if (batch < kBatches) m_batches[batch].left++;
+        return true;
+    }
+
+    // Take the next item allowed to start: the first queued one that fits the caps. Returns its
+    // token (kNone: nothing can start now).
+    intptr_t start_next(FanoutItem * out)
+    {
+        if (m_inflight >= kMaxInflight) return kNone;
+        int pick = -1;
+        for (int i = m_head; i < m_head + m_queued; i++) {
+            if (m_queue[i].cold && m_cold >= kMaxCase) { // held back by the CASE cap; a warm one behind it goes first
+                if (!m_queue[i].deferred) m_cold_deferred++;
+                m_queue[i].deferred = true;
+                continue;
+            }
+            pick = i;
+            break;
+        }
+        if (pick < 0) return kNone;
+        int idx = 0;
+        while (m_slots[idx].used) idx++;
+        Slot & s = m_slots[idx];
+        s.used = true;
+        if (++m_gen == 0) m_gen = 1;
+        s.gen = m_gen;
+        s.item = m_queue[pick];
+        for (int i = pick; i > m_head; i--) m_queue[i] = m_queue[i - 1]; // close the gap from the front
+        m_head = --m_queued ? m_head + 1 : 0;
+        m_inflight++;
+        m_cold += s.item.cold;
+        *out = s.item;
+        return ((intptr_t)s.gen << 8) | idx;
+    }
+
+    // One started item finished. `*batch_start_us` is its batch's start time once this was the
+    // batch's last item, else -1. False for an unknown token.
+    bool finish(intptr_t token, FanoutItem * out, int64_t * batch_start_us)
+    {
+        int idx = (int)(token & 0xFF);
+        *batch_start_us = -1;
+        if (token == kNone || idx >= kMaxInflight) return false;
+        Slot & s = m_slots[idx];
+        if (!s.used || s.gen != (uint16_t)(token >> 8)) return false;
+        s.used = false;
+        m_inflight--;
+        m_cold -= s.item.cold;
+        *out = s.item;
+        if (s.item.batch < kBatches) {
+            Batch & b = m_batches[s.item.batch];
+            if (b.gen == s.item.batch_gen && b.left && --b.left == 0) *batch_start_us = b.start_us;
+        }
+        return true;
+    }
+
+    int inflight() const { return m_inflight; }
+    int queued() const { return m_queued; }
+    uint32_t cold_deferred() const { return m_cold_deferred; } // items the CASE cap held back, each once
+
+private:
+    static constexpr int kMaxInflight = LIGHT_FANOUT_MAX_INFLIGHT;
+    static constexpr int kMaxCase = LIGHT_FANOUT_MAX_CASE;
+    static constexpr int kQueue = LIGHT_FANOUT_QUEUE;
+    static constexpr uint8_t kBatches = LIGHT_PRESS_TXN_MAX;
+    static_assert(kMaxInflight >= 1 && kMaxInflight <= 255, "LIGHT_FANOUT_MAX_INFLIGHT must be 1..255");
+    static_assert(kMaxCase >= 1 && kMaxCase <= kMaxInflight, "LIGHT_FANOUT_MAX_CASE must be 1..LIGHT_FANOUT_MAX_INFLIGHT");
+
+    struct Slot {
+        bool used;
+        uint16_t gen;
+        FanoutItem item;
+    };
+    struct Batch {
+        int64_t start_us;
+        uint16_t left; // items queued or in flight
+        uint8_t gen;   // items of a reused batch no longer count
+    };
+
+    FanoutItem m_queue[kQueue] = {};
+    Slot m_slots[kMaxInflight] = {};
+    Batch m_batches[kBatches] = {};
+    int m_head = 0; // queue: m_queue[m_head .. m_head + m_queued), next to start first
+    int m_queued = 0;
+    int m_inflight = 0;
+    int m_cold = 0;
+    uint16_t m_gen = 0;
+    uint32_t m_cold_deferred = 0;
+};
@@ -0,0 +1,87 @@
+/* Press fan-out transport: one OnOff command per call, over the target's CASE session (fanout.h schedules them). */
+#include "light_internal.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <app-common/zap-generated/cluster-objects.h>
+#include <controller/InvokeInteraction.h>
+
+#include "matter_await.h"
+#include "diag/metrics.h"
+#include "diag/trace.h"
+
+static const char * TAG = "fanout_tx";
+
+static metrics::Counter s_m_session_setup("fanout.session_setup");
+static metrics::Counter s_m_session_fail("fanout.session_fail");
+
+namespace {
+using namespace chip::app;
+using namespace chip::app::Clusters;
+
+template <typename F>
+CHIP_ERROR with_payload(uint32_t cmd, F && f)
+{
+    switch (cmd) {
+    case OnOff::Commands::On::Id:
+        return f(OnOff::Commands::On::Type());
+    case OnOff::Commands::Off::Id:
+        return f(OnOff::Commands::Off::Type());
+    case OnOff::Commands::Toggle::Id:
+        return f(OnOff::Commands::Toggle::Type());
+    default:
+        return CHIP_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+uint32_t since(int64_t start_us) { return (uint32_t)(esp_timer_get_time() - start_us); }
+
+// One target: its session lookup / CASE setup, then its command. The scheduler never has more than
+// LIGHT_FANOUT_MAX_INFLIGHT started, and a sync read keeps its slot until its frame ends, even past
+// its timeout (sync_reads.h), so the sync reads cannot take the frames these need (LIGHT_CORO_FRAMES).
+coro::Task unicast(uint8_t fabric_index, uint64_t node_id, uint16_t endpoint, uint32_t cmd, intptr_t token)
+{
+    const int64_t start_us = esp_timer_get_time();
+    TRACE_ASYNC_BEGIN("case.establish", token);
+    coro::SessionResult s = co_await coro::session(fabric_index, node_id);
+    TRACE_ASYNC_END("case.establish", token);
+    if (!s) {
+        s_m_session_fail.inc();
+        ESP_LOGW(TAG, "session to node=0x%016" PRIX64 " failed %" CHIP_ERROR_FORMAT, node_id, s.err.Format());
+        light_fanout_result(token, false, since(start_us));
+        co_return;
+    }
+    if (!s.cached) s_m_session_setup.inc();
+    TRACE_ASYNC_BEGIN("fanout.cmd", token);
+    coro::InvokeResult r = co_await coro::invoke(s, endpoint, OnOff::Id, cmd);
+    TRACE_ASYNC_END("fanout.cmd", token);
+    if (r.err != CHIP_NO_ERROR)
+        ESP_LOGW(TAG, "node=0x%016" PRIX64 " ep=%u: command error %" CHIP_ERROR_FORMAT, node_id, endpoint, r.err.Format());
+    light_fanout_result(token, r.ok(), since(start_us)); // no response at all counts as failed
+}
+} // namespace
+
+bool light_unicast_send(uint8_t fabric_index, uint64_t node_id, uint16_t endpoint, uint32_t cmd, intptr_t token)
+{
+    if (coro::resolve_fabric(fabric_index) == chip::kUndefinedFabricIndex || !chip::Server::GetInstance().GetCASESessionManager())
+        return false;
+    return static_cast<bool>(unicast(fabric_index, node_id, endpoint, cmd, token)); // false: no frame
+}
+
+bool light_session_cached(uint8_t fabric_index, uint64_t node_id)
+{
+    chip::FabricIndex fi = coro::resolve_fabric(fabric_index);
+    if (fi == chip::kUndefinedFabricIndex) return false;
+    return chip::Server::GetInstance().GetSecureSessionManager().FindSecureSessionForNode(chip::ScopedNodeId(node_id, fi)).HasValue();
+}
+
+bool light_group_send(uint8_t fabric_index, uint16_t group_id, uint32_t cmd)
+{
+    chip::Messaging::ExchangeManager * em = InteractionModelEngine::GetInstance()->GetExchangeManager();
+    chip::FabricIndex fi = coro::resolve_fabric(fabric_index);
+    CHIP_ERROR e = fi == chip::kUndefinedFabricIndex ? CHIP_ERROR_INCORRECT_STATE : with_payload(cmd, [&](const auto & payload) {
+        return chip::Controller::InvokeGroupCommandRequest(em, fi, group_id, payload);
+    });
+    if (e != CHIP_NO_ERROR) ESP_LOGW(TAG, "groupcast to 0x%04X failed %" CHIP_ERROR_FORMAT, group_id, e.Format());
+    return e == CHIP_NO_ERROR;
+}
@@ -0,0 +1,69 @@
+/*
+ * Fixed pool of equal-size blocks for coroutine frames (coro.h).
+ *
+ * A coroutine frame holds the coroutine's locals across its suspension points, including the CHIP
+ * client objects its awaitables own (matter_await.h). Taking frames from here rather than the heap
+ * keeps the transports' heap use flat, and running out becomes a counted failure that the caller can
+ * recover from: the coroutine does not start, and the caller fails the operation at once. A frame
+ * bigger than a block is refused the same way. largest() records the biggest request, for sizing
+ * LIGHT_CORO_FRAME_BYTES.
+ *
+ * Not thread safe: frames are only created and freed on the Matter thread.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+template <int kSlots, size_t kBytes>
+class FramePool {
+public:
+    // nullptr if every block is taken or `n` does not fit one.
+    void * alloc(size_t n)
+    {
+        if (n > m_largest) m_largest = n;
+        if (n > kBytes || m_in_use == kSlots) {
+            m_refused++;
+            return nullptr;
+        }
+        int idx = __builtin_ctz(~m_busy);
+        m_busy |= 1u << idx;
+        if (++m_in_use > m_peak) m_peak = m_in_use;
+        return m_blocks[idx].bytes;
+    }
+
+    // False for a pointer that is not a taken block of this pool.
+    bool free(void * p)
+    {
+        uintptr_t off = (uintptr_t)p - (uintptr_t)m_blocks;
+        int idx = (int)(off / sizeof(Block));
+        if ((uintptr_t)p < (uintptr_t)m_blocks || idx >= kSlots || off % sizeof(Block) || !(m_busy & (1u << idx))) return false;
+        m_busy &= ~(1u << idx);
+        m_in_use--;
+        return true;
+    }
+
+    int in_use() const { return m_in_use; }
+    int peak() const { return m_peak; }
+    uint32_t refused() const { return m_refused; }
+    size_t largest() const { return m_largest; }
+
+private:
+    static_assert(kSlots >= 1 && kSlots <= 32, "LIGHT_CORO_FRAMES must be 1..32");
+
+    struct Block {
+        alignas(alignof(max_align_t)) uint8_t bytes[kBytes];
+    };
+
+    Block m_blocks[kSlots];
+    uint32_t m_busy = kSlots == 32 ? 0 : ~((1u << kSlots) - 1); // blocks past kSlots read as taken
+    int m_in_use = 0;
+    int m_peak = 0;
+    uint32_t m_refused = 0;
+    size_t m_largest = 0;
+};
+
+// The shared pool (LIGHT_CORO_FRAMES blocks of LIGHT_CORO_FRAME_BYTES, coro_frames.cpp) that every
+// coro::Task frame comes from. nullptr: refused.
+void * coro_frame_alloc(size_t n);
+void coro_frame_free(void * p);
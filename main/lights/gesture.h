@@ -0,0 +1,135 @@
+/*
+ * Per-channel button gesture recogniser: single / double / triple press and long press.
+ *
+ * Input is the debounced press and release edges of each channel. Output is a stream of events,
+ * handed to a callback. Nothing waits to find out which gesture is coming:
+ *   Single        first press of a sequence, emitted at the press (the caller acts on it speculatively)
+ *   Multi         press 2 or 3 of the sequence within LIGHT_GESTURE_GAP_MS of the previous release,
+ *                 emitted at the press. It supersedes the earlier presses of the sequence.
+ *   LongStart     the button has been held for LIGHT_GESTURE_LONG_MS
+ *   LongEnd       release after a LongStart
+ *   ShortRelease  release without a LongStart
+ *   Complete      the sequence is over: the gap expired, the last enabled count was reached, or a
+ *                 long press was released. `count` is the final press count.
+ * Counts beyond the highest enabled one (kDouble, kTriple) start a new sequence. Without kLong
+ * there is no LongStart. With nothing enabled every press is Single + ShortRelease + Complete.
+ *
+ * Time is passed in by the caller and poll() fires the timeouts, so the host build can drive it
+ * directly. Not thread safe: owned by the btn_act task.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+struct GestureEvent {
+    enum Kind : uint8_t { Single, Multi, LongStart, LongEnd, ShortRelease, Complete };
+    Kind kind;
+    uint8_t ch;
+    uint8_t count;   // presses in the sequence so far
+    int64_t edge_us; // press / release edge (or the timeout) that produced the event
+};
+
+class GestureRecognizer {
+public:
+    enum : uint8_t { kDouble = 1, kTriple = 2, kLong = 4 };
+
+    void configure(uint8_t enabled, int64_t gap_us, int64_t long_us)
+    {
+        m_enabled = enabled;
+        m_gap_us = gap_us;
+        m_long_us = long_us;
+        m_max = (enabled & kTriple) ? 3 : (enabled & kDouble) ? 2 : 1;
+        reset();
+    }
+    void reset()
+    {
+        for (Chan & c : m_ch) c = Chan{};
+    }
+
+    template <typename F>
+    void press(uint8_t ch, int64_t now_us, F && emit)
+    {
+        if (ch >= LIGHT_CHANNELS) return;
+        Chan & c = m_ch[ch];
+        if (c.down) release(ch, now_us, emit); // the release was too short to debounce, but it ended the press
+        if (c.count && (c.count >= m_max || now_us >= c.release_us + m_gap_us)) complete(ch, now_us, emit); // gap expired before poll() saw it
+        c.down = true;
+        c.long_fired = false;
+        c.press_us = now_us;
+        c.count++;
+        emit(GestureEvent{ c.count == 1 ? GestureEvent::Single : GestureEvent::Multi, ch, c.count, now_us });
+    }
+
+    template <typename F>
+    void release(uint8_t ch, int64_t now_us, F && emit)
+    {
+        if (ch >= LIGHT_CHANNELS || !m_ch[ch].down) return;
+        Chan & c = m_ch[ch];
+        c.down = false;
+        c.release_us = now_us;
+        if (c.long_fired) {
+            emit(GestureEvent{ GestureEvent::LongEnd, ch, c.count, now_us });
+            complete(ch, now_us, emit);
+            return;
+        }
+        emit(GestureEvent{ GestureEvent::ShortRelease, ch, c.count, now_us });
+        if (c.count >= m_max) complete(ch, now_us, emit);
+    }
+
+    // Long-press and gap timeouts due at `now_us`.
+    template <typename F>
+    void poll(int64_t now_us, F && emit)
+    {
+        for (uint8_t ch = 0; ch < LIGHT_CHANNELS; ch++) {
+            Chan & c = m_ch[ch];
+            if (c.down && (m_enabled & kLong) && !c.long_fired && now_us >= c.press_us + m_long_us) {
+                c.long_fired = true;
+                emit(GestureEvent{ GestureEvent::LongStart, ch, c.count, now_us });
+            } else if (!c.down && c.count && now_us >= c.release_us + m_gap_us) {
+                complete(ch, now_us, emit);
+            }
+        }
+    }
+
+    // Next long-press or gap timeout (INT64_MAX if none is pending).
+    int64_t next_deadline_us() const
+    {
+        int64_t d = INT64_MAX;
+        for (const Chan & c : m_ch) {
+            int64_t t = INT64_MAX;
+            if (c.down && (m_enabled & kLong) && !c.long_fired) t = c.press_us + m_long_us;
+            else if (!c.down && c.count) t = c.release_us + m_gap_us;
+            if (t < d) d = t;
+        }
+        return d;
+    }
+
+    // True while channel `ch` is inside a sequence (held, or waiting for the next press).
+    bool active(uint8_t ch) const { return ch < LIGHT_CHANNELS && (m_ch[ch].down || m_ch[ch].count); }
+
+private:
+    struct Chan {
+        uint8_t count = 0;
+        bool down = false;
+        bool long_fired = false;
+        int64_t press_us = 0;
+        int64_t release_us = 0;
+    };
+
+    template <typename F>
+    void complete(uint8_t ch, int64_t now_us, F && emit)
+    {
+        Chan & c = m_ch[ch];
+        uint8_t n = c.count;
+        c.count = 0;
+        if (n) emit(GestureEvent{ GestureEvent::Complete, ch, n, now_us });
+    }
+
+    Chan m_ch[LIGHT_CHANNELS];
+    uint8_t m_enabled = 0;
+    uint8_t m_max = 1;
+    int64_t m_gap_us = 0;
+    int64_t m_long_us = 0;
+};
@@ -0,0 +1,221 @@
+/* MCP23017 (I2C) and 74HC165 (SPI) button input backends, see io_expander.h. */
+#include "io_expander.h"
+
+#if BUTTON_IO != BUTTON_IO_GPIO
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+
+#include "channels.h"
+#include "diag/metrics.h"
+#include "diag/trace.h"
+
+#if BUTTON_IO == BUTTON_IO_MCP23017
+#include <driver/i2c_master.h>
+static_assert(LIGHT_CHANNELS <= 16, "MCP23017 has 16 inputs");
+#elif BUTTON_IO == BUTTON_IO_74HC165
+#include <driver/spi_master.h>
+#else
+#error "unknown BUTTON_IO"
+#endif
+
+static const char * TAG = "iox";
+
+static constexpr uint64_t pin_bit(gpio_num_t pin) { return pin == GPIO_NUM_NC ? 0 : 1ULL << pin; }
+#if BUTTON_IO == BUTTON_IO_MCP23017
+static constexpr uint64_t k_bus_pins = pin_bit(IOX_I2C_SDA_GPIO) | pin_bit(IOX_I2C_SCL_GPIO) | pin_bit(IOX_INT_GPIO);
+#else
+static constexpr uint64_t k_bus_pins = pin_bit(IOX_SPI_SCLK_GPIO) | pin_bit(IOX_SPI_MISO_GPIO) | pin_bit(IOX_SR_LOAD_GPIO) | pin_bit(IOX_INT_GPIO);
+#endif
+static_assert((k_bus_pins & channels::kLedMask) == 0, "an expander pin is also used as an LED");
+
+// Bus transactions are tens to hundreds of microseconds, below the shared latency layout.
+static constexpr uint32_t k_scan_buckets_us[] = { 25, 50, 100, 200, 400, 800, 1600, 5000 };
+static metrics::Histogram s_m_scan_us("iox.scan_us", k_scan_buckets_us);
+static metrics::Counter s_m_scans("iox.scans");
+static metrics::Counter s_m_irqs("iox.irqs");
+static metrics::Counter s_m_errors("iox.errors");
+
+static TaskHandle_t s_notify_task = nullptr;
+static bool s_ready = false;
+
+static void iox_isr(void *)
+{
+    BaseType_t woken = pdFALSE;
+    s_m_irqs.inc();
+    if (s_notify_task) vTaskNotifyGiveFromISR(s_notify_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static esp_err_t int_line_init()
+{
+    if (IOX_INT_GPIO == GPIO_NUM_NC) return ESP_OK;
+    gpio_config_t cfg = {};
+    cfg.pin_bit_mask = pin_bit(IOX_INT_GPIO);
+    cfg.mode = GPIO_MODE_INPUT;
+    cfg.pull_up_en = GPIO_PULLUP_ENABLE; // INT is open drain, active low
+    cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    cfg.intr_type = GPIO_INTR_NEGEDGE;
+    esp_err_t err = gpio_config(&cfg);
+    if (err != ESP_OK) return err;
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err; // already installed is fine
+    return gpio_isr_handler_add(IOX_INT_GPIO, iox_isr, nullptr);
+}
+
+bool iox_has_irq() { return IOX_INT_GPIO != GPIO_NUM_NC; }
+
+#if BUTTON_IO == BUTTON_IO_MCP23017
+// ---- MCP23017 (IOCON.BANK = 0 register map) ----
+enum : uint8_t {
+    MCP_IODIRA = 0x00,
+    MCP_IPOLA = 0x02,
+    MCP_GPINTENA = 0x04,
+    MCP_INTCONA = 0x08,
+    MCP_IOCON = 0x0A,
+    MCP_GPPUA = 0x0C,
+    MCP_GPIOA = 0x12,
+};
+enum : uint8_t { MCP_IOCON_MIRROR = 0x40, MCP_IOCON_ODR = 0x04 };
+
+static i2c_master_bus_handle_t s_bus = nullptr;
+static i2c_master_dev_handle_t s_dev = nullptr;
+static constexpr uint8_t k_ports = LIGHT_CHANNELS > 8 ? 2 : 1;
+static constexpr uint16_t k_input_mask = (uint16_t)((1u << LIGHT_CHANNELS) - 1u);
+
+// Register pair write (A then B, sequential addressing).
+static esp_err_t mcp_write16(uint8_t reg, uint16_t v)
+{
+    uint8_t buf[3] = { reg, (uint8_t)(v & 0xFF), (uint8_t)(v >> 8) };
+    return i2c_master_transmit(s_dev, buf, sizeof(buf), IOX_BUS_TIMEOUT_MS);
+}
+
+esp_err_t iox_init(TaskHandle_t notify_task)
+{
+    s_notify_task = notify_task;
+    i2c_master_bus_config_t bus_cfg = {};
+    bus_cfg.i2c_port = IOX_I2C_PORT;
+    bus_cfg.sda_io_num = IOX_I2C_SDA_GPIO;
+    bus_cfg.scl_io_num = IOX_I2C_SCL_GPIO;
+    bus_cfg.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_cfg.glitch_ignore_cnt = 7;
+    bus_cfg.flags.enable_internal_pullup = true;
+    esp_err_t err = i2c_new_master_bus(&bus_cfg, &s_bus);
+    if (err != ESP_OK) return err;
+    i2c_device_config_t dev_cfg = {};
+    dev_cfg.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    dev_cfg.device_address = IOX_I2C_ADDR;
+    dev_cfg.scl_speed_hz = IOX_I2C_HZ;
+    err = i2c_master_bus_add_device(s_bus, &dev_cfg, &s_dev);
+    if (err != ESP_OK) return err;
+
+    // INTA mirrors both ports as an open-drain output; interrupt on any change from the last read.
+    uint8_t iocon[2] = { MCP_IOCON, MCP_IOCON_MIRROR | MCP_IOCON_ODR };
+    err = i2c_master_transmit(s_dev, iocon, sizeof(iocon), IOX_BUS_TIMEOUT_MS);
+    if (err == ESP_OK) err = mcp_write16(MCP_IODIRA, 0xFFFF);
+    if (err == ESP_OK) err = mcp_write16(MCP_IPOLA, 0x0000);
+    if (err == ESP_OK) err = mcp_write16(MCP_GPPUA, 0xFFFF);
+    if (err == ESP_OK) err = mcp_write16(MCP_INTCONA, 0x0000);
+    if (err == ESP_OK) err = mcp_write16(MCP_GPINTENA, iox_has_irq() ? k_input_mask : 0);
+    if (err == ESP_OK) err = int_line_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "MCP23017 @0x%02x init failed: %s", IOX_I2C_ADDR, esp_err_to_name(err));
+        return err;
+    }
+    s_ready = true;
+    uint32_t held;
+    iox_read(&held); // clears any interrupt latched during setup
+    ESP_LOGI(TAG, "MCP23017 @0x%02x: %d inputs, %s", IOX_I2C_ADDR, LIGHT_CHANNELS, iox_has_irq() ? "interrupt driven" : "polled");
+    return ESP_OK;
+}
+
+esp_err_t iox_read(uint32_t * held)
+{
+    if (!s_ready) return ESP_ERR_INVALID_STATE;
+    TRACE_SCOPE("iox.scan");
+    int64_t t0 = esp_timer_get_time();
+    uint8_t reg = MCP_GPIOA;
+    uint8_t port[2] = { 0xFF, 0xFF };
+    // One transaction: register pointer write, repeated start, sequential read of GPIOA (+ GPIOB).
+    // Reading GPIO also clears the pending interrupt.
+    esp_err_t err = i2c_master_transmit_receive(s_dev, &reg, 1, port, k_ports, IOX_BUS_TIMEOUT_MS);
+    s_m_scan_us.record((uint32_t)(esp_timer_get_time() - t0));
+    s_m_scans.inc();
+    if (err != ESP_OK) {
+        s_m_errors.inc();
+        return err;
+    }
+    *held = (uint32_t)(~(port[0] | (port[1] << 8)) & k_input_mask);
+    return ESP_OK;
+}
+
+#elif BUTTON_IO == BUTTON_IO_74HC165
+// ---- 74HC165 chain ----
+static constexpr int k_chain = (LIGHT_CHANNELS + 7) / 8;
+static_assert(k_chain <= 4, "74HC165 chain read uses the 4-byte inline RX buffer");
+static spi_device_handle_t s_spi = nullptr;
+
+esp_err_t iox_init(TaskHandle_t notify_task)
+{
+    s_notify_task = notify_task;
+    gpio_config_t load = {};
+    load.pin_bit_mask = 1ULL << IOX_SR_LOAD_GPIO;
+    load.mode = GPIO_MODE_OUTPUT;
+    esp_err_t err = gpio_config(&load);
+    if (err != ESP_OK) return err;
+    gpio_set_level(IOX_SR_LOAD_GPIO, 1);
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = -1;
+    bus.miso_io_num = IOX_SPI_MISO_GPIO;
+    bus.sclk_io_num = IOX_SPI_SCLK_GPIO;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = 4;
+    err = spi_bus_initialize(IOX_SPI_HOST, &bus, SPI_DMA_DISABLED);
+    if (err != ESP_OK) return err;
+    spi_device_interface_config_t dev = {};
+    dev.mode = 2; // CPOL=1/CPHA=0: sample on the falling edge, before the register shifts on the rising one
+    dev.clock_speed_hz = IOX_SPI_HZ;
+    dev.spics_io_num = -1; // CE tied low; the load pin frames the read
+    dev.queue_size = 1;
+    err = spi_bus_add_device(IOX_SPI_HOST, &dev, &s_spi);
+    if (err == ESP_OK) err = int_line_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "74HC165 chain init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    s_ready = true;
+    ESP_LOGI(TAG, "74HC165 x%d: %d inputs, %s", k_chain, LIGHT_CHANNELS, iox_has_irq() ? "interrupt driven" : "polled");
+    return ESP_OK;
+}
+
+esp_err_t iox_read(uint32_t * held)
+{
+    if (!s_ready) return ESP_ERR_INVALID_STATE;
+    TRACE_SCOPE("iox.scan");
+    int64_t t0 = esp_timer_get_time();
+    // Latch all parallel inputs, then clock the whole chain out in one transaction.
+    gpio_set_level(IOX_SR_LOAD_GPIO, 0);
+    esp_rom_delay_us(1);
+    gpio_set_level(IOX_SR_LOAD_GPIO, 1);
+    spi_transaction_t t = {};
+    t.flags = SPI_TRANS_USE_RXDATA;
+    t.length = 8 * k_chain;
+    t.rxlength = 8 * k_chain;
+    esp_err_t err = spi_device_polling_transmit(s_spi, &t);
+    s_m_scan_us.record((uint32_t)(esp_timer_get_time() - t0));
+    s_m_scans.inc();
+    if (err != ESP_OK) {
+        s_m_errors.inc();
+        return err;
+    }
+    uint32_t levels = 0;
+    for (int i = 0; i < k_chain; i++) levels |= (uint32_t)t.rx_data[i] << (8 * i);
+    *held = ~levels & ((1u << LIGHT_CHANNELS) - 1u);
+    return ESP_OK;
+}
+#endif
+
+#endif // BUTTON_IO != BUTTON_IO_GPIO
@@ -0,0 +1,36 @@
+/*
+ * Button inputs on an I/O expander, for panels with more gangs than free GPIOs.
+ *
+ * Selected with BUTTON_IO (app_config.h):
+ *   BUTTON_IO_MCP23017  16-bit I2C expander; INTA (mirrored, open drain) on IOX_INT_GPIO
+ *   BUTTON_IO_74HC165   chain of 8-bit shift registers on SPI, parallel load on IOX_SR_LOAD_GPIO
+ * Channel i is expander input i (MCP23017 GPA0..GPB7, or bit i%8 of register i/8 in the chain,
+ * register 0 nearest MISO). Inputs are active low with pull-ups, like the direct GPIO buttons.
+ *
+ * A scan is a single bus transaction: one I2C write-register + repeated-start read of GPIOA/GPIOB,
+ * or one SPI read of the whole chain. When the expander has an interrupt line wired
+ * (IOX_INT_GPIO != GPIO_NUM_NC) the button task sleeps between edges instead of polling.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_config.h"
+
+#if BUTTON_IO != BUTTON_IO_GPIO
+
+// Configure the bus, the device and (if wired) the interrupt line. `notify_task` receives a task
+// notification on every input-change interrupt.
+esp_err_t iox_init(TaskHandle_t notify_task);
+
+// Burst-read all inputs. Bit i of *held is set when channel i's button is down. Records the scan
+// latency in the `iox.scan_us` histogram.
+esp_err_t iox_read(uint32_t * held);
+
+// True when an interrupt line is configured, i.e. the scanner may block until the next edge.
+bool iox_has_irq();
+
+#endif // BUTTON_IO != BUTTON_IO_GPIO
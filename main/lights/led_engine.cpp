@@ -0,0 +1,165 @@
+/* LEDC-driven indicator LEDs: steady PWM level, hardware fades and hardware blink patterns. */
+#include "led_engine.h"
+
+#include <inttypes.h>
+#include <esp_log.h>
+
+#include "channels.h"
+#include "diag/metrics.h"
+
+static const char * TAG = "led_engine";
+
+static metrics::Counter s_m_fades("led.fades");
+static metrics::Counter s_m_fx_starts("led.fx_starts");
+
+// Per channel: steady level and the set of active effects (bit = LedFx value).
+static bool s_on[LIGHT_CHANNELS];
+static uint8_t s_fx[LIGHT_CHANNELS];
+
+static LedFx top_fx(uint8_t ch)
+{
+    uint8_t f = s_fx[ch];
+    if (f & (1u << (uint8_t)LedFx::Identify)) return LedFx::Identify;
+    if (f & (1u << (uint8_t)LedFx::Error)) return LedFx::Error;
+    if (f & (1u << (uint8_t)LedFx::Pending)) return LedFx::Pending;
+    return LedFx::None;
+}
+
+// Plain GPIO outputs: every LED until LEDC is up, and those beyond the LEDC channels after that.
+static void gpio_leds_init()
+{
+    if (!channels::kLedMask) return;
+    gpio_config_t out_cfg = {};
+    out_cfg.intr_type = GPIO_INTR_DISABLE;
+    out_cfg.mode = GPIO_MODE_OUTPUT;
+    out_cfg.pin_bit_mask = channels::kLedMask;
+    gpio_config(&out_cfg);
+    channels::write_leds(0);
+}
+
+static void gpio_render(uint8_t ch) { channels::write_leds(s_on[ch] ? (1u << ch) : 0, 1u << ch); }
+
+#if LED_DRIVER == LED_DRIVER_LEDC
+#include <driver/ledc.h>
+#include "soc/soc_caps.h"
+
+namespace {
+constexpr ledc_mode_t kMode = LEDC_LOW_SPEED_MODE;
+constexpr ledc_timer_bit_t kSteadyRes = LEDC_TIMER_10_BIT;
+constexpr ledc_timer_bit_t kBlinkRes = LEDC_TIMER_16_BIT; // low blink rates need a wide counter for the divider
+constexpr uint32_t kSteadyDuty = ((1u << kSteadyRes) * LED_BRIGHTNESS_PCT) / 100;
+constexpr uint32_t kBlinkDuty = ((1u << (kBlinkRes - 1)) * LED_BRIGHTNESS_PCT) / 100; // 50% on at full brightness, scaled like the steady level
+
+// Timer per pattern, indexed by LedFx (None = steady carrier).
+constexpr ledc_timer_t kFxTimer[] = { LEDC_TIMER_0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3 };
+constexpr uint32_t kFxHz[] = { LED_PWM_HZ, LED_PENDING_HZ, LED_ERROR_HZ, LED_IDENTIFY_HZ };
+
+// LEDC channel of each light channel: wired LEDs in channel order, -1 beyond the LEDC channel count.
+struct LedcMap {
+    int8_t ledc[16];
+};
+constexpr LedcMap make_map()
+{
+    LedcMap m = {};
+    int next = 0;
+    for (int i = 0; i < 16; i++) {
+        bool wired = i < channels::kCount && channels::kLedPins[i] != GPIO_NUM_NC;
+        m.ledc[i] = (wired && next < SOC_LEDC_CHANNEL_NUM) ? (int8_t)next++ : (int8_t)-1;
+    }
+    return m;
+}
+constexpr LedcMap kMap = make_map();
+} // namespace
+
+static bool s_ready = false;
+static LedFx s_shown[LIGHT_CHANNELS]; // pattern the LEDC channel is currently bound to
+
+static void render(uint8_t ch, bool fade)
+{
+    int lc = kMap.ledc[ch];
+    if (lc < 0 || !s_ready) {
+        gpio_render(ch);
+        return;
+    }
+    ledc_channel_t c = (ledc_channel_t)lc;
+    LedFx fx = top_fx(ch);
+    ledc_fade_stop(kMode, c); // a running fade would otherwise block the next duty change until it ends
+    if (fx != s_shown[ch]) {
+        ledc_bind_channel_timer(kMode, c, kFxTimer[(uint8_t)fx]);
+        if (fx != LedFx::None) s_m_fx_starts.inc();
+        s_shown[ch] = fx;
+        fade = false; // duty units differ between timers
+    }
+    uint32_t duty = fx != LedFx::None ? kBlinkDuty : (s_on[ch] ? kSteadyDuty : 0);
+    if (fade && LED_ACK_FADE_MS > 0) {
+        s_m_fades.inc();
+        ledc_set_fade_time_and_start(kMode, c, duty, LED_ACK_FADE_MS, LEDC_FADE_NO_WAIT);
+    } else {
+        ledc_set_duty(kMode, c, duty);
+        ledc_update_duty(kMode, c);
+    }
+}
+
+void led_engine_init()
+{
+    gpio_leds_init();
+    int used = 0;
+    for (int t = 0; t < 4; t++) {
+        ledc_timer_config_t tc = {};
+        tc.speed_mode = kMode;
+        tc.duty_resolution = t == 0 ? kSteadyRes : kBlinkRes;
+        tc.timer_num = kFxTimer[t];
+        tc.freq_hz = kFxHz[t];
+        tc.clk_cfg = LEDC_USE_RC_FAST_CLK; // all timers share one source; RC_FAST divides down to 1 Hz at 16 bits
+        esp_err_t err = ledc_timer_config(&tc);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "LEDC timer %d (%" PRIu32 " Hz) config failed: %s; LEDs stay on/off GPIO", t, kFxHz[t], esp_err_to_name(err));
+            return;
+        }
+    }
+    for (int ch = 0; ch < LIGHT_CHANNELS; ch++) {
+        if (kMap.ledc[ch] < 0) continue;
+        ledc_channel_config_t cc = {};
+        cc.gpio_num = channels::kLedPins[ch];
+        cc.speed_mode = kMode;
+        cc.channel = (ledc_channel_t)kMap.ledc[ch];
+        cc.intr_type = LEDC_INTR_DISABLE;
+        cc.timer_sel = kFxTimer[0];
+        cc.duty = 0;
+        if (ledc_channel_config(&cc) == ESP_OK) used++;
+    }
+    ledc_fade_func_install(0);
+    s_ready = true;
+    ESP_LOGI(TAG, "%d LED(s) on LEDC at %d%% brightness, %d on GPIO", used, LED_BRIGHTNESS_PCT,
+             __builtin_popcount(channels::kLedChannels) - used);
+}
+
+#else // LED_DRIVER_GPIO
+
+static void render(uint8_t ch, bool) { gpio_render(ch); }
+
+void led_engine_init() { gpio_leds_init(); }
+
+#endif // LED_DRIVER
+
+static bool wired(uint8_t ch) { return ch < LIGHT_CHANNELS && (channels::kLedChannels & (1u << ch)); }
+
+void led_engine_set(uint8_t ch, bool on, bool fade)
+{
+    if (!wired(ch)) return;
+    s_on[ch] = on;
+    s_fx[ch] &= (uint8_t)(1u << (uint8_t)LedFx::Identify);
+    render(ch, fade);
+}
+
+void led_engine_fx(uint8_t ch, LedFx fx, bool active)
+{
+    if (!wired(ch) || fx == LedFx::None) return;
+    uint8_t bit = (uint8_t)(1u << (uint8_t)fx);
+    uint8_t next = active ? (s_fx[ch] | bit) : (s_fx[ch] & ~bit);
+    if (next == s_fx[ch]) return;
+    s_fx[ch] = next;
+    render(ch, false);
+}
+
+LedFx led_engine_active_fx(uint8_t ch) { return wired(ch) ? top_fx(ch) : LedFx::None; }
@@ -0,0 +1,44 @@
+/*
+ * Indicator LED engine on the LEDC peripheral.
+ *
+ * Each LED with a pin gets an LEDC channel, up to the chip's LEDC channel count (6 on the C6). Any
+ * further LEDs, and all LEDs when LED_DRIVER is LED_DRIVER_GPIO, fall back to plain on/off through
+ * channels::write_leds() and show no effects.
+ *
+ * Four LEDC timers are set up at init. One is the steady PWM carrier, whose duty is LED_BRIGHTNESS_PCT.
+ * The other three run at the blink rates of the Pending, Error and Identify patterns, with a 50% duty
+ * scaled by the same LED_BRIGHTNESS_PCT (the blink's on-time shrinks, so it is dimmer on average too).
+ * Starting an effect rebinds the LED to that pattern's timer, so the hardware does the blinking. A
+ * press acknowledgement is a hardware fade to the new level. Once an effect is started, no timer
+ * callback or task wakes up to run it.
+ *
+ * Effects have a precedence: Identify over Error over Pending over the steady level. Setting the
+ * steady level clears Pending and Error, because the state is then known again. Identify stays on
+ * until it is cleared explicitly.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+enum class LedFx : uint8_t {
+    None = 0,
+    Pending,  // state not known yet (first sync round still reading)
+    Error,    // last dispatch failed; cleared by the next steady set
+    Identify, // Identify cluster
+};
+
+// Configure timers and channels for every wired LED; all LEDs start off.
+void led_engine_init();
+
+// Steady level of channel `ch`'s LED. With `fade` the change is a hardware ramp over
+// LED_ACK_FADE_MS (press acknowledgement). Clears Pending / Error.
+void led_engine_set(uint8_t ch, bool on, bool fade = false);
+
+// Start or stop a blink effect on channel `ch`.
+void led_engine_fx(uint8_t ch, LedFx fx, bool active);
+
+// Highest-precedence active effect on channel `ch` (None for the steady level or an unwired LED).
+// Only LEDC-driven LEDs actually blink; GPIO fallback LEDs keep showing the steady level.
+LedFx led_engine_active_fx(uint8_t ch);
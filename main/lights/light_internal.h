@@ -0,0 +1,100 @@
+/*
+ * Light manager internals shared with light_sync.cpp (Matter read transport) and the host
+ * build (host/). Not part of the public light manager API.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "light_manager.h"
+#include "scene.h"
+#include "offline_queue.h"
+#include "target_health.h"
+#include "sync_batch.h"
+
+// ---- Button debounce (button task) ----
+// One debounce step for every channel; bit i of `held` is set when button i reads pressed.
+// Returns a bitmask of channels whose press became stable on this poll (BUTTON_STABLE_CNT polls).
+uint32_t light_button_scan_step(uint32_t held);
+// Read all buttons (one input-register read, see channels.h, or one expander scan, see
+// io_expander.h) and run one debounce step.
+uint32_t light_button_poll();
+void light_button_scan_reset();
+
+// ---- LED state sync rounds (Matter thread) ----
+// Transport: start one asynchronous read of the OnOff attribute of every path's endpoint on
+// `node_id` (sync_batch.h), tracked as request `req` (sync_reads.h). Report each value that arrives
+// with light_sync_on_value(req, path.ch, on), each endpoint once with light_target_report(), then
+// end the request with one light_sync_on_done(req), on success and on every failure path. Returns
+// false if nothing was started (no callbacks follow). Calls for a request that already timed out
+// are ignored.
+bool light_sync_send_reads(uint8_t fabric_index, uint64_t node_id, const LightSyncPath * paths, uint8_t n, intptr_t req);
+void light_sync_on_value(intptr_t req, uint8_t ch, bool on);
+void light_sync_on_done(intptr_t req);
+
+// ---- Press transactions (Matter thread) ----
+// Transport: one bound target answered a toggle dispatched with `request_data` (or failed / was
+// never sent). Forwards to the press's LightToggleObserver and settles its transaction.
+void light_toggle_target_result(void * request_data, const LightToggleResult * r);
+
+// ---- Press fan-out (Matter thread, LIGHT_FANOUT_ENABLE) ----
+// Transport: send OnOff command `cmd` to one unicast target, setting up its CASE session first if
+// needed. The outcome comes back through light_fanout_result(token, ...), possibly before this
+// returns. Returns false if nothing was started (no result follows).
+bool light_unicast_send(uint8_t fabric_index, uint64_t node_id, uint16_t endpoint, uint32_t cmd, intptr_t token);
+// rtt_us: send -> response or error, CASE setup included (0 if unknown).
+void light_fanout_result(intptr_t token, bool ok, uint32_t rtt_us);
+// Transport: a secure session to the node is already up (its exchange needs no CASE setup).
+bool light_session_cached(uint8_t fabric_index, uint64_t node_id);
+// Transport: groupcast OnOff command `cmd` to `group_id` (no responses). False if it was not sent.
+bool light_group_send(uint8_t fabric_index, uint16_t group_id, uint32_t cmd);
+
+// ---- Hold-to-dim (Matter thread) ----
+// LevelControl requests carry the move in request_data (no per-request state to free).
+// `group_only`: the channel has a LevelControl group binding; unicast bindings skip the command.
+enum : uint8_t { kLevelMoveUp = 0, kLevelMoveDown = 1 }; // LevelControl MoveModeEnum
+struct LightLevelReq {
+    uint8_t mode;
+    uint8_t rate; // level units per second
+    bool group_only;
+};
+inline void * light_level_pack(LightLevelReq r) { return (void *)(intptr_t)(((intptr_t)r.group_only << 16) | ((intptr_t)r.mode << 8) | r.rate); }
+inline LightLevelReq light_level_unpack(const void * p)
+{
+    intptr_t v = (intptr_t)p;
+    return LightLevelReq{ (uint8_t)(v >> 8), (uint8_t)v, ((v >> 16) & 1) != 0 };
+}
+
+// ---- Generic Switch events (Matter thread) ----
+enum class SwitchEvent : uint8_t { InitialPress, LongPress, ShortRelease, LongRelease, MultiPressOngoing, MultiPressComplete };
+// Transport: log one Switch cluster event on `endpoint` and keep CurrentPosition in step (1 while
+// pressed). `count` is the press count of the multi-press events. Returns false if it was not logged.
+bool light_switch_log_event(uint16_t endpoint, SwitchEvent ev, uint8_t count);
+
+// ---- Scenes (Matter thread) ----
+// Transport: send `n` commands that share one destination (scene_same_dest: one peer session or one
+// group) without waiting between them. Every command's outcome comes back through
+// light_scene_cmd_result(cmd.handle, ok), possibly before this returns (groupcasts: once sent).
+void light_scene_send(const SceneCmd * cmds, uint8_t n);
+void light_scene_cmd_result(intptr_t handle, bool ok);
+// Transport: find or establish the CASE session to `node_id` so a later scene run does not wait for it.
+void light_scene_prewarm(uint8_t fabric_index, uint64_t node_id);
+
+// ---- Target health (Matter thread) ----
+// Transports: before an exchange with a bound unicast target by `owner` (press transaction handle, or
+// TargetHealthTable::kSyncOwner). False: its breaker is open or another owner holds its probe; skip it.
+// A due probe goes through and belongs to `owner` until its outcome is reported.
+bool light_target_attempt(uint64_t node_id, uint16_t endpoint, intptr_t owner);
+// Binding request callback: would the target be skipped for `owner`? (No state change; the dispatch
+// already called light_target_attempt for OnOff commands.)
+bool light_target_blocked(uint64_t node_id, uint16_t endpoint, intptr_t owner);
+// Transports: outcome of one exchange (rtt_us 0 = unknown). Press results report through
+// light_toggle_target_result().
+void light_target_report(uint64_t node_id, uint16_t endpoint, bool ok, uint32_t rtt_us);
+const TargetHealthTable & light_target_health();
+
+// ---- Offline queue (Matter thread) ----
+// Transport: true while the device has an IP link (Wi-Fi station connected or Thread attached).
+bool light_link_up();
+// Transport (offline_journal.cpp: NVS namespace "offlineq"): write / read back the held presses.
+bool light_offline_journal_save(const OfflineJournal & j);
+bool light_offline_journal_load(OfflineJournal * out);
@@ -1,17 +1,36 @@
 /* Clean replacement file (corruption fixed). */
 #include "light_manager.h"
+#include "light_internal.h"
+#include "channels.h"
+#include "debounce.h"
+#include "io_expander.h"
+#include "led_engine.h"
+#include "press_txn.h"
+#include "press_coalesce.h"
+#include "gesture.h"
+#include "offline_queue.h"
+#include "target_health.h"
+#include "fanout.h"
+#include "sync_reads.h"
+#include "scene_engine.h"
 #include <esp_log.h>
+#include <inttypes.h>
 #include <driver/gpio.h>
 #include <esp_timer.h>
 #include "freertos/queue.h"
-#include <app/ReadClient.h>
-#include <app/InteractionModelEngine.h>
-#include <app/server/Server.h>
 #include <esp_matter.h>
 #include "../temp/temp_manager.h"  // sensor task now lives in temp module
 #include <esp_matter_client.h>
+#include <esp_matter_console.h>
 #include <platform/PlatformManager.h>
-#include <lib/core/ScopedNodeId.h>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "diag/metrics.h"
+#include "rtos_static.h"
+#include "diag/work_probe.h"
+#include "diag/trace.h"
 
 using namespace esp_matter;
 using namespace esp_matter::attribute;
@@ -26,40 +45,274 @@ extern "C" void temp_manager_start();
 static bool s_led_any_on[LIGHT_CHANNELS] = {false};
 static uint8_t s_pending_read_counts[LIGHT_CHANNELS] = {0};
 static bool s_round_any_on[LIGHT_CHANNELS] = {false};
-static const gpio_num_t s_button_gpios[LIGHT_CHANNELS] = { BUTTON_GPIO_0, BUTTON_GPIO_1, BUTTON_GPIO_2, BUTTON_GPIO_3 };
-static const gpio_num_t s_led_gpios[LIGHT_CHANNELS]    = { LED_GPIO_0, LED_GPIO_1, LED_GPIO_2, LED_GPIO_3 };
 static TaskHandle_t s_button_task = nullptr;
 static TaskHandle_t s_button_act_task = nullptr;
 static QueueHandle_t s_button_evt_queue = nullptr;
-static esp_timer_handle_t s_led_blink_timers[LIGHT_CHANNELS] = {nullptr};
+static bool s_led_synced[LIGHT_CHANNELS] = {false}; // a sync round has completed since boot (else Pending)
+static int64_t s_press_us[LIGHT_CHANNELS] = {0}; // esp_timer time of last press (for press->dispatch latency)
+static OfflineQueue s_offline; // presses held while offline (Matter thread)
+static TargetHealthTable s_health; // per-target breaker (Matter thread)
 
-static void apply_led(uint8_t ch, bool on){ if (ch < LIGHT_CHANNELS) gpio_set_level(s_led_gpios[ch], on?1:0); }
+static metrics::Counter s_m_presses("light.presses");
+static metrics::Counter s_m_queue_drops("light.btn_queue_drops");
+static metrics::Counter s_m_dispatch_ok("light.dispatch_ok");
+static metrics::Counter s_m_dispatch_fail("light.dispatch_fail");
+static metrics::Histogram s_m_press_to_dispatch("light.press_to_dispatch_us", metrics::kLatencyBucketsUs);
+static metrics::Counter s_m_sync_rounds("light.sync_rounds");
+static metrics::Counter s_m_sync_skipped("light.sync_skipped_busy");
+static metrics::Counter s_m_sync_reads("light.sync_reads");
+static metrics::Counter s_m_sync_requests("light.sync_requests");
+static metrics::Counter s_m_sync_completed("light.sync_completed");
+static metrics::Counter s_m_sync_timeouts("light.sync_timeouts");
+static metrics::Counter s_m_sync_late("light.sync_late");
+static metrics::Counter s_m_sync_send_fail("light.sync_send_fail");
+static metrics::Gauge s_m_sync_inflight("light.sync_inflight");
+static metrics::Counter s_m_txn_confirmed("light.txn_confirmed");
+static metrics::Counter s_m_txn_partial("light.txn_partial");
+static metrics::Counter s_m_txn_failed("light.txn_failed");
+static metrics::Counter s_m_txn_timeouts("light.txn_timeouts");
+static metrics::Counter s_m_txn_rollbacks("light.txn_rollbacks");
+static metrics::Histogram s_m_txn_confirm("light.txn_confirm_us", metrics::kLatencyBucketsUs);
+static metrics::Counter s_m_press_merged("light.press_merged");
+static metrics::Counter s_m_toggle_jobs_full("light.toggle_jobs_full");
+static metrics::Counter s_m_press_cancelled("light.press_cancelled");
+static metrics::Counter s_m_press_batched("light.press_batched_sends");
+static metrics::Gauge s_m_press_window("light.press_window_ms");
+static metrics::Counter s_m_gesture_double("light.gesture_double");
+static metrics::Counter s_m_gesture_triple("light.gesture_triple");
+static metrics::Counter s_m_gesture_long("light.gesture_long");
+static metrics::Counter s_m_gesture_upgraded("light.gesture_upgraded");
+static metrics::Counter s_m_gesture_cancelled("light.gesture_cancelled");
+static metrics::Histogram s_m_gesture_dispatch("light.gesture_dispatch_us", metrics::kLatencyBucketsUs);
+static const uint32_t k_overshoot_buckets[] = { 1, 2, 4, 8, 16, 32, 64, 128 }; // level units
+static metrics::Counter s_m_dim_moves("level.moves");
+static metrics::Counter s_m_dim_group("level.group_moves");
+static metrics::Counter s_m_dim_fail("level.dispatch_fail");
+static metrics::Counter s_m_dim_jobs_full("level.jobs_full");
+static metrics::Counter s_m_dim_stop_retries("level.stop_retries");
+static metrics::Histogram s_m_dim_start("level.hold_to_move_us", metrics::kLatencyBucketsUs);
+static metrics::Histogram s_m_dim_stop("level.release_to_stop_us", metrics::kLatencyBucketsUs);
+static metrics::Histogram s_m_dim_overshoot("level.stop_overshoot", k_overshoot_buckets);
+static metrics::Counter s_m_sw_events("switch.events");
+static metrics::Counter s_m_sw_fail("switch.event_fail");
+static metrics::Counter s_m_sw_drops("switch.event_drops");
+static metrics::Counter s_m_sw_evicted("switch.events_evicted");
+static metrics::Gauge s_m_sw_backlog("switch.event_backlog");
+static metrics::Gauge s_m_sw_retention("switch.event_retention_s");
+static metrics::Histogram s_m_sw_lag("switch.event_lag_us", metrics::kLatencyBucketsUs);
+static metrics::Counter s_m_off_queued("offline.queued");
+static metrics::Counter s_m_off_coalesced("offline.coalesced");
+static metrics::Counter s_m_off_replayed("offline.replayed");
+static metrics::Counter s_m_off_expired("offline.expired");
+static metrics::Gauge s_m_off_depth("offline.depth");
+static metrics::Histogram s_m_off_drain("offline.drain_us", metrics::kLatencyBucketsUs);
+static metrics::Counter s_m_off_journal("offline.journal_writes");
+static metrics::Counter s_m_off_journal_fail("offline.journal_fail");
+static metrics::Counter s_m_health_opened("health.breaker_opened");
+static metrics::Counter s_m_health_recovered("health.recovered");
+static metrics::Counter s_m_health_probes("health.probes");
+static metrics::Counter s_m_health_skipped("health.skipped");
+static metrics::Gauge s_m_health_open("health.open");
+static metrics::Counter s_m_fan_sends("fanout.sends");
+static metrics::Counter s_m_fan_full("fanout.queue_full");
+static metrics::Counter s_m_fan_deferred("fanout.cold_deferred");
+static metrics::Counter s_m_fan_groups("fanout.group_sends");
+static metrics::Counter s_m_fan_group_fail("fanout.group_fail");
+static metrics::Gauge s_m_fan_inflight("fanout.inflight");
+static metrics::Gauge s_m_fan_queued("fanout.queued");
+static metrics::Histogram s_m_fan_last("fanout.last_light_us", metrics::kLatencyBucketsUs);
+
+static void apply_led(uint8_t ch, bool on, bool fade=false){ led_engine_set(ch, on, fade); }
+// Binding entry `e` receives commands of `cluster` (the binding manager's rule: no cluster = every cluster).
+static bool binds(const ShadowBindingEntry & e, chip::ClusterId cluster){ return e.cluster_id==0 || e.cluster_id==cluster; }
 bool light_manager_get(uint8_t ch){ return (ch<LIGHT_CHANNELS)? s_led_any_on[ch]: false; }
 
-static void buttons_init(){ gpio_config_t in_cfg={}; in_cfg.intr_type=GPIO_INTR_DISABLE; in_cfg.mode=GPIO_MODE_INPUT; in_cfg.pull_down_en=GPIO_PULLDOWN_DISABLE; in_cfg.pull_up_en=GPIO_PULLUP_ENABLE; for(int i=0;i<LIGHT_CHANNELS;i++){ if (s_button_gpios[i]==GPIO_NUM_NC) continue; in_cfg.pin_bit_mask=(1ULL<<s_button_gpios[i]); gpio_config(&in_cfg); gpio_set_pull_mode(s_button_gpios[i], GPIO_PULLUP_ONLY);} }
-static void leds_init(){ gpio_config_t out_cfg={}; out_cfg.intr_type=GPIO_INTR_DISABLE; out_cfg.mode=GPIO_MODE_OUTPUT; for(int i=0;i<LIGHT_CHANNELS;i++){ if (s_led_gpios[i]==GPIO_NUM_NC) continue; out_cfg.pin_bit_mask=(1ULL<<s_led_gpios[i]); gpio_config(&out_cfg); gpio_set_level(s_led_gpios[i],0);} }
+static void buttons_init(){ if(!channels::kButtonMask) return; gpio_config_t in_cfg={}; in_cfg.intr_type=GPIO_INTR_DISABLE; in_cfg.mode=GPIO_MODE_INPUT; in_cfg.pull_down_en=GPIO_PULLDOWN_DISABLE; in_cfg.pull_up_en=GPIO_PULLUP_ENABLE; in_cfg.pin_bit_mask=channels::kButtonMask; gpio_config(&in_cfg); }
+
+static VerticalDebounce<BUTTON_STABLE_CNT> s_debounce;
+void light_button_scan_reset(){ s_debounce.reset(); }
+uint32_t light_button_scan_step(uint32_t held){ return s_debounce.step(held & channels::kChannelMask); }
+#if BUTTON_IO == BUTTON_IO_GPIO
+uint32_t light_button_poll(){ return light_button_scan_step(channels::read_pressed()); }
+static bool button_scan_idle(){ return false; }
+#else
+// A failed bus read counts as "nothing held" for this poll (iox.errors tracks it).
+uint32_t light_button_poll(){ uint32_t held=0; if(iox_read(&held)!=ESP_OK) held=0; return light_button_scan_step(held); }
+// Nothing held and nothing mid-debounce: sleep until the expander interrupts (or the idle rescan).
+static bool button_scan_idle(){ return iox_has_irq() && s_debounce.held()==0 && s_debounce.down()==0; }
+#endif
+// Gestures in use (gesture.h). Without any, btn_evt carries presses only, as before.
+static constexpr uint8_t kGestures=(LIGHT_GESTURE_DOUBLE!=GESTURE_ACTION_NONE ? GestureRecognizer::kDouble : 0) | (LIGHT_GESTURE_TRIPLE!=GESTURE_ACTION_NONE ? GestureRecognizer::kTriple : 0) | (LIGHT_GESTURE_LONG!=GESTURE_ACTION_NONE ? GestureRecognizer::kLong : 0);
+static constexpr uint8_t kBtnEvtRelease=0x80; // btn_evt item: channel index, | kBtnEvtRelease for a release
+static constexpr bool kReleases=kGestures!=0 || LIGHT_SWITCH_EVENTS; // btn_poll queues releases too
+static std::atomic<uint32_t> s_edge_us[LIGHT_CHANNELS]; // btn_poll: esp_timer time (low 32 bits) of the last debounced press
+static void button_evt_send(uint8_t evt){ if(s_button_evt_queue && xQueueSend(s_button_evt_queue,&evt,0)!=pdTRUE){ s_m_queue_drops.inc(); TRACE_INSTANT("btn.queue_drop", evt); } }
+static void button_task(void*){ while(true){ uint32_t pressed=light_button_poll(); while(pressed){ uint8_t ch=(uint8_t)__builtin_ctz(pressed); pressed&=pressed-1; TRACE_INSTANT("btn.debounced", ch); s_edge_us[ch].store((uint32_t)esp_timer_get_time(), std::memory_order_relaxed); button_evt_send(ch); } if(kReleases){ uint32_t rel=s_debounce.released(); while(rel){ uint8_t ch=(uint8_t)__builtin_ctz(rel); rel&=rel-1; button_evt_send(ch | kBtnEvtRelease); } } if(button_scan_idle()) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IOX_IDLE_RESCAN_MS)); else vTaskDelay(pdMS_TO_TICKS(BUTTON_POLL_MS)); } }
+
+// LED sync round: a channel's LED ends on if any bound target reported on, off once every read finished with none on.
+// Read requests are tracked in flight (sync_reads.h): each one ends through light_sync_on_done() or its timeout, never both.
+static SyncReadTable s_sync_reads;
+void light_sync_on_value(intptr_t req, uint8_t ch, bool on){ if(ch>=LIGHT_CHANNELS || !on || s_offline.pending(ch) || !s_sync_reads.live(req)) return; s_round_any_on[ch]=true; if(!s_led_any_on[ch]){ s_led_any_on[ch]=true; apply_led(ch,true);} }
+static void sync_path_done(uint8_t ch){ if(ch>=LIGHT_CHANNELS) return; TRACE_INSTANT("sync.read_done", ch); if (s_pending_read_counts[ch]>0){ s_pending_read_counts[ch]--; if(s_pending_read_counts[ch]==0){ if(s_offline.pending(ch)) return; if(!s_round_any_on[ch]) s_led_any_on[ch]=false; s_led_synced[ch]=true; apply_led(ch, s_led_any_on[ch]); } } } // round end also clears Pending / Error
+
+// Target health (target_health.h): every exchange with a bound unicast target reports here; targets with an open breaker are skipped.
+bool light_target_attempt(uint64_t node, uint16_t ep, intptr_t owner){ if(!s_health.any_open()) return true; bool probe=false, go=s_health.attempt(node, ep, esp_timer_get_time(), owner, &probe); if(probe){ s_m_health_probes.inc(); ESP_LOGI(TAG,"target 0x%016" PRIX64 "/%u: probing", node, ep); } if(!go) s_m_health_skipped.inc(); s_m_health_open.set(s_health.open_count()); return go; }
+bool light_target_blocked(uint64_t node, uint16_t ep, intptr_t owner){ return s_health.any_open() && s_health.blocked(node, ep, esp_timer_get_time(), owner); }
+static void target_release(uint64_t node, uint16_t ep, intptr_t owner){ if(s_health.any_open()) s_health.release(node, ep, owner, esp_timer_get_time()); } // a probe token taken but not used
+void light_target_report(uint64_t node, uint16_t ep, bool ok, uint32_t rtt_us){ if(!node) return; switch(s_health.report(node, ep, ok, rtt_us, esp_timer_get_time())){ case TargetHealthTable::Opened: s_m_health_opened.inc(); s_m_health_open.set(s_health.open_count()); ESP_LOGW(TAG,"target 0x%016" PRIX64 "/%u: unreachable, skipped for %us", node, ep, LIGHT_BREAKER_BACKOFF_MIN_MS/1000); break; case TargetHealthTable::Recovered: s_m_health_recovered.inc(); s_m_health_open.set(s_health.open_count()); ESP_LOGI(TAG,"target 0x%016" PRIX64 "/%u: back", node, ep); break; default: break; } }
+const TargetHealthTable & light_target_health(){ return s_health; }
+// A round plans every read first (sync_batch.h), then sends one request per peer node carrying all of its paths, at most
+// LIGHT_SYNC_MAX_READS at a time; each finished or timed-out request lets the next planned one go.
+static SyncBatchPlan s_sync_plan;
+static int s_sync_pos = 0; // next batch of s_sync_plan to send
+static bool s_sync_pumping = false;
+static esp_timer_handle_t s_sync_timer = nullptr;
+static void plan_initial_read(uint8_t ch, const ShadowBindingEntry & e){ if(e.is_group || !binds(e, chip::app::Clusters::OnOff::Id) || !light_target_attempt(e.node_id, e.endpoint, TargetHealthTable::kSyncOwner)) return; if(!s_sync_plan.add(e.fabric_index, e.node_id, ch, e.endpoint)){ target_release(e.node_id, e.endpoint, TargetHealthTable::kSyncOwner); return; } s_pending_read_counts[ch]++; s_m_sync_reads.inc(); }
+static void sync_arm(){ if(!s_sync_timer || esp_timer_is_active(s_sync_timer)) return; int64_t d=s_sync_reads.next_deadline_us(); if(d==INT64_MAX) return; int64_t now=esp_timer_get_time(); esp_timer_start_once(s_sync_timer, d>now ? (uint64_t)(d-now) : 1); }
+static void sync_paths_done(const SyncReadDone & d){ for(uint8_t i=0;i<d.n;i++) sync_path_done(d.ch[i]); }
+static void sync_pump(){ if(s_sync_pumping) return; s_sync_pumping=true; uint64_t node; uint8_t fi, n; LightSyncPath paths[SyncBatchPlan::kMaxPaths]; int64_t now=0; while(!s_sync_reads.full() && (n=s_sync_plan.next(&s_sync_pos, &node, &fi, paths))){ if(!now) now=esp_timer_get_time(); intptr_t req=s_sync_reads.begin(paths, n, now, now+(int64_t)LIGHT_SYNC_READ_TIMEOUT_MS*1000); s_m_sync_requests.inc(); SyncReadDone d; if(!light_sync_send_reads(fi, node, paths, n, req) && s_sync_reads.finish(req, &d)){ s_m_sync_send_fail.inc(); for(uint8_t i=0;i<n;i++) target_release(node, paths[i].endpoint, TargetHealthTable::kSyncOwner); sync_paths_done(d); } } if(s_sync_pos>=s_sync_plan.size()){ s_sync_plan.reset(); s_sync_pos=0; } s_sync_pumping=false; s_m_sync_inflight.set(s_sync_reads.inflight()); sync_arm(); }
+void light_sync_on_done(intptr_t req){ SyncReadDone d; if(!s_sync_reads.finish(req, &d)){ s_m_sync_late.inc(); sync_pump(); return; } s_m_sync_completed.inc(); sync_paths_done(d); sync_pump(); } // late: its slot is only free now, so the next read can go
+static void sync_timer_cb(void*){ work_probe_schedule(WorkSource::LedSync, [](intptr_t){ int n=s_sync_reads.expire(esp_timer_get_time(), [](const SyncReadDone & d){ sync_paths_done(d); }); if(n){ s_m_sync_timeouts.inc(n); ESP_LOGW(TAG,"sync: %d read request(s) timed out", n); } sync_pump(); }); }
+
+static void offline_replay(); // forward
+void light_manager_sync_initial_state(){ offline_replay(); bool any=false; for(int ch=0;ch<LIGHT_CHANNELS;ch++) if(s_pending_read_counts[ch]) { any=true; break;} if(any){ s_m_sync_skipped.inc(); return; } s_m_sync_rounds.inc(); TRACE_INSTANT("sync.round", 0); for(int ch=0;ch<LIGHT_CHANNELS;ch++) s_round_any_on[ch]=false; s_sync_plan.reset(); s_sync_pos=0; for(int ch=0; ch<LIGHT_CHANNELS; ch++){ auto * list=shadow_binding_get_list(ch); if(!list||!list->count) continue; for(int i=0;i<list->count;i++) plan_initial_read(ch, list->entries[i]); } sync_pump(); for(int ch=0; ch<LIGHT_CHANNELS; ch++) if(!s_led_synced[ch] && s_pending_read_counts[ch]) led_engine_fx(ch, LedFx::Pending, true); }
+
+static void send_group_toggle(uint8_t ch, const LightToggleObserver * obs, bool flip=true); // forward
+static void button_press_dispatch(uint8_t channel, const LightToggleObserver * obs){ if(channel>=LIGHT_CHANNELS) return; TRACE_SCOPE("btn.press"); g_last_press_tick=(uint32_t)xTaskGetTickCount(); s_press_us[channel]=esp_timer_get_time(); s_m_presses.inc(); const ShadowBindingList * list=shadow_binding_get_list(channel); int uni=0; if(list) for(int i=0;i<list->count;i++) if(!list->entries[i].is_group) uni++; ESP_LOGI(TAG,"Button press CH%u (unicast=%d)",channel,uni); send_group_toggle(channel, obs); }
+void light_manager_button_press(uint8_t channel){ button_press_dispatch(channel, nullptr); }
+void light_manager_toggle_dispatch(uint8_t channel, const LightToggleObserver * obs){ button_press_dispatch(channel, obs); }
+static void send_group_onoff(uint8_t ch, bool on); // forward
+void light_manager_set(uint8_t channel, bool on){ send_group_onoff(channel, on); }
+
+// OnOff jobs (Toggle, or On/Off from a gesture, rule or all-off) waiting for the Matter thread: channel + optional observer.
+// Posted from several tasks: a slot is claimed with a CAS and freed once the Matter thread has copied the job.
+struct ToggleJob { uint8_t ch; bool prev_on; chip::CommandId cmd; const LightToggleObserver * obs; };
+static_assert(LIGHT_TOGGLE_JOBS >= LIGHT_CHANNELS + 1 && LIGHT_TOGGLE_JOBS <= 64, "LIGHT_TOGGLE_JOBS must hold an all-off burst plus a press (LIGHT_CHANNELS+1..64)");
+static ToggleJob s_toggle_jobs[LIGHT_TOGGLE_JOBS];
+static std::atomic<bool> s_toggle_job_busy[LIGHT_TOGGLE_JOBS];
 
-static void button_task(void*){ uint8_t stable[LIGHT_CHANNELS]={0}; uint8_t last[LIGHT_CHANNELS]={1,1,1,1}; while(true){ for(int i=0;i<LIGHT_CHANNELS;i++){ int lvl=gpio_get_level(s_button_gpios[i]); if(lvl==last[i]){ if(stable[i]<255) stable[i]++; } else { stable[i]=0; last[i]=lvl; } if(last[i]==0 && stable[i]==BUTTON_STABLE_CNT){ uint8_t ch=i; if(s_button_evt_queue) xQueueSend(s_button_evt_queue,&ch,0); } } vTaskDelay(pdMS_TO_TICKS(BUTTON_POLL_MS)); } }
-static void led_blink_timer_cb(void* arg){ uint32_t ch=(uint32_t)arg; if(ch<LIGHT_CHANNELS) apply_led(ch, s_led_any_on[ch]); }
+// Press transactions (press_txn.h), Matter thread only. The handle rides in request_data; the
+// transport reports every target back through light_toggle_target_result().
+static PressTxnTable s_txns;
+static esp_timer_handle_t s_txn_timer = nullptr;
+static std::atomic<uint32_t> s_resp_ewma_us{LIGHT_PRESS_COALESCE_MIN_MS*1000u}; // press -> last response (or timeout), EWMA 1/4; sizes the coalescing window
+// Offline queue (offline_queue.h), Matter thread: presses that could not be dispatched are held as each
+// channel's final state, replayed once the link is back and journalled to NVS OFFLINE_JOURNAL_DELAY_MS after the last change.
+static constexpr bool kOffline = OFFLINE_QUEUE_ENABLE != 0;
+static esp_timer_handle_t s_journal_timer = nullptr;
+static int64_t s_replay_start_us = 0; // first replay attempt of the current backlog (0 = none)
+static uint32_t s_replay_mask = 0; // channels whose replayed press has not resolved yet
+static bool job_target(const ToggleJob & j){ return j.cmd==chip::app::Clusters::OnOff::Commands::On::Id ? true : j.cmd==chip::app::Clusters::OnOff::Commands::Off::Id ? false : !j.prev_on; }
+static void journal_arm(){ if(!s_journal_timer) return; esp_timer_stop(s_journal_timer); esp_timer_start_once(s_journal_timer, (uint64_t)OFFLINE_JOURNAL_DELAY_MS*1000); }
+static void journal_timer_cb(void*){ work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t){ static OfflineJournal j; s_offline.to_journal(j, esp_timer_get_time()); if(light_offline_journal_save(j)) s_m_off_journal.inc(); else s_m_off_journal_fail.inc(); }); }
+static void offline_hold(uint8_t ch, bool on){ bool fresh=s_offline.put(ch, on, esp_timer_get_time()); (fresh ? s_m_off_queued : s_m_off_coalesced).inc(); s_m_off_depth.set(s_offline.depth()); s_replay_mask&=~(1u<<ch); led_engine_fx(ch, LedFx::Pending, true); journal_arm(); if(fresh) ESP_LOGW(TAG,"CH%u: offline, holding %s for replay", ch, on?"On":"Off"); }
+static void drain_check(){ if(!s_replay_start_us || s_offline.depth() || s_replay_mask) return; s_m_off_drain.record((uint32_t)(esp_timer_get_time()-s_replay_start_us)); s_replay_start_us=0; } // backlog gone and every replayed press resolved
+static void press_outcome(const PressOutcome & o){ if(o.kind==PressOutcome::None) return; if(s_replay_mask & (1u<<o.ch)){ s_replay_mask&=~(1u<<o.ch); drain_check(); } uint32_t took=(uint32_t)(esp_timer_get_time()-o.started_us), e=s_resp_ewma_us.load(std::memory_order_relaxed); s_resp_ewma_us.store(e-e/4+took/4, std::memory_order_relaxed); if(o.timed_out) s_m_txn_timeouts.inc(); if(o.kind==PressOutcome::Confirmed){ s_m_txn_confirmed.inc(); s_m_txn_confirm.record(took); return; } if(o.kind==PressOutcome::Partial) s_m_txn_partial.inc(); else s_m_txn_failed.inc(); ESP_LOGW(TAG,"CH%u: press %s (%u ok, %u failed%s)", o.ch, o.kind==PressOutcome::Partial?"partially applied":"failed", o.ok, o.failed, o.timed_out?", timed out":""); if(o.kind==PressOutcome::Failed && o.latest && s_led_any_on[o.ch]!=o.prev_on){ s_m_txn_rollbacks.inc(); s_led_any_on[o.ch]=o.prev_on; apply_led(o.ch, o.prev_on, true); } led_engine_fx(o.ch, LedFx::Error, true); } // no target changed: roll back (unless a newer press owns the LED); mixed: error until the next sync round
+static void txn_arm(){ int64_t d=s_txns.next_deadline_us(); if(!s_txn_timer || d==INT64_MAX || esp_timer_is_active(s_txn_timer)) return; int64_t now=esp_timer_get_time(); esp_timer_start_once(s_txn_timer, d>now ? (uint64_t)(d-now) : 1); }
+static void txn_timer_cb(void*){ work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t){ s_txns.expire(esp_timer_get_time(), press_outcome); txn_arm(); }); }
+void light_toggle_target_result(void * request_data, const LightToggleResult * r){ light_target_report(r->node_id, r->endpoint, r->ok, r->rtt_us); intptr_t h=(intptr_t)request_data; auto * obs=static_cast<const LightToggleObserver *>(s_txns.ctx(h)); if(obs && obs->cb) obs->cb(obs->ctx, r); press_outcome(s_txns.report(h, r->ok)); }
 
-class InitialReadCallback : public chip::app::ReadClient::Callback { public: explicit InitialReadCallback(uint8_t c):mCh(c){} void OnReportBegin() override {mGot=false;} void OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,const chip::app::StatusIB & status) override { if(status.mStatus!=chip::Protocols::InteractionModel::Status::Success) return; if(path.mClusterId!=chip::app::Clusters::OnOff::Id || path.mAttributeId!=chip::app::Clusters::OnOff::Attributes::OnOff::Id) return; bool on=false; if(data && data->Get(on)==CHIP_NO_ERROR){ mGot=true; if(on){ s_round_any_on[mCh]=true; if(!s_led_any_on[mCh]){ s_led_any_on[mCh]=true; apply_led(mCh,true);} } } } void OnDone(chip::app::ReadClient * c) override { if (s_pending_read_counts[mCh]>0){ s_pending_read_counts[mCh]--; if(s_pending_read_counts[mCh]==0 && !s_round_any_on[mCh] && s_led_any_on[mCh]) { s_led_any_on[mCh]=false; apply_led(mCh,false);} } if(c) chip::Platform::Delete(c); chip::Platform::Delete(this);} void OnError(CHIP_ERROR err) override { ESP_LOGW(TAG,"CH%u read error %" CHIP_ERROR_FORMAT,mCh,err.Format()); } void OnReportEnd() override {} void OnSubscriptionEstablished(chip::SubscriptionId) override {} private: uint8_t mCh; bool mGot=false; };
+// Fan-out (fanout.h), Matter thread: with LIGHT_FANOUT_ENABLE a press's unicast OnOff commands bypass the binding manager and are
+// released by the scheduler, slowest target first, LIGHT_FANOUT_MAX_INFLIGHT at a time (LIGHT_FANOUT_MAX_CASE of them with CASE setup).
+static constexpr bool kFanout = LIGHT_FANOUT_ENABLE != 0;
+static FanoutScheduler s_fanout;
+static bool s_fanout_pumping = false; // a synchronous send failure re-enters through light_fanout_result()
+static uint32_t s_fanout_deferred = 0; // cold_deferred() already counted
+static void fanout_pump(){ if(s_fanout_pumping) return; s_fanout_pumping=true; FanoutItem it; intptr_t tok; while((tok=s_fanout.start_next(&it))!=FanoutScheduler::kNone){ s_m_fan_sends.inc(); if(!light_unicast_send(it.fabric_index, it.node_id, it.endpoint, it.cmd, tok)) light_fanout_result(tok, false, 0); } s_fanout_pumping=false; if(s_fanout.cold_deferred()!=s_fanout_deferred){ s_m_fan_deferred.inc(s_fanout.cold_deferred()-s_fanout_deferred); s_fanout_deferred=s_fanout.cold_deferred(); } s_m_fan_inflight.set(s_fanout.inflight()); s_m_fan_queued.set(s_fanout.queued()); }
+void light_fanout_result(intptr_t token, bool ok, uint32_t rtt_us){ FanoutItem it; int64_t batch_start; if(!s_fanout.finish(token, &it, &batch_start)) return; if(batch_start>=0) s_m_fan_last.record((uint32_t)(esp_timer_get_time()-batch_start)); LightToggleResult r={it.node_id, it.endpoint, ok, rtt_us}; light_toggle_target_result((void*)it.txn, &r); fanout_pump(); }
+// Hand a job's OnOff command to the transport: the binding manager, or groupcasts + the fan-out queue. go[i]: unicast entry i is sent
+// (cleared when the queue is full; the caller fails it).
+static esp_err_t send_onoff(uint8_t ch, chip::CommandId cmd, intptr_t txn, const ShadowBindingList * list, bool * go, int64_t now){ if(!kFanout){ esp_matter::client::request_handle req={}; chip::app::CommandPathParams path(g_onoff_endpoint_ids[ch],0, chip::app::Clusters::OnOff::Id, cmd, (chip::app::CommandPathFlags)0); req.command_path=path; req.request_data=(void*)txn; return esp_matter::client::cluster_update(g_onoff_endpoint_ids[ch], &req); } if(!list) return ESP_OK; uint8_t batch=s_fanout.begin_batch(now); for(int i=0;i<list->count;i++){ const ShadowBindingEntry & e=list->entries[i]; if(!binds(e, chip::app::Clusters::OnOff::Id)) continue; if(e.is_group){ (light_group_send(e.fabric_index, e.group_id, cmd) ? s_m_fan_groups : s_m_fan_group_fail).inc(); continue; } if(!go[i]) continue; bool cold=!light_session_cached(e.fabric_index, e.node_id); FanoutItem it={e.node_id, txn, cmd, FanoutScheduler::estimate(s_health.rtt_us(e.node_id, e.endpoint), cold), e.endpoint, e.fabric_index, cold, 0, 0}; if(!s_fanout.push(it, batch)){ go[i]=false; s_m_fan_full.inc(); target_release(e.node_id, e.endpoint, txn); } } fanout_pump(); return ESP_OK; }
 
-struct PendingInitialRead { uint8_t ch; uint64_t node; chip::EndpointId ep; uint8_t fabric_index; };
-static PendingInitialRead s_pending_reads[LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH];
-static int s_pending_count=0;
+// Dispatch one OnOff job on the Matter thread. Returns its press transaction (kNoTxn: nothing to track, or held offline).
+static intptr_t dispatch_job(const ToggleJob & job){ uint8_t ch_i=job.ch; TRACE_SCOPE("toggle.cluster_update"); if(kOffline && !light_link_up()){ if(job.obs && job.obs->cb){ LightToggleResult r={0,0,false,0}; job.obs->cb(job.obs->ctx,&r); } offline_hold(ch_i, job_target(job)); return PressTxnTable::kNoTxn; } const ShadowBindingList * list=shadow_binding_get_list(ch_i); uint8_t uni=0; bool go[MAX_SHADOW_BINDINGS_PER_CH]={}; if(list) for(int i=0;i<list->count;i++) if(!list->entries[i].is_group && binds(list->entries[i], chip::app::Clusters::OnOff::Id)) uni++; int64_t now=esp_timer_get_time(); intptr_t txn=s_txns.begin(ch_i, uni, job.prev_on, now, now+(int64_t)LIGHT_PRESS_TXN_TIMEOUT_MS*1000, job.obs); txn_arm(); if(list) for(int i=0;i<list->count;i++){ const ShadowBindingEntry & e=list->entries[i]; if(!e.is_group && binds(e, chip::app::Clusters::OnOff::Id)) go[i]=light_target_attempt(e.node_id, e.endpoint, txn); } esp_err_t err=send_onoff(ch_i, job.cmd, txn, list, go, now); if(err!=ESP_OK){ s_m_dispatch_fail.inc(); ESP_LOGW(TAG,"cluster_update failed ch%u err=%d", ch_i, err); if(list) for(int i=0;i<list->count;i++) if(go[i]) target_release(list->entries[i].node_id, list->entries[i].endpoint, txn); if(job.obs && job.obs->cb){ LightToggleResult r={0,0,false,0}; job.obs->cb(job.obs->ctx,&r); } if(kOffline){ s_txns.abort(txn); offline_hold(ch_i, job_target(job)); return PressTxnTable::kNoTxn; } PressOutcome o=s_txns.abort(txn); if(o.kind==PressOutcome::None){ o=PressOutcome{}; o.kind=PressOutcome::Failed; o.ch=ch_i; o.prev_on=job.prev_on; o.latest=true; } press_outcome(o); } else { s_m_dispatch_ok.inc(); s_m_press_to_dispatch.record((uint32_t)(now-s_press_us[ch_i])); ESP_LOGI(TAG,"CH%u: %s dispatched", ch_i, job.cmd==chip::app::Clusters::OnOff::Commands::Off::Id ? "Off" : "Toggle"); if(list) for(int i=0;i<list->count;i++){ const ShadowBindingEntry & e=list->entries[i]; if(e.is_group || !binds(e, chip::app::Clusters::OnOff::Id) || go[i]) continue; LightToggleResult r={e.node_id, e.endpoint, false, 0}; if(job.obs && job.obs->cb) job.obs->cb(job.obs->ctx,&r); press_outcome(s_txns.report(txn, false)); } } return txn; } // skipped targets (breaker open, fan-out queue full) fail at once instead of holding the press until its timeout
+// Replay held presses as one absolute On / Off per channel (LED included), if the link is up. Entries older than OFFLINE_QUEUE_MAX_AGE_S are dropped.
+static void offline_replay(){ if(!kOffline || !s_offline.depth() || !light_link_up()) return; TRACE_SCOPE("offline.replay"); int64_t now=esp_timer_get_time(); int dropped=s_offline.expire(now, (int64_t)OFFLINE_QUEUE_MAX_AGE_S*1000000); if(dropped){ s_m_off_expired.inc(dropped); ESP_LOGW(TAG,"offline: dropped %d press(es) older than %ds", dropped, OFFLINE_QUEUE_MAX_AGE_S); for(uint8_t ch=0;ch<LIGHT_CHANNELS;ch++) if(!s_offline.pending(ch)) led_engine_fx(ch, LedFx::Pending, false); } if(!s_replay_start_us && s_offline.depth()) s_replay_start_us=now; for(uint8_t ch=0;ch<LIGHT_CHANNELS;ch++){ bool on; if(!s_offline.take(ch,&on)) continue; s_m_off_replayed.inc(); ESP_LOGI(TAG,"CH%u: replaying %s", ch, on?"On":"Off"); s_led_any_on[ch]=on; apply_led(ch,on); s_press_us[ch]=now; s_replay_mask|=1u<<ch; if(dispatch_job(ToggleJob{ch, !on, on ? chip::app::Clusters::OnOff::Commands::On::Id : chip::app::Clusters::OnOff::Commands::Off::Id, nullptr})==PressTxnTable::kNoTxn) s_replay_mask&=~(1u<<ch); } s_m_off_depth.set(s_offline.depth()); journal_arm(); drain_check(); }
+void light_manager_connectivity_changed(){ if(kOffline) work_probe_schedule(WorkSource::BindingRefresh, [](intptr_t){ offline_replay(); }); }
+static void dispatch_onoff(uint8_t ch, chip::CommandId cmd, bool prev, const LightToggleObserver * obs){ for(int i=0;i<LIGHT_TOGGLE_JOBS;i++){ bool f=false; if(!s_toggle_job_busy[i].compare_exchange_strong(f, true, std::memory_order_acquire)) continue; s_toggle_jobs[i]=ToggleJob{ch, prev, cmd, obs}; if(work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t arg){ ToggleJob j=s_toggle_jobs[arg]; s_toggle_job_busy[arg].store(false, std::memory_order_release); dispatch_job(j); }, (intptr_t)i)==ESP_OK) return; s_toggle_job_busy[i].store(false, std::memory_order_release); break; } s_m_toggle_jobs_full.inc(); ESP_LOGW(TAG,"CH%u: OnOff job refused (%d queued), LED restored", ch, LIGHT_TOGGLE_JOBS); s_led_any_on[ch]=prev; apply_led(ch, prev, true); if(obs && obs->cb){ LightToggleResult r={0,0,false,0}; obs->cb(obs->ctx,&r); } }
+static void send_group_toggle(uint8_t ch, const LightToggleObserver * obs, bool flip){ if(ch>=LIGHT_CHANNELS) return; bool prev=flip ? s_led_any_on[ch] : !s_led_any_on[ch]; if(flip){ s_led_any_on[ch]=!prev; apply_led(ch, s_led_any_on[ch], true); } dispatch_onoff(ch, chip::app::Clusters::OnOff::Commands::Toggle::Id, prev, obs); } // !flip: a coalesced batch, the LED already shows the state being sent
+static void send_group_onoff(uint8_t ch, bool on){ if(ch>=LIGHT_CHANNELS) return; bool prev=s_led_any_on[ch]; s_led_any_on[ch]=on; apply_led(ch, on, true); s_press_us[ch]=esp_timer_get_time(); dispatch_onoff(ch, on ? chip::app::Clusters::OnOff::Commands::On::Id : chip::app::Clusters::OnOff::Commands::Off::Id, prev, nullptr); }
 
-static void send_initial_read(const PendingInitialRead & item){ chip::FabricIndex fi=item.fabric_index; if(fi==chip::kUndefinedFabricIndex){ for(auto &f: chip::Server::GetInstance().GetFabricTable()) if(f.IsInitialized()){ fi=f.GetFabricIndex(); break; } } if(fi==chip::kUndefinedFabricIndex) return; auto * caseMgr=chip::Server::GetInstance().GetCASESessionManager(); if(!caseMgr) return; struct Ctx{ PendingInitialRead it; }; auto * ctx=chip::Platform::New<Ctx>(); if(!ctx) return; ctx->it=item; auto onConn=[](void * c2, chip::Messaging::ExchangeManager & em, const chip::SessionHandle & sh){ std::unique_ptr<Ctx, void(*)(Ctx*)> guard((Ctx*)c2,[](Ctx* p){ chip::Platform::Delete(p); }); auto & it=guard->it; auto * cb=chip::Platform::New<InitialReadCallback>(it.ch); if(!cb) return; auto * client=chip::Platform::New<chip::app::ReadClient>(chip::app::InteractionModelEngine::GetInstance(), &em, *cb, chip::app::ReadClient::InteractionType::Read); if(!client){ chip::Platform::Delete(cb); return;} chip::app::AttributePathParams path; path.mEndpointId=it.ep; path.mClusterId=chip::app::Clusters::OnOff::Id; path.mAttributeId=chip::app::Clusters::OnOff::Attributes::OnOff::Id; chip::app::AttributePathParams paths[1]={path}; chip::app::ReadPrepareParams params(sh); params.mpAttributePathParamsList=paths; params.mAttributePathParamsListSize=1; if(client->SendRequest(params)!=CHIP_NO_ERROR){ chip::Platform::Delete(client); chip::Platform::Delete(cb);} }; auto onFail=[](void * c2, const chip::ScopedNodeId & peer, CHIP_ERROR e){ std::unique_ptr<Ctx, void(*)(Ctx*)> guard((Ctx*)c2,[](Ctx* p){ chip::Platform::Delete(p); }); ESP_LOGW(TAG,"Session fail node=0x%016" PRIX64 " err=%" CHIP_ERROR_FORMAT,(uint64_t)peer.GetNodeId(), e.Format()); }; auto * cb1=chip::Platform::New<chip::Callback::Callback<chip::OnDeviceConnected>>(onConn, ctx); auto * cb2=chip::Platform::New<chip::Callback::Callback<chip::OnDeviceConnectionFailure>>(onFail, ctx); if(!cb1||!cb2){ if(cb1) chip::Platform::Delete(cb1); if(cb2) chip::Platform::Delete(cb2); chip::Platform::Delete(ctx); return;} chip::ScopedNodeId scoped(item.node, fi); caseMgr->FindOrEstablishSession(scoped, cb1, cb2); }
+// Hold-to-dim: LevelControl MoveWithOnOff while held, Stop on release, through the binding manager. With
+// LIGHT_DIM_PREFER_GROUP and a group binding on the channel the move goes to the group(s) only, so every
+// light ramps from the same multicast. Timing is taken from the button edges (btn_poll / btn_act).
+struct LevelJob { uint8_t ch; chip::CommandId cmd; uint8_t mode; uint32_t edge_us; uint8_t tries; };
+// Same claim / release scheme as the OnOff jobs: a Move and a Stop per channel fit, and a job finding every slot taken is refused.
+static LevelJob s_level_jobs[LIGHT_TOGGLE_JOBS];
+static std::atomic<bool> s_level_job_busy[LIGHT_TOGGLE_JOBS];
+static bool s_dim_next_up[LIGHT_CHANNELS]; // direction of the next dim on a lit channel (alternates, down first)
+static bool s_dimming[LIGHT_CHANNELS];
+// A Stop that could not be queued or sent is retried every LIGHT_DIM_STOP_RETRY_MS, up to LIGHT_DIM_STOP_RETRIES times: without it the lights ramp to the end of their range.
+static LevelJob s_stop_retry[LIGHT_CHANNELS];
+static std::atomic<uint32_t> s_stop_retry_mask{0}; // channels with s_stop_retry[] due
+static esp_timer_handle_t s_stop_retry_timer = nullptr;
+static void stop_failed(LevelJob job){ if(job.tries>=LIGHT_DIM_STOP_RETRIES){ ESP_LOGE(TAG,"CH%u: level Stop lost after %u retries, lights keep ramping", job.ch, (unsigned)job.tries); return; } job.tries++; s_stop_retry[job.ch]=job; s_stop_retry_mask.fetch_or(1u<<job.ch, std::memory_order_release); s_m_dim_stop_retries.inc(); if(s_stop_retry_timer && !esp_timer_is_active(s_stop_retry_timer)) esp_timer_start_once(s_stop_retry_timer, LIGHT_DIM_STOP_RETRY_MS*1000ull); }
+static void level_send(const LevelJob & job){ TRACE_SCOPE("dim.cluster_update"); const ShadowBindingList * list=shadow_binding_get_list(job.ch); bool group=false; if(LIGHT_DIM_PREFER_GROUP && list) for(int i=0;i<list->count;i++) if(list->entries[i].is_group && binds(list->entries[i], chip::app::Clusters::LevelControl::Id)) group=true; esp_matter::client::request_handle req={}; chip::app::CommandPathParams path(g_onoff_endpoint_ids[job.ch],0, chip::app::Clusters::LevelControl::Id, job.cmd, (chip::app::CommandPathFlags)0); req.command_path=path; req.request_data=light_level_pack(LightLevelReq{job.mode, LIGHT_DIM_RATE, group}); esp_err_t err=esp_matter::client::cluster_update(g_onoff_endpoint_ids[job.ch], &req); uint32_t dt=(uint32_t)esp_timer_get_time()-job.edge_us; if(err!=ESP_OK){ s_m_dim_fail.inc(); ESP_LOGW(TAG,"CH%u: level cluster_update failed err=%d", job.ch, err); if(job.cmd==chip::app::Clusters::LevelControl::Commands::Stop::Id) stop_failed(job); return; } if(job.cmd==chip::app::Clusters::LevelControl::Commands::Stop::Id){ s_m_dim_stop.record(dt); s_m_dim_overshoot.record((uint32_t)((uint64_t)dt*LIGHT_DIM_RATE/1000000)); } else { s_m_dim_moves.inc(); if(group) s_m_dim_group.inc(); s_m_dim_start.record(dt); ESP_LOGI(TAG,"CH%u: dim %s%s", job.ch, job.mode==kLevelMoveUp?"up":"down", group?" (group)":""); } } // overshoot: level units the lights kept moving between release and the Stop leaving (network time not included)
+static bool level_post(const LevelJob & job){ for(int i=0;i<LIGHT_TOGGLE_JOBS;i++){ bool f=false; if(!s_level_job_busy[i].compare_exchange_strong(f, true, std::memory_order_acquire)) continue; s_level_jobs[i]=job; if(work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t arg){ LevelJob j=s_level_jobs[arg]; s_level_job_busy[arg].store(false, std::memory_order_release); level_send(j); }, (intptr_t)i)==ESP_OK) return true; s_level_job_busy[i].store(false, std::memory_order_release); break; } s_m_dim_jobs_full.inc(); ESP_LOGW(TAG,"CH%u: level job refused (%d queued)", job.ch, LIGHT_TOGGLE_JOBS); return false; }
+static void dispatch_level(uint8_t ch, chip::CommandId cmd, uint8_t mode, uint32_t edge_us){ LevelJob job={ch, cmd, mode, edge_us, 0}; if(level_post(job)) return; if(cmd==chip::app::Clusters::LevelControl::Commands::Stop::Id) stop_failed(job); else s_dimming[ch]=false; } // a refused Move never started the ramp: no Stop on release
+static void stop_retry_cb(void*){ uint32_t m=s_stop_retry_mask.exchange(0, std::memory_order_acquire); while(m){ uint8_t ch=(uint8_t)__builtin_ctz(m); m&=m-1; LevelJob job=s_stop_retry[ch]; if(!level_post(job)) stop_failed(job); } }
+static void dim_start(uint8_t ch, bool was_on){ bool up=!was_on || s_dim_next_up[ch]; if(was_on) s_dim_next_up[ch]=!up; if(up && !s_led_any_on[ch]){ s_led_any_on[ch]=true; apply_led(ch, true, true); } s_dimming[ch]=true; s_stop_retry_mask.fetch_and(~(1u<<ch), std::memory_order_relaxed); dispatch_level(ch, chip::app::Clusters::LevelControl::Commands::MoveWithOnOff::Id, up ? kLevelMoveUp : kLevelMoveDown, s_edge_us[ch].load(std::memory_order_relaxed)+LIGHT_GESTURE_LONG_MS*1000u); } // MoveWithOnOff up switches the lights on; latency counts from the moment the hold became a long press
+static void dim_stop(uint8_t ch, int64_t edge_us){ if(!s_dimming[ch]) return; s_dimming[ch]=false; dispatch_level(ch, chip::app::Clusters::LevelControl::Commands::Stop::Id, 0, (uint32_t)edge_us); }
 
-static void schedule_single_initial_read(uint8_t ch, const ShadowBindingEntry & e){ if(e.is_group) return; if(s_pending_count >= (int)(sizeof(s_pending_reads)/sizeof(s_pending_reads[0]))) return; s_pending_reads[s_pending_count++]=PendingInitialRead{ch,e.node_id,(chip::EndpointId)e.endpoint,e.fabric_index}; s_pending_read_counts[ch]++; struct TimerCtx{ PendingInitialRead it; }; auto * tctx=chip::Platform::New<TimerCtx>(); if(!tctx) return; tctx->it=s_pending_reads[s_pending_count-1]; chip::DeviceLayer::SystemLayer().StartTimer(chip::System::Clock::Milliseconds32(0), [](chip::System::Layer*, void * arg){ auto * t=(TimerCtx*)arg; chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t a){ auto * t2=(TimerCtx*)a; send_initial_read(t2->it); chip::Platform::Delete(t2); }, (intptr_t)t); }, tctx); }
+// btn_act only: presses go through the coalescer (press_coalesce.h); light_manager_button_press() stays a direct send.
+static PressCoalescer s_coalesce;
+static int64_t press_window_us(){ uint32_t w=s_resp_ewma_us.load(std::memory_order_relaxed)/1000; if(LIGHT_PRESS_COALESCE_MAX_MS==0) w=0; else if(w<LIGHT_PRESS_COALESCE_MIN_MS) w=LIGHT_PRESS_COALESCE_MIN_MS; else if(w>LIGHT_PRESS_COALESCE_MAX_MS) w=LIGHT_PRESS_COALESCE_MAX_MS; s_m_press_window.set((int32_t)w); return (int64_t)w*1000; }
+static void coalesced_press(uint8_t ch, bool revert=false){ if(ch>=LIGHT_CHANNELS) return; if(s_coalesce.press(ch, esp_timer_get_time(), press_window_us())){ if(revert) send_group_toggle(ch, nullptr); else light_manager_button_press(ch); return; } if(!revert){ s_m_presses.inc(); s_m_press_merged.inc(); TRACE_INSTANT("btn.merged", ch); } s_led_any_on[ch]=!s_led_any_on[ch]; apply_led(ch, s_led_any_on[ch], true); } // merged: the LED still answers every press; revert: undo a speculative single press
+static void coalesce_flush(){ uint32_t cancelled=s_coalesce.cancelled(); int64_t now=esp_timer_get_time(); uint32_t send=s_coalesce.flush(now, press_window_us()); s_m_press_cancelled.inc(s_coalesce.cancelled()-cancelled); while(send){ uint8_t ch=(uint8_t)__builtin_ctz(send); send&=send-1; s_m_press_batched.inc(); s_press_us[ch]=now; ESP_LOGI(TAG,"CH%u: batched press -> one Toggle", ch); send_group_toggle(ch, nullptr, false); } }
 
-void light_manager_sync_initial_state(){ bool any=false; for(int ch=0;ch<LIGHT_CHANNELS;ch++) if(s_pending_read_counts[ch]) { any=true; break;} if(any) return; for(int ch=0;ch<LIGHT_CHANNELS;ch++){ s_round_any_on[ch]=false; s_pending_read_counts[ch]=0;} s_pending_count=0; for(int ch=0; ch<LIGHT_CHANNELS; ch++){ auto * list=shadow_binding_get_list(ch); if(!list||!list->count) continue; for(int i=0;i<list->count;i++){ if(!list->entries[i].is_group) schedule_single_initial_read(ch, list->entries[i]); } } }
+// btn_act only: gesture events (gesture.h). The single press is dispatched at once, speculatively; a
+// double / triple / long press then upgrades it (its action ran and supersedes the toggle) or cancels it
+// (no action ran: the toggle is undone through the coalescer). Dimming needs the state from before the
+// press: a light the press switched off is switched back on (cancel) and dimmed down, one it switched on
+// keeps the toggle (upgrade) and dims up.
+static GestureRecognizer s_gestures;
+static bool s_spec_single[LIGHT_CHANNELS]; // this sequence's single press went out and nothing superseded it yet
+static bool gesture_run(uint8_t ch, int action, bool start, int64_t edge_us=0){ switch(action){ case GESTURE_ACTION_ALL_OFF: if(start) for(uint8_t c=0;c<LIGHT_CHANNELS;c++){ s_coalesce.drop(c); send_group_onoff(c, false); } return true; case GESTURE_ACTION_DIM: if(start) dim_start(ch, s_led_any_on[ch]); else dim_stop(ch, edge_us); return true; case GESTURE_ACTION_SCENE: return !start || scene_engine_run(ch % SCENE_COUNT); default: return false; } }
+static void gesture_dispatched(uint8_t ch){ s_m_gesture_dispatch.record((uint32_t)esp_timer_get_time()-s_edge_us[ch].load(std::memory_order_relaxed)); }
+static void gesture_supersede(uint8_t ch, int action){ if(action==GESTURE_ACTION_DIM && s_spec_single[ch]){ s_spec_single[ch]=false; s_coalesce.drop(ch); bool was_on=!s_led_any_on[ch]; if(was_on){ s_m_gesture_cancelled.inc(); send_group_onoff(ch, true); } else s_m_gesture_upgraded.inc(); dim_start(ch, was_on); return; } bool ran=gesture_run(ch, action, true); if(!s_spec_single[ch]) return; s_spec_single[ch]=false; if(ran){ s_m_gesture_upgraded.inc(); return; } s_m_gesture_cancelled.inc(); coalesced_press(ch, true); }
+static void on_gesture(const GestureEvent & g){ TRACE_INSTANT("btn.gesture", g.kind); switch(g.kind){ case GestureEvent::Single: coalesced_press(g.ch); s_spec_single[g.ch]=kGestures!=0; gesture_dispatched(g.ch); break; case GestureEvent::Multi: (g.count==2 ? s_m_gesture_double : s_m_gesture_triple).inc(); ESP_LOGI(TAG,"CH%u: %u-press", g.ch, g.count); gesture_supersede(g.ch, g.count==2 ? LIGHT_GESTURE_DOUBLE : LIGHT_GESTURE_TRIPLE); gesture_dispatched(g.ch); break; case GestureEvent::LongStart: s_m_gesture_long.inc(); ESP_LOGI(TAG,"CH%u: long press", g.ch); gesture_supersede(g.ch, LIGHT_GESTURE_LONG); break; case GestureEvent::LongEnd: gesture_run(g.ch, LIGHT_GESTURE_LONG, false, g.edge_us); break; case GestureEvent::Complete: s_spec_single[g.ch]=false; break; default: break; } }
+// Generic Switch events (LIGHT_SWITCH_EVENTS). A second recogniser, independent of the gesture actions, always
+// tracks long and multi presses (up to LIGHT_SWITCH_MULTI_PRESS_MAX). btn_act runs it after the action path, and
+// its events go to the Matter thread behind the press's own dispatch, so a Toggle never waits for them. The job
+// ring (btn_act produces, Matter thread consumes) holds what is not logged yet; a full ring drops the event, and so
+// does a refused post: the producer publishes a slot only once its job is queued and never touches the log index.
+struct SwitchJob { uint8_t ch; SwitchEvent ev; uint8_t count; uint32_t edge_us; };
+static SwitchJob s_switch_jobs[16];
+static std::atomic<uint32_t> s_switch_posted{0}, s_switch_logged{0};
+static GestureRecognizer s_switch_gestures;
+static bool s_switch_long[LIGHT_CHANNELS]; // btn_act: the sequence is a long press (no MultiPressComplete)
+// Matter thread: log time (ms) of the last kSwitchEvtCap events, i.e. the ones the Info event buffer still holds.
+// An event logged past that evicts the oldest; its age is how far back a subscriber can catch up.
+static constexpr uint32_t kSwitchEvtCap=SWITCH_EVENT_BUFFER_BYTES/SWITCH_EVENT_BYTES;
+static_assert(kSwitchEvtCap>=1 && kSwitchEvtCap<=1024, "SWITCH_EVENT_BUFFER_BYTES / SWITCH_EVENT_BYTES must be 1..1024");
+static uint32_t s_switch_log_ms[kSwitchEvtCap];
+static uint32_t s_switch_log_total=0;
+static bool s_switch_short=false; // retention is below SWITCH_EVENT_RETENTION_WARN_S (warn once per episode)
+static void switch_buffer_note(){ uint32_t now_ms=(uint32_t)(esp_timer_get_time()/1000); uint32_t & slot=s_switch_log_ms[s_switch_log_total % kSwitchEvtCap]; if(s_switch_log_total>=kSwitchEvtCap){ uint32_t age_s=(now_ms-slot)/1000; bool was_short=s_switch_short; s_switch_short=age_s<SWITCH_EVENT_RETENTION_WARN_S; s_m_sw_evicted.inc(); s_m_sw_retention.set((int32_t)age_s); if(s_switch_short && !was_short) ESP_LOGW(TAG,"Switch events evicted after %" PRIu32 " s (< %d s); raise CONFIG_EVENT_LOGGING_INFO_BUFFER_SIZE", age_s, SWITCH_EVENT_RETENTION_WARN_S); } slot=now_ms; s_switch_log_total++; }
+static void switch_event_post(uint8_t ch, SwitchEvent ev, uint8_t count, int64_t edge_us){ constexpr uint32_t ring=sizeof(s_switch_jobs)/sizeof(s_switch_jobs[0]); uint32_t n=s_switch_posted.load(std::memory_order_relaxed); if(n-s_switch_logged.load(std::memory_order_acquire)>=ring){ s_m_sw_drops.inc(); return; } s_switch_jobs[n % ring]=SwitchJob{ch, ev, count, (uint32_t)edge_us}; esp_err_t err=work_probe_schedule(WorkSource::SwitchEvent, [](intptr_t arg){ SwitchJob job=s_switch_jobs[arg]; s_switch_logged.fetch_add(1, std::memory_order_release); if(!light_switch_log_event(g_onoff_endpoint_ids[job.ch], job.ev, job.count)){ s_m_sw_fail.inc(); return; } s_m_sw_events.inc(); s_m_sw_lag.record((uint32_t)esp_timer_get_time()-job.edge_us); switch_buffer_note(); }, (intptr_t)(n % ring)); if(err!=ESP_OK){ s_m_sw_drops.inc(); return; } s_switch_posted.store(n+1, std::memory_order_release); s_m_sw_backlog.set((int32_t)(n+1-s_switch_logged.load(std::memory_order_relaxed))); }
+static void on_switch_gesture(const GestureEvent & g){ uint8_t ch=g.ch; switch(g.kind){ case GestureEvent::Single: case GestureEvent::Multi: s_switch_long[ch]=false; switch_event_post(ch, SwitchEvent::InitialPress, g.count, g.edge_us); if(g.count>1) switch_event_post(ch, SwitchEvent::MultiPressOngoing, g.count, g.edge_us); break; case GestureEvent::LongStart: s_switch_long[ch]=true; switch_event_post(ch, SwitchEvent::LongPress, g.count, g.edge_us); break; case GestureEvent::LongEnd: switch_event_post(ch, SwitchEvent::LongRelease, g.count, g.edge_us); break; case GestureEvent::ShortRelease: switch_event_post(ch, SwitchEvent::ShortRelease, g.count, g.edge_us); break; case GestureEvent::Complete: if(!s_switch_long[ch]) switch_event_post(ch, SwitchEvent::MultiPressComplete, g.count, g.edge_us); s_switch_long[ch]=false; break; } }
+static void button_act_task(void*){ uint8_t evt; while(true){ int64_t due=std::min({s_coalesce.next_deadline_us(), s_gestures.next_deadline_us(), s_switch_gestures.next_deadline_us()}), now=esp_timer_get_time(); TickType_t wait=due==INT64_MAX ? portMAX_DELAY : (TickType_t)((due-now+portTICK_PERIOD_MS*1000-1)/(portTICK_PERIOD_MS*1000)); if(xQueueReceive(s_button_evt_queue,&evt,due>now ? wait : 0)==pdTRUE){ uint8_t ch=evt & ~kBtnEvtRelease; bool rel=evt & kBtnEvtRelease; now=esp_timer_get_time(); if(!kGestures){ if(!rel) coalesced_press(ch); } else if(rel) s_gestures.release(ch, now, on_gesture); else s_gestures.press(ch, now, on_gesture); if(LIGHT_SWITCH_EVENTS){ if(rel) s_switch_gestures.release(ch, now, on_switch_gesture); else s_switch_gestures.press(ch, now, on_switch_gesture); } } now=esp_timer_get_time(); s_gestures.poll(now, on_gesture); s_switch_gestures.poll(now, on_switch_gesture); coalesce_flush(); } }
 
-static void send_group_toggle(uint8_t ch); // forward
-void light_manager_button_press(uint8_t channel){ if(channel>=LIGHT_CHANNELS) return; g_last_press_tick=(uint32_t)xTaskGetTickCount(); const ShadowBindingList * list=shadow_binding_get_list(channel); int uni=0; if(list) for(int i=0;i<list->count;i++) if(!list->entries[i].is_group) uni++; ESP_LOGI(TAG,"Button press CH%u (unicast=%d)",channel,uni); if(s_led_gpios[channel]!=GPIO_NUM_NC){ apply_led(channel, !s_led_any_on[channel]); if(!s_led_blink_timers[channel]){ esp_timer_create_args_t a={ .callback=&led_blink_timer_cb, .arg=(void*)(uintptr_t)channel, .dispatch_method=ESP_TIMER_TASK, .name="ledblink" }; esp_timer_create(&a,&s_led_blink_timers[channel]); } if(s_led_blink_timers[channel]) esp_timer_start_once(s_led_blink_timers[channel], 40*1000); } send_group_toggle(channel); }
+// Boot: take back the presses a reboot interrupted; they replay with the first sync round after the link is up.
+static void offline_restore(){ if(!s_journal_timer){ esp_timer_create_args_t ta={ .callback=&journal_timer_cb, .arg=nullptr, .dispatch_method=ESP_TIMER_TASK, .name="offline_jrnl" }; esp_timer_create(&ta,&s_journal_timer); } static OfflineJournal j; s_offline.reset(); if(!light_offline_journal_load(&j)) return; s_offline.from_journal(j, esp_timer_get_time()); for(uint8_t i=0;i<j.count && i<LIGHT_CHANNELS;i++){ uint8_t ch=j.entries[i].ch; if(!s_offline.pending(ch)) continue; s_led_any_on[ch]=j.entries[i].on; apply_led(ch, s_led_any_on[ch]); led_engine_fx(ch, LedFx::Pending, true); } s_m_off_depth.set(s_offline.depth()); if(j.count) ESP_LOGI(TAG,"offline: %u held press(es) restored from NVS", j.count); }
+esp_err_t light_manager_init(){ buttons_init(); led_engine_init(); scene_engine_init(); s_txns.reset(); s_fanout.reset(); s_sync_reads.reset(); s_health.reset(); s_health.configure(LIGHT_BREAKER_FAILS, LIGHT_BREAKER_BACKOFF_MIN_MS, LIGHT_BREAKER_BACKOFF_MAX_MS); s_coalesce.reset(); s_gestures.configure(kGestures, (int64_t)LIGHT_GESTURE_GAP_MS*1000, (int64_t)LIGHT_GESTURE_LONG_MS*1000); if(LIGHT_SWITCH_EVENTS) s_switch_gestures.configure(GestureRecognizer::kDouble | (LIGHT_SWITCH_MULTI_PRESS_MAX>=3 ? GestureRecognizer::kTriple : 0) | GestureRecognizer::kLong, (int64_t)LIGHT_GESTURE_GAP_MS*1000, (int64_t)LIGHT_GESTURE_LONG_MS*1000); if(!s_txn_timer){ esp_timer_create_args_t ta={ .callback=&txn_timer_cb, .arg=nullptr, .dispatch_method=ESP_TIMER_TASK, .name="press_txn" }; esp_timer_create(&ta,&s_txn_timer); } if(!s_sync_timer){ esp_timer_create_args_t ta={ .callback=&sync_timer_cb, .arg=nullptr, .dispatch_method=ESP_TIMER_TASK, .name="sync_reads" }; esp_timer_create(&ta,&s_sync_timer); } if(!s_stop_retry_timer){ esp_timer_create_args_t ta={ .callback=&stop_retry_cb, .arg=nullptr, .dispatch_method=ESP_TIMER_TASK, .name="dim_stop" }; esp_timer_create(&ta,&s_stop_retry_timer); } if(kOffline) offline_restore(); s_button_evt_queue=rtos_static_queue_create(RtosQueue::BtnEvt); s_button_task=rtos_static_task_start(RtosTask::BtnPoll,button_task,nullptr,tskIDLE_PRIORITY+1);
+#if BUTTON_IO != BUTTON_IO_GPIO
+    if(iox_init(s_button_task)!=ESP_OK) ESP_LOGE(TAG,"I/O expander init failed; buttons disabled"); else xTaskNotifyGive(s_button_task); // first scan now, not after the idle rescan
+#endif
+    s_button_act_task=rtos_static_task_start(RtosTask::BtnAct,button_act_task,nullptr,tskIDLE_PRIORITY+2); ESP_LOGI(TAG,"Light manager init complete"); return ESP_OK; }
 
-static void send_group_toggle(uint8_t ch){ if(ch>=LIGHT_CHANNELS) return; s_led_any_on[ch]=!s_led_any_on[ch]; apply_led(ch, s_led_any_on[ch]); chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t arg){ uint8_t ch_i=(uint8_t)arg; esp_matter::client::request_handle req={}; chip::app::CommandPathParams path(g_onoff_endpoint_ids[ch_i],0, chip::app::Clusters::OnOff::Id, chip::app::Clusters::OnOff::Commands::Toggle::Id, (chip::app::CommandPathFlags)0); req.command_path=path; esp_err_t err=esp_matter::client::cluster_update(g_onoff_endpoint_ids[ch_i], &req); if(err!=ESP_OK) ESP_LOGW(TAG,"cluster_update failed ch%u err=%d", ch_i, err); else ESP_LOGI(TAG,"CH%u: Toggle dispatched", ch_i); }, (intptr_t)ch); }
+void light_manager_identify(uint16_t endpoint_id, bool on){ bool light_ep=false; for(int ch=0;ch<LIGHT_CHANNELS;ch++) if(g_onoff_endpoint_ids[ch]==endpoint_id){ light_ep=true; led_engine_fx(ch, LedFx::Identify, on); } if(!light_ep) for(int ch=0;ch<LIGHT_CHANNELS;ch++) led_engine_fx(ch, LedFx::Identify, on); } // other endpoints: whole panel
 
-esp_err_t light_manager_init(){ buttons_init(); leds_init(); s_button_evt_queue=xQueueCreate(8,sizeof(uint8_t)); if(!s_button_evt_queue) return ESP_ERR_NO_MEM; xTaskCreate(button_task,"btn_poll",2048,nullptr,tskIDLE_PRIORITY+1,&s_button_task); auto act=[](void*){ uint8_t ch; while(true){ if(xQueueReceive(s_button_evt_queue,&ch,portMAX_DELAY)==pdTRUE) light_manager_button_press(ch);} }; xTaskCreate(act,"btn_act",3072,nullptr,tskIDLE_PRIORITY+2,&s_button_act_task); ESP_LOGI(TAG,"Light manager init complete"); return ESP_OK; }
+// `matter health`: one line per tracked target (the console reads the Matter-thread table for display only).
+int light_manager_health_command(int argc, char ** argv){ if(argc>=1 && strcmp(argv[0],"reset")==0){ work_probe_schedule(WorkSource::BindingRefresh, [](intptr_t){ s_health.reset(); s_m_health_open.set(0); }); return 0; } if(argc>=1){ printf("Usage: matter health [reset]\n"); return 1; } static const char * const kState[]={"ok","open","probing"}; int64_t now=esp_timer_get_time(); int n=0; for(int i=0;i<s_health.size();i++){ const TargetHealth & t=s_health.entries()[i]; if(!t.node_id) continue; n++; char seen[24]="never"; if(t.last_seen_us) snprintf(seen, sizeof(seen), "%lds ago", (long)((now-t.last_seen_us)/1000000)); printf("0x%016" PRIX64 "/%u %-7s rtt %.1fms fails %u seen %s ok %" PRIu32 " failed %" PRIu32 " skipped %" PRIu32, t.node_id, t.endpoint, kState[t.state], t.rtt_ewma_us/1000.0, t.fails, seen, t.ok, t.failed, t.skipped); if(t.state!=TargetHealth::Closed) printf(" backoff %" PRIu32 "s probe in %lds", t.backoff_ms/1000, (long)((t.probe_us-now)/1000000)); printf("\n"); } if(!n) printf("no targets seen yet\n"); return 0; }
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t health_console_handler(int argc, char ** argv){ light_manager_health_command(argc, argv); return ESP_OK; }
+#endif
+void light_manager_register_console(){
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[]={ { .name="health", .description="Bound target health / circuit breakers. Usage: matter health [reset]", .handler=health_console_handler } }; esp_matter::console::add_commands(cmds, sizeof(cmds)/sizeof(cmds[0]));
+#endif
+}
 
 void dht22_start_task(){ temp_manager_start(); }
 
@@ -1,5 +1,5 @@
 /*
- * Light manager for 1-4 on/off channels and DHT22 sensor.
+ * Light manager for 1-16 on/off channels and DHT22 sensor.
  */
 #pragma once
 
@@ -47,11 +47,45 @@ extern const ShadowBindingList * shadow_binding_get_list(int ch);
 
 esp_err_t light_manager_init();
 void light_manager_button_press(uint8_t channel);
+
+// Outcome of one Toggle sent to one bound unicast target (delivered on the Matter thread).
+// node_id == 0 means the local dispatch itself failed (cluster_update error) and no target was tried.
+typedef struct {
+	uint64_t node_id;
+	uint16_t endpoint;
+	bool ok;          // Success status received from the target
+	uint32_t rtt_us;  // CommandSender send -> response / error (0 if the send itself failed)
+} LightToggleResult;
+typedef void (*light_toggle_result_cb_t)(void * ctx, const LightToggleResult * result);
+typedef struct {
+	light_toggle_result_cb_t cb;
+	void * ctx;
+} LightToggleObserver;
+
+// Same dispatch path as a physical button press (LED flip + Toggle to all bindings of `channel`).
+// `obs` may be null; otherwise it must outlive every response and receives one callback per unicast target.
+// The observer rides on the press transaction: responses after LIGHT_PRESS_TXN_TIMEOUT_MS, or after the
+// press was dropped from a full table (LIGHT_PRESS_TXN_MAX presses in flight), are not delivered.
+void light_manager_toggle_dispatch(uint8_t channel, const LightToggleObserver * obs);
 bool light_manager_get(uint8_t channel);
+// Switch `channel` on or off through the button dispatch path (LED + On / Off to all its bindings).
+void light_manager_set(uint8_t channel, bool on);
+
+// Identify cluster: blink the LED of the channel owning `endpoint_id` (every LED for any other
+// endpoint) until called again with on = false.
+void light_manager_identify(uint16_t endpoint_id, bool on);
 
 // Boot-time sync: query bound targets' OnOff attribute and set initial LED state.
 // Safe to call after Matter stack started and shadow bindings committed.
 void light_manager_sync_initial_state();
+// `matter health` console command (bound target health and circuit breakers); also the host
+// simulator's `health` command.
+int light_manager_health_command(int argc, char ** argv);
+void light_manager_register_console();
+
+// Network or session state changed: replay the presses held while offline, if the link is up again.
+// Any thread.
+void light_manager_connectivity_changed();
 
 // DHT22 task controls
 void dht22_start_task();
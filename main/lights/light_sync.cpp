@@ -0,0 +1,29 @@
+/* LED state sync transport: CASE session + one OnOff attribute read per peer node, covering all of its bound endpoints (sync_batch.h). */
+#include "light_internal.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <platform/PlatformManager.h>
+#include "matter_await.h"
+#include "diag/metrics.h"
+#include "diag/work_probe.h"
+#include "diag/trace.h"
+
+static const char * TAG = "light_sync";
+
+static metrics::Counter s_m_sync_read_errors("light.sync_read_errors");
+static metrics::Counter s_m_sync_session_fail("light.sync_session_fail");
+
+// One read request to a peer node. An endpoint bound on several channels is requested once; its value goes to every path with it.
+struct PendingNodeRead { intptr_t req; uint64_t node; uint8_t fabric_index; uint8_t n; LightSyncPath paths[SyncBatchPlan::kMaxPaths]; };
+
+// Health: one report per distinct endpoint of the request.
+static void report_endpoints(const PendingNodeRead & r, bool ok, uint32_t rtt_us){ for(uint8_t i=0;i<r.n;i++){ bool dup=false; for(uint8_t j=0;j<i && !dup;j++) dup=r.paths[j].endpoint==r.paths[i].endpoint; if(!dup) light_target_report(r.node, r.paths[i].endpoint, ok, ok ? rtt_us : 0); } }
+
+// Hop onto the Matter work queue (LedSync probe), so a read starts after the round that planned it; false (not suspended) if the timer failed.
+// Once suspended the read must always resume: if the work queue refuses the job (wq.rejected), the timer callback, also on the Matter thread, resumes it in place.
+struct ToMatterWork { bool ok=false; bool await_ready() const { return false; } bool await_suspend(std::coroutine_handle<> h){ ok=chip::DeviceLayer::SystemLayer().StartTimer(chip::System::Clock::Milliseconds32(0), [](chip::System::Layer*, void * a){ if(work_probe_schedule(WorkSource::LedSync, [](intptr_t x){ std::coroutine_handle<>::from_address((void*)x).resume(); }, (intptr_t)a)!=ESP_OK){ ESP_LOGW(TAG,"work queue full: sync read runs from the timer"); std::coroutine_handle<>::from_address(a).resume(); } }, h.address())==CHIP_NO_ERROR; return ok; } bool await_resume() const { return ok; } };
+
+// One request: session, then the read; light_sync_on_done() exactly once whichever way it ends. `*started` is settled before the first suspension.
+static coro::Task node_read(PendingNodeRead r, bool * started){ ToMatterWork hop; *started=true; if(!co_await hop){ *started=false; co_return; } TRACE_ASYNC_BEGIN("case.establish", r.req); coro::SessionResult s=co_await coro::session(r.fabric_index, r.node); TRACE_ASYNC_END("case.establish", r.req); if(!s){ s_m_sync_session_fail.inc(); ESP_LOGW(TAG,"Session fail node=0x%016" PRIX64 " err=%" CHIP_ERROR_FORMAT, r.node, s.err.Format()); report_endpoints(r, false, 0); light_sync_on_done(r.req); co_return; } chip::app::AttributePathParams paths[SyncBatchPlan::kMaxPaths]; size_t m=0; for(uint8_t i=0;i<r.n;i++){ bool dup=false; for(size_t j=0;j<m && !dup;j++) dup=paths[j].mEndpointId==r.paths[i].endpoint; if(dup) continue; paths[m].mEndpointId=r.paths[i].endpoint; paths[m].mClusterId=chip::app::Clusters::OnOff::Id; paths[m].mAttributeId=chip::app::Clusters::OnOff::Attributes::OnOff::Id; m++; } const int64_t start_us=esp_timer_get_time(); coro::ReadResult rd=co_await coro::read(s, paths, m, [&r](const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data, const chip::app::StatusIB & status){ if(status.mStatus!=chip::Protocols::InteractionModel::Status::Success) return; if(path.mClusterId!=chip::app::Clusters::OnOff::Id || path.mAttributeId!=chip::app::Clusters::OnOff::Attributes::OnOff::Id) return; bool on=false; if(!data || data->Get(on)!=CHIP_NO_ERROR) return; for(uint8_t i=0;i<r.n;i++) if(r.paths[i].endpoint==path.mEndpointId) light_sync_on_value(r.req, r.paths[i].ch, on); }); if(rd.err!=CHIP_NO_ERROR){ s_m_sync_read_errors.inc(); ESP_LOGW(TAG,"node=0x%016" PRIX64 " read error %" CHIP_ERROR_FORMAT, r.node, rd.err.Format()); } if(rd.sent) report_endpoints(r, rd.err==CHIP_NO_ERROR, (uint32_t)(esp_timer_get_time()-start_us)); light_sync_on_done(r.req); }
+
+bool light_sync_send_reads(uint8_t fabric_index, uint64_t node_id, const LightSyncPath * paths, uint8_t n, intptr_t req){ if(!n || n>SyncBatchPlan::kMaxPaths) return false; PendingNodeRead r{ req, node_id, fabric_index, n, {} }; for(uint8_t i=0;i<n;i++) r.paths[i]=paths[i]; bool started=false; return node_read(r, &started) && started; }
@@ -0,0 +1,219 @@
+/*
+ * Awaitables over the Matter client calls of the light transports, for coro::Task coroutines (coro.h):
+ *
+ *   coro::SessionResult s = co_await coro::session(fabric_index, node_id);       // FindOrEstablishSession
+ *   coro::ReadResult r = co_await coro::read(s, paths, n, on_data);              // ReadClient
+ *   coro::InvokeResult c = co_await coro::invoke(s, endpoint, cluster, command); // CommandSender
+ *
+ * Each awaitable lives in the coroutine frame and owns its CHIP callback objects there, along with
+ * the ReadClient or CommandSender. The transports therefore need no Platform::New and no cleanup per
+ * path: when the frame ends, everything in it goes with it.
+ *
+ * The coroutine is resumed from inside the CHIP callback. The session handle is only valid there, and
+ * OnDone is where a client may be destroyed. Two rules follow:
+ *   - read() or invoke() must follow session() without any suspension in between.
+ *   - Code after a co_await may run before the call that started the coroutine has returned.
+ *
+ * Firmware only (needs the Matter stack); the host build stands in for the transports (host/app).
+ */
+#pragma once
+
+#include <new>
+#include <app/CommandSender.h>
+#include <app/InteractionModelEngine.h>
+#include <app/ReadClient.h>
+#include <app/server/Server.h>
+#include <lib/core/ScopedNodeId.h>
+
+#include "coro.h"
+
+namespace coro {
+
+// The fabric a binding's fabric index stands for (undefined: the first initialized fabric).
+inline chip::FabricIndex resolve_fabric(uint8_t fabric_index)
+{
+    if (fabric_index != chip::kUndefinedFabricIndex) return fabric_index;
+    for (auto & f : chip::Server::GetInstance().GetFabricTable())
+        if (f.IsInitialized()) return f.GetFabricIndex();
+    return chip::kUndefinedFabricIndex;
+}
+
+struct SessionResult {
+    CHIP_ERROR err;
+    bool cached; // an existing session answered: no CASE exchange
+    chip::Messaging::ExchangeManager * em;
+    const chip::SessionHandle * handle; // valid until the coroutine next suspends
+    explicit operator bool() const { return err == CHIP_NO_ERROR; }
+};
+
+class SessionAwait {
+public:
+    SessionAwait(uint8_t fabric_index, uint64_t node_id)
+        : m_node(node_id), m_fabric(resolve_fabric(fabric_index)), m_on_conn(&connected, this), m_on_fail(&failed, this)
+    {
+    }
+    SessionAwait(const SessionAwait &) = delete; // the callbacks point at this object
+    SessionAwait & operator=(const SessionAwait &) = delete;
+
+    bool await_ready()
+    {
+        m_mgr = chip::Server::GetInstance().GetCASESessionManager();
+        if (m_fabric != chip::kUndefinedFabricIndex && m_mgr) return false;
+        m_res.err = CHIP_ERROR_INCORRECT_STATE;
+        return true;
+    }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        m_h = h;
+        s_in_find = true; // a cached session answers from inside the call
+        m_mgr->FindOrEstablishSession(chip::ScopedNodeId(m_node, m_fabric), &m_on_conn, &m_on_fail);
+        s_in_find = false; // no member access past the call: the coroutine may have run to its end
+    }
+    SessionResult await_resume() const { return m_res; }
+
+private:
+    static void connected(void * ctx, chip::Messaging::ExchangeManager & em, const chip::SessionHandle & sh)
+    {
+        auto * a = static_cast<SessionAwait *>(ctx);
+        a->m_res = SessionResult{ CHIP_NO_ERROR, s_in_find, &em, &sh };
+        a->m_h.resume();
+    }
+    static void failed(void * ctx, const chip::ScopedNodeId &, CHIP_ERROR err)
+    {
+        auto * a = static_cast<SessionAwait *>(ctx);
+        a->m_res.err = err;
+        a->m_h.resume();
+    }
+
+    static inline bool s_in_find = false;
+
+    uint64_t m_node;
+    chip::FabricIndex m_fabric;
+    chip::CASESessionManager * m_mgr = nullptr;
+    std::coroutine_handle<> m_h;
+    SessionResult m_res{ CHIP_NO_ERROR, false, nullptr, nullptr };
+    chip::Callback::Callback<chip::OnDeviceConnected> m_on_conn;
+    chip::Callback::Callback<chip::OnDeviceConnectionFailure> m_on_fail;
+};
+
+inline SessionAwait session(uint8_t fabric_index, uint64_t node_id) { return SessionAwait(fabric_index, node_id); }
+
+struct ReadResult {
+    CHIP_ERROR err; // first error of the read (CHIP_NO_ERROR: every report arrived)
+    bool sent;      // false: SendRequest failed, nothing reached the peer
+};
+
+// `on_data(path, data, status)` runs for every attribute report.
+template <typename OnData>
+class ReadAwait : public chip::app::ReadClient::Callback {
+public:
+    ReadAwait(const SessionResult & s, chip::app::AttributePathParams * paths, size_t n, OnData on_data)
+        : m_session(s), m_paths(paths), m_n(n), m_on_data(on_data)
+    {
+    }
+    ReadAwait(const ReadAwait &) = delete;
+    ReadAwait & operator=(const ReadAwait &) = delete;
+    ~ReadAwait() override
+    {
+        if (m_client) m_client->~ReadClient();
+    }
+
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_h = h;
+        m_client = new (m_storage) chip::app::ReadClient(chip::app::InteractionModelEngine::GetInstance(), m_session.em, *this,
+                                                         chip::app::ReadClient::InteractionType::Read);
+        chip::app::ReadPrepareParams params(*m_session.handle);
+        params.mpAttributePathParamsList = m_paths;
+        params.mAttributePathParamsListSize = m_n;
+        m_res.err = m_client->SendRequest(params);
+        m_res.sent = m_res.err == CHIP_NO_ERROR;
+        return m_res.sent; // a failed send gets no callbacks
+    }
+    ReadResult await_resume() const { return m_res; }
+
+    void OnAttributeData(const chip::app::ConcreteDataAttributePath & path, chip::TLV::TLVReader * data,
+                         const chip::app::StatusIB & status) override
+    {
+        m_on_data(path, data, status);
+    }
+    void OnError(CHIP_ERROR err) override
+    {
+        if (m_res.err == CHIP_NO_ERROR) m_res.err = err;
+    }
+    void OnDone(chip::app::ReadClient *) override { m_h.resume(); } // the frame, and the client with it, may end here
+
+private:
+    SessionResult m_session;
+    chip::app::AttributePathParams * m_paths;
+    size_t m_n;
+    OnData m_on_data;
+    std::coroutine_handle<> m_h;
+    ReadResult m_res{ CHIP_NO_ERROR, false };
+    chip::app::ReadClient * m_client = nullptr;
+    alignas(chip::app::ReadClient) uint8_t m_storage[sizeof(chip::app::ReadClient)];
+};
+
+template <typename OnData>
+ReadAwait<OnData> read(const SessionResult & s, chip::app::AttributePathParams * paths, size_t n, OnData on_data)
+{
+    return ReadAwait<OnData>(s, paths, n, on_data);
+}
+
+struct InvokeResult {
+    CHIP_ERROR err; // send failure or exchange error (timeout, ...)
+    bool responded;
+    chip::Protocols::InteractionModel::Status status;
+    bool ok() const { return err == CHIP_NO_ERROR && responded && status == chip::Protocols::InteractionModel::Status::Success; }
+};
+
+// A command without fields (OnOff On / Off / Toggle).
+class InvokeAwait : public chip::app::CommandSender::Callback {
+public:
+    InvokeAwait(const SessionResult & s, uint16_t endpoint, chip::ClusterId cluster, chip::CommandId cmd) : m_session(s)
+    {
+        m_sender = new (m_storage) chip::app::CommandSender(this, s.em);
+        chip::app::CommandPathParams cp(endpoint, 0, cluster, cmd, chip::app::CommandPathFlags::kEndpointIdValid);
+        m_res.err = m_sender->PrepareCommand(cp);
+        if (m_res.err == CHIP_NO_ERROR) m_res.err = m_sender->FinishCommand();
+    }
+    InvokeAwait(const InvokeAwait &) = delete;
+    InvokeAwait & operator=(const InvokeAwait &) = delete;
+    ~InvokeAwait() override { m_sender->~CommandSender(); }
+
+    bool await_ready() const { return m_res.err != CHIP_NO_ERROR; }
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_h = h;
+        m_res.err = m_sender->SendCommandRequest(*m_session.handle);
+        return m_res.err == CHIP_NO_ERROR; // a failed send gets no callbacks
+    }
+    InvokeResult await_resume() const { return m_res; }
+
+    void OnResponse(chip::app::CommandSender *, const chip::app::ConcreteCommandPath &, const chip::app::StatusIB & status,
+                    chip::TLV::TLVReader *) override
+    {
+        m_res.responded = true;
+        m_res.status = status.mStatus;
+    }
+    void OnError(const chip::app::CommandSender *, CHIP_ERROR err) override
+    {
+        if (m_res.err == CHIP_NO_ERROR) m_res.err = err;
+    }
+    void OnDone(chip::app::CommandSender *) override { m_h.resume(); } // the frame, and the sender with it, may end here
+
+private:
+    SessionResult m_session;
+    std::coroutine_handle<> m_h;
+    InvokeResult m_res{ CHIP_NO_ERROR, false, chip::Protocols::InteractionModel::Status::Failure };
+    chip::app::CommandSender * m_sender;
+    alignas(chip::app::CommandSender) uint8_t m_storage[sizeof(chip::app::CommandSender)];
+};
+
+inline InvokeAwait invoke(const SessionResult & s, uint16_t endpoint, chip::ClusterId cluster, chip::CommandId cmd)
+{
+    return InvokeAwait(s, endpoint, cluster, cmd);
+}
+
+} // namespace coro
@@ -0,0 +1,61 @@
+/* Offline queue transport: link state from the CHIP connectivity manager and the NVS journal
+ * (namespace "offlineq", key "held"). */
+#include "light_internal.h"
+
+#include <stddef.h>
+#include <esp_log.h>
+#include <nvs.h>
+#include <platform/CHIPDeviceLayer.h>
+
+#include "diag/trace.h"
+
+static const char * TAG = "offline_jrnl";
+static const char * k_offline_nvs_namespace = "offlineq";
+
+// Header plus the held entries only: 2 + 8 * count bytes.
+static size_t blob_size(uint8_t count) { return offsetof(OfflineJournal, entries) + count * sizeof(OfflineJournal::Entry); }
+
+bool light_link_up()
+{
+    auto & cm = chip::DeviceLayer::ConnectivityMgr();
+#if CHIP_DEVICE_CONFIG_ENABLE_WIFI
+    if (cm.IsWiFiStationConnected()) return true;
+#endif
+#if CHIP_DEVICE_CONFIG_ENABLE_THREAD
+    if (cm.IsThreadAttached()) return true;
+#endif
+    (void)cm;
+    return false;
+}
+
+bool light_offline_journal_save(const OfflineJournal & j)
+{
+    if (j.count > LIGHT_CHANNELS) return false;
+    TRACE_SCOPE("nvs.save");
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(k_offline_nvs_namespace, NVS_READWRITE, &h);
+    if (err != ESP_OK) return false;
+    err = j.count ? nvs_set_blob(h, "held", &j, blob_size(j.count)) : nvs_erase_key(h, "held");
+    if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK; // nothing held, nothing stored
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK) ESP_LOGW(TAG, "Failed saving offline journal err=%d", (int)err);
+    return err == ESP_OK;
+}
+
+bool light_offline_journal_load(OfflineJournal * out)
+{
+    nvs_handle_t h;
+    if (nvs_open(k_offline_nvs_namespace, NVS_READONLY, &h) != ESP_OK) return false;
+    OfflineJournal tmp = {};
+    size_t len = sizeof(OfflineJournal);
+    esp_err_t err = nvs_get_blob(h, "held", &tmp, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return false;
+    if (tmp.version != OfflineJournal::kVersion || tmp.count > LIGHT_CHANNELS || len != blob_size(tmp.count)) { // sanitize
+        ESP_LOGW(TAG, "Ignoring stored offline journal (version %u, %u bytes)", tmp.version, (unsigned)len);
+        return false;
+    }
+    *out = tmp;
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+ * Offline command queue: the state each channel's targets should end in while the network is down.
+ *
+ * A press that cannot be dispatched (no link, or cluster_update failed) is held as its channel's
+ * final On / Off state. Later presses on the same channel replace it (coalesced), so the queue is
+ * bounded at one entry per channel and a replay sends one absolute command per channel, not every
+ * toggle. Entries older than the caller's maximum age are dropped instead of replayed. The queue
+ * converts to and from a compact journal that light_manager writes behind to NVS.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "app_config.h"
+
+// NVS journal: one record per held channel (only `count` records are stored).
+struct OfflineJournal {
+    static constexpr uint8_t kVersion = 1;
+    struct Entry {
+        uint8_t ch;
+        uint8_t on;
+        uint16_t presses; // presses folded into the entry
+        uint32_t age_s;   // age when the journal was written
+    };
+    uint8_t version;
+    uint8_t count;
+    Entry entries[LIGHT_CHANNELS];
+};
+
+class OfflineQueue {
+public:
+    void reset()
+    {
+        for (Slot & s : m) s = {};
+    }
+
+    // Hold `on` as the final state of channel ch. Returns false if it replaced an earlier entry.
+    bool put(uint8_t ch, bool on, int64_t now_us)
+    {
+        if (ch >= LIGHT_CHANNELS) return false;
+        Slot & s = m[ch];
+        bool fresh = !s.held;
+        if (fresh) s = Slot{ true, on, 0, now_us };
+        s.on = on;
+        if (s.presses < UINT16_MAX) s.presses++;
+        return fresh;
+    }
+    bool pending(uint8_t ch) const { return ch < LIGHT_CHANNELS && m[ch].held; }
+    uint8_t depth() const
+    {
+        uint8_t n = 0;
+        for (const Slot & s : m) n += s.held;
+        return n;
+    }
+    // Remove channel ch's entry; `*on` is the state to send.
+    bool take(uint8_t ch, bool * on)
+    {
+        if (!pending(ch)) return false;
+        *on = m[ch].on;
+        m[ch].held = false;
+        return true;
+    }
+    // Drop entries held for longer than max_age_us. Returns how many were dropped.
+    int expire(int64_t now_us, int64_t max_age_us)
+    {
+        int n = 0;
+        for (Slot & s : m)
+            if (s.held && now_us - s.since_us > max_age_us) {
+                s.held = false;
+                n++;
+            }
+        return n;
+    }
+    // Age of the oldest entry (0 when empty).
+    int64_t oldest_age_us(int64_t now_us) const
+    {
+        int64_t age = 0;
+        for (const Slot & s : m)
+            if (s.held && now_us - s.since_us > age) age = now_us - s.since_us;
+        return age;
+    }
+
+    void to_journal(OfflineJournal & j, int64_t now_us) const
+    {
+        j.version = OfflineJournal::kVersion;
+        j.count = 0;
+        for (uint8_t ch = 0; ch < LIGHT_CHANNELS; ch++)
+            if (m[ch].held) j.entries[j.count++] = { ch, m[ch].on, m[ch].presses, (uint32_t)((now_us - m[ch].since_us) / 1000000) };
+    }
+    // Restore a journal written before a reboot. The time spent rebooting is not known and not counted.
+    void from_journal(const OfflineJournal & j, int64_t now_us)
+    {
+        reset();
+        if (j.version != OfflineJournal::kVersion) return;
+        for (uint8_t i = 0; i < j.count && i < LIGHT_CHANNELS; i++) {
+            const OfflineJournal::Entry & e = j.entries[i];
+            if (e.ch < LIGHT_CHANNELS) m[e.ch] = Slot{ true, e.on != 0, e.presses, now_us - (int64_t)e.age_s * 1000000 };
+        }
+    }
+
+private:
+    struct Slot {
+        bool held;
+        bool on;
+        uint16_t presses;
+        int64_t since_us; // first press held
+    };
+    Slot m[LIGHT_CHANNELS] = {};
+};
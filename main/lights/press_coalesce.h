@@ -0,0 +1,90 @@
+/*
+ * Per-channel press coalescer.
+ *
+ * Every press flips the LED right away, but a channel sends at most one Toggle per batch window.
+ * A press on an idle channel is sent at once and opens a window. Presses inside the window are held.
+ * When the window ends, an odd number of held presses is one net state change. It is sent as a
+ * single Toggle, and that Toggle opens the next window. An even number cancels out, so nothing is
+ * sent and the channel is idle again. Hammering a button therefore costs one Toggle per window, and
+ * the targets end in the state the LED shows.
+ *
+ * The caller picks the window per press (light_manager.cpp sizes it to the current response time).
+ * Not thread safe: owned by the btn_act task.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+class PressCoalescer {
+public:
+    void reset()
+    {
+        for (Chan & c : m_ch) c = Chan{};
+    }
+
+    // A debounced press on `ch`. Returns true if it should be sent now; false if it was merged into
+    // the open window.
+    bool press(uint8_t ch, int64_t now_us, int64_t window_us)
+    {
+        if (ch >= LIGHT_CHANNELS) return false;
+        Chan & c = m_ch[ch];
+        if (!c.open) {
+            c.open = true;
+            c.deadline_us = now_us + window_us;
+            return true;
+        }
+        c.held++;
+        m_merged++;
+        return false;
+    }
+
+    // Forget the presses held on `ch` (an absolute command superseded them). The window stays open.
+    void drop(uint8_t ch)
+    {
+        if (ch < LIGHT_CHANNELS) m_ch[ch].held = 0;
+    }
+
+    // Close every window that has ended. Returns the channels that owe one net Toggle. Those windows
+    // restart at `now_us + window_us`.
+    uint32_t flush(int64_t now_us, int64_t window_us)
+    {
+        uint32_t send = 0;
+        for (int ch = 0; ch < LIGHT_CHANNELS; ch++) {
+            Chan & c = m_ch[ch];
+            if (!c.open || now_us < c.deadline_us) continue;
+            m_cancelled += c.held & ~1u;
+            if (c.held & 1u) {
+                send |= 1u << ch;
+                c.deadline_us = now_us + window_us;
+            } else {
+                c.open = false;
+            }
+            c.held = 0;
+        }
+        return send;
+    }
+
+    // End of the earliest open window (INT64_MAX if every channel is idle).
+    int64_t next_deadline_us() const
+    {
+        int64_t d = INT64_MAX;
+        for (const Chan & c : m_ch)
+            if (c.open && c.deadline_us < d) d = c.deadline_us;
+        return d;
+    }
+
+    uint32_t merged() const { return m_merged; }       // presses that did not get their own Toggle
+    uint32_t cancelled() const { return m_cancelled; } // merged presses that cancelled each other out
+
+private:
+    struct Chan {
+        bool open = false;
+        uint32_t held = 0;
+        int64_t deadline_us = 0;
+    };
+    Chan m_ch[LIGHT_CHANNELS];
+    uint32_t m_merged = 0;
+    uint32_t m_cancelled = 0;
+};
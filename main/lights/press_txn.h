@@ -0,0 +1,169 @@
+/*
+ * Fixed-size table of in-flight press transactions.
+ *
+ * A press that toggles a channel opens one transaction with one expected outcome per bound
+ * unicast target, and the LED shows the new state right away (optimistic). Each target's response
+ * is recorded against the transaction, and the transaction resolves once all of them are in or its
+ * deadline passes:
+ *   Confirmed  every target reported success
+ *   Partial    some succeeded, some failed or never answered
+ *   Failed     none succeeded (or the local dispatch failed)
+ * The caller decides what the LED does with each outcome (light_manager.cpp).
+ *
+ * Handles are slot index + generation packed into an intptr_t, so they can ride in
+ * request_handle::request_data and a late response to a recycled slot is simply ignored. When all
+ * slots are busy the oldest transaction is dropped (it resolves as nothing). Not thread safe: the
+ * light manager only touches it on the Matter thread.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+struct PressOutcome {
+    enum Kind : uint8_t { None, Confirmed, Partial, Failed };
+    Kind kind;
+    uint8_t ch;
+    bool prev_on;   // channel state before the press (what a rollback restores)
+    bool latest;    // no newer press on this channel has opened a transaction since
+    bool timed_out; // resolved by the deadline with responses missing
+    uint8_t ok;
+    uint8_t failed;
+    int64_t started_us;
+};
+
+class PressTxnTable {
+public:
+    static constexpr intptr_t kNoTxn = 0;
+
+    void reset()
+    {
+        for (Slot & s : m_slots) s.active = false;
+        for (intptr_t & h : m_latest) h = kNoTxn;
+    }
+
+    // Open a transaction on `ch` expecting `expected` target outcomes (0 -> kNoTxn, nothing to track).
+    // `ctx` is caller data kept with the transaction (see ctx()).
+    intptr_t begin(uint8_t ch, uint8_t expected, bool prev_on, int64_t now_us, int64_t deadline_us, const void * ctx = nullptr)
+    {
+        if (!expected || ch >= LIGHT_CHANNELS) return kNoTxn;
+        int idx = 0;
+        for (int i = 0; i < kSlots; i++) {
+            if (!m_slots[i].active) {
+                idx = i;
+                break;
+            }
+            if (m_slots[i].started_us < m_slots[idx].started_us) idx = i; // all busy: recycle the oldest
+        }
+        if (m_slots[idx].active) m_dropped++;
+        Slot & s = m_slots[idx];
+        if (++m_gen == 0) m_gen = 1;
+        s = Slot{ m_gen, ch, expected, 0, 0, prev_on, true, now_us, deadline_us, ctx };
+        intptr_t h = handle(idx, s.gen);
+        m_latest[ch] = h;
+        return h;
+    }
+
+    // Caller data of an open transaction (nullptr once it resolved or was recycled).
+    const void * ctx(intptr_t h)
+    {
+        Slot * s = lookup(h);
+        return s ? s->ctx : nullptr;
+    }
+
+    // Record one target's outcome. Returns the resolved outcome when this was the last one missing.
+    PressOutcome report(intptr_t h, bool ok)
+    {
+        Slot * s = lookup(h);
+        if (!s) return {};
+        if (ok) s->ok++;
+        else s->failed++;
+        if (s->ok + s->failed < s->expected) return {};
+        return resolve(h, *s, false);
+    }
+
+    // Fail the transaction outright (the local dispatch never reached any target).
+    PressOutcome abort(intptr_t h)
+    {
+        Slot * s = lookup(h);
+        if (!s) return {};
+        s->failed = (uint8_t)(s->expected - s->ok);
+        return resolve(h, *s, false);
+    }
+
+    // Resolve every transaction whose deadline has passed; `fn(const PressOutcome &)` for each.
+    template <typename F>
+    void expire(int64_t now_us, F && fn)
+    {
+        for (int i = 0; i < kSlots; i++) {
+            Slot & s = m_slots[i];
+            if (s.active && now_us >= s.deadline_us) fn(resolve(handle(i, s.gen), s, true));
+        }
+    }
+
+    // Earliest deadline of an open transaction (INT64_MAX if none).
+    int64_t next_deadline_us() const
+    {
+        int64_t d = INT64_MAX;
+        for (const Slot & s : m_slots)
+            if (s.active && s.deadline_us < d) d = s.deadline_us;
+        return d;
+    }
+
+    int open() const
+    {
+        int n = 0;
+        for (const Slot & s : m_slots) n += s.active;
+        return n;
+    }
+    uint32_t dropped() const { return m_dropped; }
+
+private:
+    static constexpr int kSlots = LIGHT_PRESS_TXN_MAX;
+    static_assert(kSlots >= 1 && kSlots <= 255, "LIGHT_PRESS_TXN_MAX must be 1..255");
+
+    struct Slot {
+        uint16_t gen;
+        uint8_t ch;
+        uint8_t expected;
+        uint8_t ok;
+        uint8_t failed;
+        bool prev_on;
+        bool active;
+        int64_t started_us;
+        int64_t deadline_us;
+        const void * ctx;
+    };
+
+    static intptr_t handle(int idx, uint16_t gen) { return ((intptr_t)gen << 8) | (intptr_t)idx; }
+
+    Slot * lookup(intptr_t h)
+    {
+        int idx = (int)(h & 0xFF);
+        if (h == kNoTxn || idx >= kSlots) return nullptr;
+        Slot & s = m_slots[idx];
+        return (s.active && s.gen == (uint16_t)(h >> 8)) ? &s : nullptr;
+    }
+
+    PressOutcome resolve(intptr_t h, Slot & s, bool timed_out)
+    {
+        s.active = false;
+        PressOutcome o;
+        o.kind = s.ok == s.expected ? PressOutcome::Confirmed : s.ok ? PressOutcome::Partial : PressOutcome::Failed;
+        o.ch = s.ch;
+        o.prev_on = s.prev_on;
+        o.latest = m_latest[s.ch] == h;
+        o.timed_out = timed_out;
+        o.ok = s.ok;
+        o.failed = (uint8_t)(s.expected - s.ok);
+        o.started_us = s.started_us;
+        if (o.latest) m_latest[s.ch] = kNoTxn;
+        return o;
+    }
+
+    Slot m_slots[kSlots] = {};
+    intptr_t m_latest[LIGHT_CHANNELS] = {};
+    uint16_t m_gen = 0;
+    uint32_t m_dropped = 0;
+};
@@ -0,0 +1,117 @@
+/*
+ * Scenes: a stored set of target states that one press applies (GESTURE_ACTION_SCENE).
+ *
+ * A Scene is a fixed-size POD, stored as one NVS blob (scene_store.cpp). It lists up to
+ * SCENE_MAX_ACTIONS targets. Each target is a unicast node/endpoint or a group, with any of on/off,
+ * level and colour temperature. scene_plan() expands a scene into the commands the executor sends
+ * (scene_engine.cpp):
+ *   off                   OnOff Off (level and colour temperature are skipped)
+ *   on, or a level        OnOff On, or LevelControl MoveToLevelWithOnOff (which also switches on)
+ *   colour temperature    ColorControl MoveToColorTemperature
+ * Identical commands to the same group on the same fabric collapse into one groupcast. The plan is
+ * ordered groups first, then by fabric and node, so every peer's commands are adjacent and go out
+ * over one session.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+#include "app_config.h"
+
+static constexpr int SCENE_MAX_CMDS = SCENE_MAX_ACTIONS * 2; // a target gets On / level + colour temperature at most
+static_assert(SCENE_MAX_CMDS <= 255, "SCENE_MAX_ACTIONS must be 1..127 (command handles carry an 8-bit index)");
+static_assert(SCENE_COUNT >= 1 && SCENE_COUNT <= 16, "SCENE_COUNT must be 1..16");
+
+struct SceneAction {
+    enum : uint8_t { kOnOff = 1, kLevel = 2, kColorTemp = 4, kGroup = 0x80 };
+    uint8_t flags;
+    uint8_t fabric_index; // 0: the first commissioned fabric
+    uint16_t endpoint;    // unicast: remote endpoint
+    uint16_t group_id;    // kGroup
+    bool on;              // kOnOff
+    uint8_t level;        // kLevel, 1..254
+    uint16_t mireds;      // kColorTemp
+    uint64_t node_id;     // unicast
+};
+
+struct Scene {
+    static constexpr uint8_t kVersion = 1; // bump when the layout changes (older blobs are ignored)
+    uint8_t version;
+    uint8_t count;
+    SceneAction actions[SCENE_MAX_ACTIONS];
+};
+
+// One command of a planned scene run.
+struct SceneCmd {
+    enum Kind : uint8_t { Off, On, Level, ColorTemp };
+    Kind kind;
+    bool group;
+    uint8_t fabric_index;
+    uint8_t level;
+    uint16_t dest;   // remote endpoint, or group id
+    uint16_t mireds;
+    uint64_t node_id;
+    intptr_t handle; // executor handle; the transport reports the outcome against it
+};
+
+// Expand `s` into `out` (room for SCENE_MAX_CMDS). Returns the command count. `*merged` counts
+// group commands folded into an identical one.
+inline uint8_t scene_plan(const Scene & s, SceneCmd * out, uint8_t * merged)
+{
+    uint8_t n = 0;
+    *merged = 0;
+    auto add = [&](const SceneAction & a, SceneCmd::Kind kind) {
+        bool group = a.flags & SceneAction::kGroup;
+        SceneCmd c = { kind, group, a.fabric_index, a.level, group ? a.group_id : a.endpoint, a.mireds, group ? 0 : a.node_id, 0 };
+        if (kind != SceneCmd::Level) c.level = 0;
+        if (kind != SceneCmd::ColorTemp) c.mireds = 0;
+        for (uint8_t i = 0; group && i < n; i++) {
+            const SceneCmd & o = out[i];
+            if (o.group && o.kind == c.kind && o.fabric_index == c.fabric_index && o.dest == c.dest && o.level == c.level && o.mireds == c.mireds) {
+                (*merged)++;
+                return;
+            }
+        }
+        out[n++] = c;
+    };
+    for (uint8_t i = 0; i < s.count && i < SCENE_MAX_ACTIONS; i++) {
+        const SceneAction & a = s.actions[i];
+        if ((a.flags & SceneAction::kOnOff) && !a.on) {
+            add(a, SceneCmd::Off);
+            continue;
+        }
+        if (a.flags & SceneAction::kLevel) add(a, SceneCmd::Level);
+        else if (a.flags & SceneAction::kOnOff) add(a, SceneCmd::On);
+        if (a.flags & SceneAction::kColorTemp) add(a, SceneCmd::ColorTemp);
+    }
+    // Insertion sort (n <= SCENE_MAX_CMDS, stable): groups first, then fabric, node, endpoint.
+    auto before = [](const SceneCmd & a, const SceneCmd & b) {
+        if (a.group != b.group) return a.group;
+        if (a.fabric_index != b.fabric_index) return a.fabric_index < b.fabric_index;
+        if (a.node_id != b.node_id) return a.node_id < b.node_id;
+        return a.dest < b.dest;
+    };
+    for (uint8_t i = 1; i < n; i++) {
+        SceneCmd c = out[i];
+        uint8_t j = i;
+        for (; j > 0 && before(c, out[j - 1]); j--) out[j] = out[j - 1];
+        out[j] = c;
+    }
+    return n;
+}
+
+// True when `a` and `b` go out over the same session (unicast) or groupcast destination.
+inline bool scene_same_dest(const SceneCmd & a, const SceneCmd & b)
+{
+    if (a.group != b.group || a.fabric_index != b.fabric_index) return false;
+    return a.group ? a.dest == b.dest : a.node_id == b.node_id;
+}
+
+// ---- Scene store (scene_store.cpp: NVS namespace "scenecfg"; host/app/host_app.cpp on the host) ----
+// Load every scene from NVS (boot).
+void scene_store_load();
+// Scene `id`, or nullptr when it is unknown or empty.
+const Scene * scene_store_get(uint8_t id);
+// Replace scene `id` and persist it; a null or empty scene erases it.
+esp_err_t scene_store_put(uint8_t id, const Scene * s);
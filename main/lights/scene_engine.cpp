@@ -0,0 +1,270 @@
+/* Scene executor (see scene_engine.h). The run state is owned by the Matter thread. */
+#include "scene_engine.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_matter_console.h>
+
+#include "light_internal.h"
+#include "diag/metrics.h"
+#include "diag/trace.h"
+#include "diag/work_probe.h"
+
+static const char * TAG = "scene";
+
+static metrics::Counter s_m_runs("scene.runs");
+static metrics::Counter s_m_superseded("scene.superseded");
+static metrics::Counter s_m_partial("scene.partial");
+static metrics::Counter s_m_failed("scene.failed");
+static metrics::Counter s_m_timeouts("scene.timeouts");
+static metrics::Counter s_m_cmds("scene.cmds");
+static metrics::Counter s_m_dests("scene.destinations");
+static metrics::Counter s_m_merged("scene.merged");
+static metrics::Histogram s_m_complete("scene.complete_us", metrics::kLatencyBucketsUs);
+static metrics::Gauge s_m_last("scene.last_ms");
+
+// Per-scene completion report (`matter scene`).
+struct SceneStats {
+    uint32_t runs;
+    uint32_t incomplete; // partial or failed
+    uint32_t last_us;
+    uint32_t avg_us; // EWMA 1/4
+    uint32_t max_us;
+};
+static SceneStats s_stats[SCENE_COUNT];
+
+// The run in flight: command table, per-command state (0 pending, 1 ok, 2 failed) and counts.
+static SceneCmd s_cmds[SCENE_MAX_CMDS];
+static uint8_t s_state[SCENE_MAX_CMDS];
+static uint8_t s_n = 0;
+static uint8_t s_pending = 0;
+static uint8_t s_ok = 0;
+static uint8_t s_scene = 0;
+static uint16_t s_gen = 0;
+static bool s_active = false;
+static int64_t s_started_us = 0;
+static esp_timer_handle_t s_timer = nullptr;
+
+static void finish(bool timed_out)
+{
+    s_active = false;
+    if (s_timer) esp_timer_stop(s_timer);
+    uint32_t took = (uint32_t)(esp_timer_get_time() - s_started_us);
+    uint8_t failed = (uint8_t)(s_n - s_ok);
+    SceneStats & st = s_stats[s_scene];
+    st.runs++;
+    st.last_us = took;
+    st.avg_us = st.runs == 1 ? took : st.avg_us - st.avg_us / 4 + took / 4;
+    if (took > st.max_us) st.max_us = took;
+    s_m_complete.record(took);
+    s_m_last.set((int32_t)(took / 1000));
+    if (timed_out) s_m_timeouts.inc();
+    if (!failed) {
+        ESP_LOGI(TAG, "scene %u: %u command(s) done in %" PRIu32 " ms", s_scene, s_n, took / 1000);
+        return;
+    }
+    st.incomplete++;
+    (s_ok ? s_m_partial : s_m_failed).inc();
+    ESP_LOGW(TAG, "scene %u: %u of %u command(s) failed%s (%" PRIu32 " ms)", s_scene, failed, s_n,
+             timed_out ? ", timed out" : "", took / 1000);
+}
+
+void light_scene_cmd_result(intptr_t handle, bool ok)
+{
+    uint8_t idx = (uint8_t)(handle & 0xFF);
+    if (!s_active || (uint16_t)(handle >> 8) != s_gen || idx >= s_n || s_state[idx]) return; // late, or a superseded run
+    s_state[idx] = ok ? 1 : 2;
+    if (ok) s_ok++;
+    if (--s_pending == 0) finish(false);
+}
+
+static void timer_cb(void *)
+{
+    work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t gen) {
+        if (s_active && (uint16_t)gen == s_gen) finish(true);
+    }, (intptr_t)s_gen);
+}
+
+static void run(uint8_t id)
+{
+    TRACE_SCOPE("scene.run");
+    const Scene * scene = scene_store_get(id);
+    if (!scene) return;
+    if (s_active) {
+        s_m_superseded.inc();
+        ESP_LOGW(TAG, "scene %u superseded by scene %u with %u response(s) missing", s_scene, id, s_pending);
+        s_active = false;
+    }
+    uint8_t merged = 0;
+    s_n = scene_plan(*scene, s_cmds, &merged);
+    if (!s_n) return;
+    if (++s_gen == 0) s_gen = 1;
+    for (uint8_t i = 0; i < s_n; i++) {
+        s_cmds[i].handle = ((intptr_t)s_gen << 8) | i;
+        s_state[i] = 0;
+    }
+    s_scene = id;
+    s_pending = s_n;
+    s_ok = 0;
+    s_active = true;
+    s_started_us = esp_timer_get_time();
+    s_m_runs.inc();
+    s_m_cmds.inc(s_n);
+    s_m_merged.inc(merged);
+    if (s_timer) esp_timer_start_once(s_timer, (uint64_t)SCENE_TIMEOUT_MS * 1000);
+    // One transport call per destination; results may arrive (and even finish the run) while sending.
+    uint16_t gen = s_gen;
+    for (uint8_t i = 0; i < s_n && gen == s_gen;) {
+        uint8_t j = i + 1;
+        while (j < s_n && scene_same_dest(s_cmds[i], s_cmds[j])) j++;
+        s_m_dests.inc();
+        light_scene_send(&s_cmds[i], (uint8_t)(j - i));
+        i = j;
+    }
+}
+
+void scene_engine_init()
+{
+    if (s_timer) return;
+    esp_timer_create_args_t ta = {};
+    ta.callback = &timer_cb;
+    ta.dispatch_method = ESP_TIMER_TASK;
+    ta.name = "scene";
+    esp_timer_create(&ta, &s_timer);
+}
+
+bool scene_engine_run(uint8_t id)
+{
+    if (id >= SCENE_COUNT || !scene_store_get(id)) {
+        ESP_LOGW(TAG, "scene %u is empty", id);
+        return false;
+    }
+    return work_probe_schedule(WorkSource::ButtonToggle, [](intptr_t a) { run((uint8_t)a); }, id) == ESP_OK;
+}
+
+void scene_engine_prewarm()
+{
+    for (uint8_t id = 0; id < SCENE_COUNT; id++) {
+        const Scene * s = scene_store_get(id);
+        for (uint8_t i = 0; s && i < s->count; i++) {
+            const SceneAction & a = s->actions[i];
+            bool seen = false; // one session per peer, even if it appears in several actions
+            for (uint8_t k = 0; k < i && !seen; k++)
+                seen = !(s->actions[k].flags & SceneAction::kGroup) && s->actions[k].node_id == a.node_id &&
+                       s->actions[k].fabric_index == a.fabric_index;
+            if (!(a.flags & SceneAction::kGroup) && !seen) light_scene_prewarm(a.fabric_index, a.node_id);
+        }
+    }
+}
+
+// ---- Console ----
+static void print_action(const SceneAction & a)
+{
+    if (a.flags & SceneAction::kGroup) printf("  group 0x%04X", a.group_id);
+    else printf("  0x%016" PRIX64 "/%u", a.node_id, a.endpoint);
+    if (a.fabric_index) printf(" fabric=%u", a.fabric_index);
+    if (a.flags & SceneAction::kOnOff) printf(" %s", a.on ? "on" : "off");
+    if (a.flags & SceneAction::kLevel) printf(" level=%u", a.level);
+    if (a.flags & SceneAction::kColorTemp) printf(" ct=%u", a.mireds);
+    printf("\n");
+}
+
+static void print_scenes()
+{
+    for (uint8_t id = 0; id < SCENE_COUNT; id++) {
+        const Scene * s = scene_store_get(id);
+        const SceneStats & st = s_stats[id];
+        printf("scene %u: %u action(s), %" PRIu32 " run(s), %" PRIu32 " incomplete, last %" PRIu32 " ms, avg %" PRIu32
+               " ms, max %" PRIu32 " ms\n",
+               id, s ? s->count : 0, st.runs, st.incomplete, st.last_us / 1000, st.avg_us / 1000, st.max_us / 1000);
+        for (uint8_t i = 0; s && i < s->count; i++) print_action(s->actions[i]);
+    }
+}
+
+// Parse "<node> <ep>" or "group <gid>", then on|off|level=N|ct=N|fabric=N, into `a`.
+static bool parse_action(int argc, char ** argv, SceneAction & a)
+{
+    a = {};
+    if (argc >= 2 && strcmp(argv[0], "group") == 0) {
+        a.flags = SceneAction::kGroup;
+        a.group_id = (uint16_t)strtoul(argv[1], nullptr, 0);
+    } else if (argc >= 2) {
+        a.node_id = strtoull(argv[0], nullptr, 0);
+        a.endpoint = (uint16_t)strtoul(argv[1], nullptr, 0);
+    } else {
+        return false;
+    }
+    for (int i = 2; i < argc; i++) {
+        const char * t = argv[i];
+        if (strcmp(t, "on") == 0 || strcmp(t, "off") == 0) {
+            a.flags |= SceneAction::kOnOff;
+            a.on = t[1] == 'n';
+        } else if (strncmp(t, "level=", 6) == 0) {
+            unsigned long l = strtoul(t + 6, nullptr, 0);
+            a.flags |= SceneAction::kLevel;
+            a.level = (uint8_t)(l < 1 ? 1 : l > 254 ? 254 : l);
+        } else if (strncmp(t, "ct=", 3) == 0) {
+            a.flags |= SceneAction::kColorTemp;
+            a.mireds = (uint16_t)strtoul(t + 3, nullptr, 0);
+        } else if (strncmp(t, "fabric=", 7) == 0) {
+            a.fabric_index = (uint8_t)strtoul(t + 7, nullptr, 0);
+        } else {
+            return false;
+        }
+    }
+    return (a.flags & ~SceneAction::kGroup) != 0;
+}
+
+int scene_engine_command(int argc, char ** argv)
+{
+    const char * sub = argc >= 1 ? argv[0] : "list";
+    uint8_t id = argc >= 2 ? (uint8_t)strtoul(argv[1], nullptr, 0) : 0;
+    if (strcmp(sub, "list") == 0) {
+        print_scenes();
+        return 0;
+    }
+    if (argc < 2 || id >= SCENE_COUNT || (strcmp(sub, "run") && strcmp(sub, "clear") && strcmp(sub, "add"))) {
+        printf("Usage: matter scene [list] | add <id> <node> <ep>|group <gid> [on|off] [level=N] [ct=N] [fabric=N]"
+               " | clear <id> | run <id>   (id 0..%d)\n", SCENE_COUNT - 1);
+        return 1;
+    }
+    if (strcmp(sub, "run") == 0) return scene_engine_run(id) ? 0 : 1;
+    if (strcmp(sub, "clear") == 0) return scene_store_put(id, nullptr) == ESP_OK ? 0 : 1;
+    Scene s = {};
+    if (const Scene * cur = scene_store_get(id)) s = *cur;
+    s.version = Scene::kVersion;
+    if (s.count >= SCENE_MAX_ACTIONS) {
+        printf("scene %u is full (SCENE_MAX_ACTIONS %d)\n", id, SCENE_MAX_ACTIONS);
+        return 1;
+    }
+    if (!parse_action(argc - 2, argv + 2, s.actions[s.count])) {
+        printf("scene add: expected <node> <ep> or group <gid>, then on|off|level=N|ct=N|fabric=N\n");
+        return 1;
+    }
+    s.count++;
+    if (scene_store_put(id, &s) != ESP_OK) return 1;
+    work_probe_schedule(WorkSource::BindingRefresh, [](intptr_t) { scene_engine_prewarm(); });
+    return 0;
+}
+
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t scene_console_handler(int argc, char ** argv)
+{
+    scene_engine_command(argc, argv);
+    return ESP_OK;
+}
+#endif
+
+void scene_engine_register_console()
+{
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "scene", .description = "Scenes. Usage: matter scene [list] | add <id> ... | clear <id> | run <id>", .handler = scene_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
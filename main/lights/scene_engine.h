@@ -0,0 +1,23 @@
+/*
+ * Scene executor: applies a stored scene (scene.h) to all of its targets at once and reports how long
+ * the scene took to complete.
+ *
+ * A run is planned into a fixed command table (SCENE_MAX_CMDS, nothing allocated on the press path).
+ * Every destination is sent in one pass without waiting for responses: one groupcast per group
+ * command, and each peer's commands back to back over its session, which scene_engine_prewarm() has
+ * opened ahead of time. The run completes when every command has reported back, or after
+ * SCENE_TIMEOUT_MS. A new run supersedes one still in flight, whose late responses are then ignored.
+ */
+#pragma once
+
+#include <stdint.h>
+
+void scene_engine_init();
+// Run scene `id` (any task; the run happens on the Matter thread). Returns false if the scene is
+// unknown or empty.
+bool scene_engine_run(uint8_t id);
+// Matter thread: find or establish the sessions every stored scene needs.
+void scene_engine_prewarm();
+// `matter scene` console command; also the host simulator's `scene` command.
+int scene_engine_command(int argc, char ** argv);
+void scene_engine_register_console();
@@ -0,0 +1,65 @@
+/* Scene store: one NVS blob per scene (namespace "scenecfg", key "s<id>"), cached in RAM. */
+#include "scene.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <esp_log.h>
+#include <nvs.h>
+
+#include "diag/trace.h"
+
+static const char * TAG = "scene_store";
+static const char * k_scene_nvs_namespace = "scenecfg";
+
+static Scene s_scenes[SCENE_COUNT];
+
+void scene_store_load()
+{
+    nvs_handle_t h;
+    if (nvs_open(k_scene_nvs_namespace, NVS_READONLY, &h) != ESP_OK) return; // nothing stored yet
+    for (uint8_t id = 0; id < SCENE_COUNT; id++) {
+        char key[8];
+        snprintf(key, sizeof(key), "s%u", id);
+        Scene tmp = {};
+        size_t len = sizeof(Scene);
+        esp_err_t err = nvs_get_blob(h, key, &tmp, &len);
+        if (err != ESP_OK) continue;
+        if (len != sizeof(Scene) || tmp.version != Scene::kVersion || tmp.count > SCENE_MAX_ACTIONS) { // sanitize
+            ESP_LOGW(TAG, "Ignoring stored scene %u (version %u, %u bytes)", id, tmp.version, (unsigned)len);
+            continue;
+        }
+        s_scenes[id] = tmp;
+        ESP_LOGI(TAG, "Loaded scene %u from NVS (%u action(s))", id, tmp.count);
+    }
+    nvs_close(h);
+}
+
+const Scene * scene_store_get(uint8_t id)
+{
+    return id < SCENE_COUNT && s_scenes[id].count ? &s_scenes[id] : nullptr;
+}
+
+esp_err_t scene_store_put(uint8_t id, const Scene * s)
+{
+    if (id >= SCENE_COUNT || (s && s->count > SCENE_MAX_ACTIONS)) return ESP_ERR_INVALID_ARG;
+    TRACE_SCOPE("nvs.save");
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(k_scene_nvs_namespace, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    char key[8];
+    snprintf(key, sizeof(key), "s%u", id);
+    if (s && s->count) {
+        s_scenes[id] = *s;
+        s_scenes[id].version = Scene::kVersion;
+        err = nvs_set_blob(h, key, &s_scenes[id], sizeof(Scene));
+    } else {
+        s_scenes[id] = {};
+        err = nvs_erase_key(h, key);
+        if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+    }
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err == ESP_OK) ESP_LOGI(TAG, "Saved scene %u to NVS (%u action(s))", id, s_scenes[id].count);
+    else ESP_LOGE(TAG, "Failed saving scene %u err=%d", id, (int)err);
+    return err;
+}
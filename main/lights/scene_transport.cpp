@@ -0,0 +1,208 @@
+/* Scene transport: sends a planned scene's commands (scene_engine.cpp) over CASE sessions and groupcasts. */
+#include "light_internal.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <new>
+#include <type_traits>
+#include <app-common/zap-generated/cluster-objects.h>
+#include <app/CommandSender.h>
+#include <app/InteractionModelEngine.h>
+#include <app/server/Server.h>
+#include <controller/InvokeInteraction.h>
+
+#include "diag/metrics.h"
+#include "diag/trace.h"
+
+static const char * TAG = "scene_tx";
+
+static metrics::Counter s_m_session_cached("scene.session_cached");
+static metrics::Counter s_m_session_setup("scene.session_setup");
+static metrics::Counter s_m_session_fail("scene.session_fail");
+static metrics::Counter s_m_send_fail("scene.send_fail");
+static metrics::Counter s_m_groupcasts("scene.groupcasts");
+
+namespace {
+using namespace chip::app;
+using namespace chip::app::Clusters;
+
+// One unicast command in flight. Statically pooled: a scene run allocates nothing.
+struct SendSlot : public CommandSender::Callback {
+    bool used = false;
+    bool reported = false;
+    intptr_t handle = 0;
+    CommandSender * sender = nullptr;
+    alignas(CommandSender) uint8_t storage[sizeof(CommandSender)];
+
+    void Report(bool ok) {
+        if (reported) return;
+        reported = true;
+        light_scene_cmd_result(handle, ok);
+    }
+    void Release() {
+        if (sender) sender->~CommandSender();
+        sender = nullptr;
+        used = false;
+    }
+    void OnResponse(CommandSender *, const ConcreteCommandPath &, const StatusIB & status, chip::TLV::TLVReader *) override {
+        Report(status.mStatus == chip::Protocols::InteractionModel::Status::Success);
+    }
+    void OnError(const CommandSender *, CHIP_ERROR err) override {
+        ESP_LOGW(TAG, "command error %" CHIP_ERROR_FORMAT, err.Format());
+        Report(false);
+    }
+    void OnDone(CommandSender *) override {
+        TRACE_ASYNC_END("scene.cmd", this);
+        Report(false); // no response at all
+        Release();
+    }
+};
+SendSlot s_slots[SCENE_MAX_CMDS];
+
+// A peer whose session is being found or set up. `cmds` points into the executor's table; the
+// first command's handle tells whether that run is still the current one when the session is ready.
+struct PeerCtx {
+    bool used = false;
+    const SceneCmd * cmds = nullptr;
+    uint8_t n = 0;
+    intptr_t first_handle = 0;
+    chip::Callback::Callback<chip::OnDeviceConnected> on_connected;
+    chip::Callback::Callback<chip::OnDeviceConnectionFailure> on_failure;
+    PeerCtx();
+};
+PeerCtx s_peers[SCENE_MAX_ACTIONS];
+bool s_in_find = false; // FindOrEstablishSession answers synchronously when the session is cached
+
+chip::FabricIndex resolve_fabric(uint8_t fabric_index)
+{
+    if (fabric_index != chip::kUndefinedFabricIndex) return fabric_index;
+    for (auto & f : chip::Server::GetInstance().GetFabricTable())
+        if (f.IsInitialized()) return f.GetFabricIndex();
+    return chip::kUndefinedFabricIndex;
+}
+
+template <typename F>
+auto with_payload(const SceneCmd & c, F && f)
+{
+    switch (c.kind) {
+    case SceneCmd::Off:
+        return f(OnOff::Commands::Off::Type());
+    case SceneCmd::On:
+        return f(OnOff::Commands::On::Type());
+    case SceneCmd::Level: {
+        LevelControl::Commands::MoveToLevelWithOnOff::Type d;
+        d.level = c.level;
+        d.transitionTime.SetNonNull((uint16_t)SCENE_TRANSITION_DS);
+        return f(d);
+    }
+    case SceneCmd::ColorTemp:
+    default: {
+        ColorControl::Commands::MoveToColorTemperature::Type d;
+        d.colorTemperatureMireds = c.mireds;
+        d.transitionTime = SCENE_TRANSITION_DS;
+        return f(d);
+    }
+    }
+}
+
+void send_unicast(const SceneCmd & c, chip::Messaging::ExchangeManager & em, const chip::SessionHandle & session)
+{
+    SendSlot * slot = nullptr;
+    for (auto & s : s_slots)
+        if (!s.used) { slot = &s; break; }
+    if (!slot) {
+        s_m_send_fail.inc();
+        light_scene_cmd_result(c.handle, false);
+        return;
+    }
+    slot->used = true;
+    slot->reported = false;
+    slot->handle = c.handle;
+    slot->sender = new (slot->storage) CommandSender(slot, &em);
+    CHIP_ERROR e = with_payload(c, [&](const auto & payload) {
+        using T = std::decay_t<decltype(payload)>;
+        CommandPathParams cp(c.dest, 0, T::GetClusterId(), T::GetCommandId(), CommandPathFlags::kEndpointIdValid);
+        return slot->sender->AddRequestData(cp, payload);
+    });
+    if (e == CHIP_NO_ERROR) {
+        TRACE_ASYNC_BEGIN("scene.cmd", slot);
+        e = slot->sender->SendCommandRequest(session);
+    }
+    if (e != CHIP_NO_ERROR) {
+        s_m_send_fail.inc();
+        ESP_LOGW(TAG, "send to node=0x%016" PRIX64 " ep=%u failed %" CHIP_ERROR_FORMAT, c.node_id, c.dest, e.Format());
+        slot->Report(false);
+        slot->Release();
+    }
+}
+
+void peer_connected(void * ctx, chip::Messaging::ExchangeManager & em, const chip::SessionHandle & session)
+{
+    PeerCtx * p = static_cast<PeerCtx *>(ctx);
+    TRACE_ASYNC_END("case.establish", p);
+    (s_in_find ? s_m_session_cached : s_m_session_setup).inc();
+    // Each command gets its own CommandSender: they go out back to back without waiting on each other.
+    for (uint8_t i = 0; i < p->n && p->cmds[0].handle == p->first_handle; i++) send_unicast(p->cmds[i], em, session);
+    p->used = false;
+}
+
+void peer_failed(void * ctx, const chip::ScopedNodeId & peer, CHIP_ERROR err)
+{
+    PeerCtx * p = static_cast<PeerCtx *>(ctx);
+    TRACE_ASYNC_END("case.establish", p);
+    s_m_session_fail.inc();
+    ESP_LOGW(TAG, "session to node=0x%016" PRIX64 " failed %" CHIP_ERROR_FORMAT, (uint64_t)peer.GetNodeId(), err.Format());
+    for (uint8_t i = 0; i < p->n && p->cmds[0].handle == p->first_handle; i++) light_scene_cmd_result(p->cmds[i].handle, false);
+    p->used = false;
+}
+
+PeerCtx::PeerCtx() : on_connected(&peer_connected, this), on_failure(&peer_failed, this) {}
+
+// Find (or set up) the session to `node`; then send `n` commands from `cmds` over it (n == 0: prewarm).
+bool find_session(uint8_t fabric_index, uint64_t node, const SceneCmd * cmds, uint8_t n)
+{
+    chip::FabricIndex fi = resolve_fabric(fabric_index);
+    auto * case_mgr = chip::Server::GetInstance().GetCASESessionManager();
+    PeerCtx * p = nullptr;
+    for (auto & c : s_peers)
+        if (!c.used) { p = &c; break; }
+    if (fi == chip::kUndefinedFabricIndex || !case_mgr || !p) return false;
+    p->used = true;
+    p->cmds = cmds;
+    p->n = n;
+    p->first_handle = n ? cmds[0].handle : 0;
+    TRACE_ASYNC_BEGIN("case.establish", p);
+    s_in_find = true;
+    case_mgr->FindOrEstablishSession(chip::ScopedNodeId(node, fi), &p->on_connected, &p->on_failure);
+    s_in_find = false;
+    return true;
+}
+} // namespace
+
+void light_scene_send(const SceneCmd * cmds, uint8_t n)
+{
+    if (!n) return;
+    const SceneCmd & c = cmds[0];
+    if (c.group) {
+        // Groupcasts carry no response: each counts as done once it is out.
+        chip::Messaging::ExchangeManager * em = InteractionModelEngine::GetInstance()->GetExchangeManager();
+        chip::FabricIndex fi = resolve_fabric(c.fabric_index);
+        for (uint8_t i = 0; i < n; i++) {
+            CHIP_ERROR e = fi == chip::kUndefinedFabricIndex ? CHIP_ERROR_INCORRECT_STATE : with_payload(cmds[i], [&](const auto & payload) {
+                return chip::Controller::InvokeGroupCommandRequest(em, fi, cmds[i].dest, payload);
+            });
+            s_m_groupcasts.inc();
+            if (e != CHIP_NO_ERROR) ESP_LOGW(TAG, "groupcast to 0x%04X failed %" CHIP_ERROR_FORMAT, cmds[i].dest, e.Format());
+            light_scene_cmd_result(cmds[i].handle, e == CHIP_NO_ERROR);
+        }
+        return;
+    }
+    if (!find_session(c.fabric_index, c.node_id, cmds, n)) {
+        s_m_session_fail.inc();
+        for (uint8_t i = 0; i < n; i++) light_scene_cmd_result(cmds[i].handle, false);
+    }
+}
+
+void light_scene_prewarm(uint8_t fabric_index, uint64_t node_id)
+{
+    find_session(fabric_index, node_id, nullptr, 0);
+}
@@ -0,0 +1,29 @@
+/* Shadow binding import (BindingTable entry -> per-channel shadow list). */
+#include "shadow_binding.h"
+
+shadow_import_result_t shadow_binding_import(ShadowBindingList lists[LIGHT_CHANNELS], const uint16_t onoff_eps[LIGHT_CHANNELS],
+                                             const ShadowBindingSource * src, int * out_ch)
+{
+    int chIndex = -1;
+    for (int ch = 0; ch < LIGHT_CHANNELS; ++ch) { if (onoff_eps[ch] == src->local_ep) { chIndex = ch; break; } }
+    if (out_ch) *out_ch = chIndex;
+    if (chIndex < 0) return SHADOW_IMPORT_NOT_OURS;
+    ShadowBindingList & list = lists[chIndex];
+    if (src->kind == SHADOW_SRC_UNICAST) {
+        for (int i = 0; i < list.count; i++) {
+            const auto & sb = list.entries[i];
+            if (!sb.is_group && sb.node_id == src->node_id && sb.endpoint == src->remote_ep && sb.cluster_id == src->cluster_id) return SHADOW_IMPORT_DUPLICATE;
+        }
+        if (list.count >= MAX_SHADOW_BINDINGS_PER_CH) return SHADOW_IMPORT_FULL;
+        auto & dst = list.entries[list.count++];
+        dst.is_group = false; dst.node_id = src->node_id; dst.endpoint = src->remote_ep; dst.cluster_id = src->cluster_id; dst.group_id = 0; dst.fabric_index = src->fabric_index;
+        return SHADOW_IMPORT_ADDED;
+    }
+    if (src->kind == SHADOW_SRC_GROUP) {
+        if (list.count >= MAX_SHADOW_BINDINGS_PER_CH) return SHADOW_IMPORT_FULL;
+        auto & dst = list.entries[list.count++];
+        dst.is_group = true; dst.group_id = src->group_id; dst.cluster_id = src->cluster_id; dst.node_id = 0; dst.endpoint = 0; dst.fabric_index = src->fabric_index;
+        return SHADOW_IMPORT_ADDED;
+    }
+    return SHADOW_IMPORT_UNSUPPORTED;
+}
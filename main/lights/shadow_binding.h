@@ -0,0 +1,38 @@
+/*
+ * Shadow binding import: maps CHIP BindingTable entries onto the per-channel shadow lists
+ * (de-duplicated, capacity-limited). Pure logic so it also builds on the host.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "light_manager.h"
+
+typedef enum {
+	SHADOW_SRC_UNICAST,
+	SHADOW_SRC_GROUP,
+	SHADOW_SRC_OTHER,
+} shadow_src_kind_t;
+
+// Binding table entry, decoupled from EmberBindingTableEntry.
+typedef struct {
+	shadow_src_kind_t kind;
+	uint16_t local_ep;
+	uint64_t node_id;
+	uint16_t remote_ep;
+	uint16_t group_id;
+	uint32_t cluster_id;   // 0 if the binding has no cluster
+	uint8_t fabric_index;
+} ShadowBindingSource;
+
+typedef enum {
+	SHADOW_IMPORT_ADDED,
+	SHADOW_IMPORT_DUPLICATE,    // same (node, ep, cluster) unicast already on the channel
+	SHADOW_IMPORT_FULL,         // MAX_SHADOW_BINDINGS_PER_CH reached
+	SHADOW_IMPORT_NOT_OURS,     // local endpoint is not one of our OnOff endpoints
+	SHADOW_IMPORT_UNSUPPORTED,  // neither unicast nor group
+} shadow_import_result_t;
+
+// Append `src` to the list of the channel whose endpoint is `src->local_ep`.
+// `*out_ch` receives the channel (or -1 when NOT_OURS).
+shadow_import_result_t shadow_binding_import(ShadowBindingList lists[LIGHT_CHANNELS], const uint16_t onoff_eps[LIGHT_CHANNELS],
+                                             const ShadowBindingSource * src, int * out_ch);
@@ -0,0 +1,56 @@
+/* Generic Switch event transport: Switch cluster events and CurrentPosition on a channel endpoint. */
+#include "light_internal.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <app-common/zap-generated/attributes/Accessors.h>
+#include <app-common/zap-generated/cluster-objects.h>
+#include <app/EventLogging.h>
+
+static const char * TAG = "switch_evt";
+
+namespace {
+using namespace chip::app::Clusters;
+
+constexpr uint8_t kReleased = 0;
+constexpr uint8_t kPressed = 1; // momentary switch: one pressed position
+
+template <typename E>
+bool log_event(uint16_t endpoint, const E & event)
+{
+    chip::EventNumber number;
+    CHIP_ERROR err = chip::app::LogEvent(event, endpoint, number);
+    if (err != CHIP_NO_ERROR) {
+        ESP_LOGW(TAG, "ep %u: event 0x%02" PRIx32 " not logged %" CHIP_ERROR_FORMAT, endpoint, (uint32_t)E::GetEventId(), err.Format());
+        return false;
+    }
+    return true;
+}
+
+void set_position(uint16_t endpoint, uint8_t pos)
+{
+    if (Switch::Attributes::CurrentPosition::Set(endpoint, pos) != chip::Protocols::InteractionModel::Status::Success)
+        ESP_LOGW(TAG, "ep %u: CurrentPosition update failed", endpoint);
+}
+} // namespace
+
+bool light_switch_log_event(uint16_t endpoint, SwitchEvent ev, uint8_t count)
+{
+    switch (ev) {
+    case SwitchEvent::InitialPress:
+        set_position(endpoint, kPressed);
+        return log_event(endpoint, Switch::Events::InitialPress::Type{ kPressed });
+    case SwitchEvent::LongPress:
+        return log_event(endpoint, Switch::Events::LongPress::Type{ kPressed });
+    case SwitchEvent::ShortRelease:
+        set_position(endpoint, kReleased);
+        return log_event(endpoint, Switch::Events::ShortRelease::Type{ kPressed });
+    case SwitchEvent::LongRelease:
+        set_position(endpoint, kReleased);
+        return log_event(endpoint, Switch::Events::LongRelease::Type{ kPressed });
+    case SwitchEvent::MultiPressOngoing:
+        return log_event(endpoint, Switch::Events::MultiPressOngoing::Type{ kPressed, count });
+    case SwitchEvent::MultiPressComplete:
+        return log_event(endpoint, Switch::Events::MultiPressComplete::Type{ kPressed, count });
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+/*
+ * LED sync round planner: one OnOff read request per peer node.
+ *
+ * A node that hosts several bound endpoints (a multi-relay module), or that is bound to several
+ * channels, used to get one read request, and one exchange, per binding entry. The sync round now
+ * adds every entry here first. The planner groups them by (fabric, node), and each batch becomes one
+ * read request carrying all of that node's OnOff attribute paths (at most LIGHT_SYNC_MAX_PATHS; a
+ * larger set is split). The transport hands each value back to every channel its endpoint is bound
+ * on.
+ *
+ * Fixed tables, no allocation. Not thread safe: the light manager only touches it on the Matter thread.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+#include "light_manager.h" // MAX_SHADOW_BINDINGS_PER_CH
+
+// One OnOff attribute of a batched read: the target endpoint and the channel its value belongs to.
+struct LightSyncPath {
+    uint8_t ch;
+    uint16_t endpoint;
+};
+
+class SyncBatchPlan {
+public:
+    static constexpr int kMaxPaths = LIGHT_SYNC_MAX_PATHS;
+
+    void reset() { m_count = 0; }
+
+    // Add one binding entry. Entries of a node stay in the order they were added. False if full.
+    bool add(uint8_t fabric_index, uint64_t node_id, uint8_t ch, uint16_t endpoint)
+    {
+        if (m_count >= kEntries) return false;
+        Entry e{ node_id, fabric_index, { ch, endpoint } };
+        int pos = m_count;
+        while (pos > 0 && after(m_entries[pos - 1], e)) {
+            m_entries[pos] = m_entries[pos - 1];
+            pos--;
+        }
+        m_entries[pos] = e;
+        m_count++;
+        return true;
+    }
+
+    // Walk the batches: `*pos` starts at 0. Fills the batch's node, fabric and paths (n <= kMaxPaths)
+    // and returns n; 0 once every entry was handed out.
+    uint8_t next(int * pos, uint64_t * node_id, uint8_t * fabric_index, LightSyncPath * paths) const
+    {
+        if (*pos >= m_count) return 0;
+        const Entry & first = m_entries[*pos];
+        *node_id = first.node_id;
+        *fabric_index = first.fabric_index;
+        uint8_t n = 0;
+        while (*pos < m_count && n < kMaxPaths && m_entries[*pos].node_id == first.node_id && m_entries[*pos].fabric_index == first.fabric_index)
+            paths[n++] = m_entries[(*pos)++].path;
+        return n;
+    }
+
+    int size() const { return m_count; }
+
+private:
+    static constexpr int kEntries = LIGHT_CHANNELS * MAX_SHADOW_BINDINGS_PER_CH;
+    static_assert(kMaxPaths >= 1 && kMaxPaths <= 255, "LIGHT_SYNC_MAX_PATHS must be 1..255");
+
+    struct Entry {
+        uint64_t node_id;
+        uint8_t fabric_index;
+        LightSyncPath path;
+    };
+    static bool after(const Entry & a, const Entry & b)
+    {
+        return a.fabric_index != b.fabric_index ? a.fabric_index > b.fabric_index : a.node_id > b.node_id;
+    }
+
+    Entry m_entries[kEntries] = {};
+    int m_count = 0;
+};
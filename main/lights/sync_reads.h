@@ -0,0 +1,156 @@
+/*
+ * Fixed-size table of in-flight LED sync read requests.
+ *
+ * Each read request of a sync round (one per peer node, see sync_batch.h) holds a slot from the
+ * moment it is handed to the transport until the transport reports it done. Its paths are accounted
+ * for exactly once, when it finishes or when its deadline passes, whichever comes first, so a
+ * channel's round always ends: a session that never comes up or a response that never arrives costs
+ * at most LIGHT_SYNC_READ_TIMEOUT_MS, not every later round.
+ *
+ * A timed-out request keeps its slot until the transport reports it done anyway, since its
+ * coroutine frame (coro.h) lives until then. Sync reads can therefore never hold more than
+ * LIGHT_SYNC_MAX_READS frames, and the frames budgeted for the press fan-out stay free.
+ *
+ * Handles are slot index + generation packed into an intptr_t (as in press_txn.h); values arriving
+ * for a timed-out request are ignored. When every slot is busy, begin()
+ * refuses and the caller keeps the request planned until one frees up. Not thread safe: the light
+ * manager only touches it on the Matter thread.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+#include "sync_batch.h"
+
+// A finished request: the channel of each of its paths.
+struct SyncReadDone {
+    uint8_t n;
+    uint8_t ch[SyncBatchPlan::kMaxPaths];
+    bool timed_out;
+    int64_t started_us;
+};
+
+class SyncReadTable {
+public:
+    static constexpr intptr_t kNone = 0;
+
+    void reset()
+    {
+        for (Slot & s : m_slots) s.active = false;
+        m_inflight = 0;
+        m_expired = 0;
+    }
+
+    bool full() const { return m_inflight >= kSlots; }
+
+    // Track a request carrying `paths` (n >= 1). kNone if the table is full.
+    intptr_t begin(const LightSyncPath * paths, uint8_t n, int64_t now_us, int64_t deadline_us)
+    {
+        if (!n || n > SyncBatchPlan::kMaxPaths || full()) return kNone;
+        int idx = 0;
+        while (m_slots[idx].active) idx++;
+        Slot & s = m_slots[idx];
+        if (++m_gen == 0) m_gen = 1;
+        s.gen = m_gen;
+        s.active = true;
+        s.expired = false;
+        s.n = n;
+        for (uint8_t i = 0; i < n; i++) s.ch[i] = paths[i].ch;
+        s.started_us = now_us;
+        s.deadline_us = deadline_us;
+        m_inflight++;
+        return handle(idx, s.gen);
+    }
+
+    // Is `h` still waiting for its answer? (False once it finished or timed out.)
+    bool live(intptr_t h) const
+    {
+        const Slot * s = lookup(h);
+        return s && !s->expired;
+    }
+
+    // The transport finished request `h`, which frees its slot. False if it had already timed out
+    // (its paths were reported then) or the handle is unknown.
+    bool finish(intptr_t h, SyncReadDone * out)
+    {
+        Slot * s = const_cast<Slot *>(lookup(h));
+        if (!s) return false;
+        bool late = s->expired;
+        s->active = false;
+        m_inflight--;
+        if (late) {
+            m_expired--;
+            return false;
+        }
+        fill(*s, false, out);
+        return true;
+    }
+
+    // Time out every request whose deadline has passed; `fn(const SyncReadDone &)` for each. Their
+    // slots stay taken until finish().
+    template <typename F>
+    int expire(int64_t now_us, F && fn)
+    {
+        int n = 0;
+        for (Slot & s : m_slots) {
+            if (!s.active || s.expired || now_us < s.deadline_us) continue;
+            s.expired = true;
+            m_expired++;
+            SyncReadDone d;
+            fill(s, true, &d);
+            fn(d);
+            n++;
+        }
+        return n;
+    }
+
+    // Earliest deadline of a request in flight (INT64_MAX if none).
+    int64_t next_deadline_us() const
+    {
+        int64_t d = INT64_MAX;
+        for (const Slot & s : m_slots)
+            if (s.active && !s.expired && s.deadline_us < d) d = s.deadline_us;
+        return d;
+    }
+
+    int inflight() const { return m_inflight; }
+    int expired() const { return m_expired; } // timed out, transport not done yet (slot still taken)
+
+private:
+    static constexpr int kSlots = LIGHT_SYNC_MAX_READS;
+    static_assert(kSlots >= 1 && kSlots <= 255, "LIGHT_SYNC_MAX_READS must be 1..255");
+
+    struct Slot {
+        uint16_t gen;
+        bool active;
+        bool expired; // timed out; the slot is freed by finish()
+        uint8_t n;
+        uint8_t ch[SyncBatchPlan::kMaxPaths];
+        int64_t started_us;
+        int64_t deadline_us;
+    };
+
+    static intptr_t handle(int idx, uint16_t gen) { return ((intptr_t)gen << 8) | (intptr_t)idx; }
+
+    const Slot * lookup(intptr_t h) const
+    {
+        int idx = (int)(h & 0xFF);
+        if (h == kNone || idx >= kSlots) return nullptr;
+        const Slot & s = m_slots[idx];
+        return (s.active && s.gen == (uint16_t)(h >> 8)) ? &s : nullptr;
+    }
+
+    static void fill(const Slot & s, bool timed_out, SyncReadDone * out)
+    {
+        out->n = s.n;
+        for (uint8_t i = 0; i < s.n; i++) out->ch[i] = s.ch[i];
+        out->timed_out = timed_out;
+        out->started_us = s.started_us;
+    }
+
+    Slot m_slots[kSlots] = {};
+    int m_inflight = 0; // slots taken, timed-out ones included
+    int m_expired = 0;
+    uint16_t m_gen = 0;
+};
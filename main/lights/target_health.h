@@ -0,0 +1,206 @@
+/*
+ * Health of the bound unicast targets, with a circuit breaker per target.
+ *
+ * Every exchange with a target (press command, LED sync read) reports its outcome here. A target
+ * keeps an RTT EWMA, its consecutive failures and when it last answered. After `fails_to_open`
+ * consecutive failures its breaker opens: presses and sync reads skip it, and no CASE attempt or
+ * exchange is spent on it. Once the backoff has passed, the next exchange goes through as a probe.
+ * The probe is a single token per target, shared by presses and sync reads: whichever path takes it
+ * first holds it, and every other exchange is still skipped until the probe's outcome arrives.
+ * A success closes the breaker. A failure, or no answer within another backoff, reopens it with
+ * the backoff doubled (backoff_min_ms .. backoff_max_ms).
+ *
+ * Fixed table of LIGHT_HEALTH_TARGETS entries keyed by node id + endpoint, by default one per
+ * unicast binding slot so every bound target keeps its RTT (the fan-out sorts by it); when it is
+ * full (stale targets of removed bindings) the least recently used entry is recycled. Not thread safe: the light manager only touches it on
+ * the Matter thread (the console reads it without locking, for display only).
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include "app_config.h"
+#include "light_manager.h" // MAX_SHADOW_BINDINGS_PER_CH (LIGHT_HEALTH_TARGETS default)
+
+struct TargetHealth {
+    enum State : uint8_t { Closed, Open, Probing };
+    uint64_t node_id;
+    uint16_t endpoint;
+    State state;
+    uint8_t fails;        // consecutive failures
+    uint32_t rtt_ewma_us; // successful exchanges, EWMA 1/4 (0 = none yet)
+    uint32_t backoff_ms;  // current open interval (0 while closed)
+    uint32_t ok;
+    uint32_t failed;
+    uint32_t skipped;     // exchanges not attempted while open
+    int64_t last_seen_us; // last success (0 = never)
+    int64_t last_used_us; // for recycling
+    int64_t probe_us;     // Open: first probe allowed at; Probing: probe answer due by
+    intptr_t probe_owner; // Probing: who holds the probe token (press transaction, kSyncOwner)
+};
+
+class TargetHealthTable {
+public:
+    enum Change : uint8_t { None, Opened, Recovered };
+    // Probe token owner of the LED sync reads (press transactions use their handle, never negative).
+    static constexpr intptr_t kSyncOwner = -1;
+
+    void configure(uint8_t fails_to_open, uint32_t backoff_min_ms, uint32_t backoff_max_ms)
+    {
+        m_fails_to_open = fails_to_open ? fails_to_open : 1;
+        m_backoff_min_ms = backoff_min_ms;
+        m_backoff_max_ms = backoff_max_ms > backoff_min_ms ? backoff_max_ms : backoff_min_ms;
+    }
+    void reset()
+    {
+        for (TargetHealth & t : m) t = {};
+        m_open = 0;
+    }
+    // Any breaker open or probing? While none is, attempt() and blocked() need no lookup.
+    bool any_open() const { return m_open != 0; }
+
+    // Would attempt() by `owner` skip the target now? (No state change; unknown targets are never blocked.)
+    bool blocked(uint64_t node, uint16_t ep, int64_t now_us, intptr_t owner) const
+    {
+        if (!m_open) return false;
+        const TargetHealth * t = find(node, ep);
+        if (!t) return false;
+        if (t->state == TargetHealth::Probing) return now_us >= t->probe_us || t->probe_owner != owner;
+        return t->state == TargetHealth::Open && now_us < t->probe_us;
+    }
+
+    // Before an exchange with the target by `owner`. Returns false if it must be skipped (breaker
+    // open, or another owner holds the probe). Hands `owner` the probe token when the backoff has
+    // passed (`*probe` set) and reopens the breaker when a probe went unanswered.
+    bool attempt(uint64_t node, uint16_t ep, int64_t now_us, intptr_t owner, bool * probe = nullptr)
+    {
+        if (probe) *probe = false;
+        if (!m_open) return true;
+        TargetHealth * t = find(node, ep);
+        if (!t || t->state == TargetHealth::Closed) return true;
+        t->last_used_us = now_us;
+        if (t->state == TargetHealth::Probing && now_us >= t->probe_us) { // probe never answered
+            t->failed++;
+            reopen(*t, now_us);
+        }
+        if (t->state == TargetHealth::Probing) {
+            if (t->probe_owner == owner) return true; // the same press or sync round, another binding
+            t->skipped++;
+            return false;
+        }
+        if (now_us < t->probe_us) {
+            t->skipped++;
+            return false;
+        }
+        t->state = TargetHealth::Probing;
+        t->probe_us = now_us + (int64_t)t->backoff_ms * 1000;
+        t->probe_owner = owner;
+        if (probe) *probe = true;
+        return true;
+    }
+
+    // `owner` took the probe token but sent nothing (queue full, send failed): hand it back, due now.
+    void release(uint64_t node, uint16_t ep, intptr_t owner, int64_t now_us)
+    {
+        if (!m_open) return;
+        TargetHealth * t = find(node, ep);
+        if (!t || t->state != TargetHealth::Probing || t->probe_owner != owner) return;
+        t->state = TargetHealth::Open;
+        t->probe_us = now_us;
+    }
+
+    // Outcome of one exchange (rtt_us 0 = unknown).
+    Change report(uint64_t node, uint16_t ep, bool ok, uint32_t rtt_us, int64_t now_us)
+    {
+        TargetHealth * t = find_or_add(node, ep, now_us, ok);
+        if (!t) return None;
+        t->last_used_us = now_us;
+        if (ok) {
+            t->ok++;
+            t->last_seen_us = now_us;
+            if (rtt_us) t->rtt_ewma_us = t->rtt_ewma_us ? t->rtt_ewma_us - t->rtt_ewma_us / 4 + rtt_us / 4 : rtt_us;
+            t->fails = 0;
+            if (t->state == TargetHealth::Closed) return None;
+            t->state = TargetHealth::Closed;
+            t->backoff_ms = 0;
+            m_open--;
+            return Recovered;
+        }
+        t->failed++;
+        if (t->fails < UINT8_MAX) t->fails++;
+        if (t->state == TargetHealth::Probing) {
+            reopen(*t, now_us);
+            return None;
+        }
+        if (t->state == TargetHealth::Closed && t->fails >= m_fails_to_open) {
+            t->state = TargetHealth::Open;
+            m_open++;
+            t->backoff_ms = m_backoff_min_ms;
+            t->probe_us = now_us + (int64_t)t->backoff_ms * 1000;
+            return Opened;
+        }
+        return None;
+    }
+
+    int open_count() const { return m_open; }
+    // RTT EWMA of a target (0 = unknown).
+    uint32_t rtt_us(uint64_t node, uint16_t ep) const
+    {
+        const TargetHealth * t = find(node, ep);
+        return t ? t->rtt_ewma_us : 0;
+    }
+    const TargetHealth * entries() const { return m; }
+    static constexpr int size() { return kSlots; }
+
+private:
+    static constexpr int kSlots = LIGHT_HEALTH_TARGETS;
+    static_assert(kSlots >= 1 && kSlots <= UINT16_MAX, "LIGHT_HEALTH_TARGETS must be 1..65535");
+
+    void reopen(TargetHealth & t, int64_t now_us)
+    {
+        t.state = TargetHealth::Open;
+        t.backoff_ms = t.backoff_ms * 2 < m_backoff_max_ms ? t.backoff_ms * 2 : m_backoff_max_ms;
+        t.probe_us = now_us + (int64_t)t.backoff_ms * 1000;
+    }
+    const TargetHealth * find(uint64_t node, uint16_t ep) const
+    {
+        for (const TargetHealth & t : m)
+            if (t.node_id == node && t.endpoint == ep && node) return &t;
+        return nullptr;
+    }
+    TargetHealth * find(uint64_t node, uint16_t ep) { return const_cast<TargetHealth *>(static_cast<const TargetHealthTable *>(this)->find(node, ep)); }
+    // A full table recycles the least recently used healthy entry. Only a failing target may take
+    // an open one (when every entry is open), so successes never evict what a breaker remembers.
+    TargetHealth * find_or_add(uint64_t node, uint16_t ep, int64_t now_us, bool ok)
+    {
+        TargetHealth * slot = nullptr;
+        for (TargetHealth & t : m) {
+            if (t.node_id == node && t.endpoint == ep && node) return &t;
+            if (!t.node_id) {
+                if (!slot || slot->node_id) slot = &t;
+            } else if ((!ok || t.state == TargetHealth::Closed) && (!slot || (slot->node_id && lru_before(t, *slot)))) {
+                slot = &t;
+            }
+        }
+        if (!slot) return nullptr;
+        if (slot->state != TargetHealth::Closed) m_open--;
+        *slot = TargetHealth{};
+        slot->node_id = node;
+        slot->endpoint = ep;
+        slot->last_used_us = now_us;
+        return slot;
+    }
+
+    // Recycling order: healthy before open, then least recently used.
+    static bool lru_before(const TargetHealth & a, const TargetHealth & b)
+    {
+        bool a_open = a.state != TargetHealth::Closed, b_open = b.state != TargetHealth::Closed;
+        return a_open != b_open ? !a_open : a.last_used_us < b.last_used_us;
+    }
+
+    TargetHealth m[kSlots] = {};
+    uint16_t m_open = 0; // entries not Closed
+    uint8_t m_fails_to_open = 3;
+    uint32_t m_backoff_min_ms = 20000;
+    uint32_t m_backoff_max_ms = 600000;
+};
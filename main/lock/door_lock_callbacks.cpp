@@ -10,6 +10,7 @@
 #include "door_lock_manager.h"
 #include <app/clusters/door-lock-server/door-lock-server.h>
 #include <platform/CHIPDeviceLayer.h>
+#include "diag/work_probe.h"
 
 #include <app-common/zap-generated/ids/Attributes.h>
 #include <app-common/zap-generated/ids/Clusters.h>
@@ -37,7 +38,7 @@ void emberAfDoorLockClusterInitCallback(EndpointId endpoint)
     // Add a small delay to ensure the Matter stack is ready
     
     // Schedule the lock state initialization on the Matter thread to avoid blocking
-    chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t context) {
+    work_probe_schedule(WorkSource::ContactSensor, [](intptr_t context) {
         EndpointId ep = static_cast<EndpointId>(context);
         ESP_LOGI(TAG, "Initializing lock state for endpoint %d", ep);
         
@@ -14,7 +14,12 @@
 #include <cstring>
 #include <esp_log.h>
 #include <esp_matter.h>
+#include <esp_timer.h>
 #include <platform/CHIPDeviceLayer.h>
+#include "app_config.h"
+#include "diag/metrics.h"
+#include "diag/work_probe.h"
+#include "rtos_static.h"
 
 static const char *TAG = "garagedoor_manager";
 
@@ -24,6 +29,12 @@ extern uint16_t contact_sensor_endpoint_id;
 
 BoltLockManager BoltLockManager::sLock;
 
+static metrics::Counter s_m_door_changes("lock.door_changes");
+static metrics::Counter s_m_relay_pulses("lock.relay_pulses");
+static metrics::Counter s_m_contact_updates("lock.contact_updates");
+static metrics::Counter s_m_contact_update_errors("lock.contact_update_errors");
+static metrics::Gauge s_m_door_open("lock.door_open");
+
 // Initialize static variables
 bool BoltLockManager::sContactSensorStateChanged = false;
 bool BoltLockManager::sContactSensorState = false;
@@ -34,21 +45,21 @@ using namespace chip::app;
 using namespace chip::app::Clusters;
 using namespace chip::app::Clusters::DoorLock;
 
+// Relay pulse worker and the post-toggle state check. Both are created once in Init(): the worker
+// on static storage (rtos_static.h), the check as an esp_timer re-armed on every operation.
+static TaskHandle_t s_relay_task = NULL;
+static esp_timer_handle_t s_state_check_timer = NULL;
+
+struct DelayedStateCheck {
+    EndpointId endpointId;
+    DlLockState targetState;
+    BoltLockManager* manager;
+};
+static DelayedStateCheck s_check_context;
+
 BoltLockManager::~BoltLockManager()
 {
-    // Clean up the mutex if it exists
-    if (sContactSensorMutex != NULL) {
-        vSemaphoreDelete(sContactSensorMutex);
-        sContactSensorMutex = NULL;
-        ESP_LOGI(TAG, "Cleaned up contact sensor mutex");
-    }
-    
-    // Stop the garage door sensor task if it's running
-    if (mDoorSensorTaskHandle != NULL) {
-        vTaskDelete(mDoorSensorTaskHandle);
-        mDoorSensorTaskHandle = NULL;
-        ESP_LOGI(TAG, "Stopped garage door sensor task");
-    }
+    // Tasks, the mutex and the timer are static and live for the whole program (sLock is a static).
 }
 
 CHIP_ERROR BoltLockManager::Init(DataModel::Nullable<DlLockState> state)
@@ -57,7 +68,7 @@ CHIP_ERROR BoltLockManager::Init(DataModel::Nullable<DlLockState> state)
     
     // Create mutex for thread-safe access to contact sensor state
     if (sContactSensorMutex == NULL) {
-        sContactSensorMutex = xSemaphoreCreateMutex();
+        sContactSensorMutex = rtos_static_mutex_create(RtosMutex::GarageContact);
         if (sContactSensorMutex == NULL) {
             ESP_LOGE(TAG, "Failed to create contact sensor mutex");
             return CHIP_ERROR_NO_MEMORY;
@@ -69,39 +80,40 @@ CHIP_ERROR BoltLockManager::Init(DataModel::Nullable<DlLockState> state)
     // GPIO will be initialized later when the system is stable
     ESP_LOGI(TAG, "GPIO initialization deferred until system is stable");
     
-    // Create a delayed initialization task that will run after Matter is stable
-    BaseType_t taskResult = xTaskCreate(delayedGpioInitTask, "delayed_gpio_init", 4096, this, 5, NULL);
-    
-    if (taskResult != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create delayed GPIO initialization task");
-        return CHIP_ERROR_NO_MEMORY;
+    // The post-toggle state check timer is created up front so an operation never allocates.
+    if (s_state_check_timer == NULL) {
+        esp_timer_create_args_t args = {};
+        args.callback = &stateCheckTimerCb;
+        args.arg = &s_check_context;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "garage_check";
+        if (esp_timer_create(&args, &s_state_check_timer) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create garage state check timer");
+            return CHIP_ERROR_NO_MEMORY;
+        }
     }
-    ESP_LOGI(TAG, "Delayed GPIO initialization task created successfully");
+
+    // The sensor task runs the deferred GPIO init first; the relay worker sleeps until a pulse.
+    mDoorSensorTaskHandle = rtos_static_task_start(RtosTask::GarageSensor, doorSensorTask, this, 5);
+    s_relay_task = rtos_static_task_start(RtosTask::GarageRelay, relayTask, NULL, 5);
+    ESP_LOGI(TAG, "Garage sensor and relay tasks started (static)");
     
     return CHIP_NO_ERROR;
 }
 
-void BoltLockManager::delayedGpioInitTask(void *pvParameters)
+void BoltLockManager::delayedGpioInit()
 {
-    BoltLockManager* manager = static_cast<BoltLockManager*>(pvParameters);
-    
     // Wait for Matter stack to stabilize
     vTaskDelay(pdMS_TO_TICKS(5000)); // 5 second delay
     
     ESP_LOGI(TAG, "Starting delayed GPIO initialization...");
     
     // Now initialize GPIO safely
-    manager->initRelayPin();
+    initRelayPin();
     ESP_LOGI(TAG, "Relay pin initialization completed successfully");
     
-    manager->initDoorSensor();
+    initDoorSensor();
     ESP_LOGI(TAG, "Door sensor initialization completed successfully");
-    
-    // Start the door sensor monitoring task
-    xTaskCreate(doorSensorTask, "garage_door_sensor_task", 2048, manager, 5, &manager->mDoorSensorTaskHandle);
-    
-    // Delete this initialization task
-    vTaskDelete(NULL);
 }
 
 void BoltLockManager::initRelayPin()
@@ -240,7 +252,7 @@ void BoltLockManager::ScheduleContactSensorUpdate(bool isOpen)
     
     // Schedule the work on the Matter thread
     ESP_LOGI(TAG, "Scheduling contact sensor update on Matter thread: %s", isOpen ? "OPEN" : "CLOSED");
-    chip::DeviceLayer::PlatformMgr().ScheduleWork(ContactSensorUpdateHandler, stateValue);
+    work_probe_schedule(WorkSource::ContactSensor, ContactSensorUpdateHandler, stateValue);
 }
 
 void BoltLockManager::ContactSensorUpdateHandler(intptr_t context)
@@ -261,9 +273,11 @@ void BoltLockManager::ContactSensorUpdateHandler(intptr_t context)
         esp_err_t err = esp_matter::attribute::report(contact_sensor_endpoint_id, 0x0045, 0x0000, &val);
         
         if (err == ESP_OK) {
+            s_m_contact_updates.inc();
             ESP_LOGI(TAG, "Matter thread: Updated contact sensor state to %s",
                      isOpen ? "OPEN (active)" : "CLOSED (inactive)");
         } else {
+            s_m_contact_update_errors.inc();
             ESP_LOGE(TAG, "Failed to update contact sensor state: %d", err);
         }
     } else {
@@ -275,6 +289,8 @@ void BoltLockManager::updateDoorState(bool isOpen)
 {
     // Update the internal state
     mDoorIsOpen = isOpen;
+    s_m_door_changes.inc();
+    s_m_door_open.set(isOpen ? 1 : 0);
     
     // Log the door state change
     ESP_LOGI(TAG, "Garage door state changed: %s", isOpen ? "OPEN" : "CLOSED");
@@ -291,7 +307,7 @@ void BoltLockManager::updateDoorState(bool isOpen)
     
     // Schedule the door lock state update on the Matter thread
     ESP_LOGI(TAG, "Scheduling door lock state update on Matter thread");
-    chip::DeviceLayer::PlatformMgr().ScheduleWork(
+    work_probe_schedule(WorkSource::ContactSensor,
         [](intptr_t context) {
             DoorStateContext* ctx = reinterpret_cast<DoorStateContext*>(context);
             
@@ -314,6 +330,7 @@ void BoltLockManager::updateDoorState(bool isOpen)
 void BoltLockManager::doorSensorTask(void *pvParameters)
 {
     BoltLockManager *manager = static_cast<BoltLockManager *>(pvParameters);
+    manager->delayedGpioInit();
     bool lastDoorState = manager->getDoorState();
     
     // Log initial state
@@ -356,10 +373,23 @@ void BoltLockManager::doorSensorTask(void *pvParameters)
 void BoltLockManager::toggleGarageDoor()
 {
     ESP_LOGI(TAG, "Garage door: Scheduling MOSFET toggle operation");
+    s_m_relay_pulses.inc();
     
-    // Schedule the MOSFET toggle on a separate task to avoid blocking the Matter thread
-    xTaskCreate([](void* param) {
-        const int mosfet_activation_time = 1000; // 1 second activation
+    // Hand the pulse to the relay worker to avoid blocking the Matter thread
+    if (s_relay_task != NULL) {
+        xTaskNotifyGive(s_relay_task);
+    } else {
+        ESP_LOGE(TAG, "Garage door: relay task not started, pulse dropped");
+    }
+}
+
+void BoltLockManager::relayTask(void *pvParameters)
+{
+    const int mosfet_activation_time = 1000; // 1 second activation
+    
+    while (1) {
+        // One pulse per notification; pulses requested during a pulse run back to back
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
         
         ESP_LOGI(TAG, "Garage door: Activating MOSFET");
         
@@ -376,10 +406,25 @@ void BoltLockManager::toggleGarageDoor()
         ESP_LOGI(TAG, "Garage door MOSFET DEACTIVATED (GPIO=%d LOW)", GARAGE_DOOR_RELAY_PIN);
         
         ESP_LOGI(TAG, "Garage door: MOSFET toggle operation completed - door should be moving");
+    }
+}
+
+void BoltLockManager::stateCheckTimerCb(void *arg)
+{
+    DelayedStateCheck* ctx = static_cast<DelayedStateCheck*>(arg);
+    
+    ESP_LOGI(TAG, "Checking door state after 15-second delay...");
+    
+    // Update the lock state to match actual door position
+    work_probe_schedule(WorkSource::ContactSensor, [](intptr_t context) {
+        DelayedStateCheck* ctx = reinterpret_cast<DelayedStateCheck*>(context);
+        bool doorState = ctx->manager->getDoorState();
+        DlLockState finalState = doorState ? DlLockState::kUnlocked : DlLockState::kLocked;
         
-        // Delete this task as it's a one-time operation
-        vTaskDelete(NULL);
-    }, "garage_door_toggle", 2048, NULL, 5, NULL);
+        DoorLockServer::Instance().SetLockState(ctx->endpointId, finalState);
+        ESP_LOGI(TAG, "Final lock state set to %s after garage door operation",
+                 doorState ? "UNLOCKED" : "LOCKED");
+    }, reinterpret_cast<intptr_t>(ctx));
 }
 
 bool BoltLockManager::Lock(EndpointId endpointId, const Optional<ByteSpan> & pin, OperationErrorEnum & err)
@@ -456,45 +501,16 @@ bool BoltLockManager::setLockState(EndpointId endpointId, DlLockState lockState,
         ESP_LOGI(TAG, "Garage Door: Triggering toggle operation");
         toggleGarageDoor();
         
-        // Schedule a delayed check to verify the door has moved (15 seconds for garage door)
-        struct DelayedStateCheck {
-            EndpointId endpointId;
-            DlLockState targetState;
-            BoltLockManager* manager;
-        };
-        
-        static DelayedStateCheck checkContext;
-        checkContext.endpointId = endpointId;
-        checkContext.targetState = lockState;
-        checkContext.manager = this;
+        // Schedule a delayed check to verify the door has moved (15 seconds for garage door);
+        // a newer operation re-arms the check.
+        s_check_context.endpointId = endpointId;
+        s_check_context.targetState = lockState;
+        s_check_context.manager = this;
         
-        // Create a task to check the door state after 15 seconds
-        xTaskCreate([](void* param) {
-            DelayedStateCheck* ctx = static_cast<DelayedStateCheck*>(param);
-            
-            // Wait 15 seconds for garage door to complete movement
-            vTaskDelay(pdMS_TO_TICKS(15000));
-            
-            ESP_LOGI(TAG, "Checking door state after 15-second delay...");
-            
-            // Read current door state and update lock state accordingly
-            bool currentDoorState = ctx->manager->getDoorState();
-            DlLockState actualLockState = currentDoorState ? DlLockState::kUnlocked : DlLockState::kLocked;
-            
-            // Update the lock state to match actual door position
-            chip::DeviceLayer::PlatformMgr().ScheduleWork([](intptr_t context) {
-                DelayedStateCheck* ctx = reinterpret_cast<DelayedStateCheck*>(context);
-                bool doorState = ctx->manager->getDoorState();
-                DlLockState finalState = doorState ? DlLockState::kUnlocked : DlLockState::kLocked;
-                
-                DoorLockServer::Instance().SetLockState(ctx->endpointId, finalState);
-                ESP_LOGI(TAG, "Final lock state set to %s after garage door operation",
-                         doorState ? "UNLOCKED" : "LOCKED");
-            }, reinterpret_cast<intptr_t>(ctx));
-            
-            // Delete this task
-            vTaskDelete(NULL);
-        }, "delayed_state_check", 2048, &checkContext, 5, NULL);
+        if (s_state_check_timer != NULL) {
+            esp_timer_stop(s_state_check_timer);
+            esp_timer_start_once(s_state_check_timer, 15000ULL * 1000ULL);
+        }
     }
     
     return true;
@@ -62,8 +62,14 @@ public:
     void updateDoorState(bool isOpen);
     static void doorSensorTask(void *pvParameters);
     
-    // Delayed GPIO initialization task
-    static void delayedGpioInitTask(void *pvParameters);
+    // Deferred GPIO initialization (run by doorSensorTask before it starts polling)
+    void delayedGpioInit();
+    
+    // Relay pulse worker (one pulse per task notification)
+    static void relayTask(void *pvParameters);
+    
+    // Post-toggle door state check (esp_timer callback)
+    static void stateCheckTimerCb(void *arg);
     
     // Contact sensor methods
     void updateContactSensorState(bool isOpen);
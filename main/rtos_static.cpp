@@ -0,0 +1,112 @@
+/* Storage and creation for the statically allocated RTOS objects listed in rtos_static.h. */
+#include "rtos_static.h"
+
+#include <array>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <esp_log.h>
+
+#include "diag/resource_monitor.h"
+
+static const char *TAG = "rtos_static";
+
+namespace {
+
+struct TaskSlot {
+    const char * name;
+    uint32_t stack_bytes;
+    StackType_t * stack;
+    StaticTask_t * tcb;
+    TaskHandle_t handle;
+};
+
+struct QueueSlot {
+    const char * name;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    uint8_t * storage;
+    StaticQueue_t * cb;
+    QueueHandle_t handle;
+};
+
+struct MutexSlot {
+    const char * name;
+    StaticSemaphore_t * cb;
+    SemaphoreHandle_t handle;
+};
+
+// One named buffer per object so the linker map shows each of them by name.
+#define X(id, name, stack)                                            \
+    StackType_t s_stack_##id[(stack) / sizeof(StackType_t)];          \
+    StaticTask_t s_tcb_##id;
+RTOS_STATIC_TASKS(X)
+#undef X
+
+#define X(id, name, len, size)                                        \
+    uint8_t s_qstore_##id[(len) * (size)];                            \
+    StaticQueue_t s_qcb_##id;
+RTOS_STATIC_QUEUES(X)
+#undef X
+
+#define X(id, name) StaticSemaphore_t s_mcb_##id;
+RTOS_STATIC_MUTEXES(X)
+#undef X
+
+std::array<TaskSlot, (size_t)RtosTask::Count> s_tasks = { {
+#define X(id, name, stack) { name, (uint32_t)(stack), s_stack_##id, &s_tcb_##id, nullptr },
+    RTOS_STATIC_TASKS(X)
+#undef X
+} };
+
+std::array<QueueSlot, (size_t)RtosQueue::Count> s_queues = { {
+#define X(id, name, len, size) { name, (UBaseType_t)(len), (UBaseType_t)(size), s_qstore_##id, &s_qcb_##id, nullptr },
+    RTOS_STATIC_QUEUES(X)
+#undef X
+} };
+
+std::array<MutexSlot, (size_t)RtosMutex::Count> s_mutexes = { {
+#define X(id, name) { name, &s_mcb_##id, nullptr },
+    RTOS_STATIC_MUTEXES(X)
+#undef X
+} };
+
+} // namespace
+
+TaskHandle_t rtos_static_task_start(RtosTask id, TaskFunction_t fn, void * arg, UBaseType_t priority)
+{
+    TaskSlot & t = s_tasks[(size_t)id];
+    if (t.handle) return t.handle;
+    t.handle = xTaskCreateStatic(fn, t.name, t.stack_bytes, arg, priority, t.stack, t.tcb);
+    resource_monitor_track_task(t.handle, t.name, t.stack_bytes);
+    ESP_LOGD(TAG, "task %s: %" PRIu32 " byte static stack", t.name, t.stack_bytes);
+    return t.handle;
+}
+
+QueueHandle_t rtos_static_queue_create(RtosQueue id)
+{
+    QueueSlot & q = s_queues[(size_t)id];
+    if (!q.handle) q.handle = xQueueCreateStatic(q.length, q.item_size, q.storage, q.cb);
+    return q.handle;
+}
+
+SemaphoreHandle_t rtos_static_mutex_create(RtosMutex id)
+{
+    MutexSlot & m = s_mutexes[(size_t)id];
+    if (!m.handle) m.handle = xSemaphoreCreateMutexStatic(m.cb);
+    return m.handle;
+}
+
+void rtos_static_print_map()
+{
+    printf("%-6s %-16s %8s %s\n", "kind", "name", "bytes", "created");
+    size_t t = 0, q = 0, m = 0;
+    for (const rtos_static::MapEntry & e : rtos_static::k_map) {
+        bool created = false;
+        if (e.kind[0] == 't') created = s_tasks[t++].handle != nullptr;
+        else if (e.kind[0] == 'q') created = s_queues[q++].handle != nullptr;
+        else created = s_mutexes[m++].handle != nullptr;
+        printf("%-6s %-16s %8" PRIu32 " %s\n", e.kind, e.name, e.bytes, created ? "yes" : "no");
+    }
+    printf("static RTOS total: %" PRIu32 " bytes (budget %d)\n", rtos_static::total_bytes(), RTOS_STATIC_BUDGET_BYTES);
+}
@@ -0,0 +1,112 @@
+/*
+ * Statically allocated RTOS objects.
+ *
+ * Every firmware-owned task and queue is listed once in the tables below. rtos_static.cpp reserves
+ * their stacks, control blocks and queue storage in .bss, so creating them cannot fail at runtime and
+ * none of it comes out of the heap the CHIP stack later carves its pools from. The same tables give a
+ * compile-time memory map (rtos_static::k_map) that `matter resmon map` prints.
+ *
+ * Static tasks are persistent: they may block forever but never vTaskDelete themselves, because the
+ * idle task still references a deleted TCB until it has cleaned up and the buffer cannot be reused.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "app_config.h"
+
+// X(id, name, stack_bytes)
+#define RTOS_STATIC_TASKS_CORE(X)                   \
+    X(BtnPoll, "btn_poll", BTN_POLL_TASK_STACK)     \
+    X(BtnAct, "btn_act", BTN_ACT_TASK_STACK)        \
+    X(TempMgr, "temp_mgr", TEMP_TASK_STACK)
+#if GARAGE_DOOR_ENABLE
+#define RTOS_STATIC_TASKS_GARAGE(X)                           \
+    X(GarageSensor, "garage_sensor", GARAGE_SENSOR_TASK_STACK) \
+    X(GarageRelay, "garage_relay", GARAGE_RELAY_TASK_STACK)
+#else
+#define RTOS_STATIC_TASKS_GARAGE(X)
+#endif
+#define RTOS_STATIC_TASKS(X) RTOS_STATIC_TASKS_CORE(X) RTOS_STATIC_TASKS_GARAGE(X)
+
+// X(id, name, length, item_size)
+#define RTOS_STATIC_QUEUES(X) \
+    X(BtnEvt, "btn_evt", BTN_EVT_QUEUE_LEN, sizeof(uint8_t))
+
+// X(id, name)
+#if GARAGE_DOOR_ENABLE
+#define RTOS_STATIC_MUTEXES_GARAGE(X) X(GarageContact, "garage_contact")
+#else
+#define RTOS_STATIC_MUTEXES_GARAGE(X)
+#endif
+#define RTOS_STATIC_MUTEXES(X) X(TempRules, "temp_rules") RTOS_STATIC_MUTEXES_GARAGE(X)
+
+enum class RtosTask : uint8_t {
+#define X(id, name, stack) id,
+    RTOS_STATIC_TASKS(X)
+#undef X
+    Count
+};
+
+enum class RtosQueue : uint8_t {
+#define X(id, name, len, size) id,
+    RTOS_STATIC_QUEUES(X)
+#undef X
+    Count
+};
+
+enum class RtosMutex : uint8_t {
+#define X(id, name) id,
+    RTOS_STATIC_MUTEXES(X)
+#undef X
+    Count
+};
+
+namespace rtos_static {
+
+struct MapEntry {
+    const char * kind;
+    const char * name;
+    uint32_t bytes; // stack or item storage plus the control block
+};
+
+inline constexpr MapEntry k_map[] = {
+#define X(id, name, stack) { "task", name, (uint32_t)((stack) + sizeof(StaticTask_t)) },
+    RTOS_STATIC_TASKS(X)
+#undef X
+#define X(id, name, len, size) { "queue", name, (uint32_t)((len) * (size) + sizeof(StaticQueue_t)) },
+    RTOS_STATIC_QUEUES(X)
+#undef X
+#define X(id, name) { "mutex", name, (uint32_t)sizeof(StaticSemaphore_t) },
+    RTOS_STATIC_MUTEXES(X)
+#undef X
+};
+
+constexpr uint32_t total_bytes()
+{
+    uint32_t sum = 0;
+    for (const MapEntry & e : k_map) sum += e.bytes;
+    return sum;
+}
+
+} // namespace rtos_static
+
+static_assert(rtos_static::total_bytes() <= RTOS_STATIC_BUDGET_BYTES,
+              "static RTOS objects exceed RTOS_STATIC_BUDGET_BYTES; review *_TASK_STACK in app_config.h");
+
+// Create task `id` on its reserved stack and TCB and register it with the resource monitor.
+// Each task is started at most once; later calls return the existing handle.
+TaskHandle_t rtos_static_task_start(RtosTask id, TaskFunction_t fn, void * arg, UBaseType_t priority);
+
+// Create queue `id` in its reserved storage (idempotent, like rtos_static_task_start).
+QueueHandle_t rtos_static_queue_create(RtosQueue id);
+
+// Create mutex `id` in its reserved control block (idempotent).
+SemaphoreHandle_t rtos_static_mutex_create(RtosMutex id);
+
+// Print the static memory map (kind, name, bytes, created) and the total to stdout.
+void rtos_static_print_map();
@@ -0,0 +1,43 @@
+/* DHT22 pulse-train decoder (split out of temp_manager for reuse on the host build). */
+#include "dht22_decode.h"
+#include <string.h>
+#include "app_config.h"
+
+dht22_decode_status_t dht22_decode_pulses(const uint8_t * pulse_lvl, const uint16_t * pulse_dur, size_t pulse_count, Dht22Frame * out)
+{
+    memset(out, 0, sizeof(*out));
+    uint8_t * data = out->raw;
+    int bit_index = 0;
+    int presence_skipped = 0;
+    // Scan for low-high pairs
+    for(size_t i=0; i+1<pulse_count && bit_index < 40; i++) {
+        if(pulse_lvl[i] != 0 || pulse_lvl[i+1] != 1) continue; // need low then high consecutive
+        uint32_t low = pulse_dur[i];
+        uint32_t high = pulse_dur[i+1];
+        // Presence pulse pair (~80/80) - skip first two
+        if(presence_skipped < 2 && low >= 60 && low <= 110 && high >= 60 && high <= 110) {
+            presence_skipped++;
+            continue;
+        }
+        if(low < 30 || low > 100) continue; // filter improbable low
+        uint8_t bit = (high > DHT22_BIT_THRESHOLD_US) ? 1 : 0;
+        data[bit_index/8] = (uint8_t)((data[bit_index/8] << 1) | bit);
+        bit_index++;
+        i++; // advance past the high we used
+    }
+    out->bits = bit_index;
+    out->presence_skipped = presence_skipped;
+    if(bit_index != 40) return DHT22_DECODE_BAD_BITS;
+    uint8_t sum = (uint8_t)((data[0]+data[1]+data[2]+data[3]) & 0xFF);
+    if(sum != data[4]) return DHT22_DECODE_CHECKSUM;
+    if(data[0]==0 && data[1]==0 && data[2]==0 && data[3]==0) return DHT22_DECODE_ALL_ZERO;
+    uint16_t raw_h = ((uint16_t)data[0] << 8) | data[1];
+    uint16_t raw_t_mag = ((uint16_t)(data[2] & 0x7F) << 8) | data[3];
+    bool neg = (data[2] & 0x80) != 0;
+    out->hum_x10 = raw_h;
+    out->temp_x10 = neg ? -(int16_t)raw_t_mag : (int16_t)raw_t_mag;
+    if(out->temp_x10 < DHT22_TEMP_MIN_X10 || out->temp_x10 > DHT22_TEMP_MAX_X10 || out->hum_x10 < DHT22_HUM_MIN_X10 || out->hum_x10 > DHT22_HUM_MAX_X10) {
+        return DHT22_DECODE_OUT_OF_RANGE;
+    }
+    return DHT22_DECODE_OK;
+}
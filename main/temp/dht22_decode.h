@@ -0,0 +1,23 @@
+/* DHT22 frame decoding from captured (level, duration) pulses. Hardware independent. */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    DHT22_DECODE_OK = 0,
+    DHT22_DECODE_BAD_BITS,      // fewer / more than 40 data bits recognised
+    DHT22_DECODE_CHECKSUM,
+    DHT22_DECODE_ALL_ZERO,
+    DHT22_DECODE_OUT_OF_RANGE,  // outside DHT22_TEMP_* / DHT22_HUM_* limits
+} dht22_decode_status_t;
+
+typedef struct {
+    int16_t temp_x10;
+    uint16_t hum_x10;
+    uint8_t raw[5];
+    int bits;               // data bits recognised
+    int presence_skipped;   // presence pulse pairs skipped (expected 1-2)
+} Dht22Frame;
+
+// `lvl[i]` / `dur_us[i]` describe consecutive pulses as captured by RMT (starting polarity may vary).
+dht22_decode_status_t dht22_decode_pulses(const uint8_t * lvl, const uint16_t * dur_us, size_t count, Dht22Frame * out);
@@ -0,0 +1,167 @@
+/* Threshold rules on the DHT22 samples (see rules.h). Evaluated on the sensor task. */
+#include "rules.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_matter_console.h>
+
+#include "light_manager.h"
+#include "rtos_static.h"
+#include "diag/metrics.h"
+#include "diag/trace.h"
+
+static const char * TAG = "rules";
+
+static metrics::Counter s_m_evals("rules.evals");
+static metrics::Counter s_m_fired("rules.fired");
+static metrics::Counter s_m_cleared("rules.cleared");
+static metrics::Gauge s_m_active("rules.active");
+
+// The rule set and its engine state; the console edits it while the sensor task evaluates it.
+static RuleSet s_set = { RuleSet::kVersion, 0, {} };
+static RuleEngine s_engine;
+static SemaphoreHandle_t s_lock = nullptr;
+
+static void lock()
+{
+    if (!s_lock) s_lock = rtos_static_mutex_create(RtosMutex::TempRules);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+}
+static void unlock() { xSemaphoreGive(s_lock); }
+
+void rules_init()
+{
+    lock();
+    RuleSet tmp = {};
+    if (rules_store_load(&tmp) == ESP_OK) s_set = tmp;
+    s_engine.reset();
+    unlock();
+    if (s_set.count) ESP_LOGI(TAG, "%u rule(s) loaded", s_set.count);
+}
+
+void rules_on_sample(int16_t t_0_01, uint16_t h_0_01)
+{
+    TRACE_SCOPE("rules.eval");
+    lock();
+    s_m_evals.inc();
+    s_engine.step(s_set.rules, s_set.count, t_0_01, h_0_01, esp_timer_get_time(), [](uint8_t i, const Rule & r, bool fired) {
+        (fired ? s_m_fired : s_m_cleared).inc();
+        bool on = (r.flags & Rule::kOn) != 0;
+        ESP_LOGI(TAG, "rule %u %s -> CH%u", i, fired ? "fired" : "cleared", r.channel);
+        if (fired) light_manager_set(r.channel, on);
+        else if (r.flags & Rule::kClearSends) light_manager_set(r.channel, !on);
+    });
+    int32_t active = 0;
+    for (uint8_t i = 0; i < s_set.count; i++) active += s_engine.active(i);
+    s_m_active.set(active);
+    unlock();
+}
+
+// ---- Console ----
+// Values are typed in C / %RH ("70", "21.5") and kept in 0.01 units.
+static int16_t parse_centi(const char * s) { return (int16_t)(strtod(s, nullptr) * 100 + (s[0] == '-' ? -0.5 : 0.5)); }
+
+static void print_rules()
+{
+    lock();
+    for (uint8_t i = 0; i < s_set.count; i++) {
+        const Rule & r = s_set.rules[i];
+        bool hum = r.flags & Rule::kHumidity;
+        printf("rule %u: %s %s %.2f%s hyst %.2f dwell %us -> CH%u %s%s%s\n", i, hum ? "hum" : "temp",
+               (r.flags & Rule::kBelow) ? "below" : "above", r.threshold / 100.0, hum ? "%" : "C", r.hysteresis / 100.0,
+               r.dwell_s, r.channel, (r.flags & Rule::kOn) ? "on" : "off", (r.flags & Rule::kClearSends) ? " clear" : "",
+               s_engine.active(i) ? " [active]" : "");
+    }
+    if (!s_set.count) printf("no rules\n");
+    unlock();
+}
+
+// Edit the set under the lock, persist it and restart evaluation (every rule starts clear).
+static int save(void (*edit)(RuleSet &, intptr_t), intptr_t arg)
+{
+    lock();
+    edit(s_set, arg);
+    s_engine.reset();
+    RuleSet copy = s_set;
+    unlock();
+    esp_err_t err = rules_store_save(copy);
+    if (err != ESP_OK) ESP_LOGE(TAG, "Failed saving rules err=%d", (int)err);
+    return err == ESP_OK ? 0 : 1;
+}
+
+// add <ch> temp|hum above|below <value> [hyst=V] [dwell=S] [on|off] [clear]
+static bool parse_rule(int argc, char ** argv, Rule & r)
+{
+    if (argc < 4) return false;
+    r = {};
+    r.flags = Rule::kOn;
+    r.channel = (uint8_t)strtoul(argv[0], nullptr, 0);
+    if (r.channel >= LIGHT_CHANNELS) return false;
+    if (strcmp(argv[1], "hum") == 0) r.flags |= Rule::kHumidity;
+    else if (strcmp(argv[1], "temp") != 0) return false;
+    if (strcmp(argv[2], "below") == 0) r.flags |= Rule::kBelow;
+    else if (strcmp(argv[2], "above") != 0) return false;
+    r.threshold = parse_centi(argv[3]);
+    for (int i = 4; i < argc; i++) {
+        const char * t = argv[i];
+        if (strncmp(t, "hyst=", 5) == 0) r.hysteresis = (uint16_t)parse_centi(t + 5);
+        else if (strncmp(t, "dwell=", 6) == 0) r.dwell_s = (uint16_t)strtoul(t + 6, nullptr, 0);
+        else if (strcmp(t, "on") == 0) r.flags |= Rule::kOn;
+        else if (strcmp(t, "off") == 0) r.flags &= (uint8_t)~Rule::kOn;
+        else if (strcmp(t, "clear") == 0) r.flags |= Rule::kClearSends;
+        else return false;
+    }
+    return true;
+}
+
+int rules_command(int argc, char ** argv)
+{
+    const char * sub = argc >= 1 ? argv[0] : "list";
+    if (strcmp(sub, "list") == 0) {
+        print_rules();
+        return 0;
+    }
+    if (strcmp(sub, "add") == 0) {
+        static Rule s_new; // console task only
+        if (!parse_rule(argc - 1, argv + 1, s_new)) {
+            printf("Usage: matter rule add <ch> temp|hum above|below <value> [hyst=V] [dwell=S] [on|off] [clear]\n");
+            return 1;
+        }
+        if (s_set.count >= RULES_MAX) {
+            printf("rule table full (RULES_MAX %d)\n", RULES_MAX);
+            return 1;
+        }
+        return save([](RuleSet & s, intptr_t) { if (s.count < RULES_MAX) s.rules[s.count++] = s_new; }, 0);
+    }
+    if (strcmp(sub, "del") == 0 && argc >= 2) {
+        return save([](RuleSet & s, intptr_t i) {
+            if (i < 0 || i >= s.count) return;
+            memmove(&s.rules[i], &s.rules[i + 1], (s.count - i - 1) * sizeof(Rule));
+            s.count--;
+        }, (intptr_t)strtol(argv[1], nullptr, 0));
+    }
+    if (strcmp(sub, "clear") == 0) return save([](RuleSet & s, intptr_t) { s.count = 0; }, 0);
+    printf("Usage: matter rule [list] | add <ch> temp|hum above|below <value> [hyst=V] [dwell=S] [on|off] [clear] | del <i> | clear\n");
+    return 1;
+}
+
+#if CONFIG_ENABLE_CHIP_SHELL
+static esp_err_t rules_console_handler(int argc, char ** argv)
+{
+    rules_command(argc, argv);
+    return ESP_OK;
+}
+#endif
+
+void rules_register_console()
+{
+#if CONFIG_ENABLE_CHIP_SHELL
+    static const esp_matter::console::command_t cmds[] = {
+        { .name = "rule", .description = "Sensor rules. Usage: matter rule [list] | add <ch> temp|hum above|below <v> ... | del <i> | clear", .handler = rules_console_handler },
+    };
+    esp_matter::console::add_commands(cmds, sizeof(cmds) / sizeof(cmds[0]));
+#endif
+}
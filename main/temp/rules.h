@@ -0,0 +1,90 @@
+/*
+ * Local threshold rules on the DHT22 samples (e.g. "fan on channel 2 on above 70 %RH").
+ *
+ * A Rule is 8 bytes: sensor, direction, threshold, hysteresis, dwell time and the command it sends
+ * to a channel's bindings. A rule fires when the value has been past the threshold for dwell_s. It
+ * clears when the value has been back by more than the hysteresis for dwell_s. Firing sends On or
+ * Off; with kClearSends, clearing sends the opposite command. RuleEngine keeps two words of state per
+ * rule and is stepped once per valid sample (rules.cpp, on the sensor task). It never allocates.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <esp_err.h>
+
+#include "app_config.h"
+
+struct Rule {
+    enum : uint8_t { kHumidity = 1, kBelow = 2, kOn = 4, kClearSends = 8 };
+    uint8_t flags;
+    uint8_t channel;     // its bindings receive the command
+    int16_t threshold;   // 0.01 C, or 0.01 %RH with kHumidity
+    uint16_t hysteresis; // same unit
+    uint16_t dwell_s;    // how long the condition must hold before firing / clearing
+};
+static_assert(sizeof(Rule) == 8, "Rule is stored as an 8-byte record");
+
+// NVS form: the header plus `count` rules (only the used part is stored).
+struct RuleSet {
+    static constexpr uint8_t kVersion = 1;
+    uint8_t version;
+    uint8_t count;
+    Rule rules[RULES_MAX];
+};
+static_assert(RULES_MAX >= 1 && RULES_MAX <= 32, "RULES_MAX must be 1..32");
+
+class RuleEngine {
+public:
+    void reset()
+    {
+        for (State & s : mState) s = {};
+    }
+    bool active(uint8_t i) const { return mState[i].active; }
+
+    // Evaluate `n` rules against one sample. fire(index, rule, fired) runs for each rule that fires
+    // (fired = true) or clears (false). Returns the number of rules that changed.
+    template <typename F>
+    int step(const Rule * rules, uint8_t n, int16_t t_0_01, uint16_t h_0_01, int64_t now_us, F && fire)
+    {
+        int changed = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            const Rule & r = rules[i];
+            State & s = mState[i];
+            int32_t v = (r.flags & Rule::kHumidity) ? (int32_t)h_0_01 : (int32_t)t_0_01;
+            // Distance past the threshold in the firing direction.
+            int32_t past = (r.flags & Rule::kBelow) ? (int32_t)r.threshold - v : v - (int32_t)r.threshold;
+            bool toward = s.active ? past < -(int32_t)r.hysteresis : past > 0; // toward the other state
+            if (!toward) {
+                s.since_us = 0;
+                continue;
+            }
+            if (!s.since_us) s.since_us = now_us ? now_us : 1;
+            if (now_us - s.since_us < (int64_t)r.dwell_s * 1000000) continue;
+            s.active = !s.active;
+            s.since_us = 0;
+            changed++;
+            fire(i, r, s.active);
+        }
+        return changed;
+    }
+
+private:
+    struct State {
+        bool active;
+        int64_t since_us; // first sample of the current run toward the other state (0 = none)
+    };
+    State mState[RULES_MAX] = {};
+};
+
+// ---- Rules (rules.cpp) ----
+// Sensor task: evaluate every rule against a valid sample (0.01 units).
+void rules_on_sample(int16_t t_0_01, uint16_t h_0_01);
+// Load the rules from NVS (boot).
+void rules_init();
+// `matter rule` console command; also the host simulator's `rule` command.
+int rules_command(int argc, char ** argv);
+void rules_register_console();
+
+// ---- Rule store (rules_store.cpp: NVS namespace "rulecfg"; host/app/host_app.cpp on the host) ----
+esp_err_t rules_store_load(RuleSet * out);
+esp_err_t rules_store_save(const RuleSet & set);
@@ -0,0 +1,50 @@
+/* Rule store: the rule set as one compact NVS blob (namespace "rulecfg", key "rules"). */
+#include "rules.h"
+
+#include <stddef.h>
+#include <esp_log.h>
+#include <nvs.h>
+
+#include "diag/trace.h"
+
+static const char * TAG = "rules_store";
+static const char * k_rules_nvs_namespace = "rulecfg";
+
+// Header plus the used rules only: 2 + 8 * count bytes.
+static size_t blob_size(uint8_t count) { return offsetof(RuleSet, rules) + count * sizeof(Rule); }
+
+esp_err_t rules_store_load(RuleSet * out)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(k_rules_nvs_namespace, NVS_READONLY, &h);
+    if (err != ESP_OK) return err;
+    RuleSet tmp = {};
+    size_t len = sizeof(RuleSet);
+    err = nvs_get_blob(h, "rules", &tmp, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return err;
+    if (tmp.version != RuleSet::kVersion || tmp.count > RULES_MAX || len != blob_size(tmp.count)) { // sanitize
+        ESP_LOGW(TAG, "Ignoring stored rules (version %u, %u bytes)", tmp.version, (unsigned)len);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    for (uint8_t i = 0; i < tmp.count; i++)
+        if (tmp.rules[i].channel >= LIGHT_CHANNELS) return ESP_ERR_INVALID_ARG;
+    *out = tmp;
+    return ESP_OK;
+}
+
+esp_err_t rules_store_save(const RuleSet & set)
+{
+    if (set.count > RULES_MAX) return ESP_ERR_INVALID_ARG;
+    TRACE_SCOPE("nvs.save");
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(k_rules_nvs_namespace, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    RuleSet out = set;
+    out.version = RuleSet::kVersion;
+    err = nvs_set_blob(h, "rules", &out, blob_size(out.count));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err == ESP_OK) ESP_LOGI(TAG, "Saved %u rule(s) to NVS (%u bytes)", out.count, (unsigned)blob_size(out.count));
+    return err;
+}
@@ -1,5 +1,7 @@
 /* DHT22 driver & periodic reporting (moved from light_manager) */
 #include "temp_manager.h"
+#include "dht22_decode.h"
+#include "rules.h"
 #include "app_config.h"
 #include "light_manager.h" // for endpoint globals
 #include <esp_log.h>
@@ -12,6 +14,10 @@
 #include <esp_matter.h>
 #include <app-common/zap-generated/cluster-objects.h>
 #include <platform/PlatformManager.h>
+#include "diag/metrics.h"
+#include "rtos_static.h"
+#include "diag/work_probe.h"
+#include "diag/trace.h"
 
 static const char *TAG = "temp_manager";
 
@@ -25,6 +31,16 @@ static int16_t s_last_t_0_01 = 0; // stored in 0.01C
 static uint16_t s_last_h_0_01 = 0; // stored in 0.01%RH
 static int s_warmup_discarded = 0;
 
+static const uint32_t k_read_buckets_us[] = { 5000, 10000, 20000, 50000, 100000, 500000 };
+static metrics::Counter s_m_reads_ok("temp.reads_ok");
+static metrics::Counter s_m_reads_fail("temp.reads_fail");
+static metrics::Counter s_m_reports("temp.reports");
+static metrics::Counter s_m_report_errors("temp.report_errors");
+static metrics::Gauge s_m_fail_streak("temp.fail_streak");
+static metrics::Gauge s_m_last_t("temp.last_t_0_01c");
+static metrics::Gauge s_m_last_h("temp.last_h_0_01pct");
+static metrics::Histogram s_m_read_us("temp.read_us", k_read_buckets_us);
+
 // RMT-based DHT22 reader using new RMT RX driver (captures pulse widths instead of busy-wait)
 /*
  * DHT22 timing (typical):
@@ -89,13 +105,13 @@ static bool dht22_read_rmt(int16_t &temp_x10, uint16_t &hum_x10) {
     // We reuse the callback's static (registered during ensure_channel). Retrieve its address by static storage in ensure function.
     // For parsing we need a buffer of symbols.
     static rmt_symbol_word_t s_symbols[64];
-    extern bool s_rmt_init_attempted; // silence unused warning if not used elsewhere
 
     // We can't get internal RxState pointer easily; so we re-register a lightweight callback each read.
     static RxState s_rx = { false, 0 };
     auto rx_done_cb2 = [](rmt_channel_handle_t, const rmt_rx_done_event_data_t *edata, void *user)->bool{
         auto *st = reinterpret_cast<RxState*>(user);
         if(st) { st->symbols = edata->num_symbols; st->done = true; }
+        TRACE_INSTANT("dht.rmt_done", edata->num_symbols);
         return false;
     };
     rmt_rx_event_callbacks_t cbs2 = { .on_recv_done = rx_done_cb2 };
@@ -137,9 +153,11 @@ static bool dht22_read_rmt(int16_t &temp_x10, uint16_t &hum_x10) {
 
     // Wait (poll) for completion: DHT22 frame <5ms. Give 8ms budget.
     const int MAX_WAIT_MS = 8;
+    TRACE_BEGIN("dht.rmt_capture");
     for(int waited=0; !s_rx.done && waited<MAX_WAIT_MS; waited++) {
         vTaskDelay(pdMS_TO_TICKS(1));
     }
+    TRACE_END("dht.rmt_capture");
     if(!s_rx.done) {
         ESP_LOGW(TAG, "RMT timeout (no complete frame)");
         return false;
@@ -159,30 +177,13 @@ static bool dht22_read_rmt(int16_t &temp_x10, uint16_t &hum_x10) {
         pulse_lvl[pulse_count] = sym.level0; pulse_dur[pulse_count] = sym.duration0; pulse_count++;
         pulse_lvl[pulse_count] = sym.level1; pulse_dur[pulse_count] = sym.duration1; pulse_count++;
     }
-    // Scan for low-high pairs
-    uint8_t data[5] = {0};
-    int bit_index = 0;
-    int presence_skipped = 0;
-    for(size_t i=0; i+1<pulse_count && bit_index < 40; i++) {
-        if(pulse_lvl[i] != 0 || pulse_lvl[i+1] != 1) continue; // need low then high consecutive
-        uint32_t low = pulse_dur[i];
-        uint32_t high = pulse_dur[i+1];
-        // Presence pulse pair (~80/80) - skip first two
-        if(presence_skipped < 2 && low >= 60 && low <= 110 && high >= 60 && high <= 110) {
-            presence_skipped++;
-            continue;
-        }
-        if(low < 30 || low > 100) continue; // filter improbable low
-        uint8_t bit = (high > DHT22_BIT_THRESHOLD_US) ? 1 : 0;
-        data[bit_index/8] = (uint8_t)((data[bit_index/8] << 1) | bit);
+    Dht22Frame frame;
+    dht22_decode_status_t st = dht22_decode_pulses(pulse_lvl, pulse_dur, pulse_count, &frame);
 #if DHT22_DEBUG
-        ESP_LOGD(TAG, "bit%02d low=%u high=%u val=%u", bit_index, (unsigned)low, (unsigned)high, bit);
+    ESP_LOGD(TAG, "decode st=%d bits=%d raw=%02X %02X %02X %02X %02X", (int)st, frame.bits, frame.raw[0], frame.raw[1], frame.raw[2], frame.raw[3], frame.raw[4]);
 #endif
-        bit_index++;
-        i++; // advance past the high we used
-    }
-    if(bit_index != 40) {
-        if(bit_index == 0) {
+    if(st == DHT22_DECODE_BAD_BITS) {
+        if(frame.bits == 0) {
             // Dump first few pulses for diagnostics
             char buf[192];
             int off=0;
@@ -193,24 +194,20 @@ static bool dht22_read_rmt(int16_t &temp_x10, uint16_t &hum_x10) {
             }
             ESP_LOGW(TAG, "%s", buf);
         }
-        ESP_LOGW(TAG, "bits parsed=%d (expected 40) symbols=%u preskip=%d pulses=%u", bit_index, (unsigned)symbol_count, presence_skipped, (unsigned)pulse_count);
+        ESP_LOGW(TAG, "bits parsed=%d (expected 40) symbols=%u preskip=%d pulses=%u", frame.bits, (unsigned)symbol_count, frame.presence_skipped, (unsigned)pulse_count);
         return false;
     }
-    uint8_t sum = (uint8_t)((data[0]+data[1]+data[2]+data[3]) & 0xFF);
-    if(sum != data[4]) {
-        ESP_LOGW(TAG, "Checksum mismatch %02X!=%02X", sum, data[4]);
+    if(st == DHT22_DECODE_CHECKSUM) {
+        ESP_LOGW(TAG, "Checksum mismatch %02X!=%02X", (uint8_t)(frame.raw[0]+frame.raw[1]+frame.raw[2]+frame.raw[3]), frame.raw[4]);
         return false;
     }
-    if(data[0]==0 && data[1]==0 && data[2]==0 && data[3]==0) {
+    if(st == DHT22_DECODE_ALL_ZERO) {
         ESP_LOGW(TAG, "All-zero frame (RMT)");
         return false;
     }
-    uint16_t raw_h = ((uint16_t)data[0] << 8) | data[1];
-    uint16_t raw_t_mag = ((uint16_t)(data[2] & 0x7F) << 8) | data[3];
-    bool neg = (data[2] & 0x80) != 0;
-    hum_x10 = raw_h;
-    temp_x10 = neg ? -(int16_t)raw_t_mag : (int16_t)raw_t_mag;
-    if(temp_x10 < DHT22_TEMP_MIN_X10 || temp_x10 > DHT22_TEMP_MAX_X10 || hum_x10 < DHT22_HUM_MIN_X10 || hum_x10 > DHT22_HUM_MAX_X10) {
+    hum_x10 = frame.hum_x10;
+    temp_x10 = frame.temp_x10;
+    if(st == DHT22_DECODE_OUT_OF_RANGE) {
         ESP_LOGW(TAG, "Out-of-range t=%d h=%u", (int)temp_x10, (unsigned)hum_x10);
         return false;
     }
@@ -225,6 +222,8 @@ static void report(int16_t t_0_01, uint16_t h_0_01){
     if(t_0_01 < -27315) t_0_01 = -27315;
     if(t_0_01 > 32767) t_0_01 = 32767;
     if(h_0_01 > 10000) h_0_01 = 10000;
+    s_m_reports.inc();
+    TRACE_SCOPE("temp.report");
 
     if (g_temp_endpoint_id) {
         esp_matter_attr_val_t v{}; v.type = ESP_MATTER_VAL_TYPE_NULLABLE_INT16; v.val.i16 = t_0_01;
@@ -234,6 +233,7 @@ static void report(int16_t t_0_01, uint16_t h_0_01){
             chip::app::Clusters::TemperatureMeasurement::Attributes::MeasuredValue::Id,
             &v);
         if (err != ESP_OK) {
+            s_m_report_errors.inc();
             ESP_LOGE(TAG, "Temp report nullable failed err=%d", err);
         } else {
             ESP_LOGD(TAG, "Temp (nullable)=%d", (int)v.val.i16);
@@ -247,6 +247,7 @@ static void report(int16_t t_0_01, uint16_t h_0_01){
             chip::app::Clusters::RelativeHumidityMeasurement::Attributes::MeasuredValue::Id,
             &v2);
         if (errh != ESP_OK) {
+            s_m_report_errors.inc();
             ESP_LOGE(TAG, "Humidity report nullable failed err=%d", errh);
         } else {
             ESP_LOGD(TAG, "Humidity (nullable)=%u", (unsigned)v2.val.u16);
@@ -254,86 +255,106 @@ static void report(int16_t t_0_01, uint16_t h_0_01){
     }
 }
 
-static void task(void*){
-    ESP_LOGI(TAG,"start pin=%d period=%dms (RMT-based)", (int)DHT22_GPIO, DHT22_PERIOD_MS);
-    vTaskDelay(pdMS_TO_TICKS(DHT22_STABILIZE_DELAY_MS));
+// One read (with retries) + report cycle. Called from the sensor task every DHT22_PERIOD_MS;
+// the host build drives it directly.
+void temp_manager_poll_once(){
+    int16_t tx10=0; uint16_t hx10=0; bool ok=false;
     
-    while(!s_stop){
-        int16_t tx10=0; uint16_t hx10=0; bool ok=false;
-        
-        // Try reading with timeout protection
-        for(int a=0; a<DHT22_MAX_RETRIES && !ok && !s_stop; a++){ 
-            ok=dht22_read_rmt(tx10,hx10); 
-            if(!ok) vTaskDelay(pdMS_TO_TICKS(100)); // Longer delay between retries
-        }
-        
-        if(ok && !s_stop){
-            s_fail_streak=0; 
-            int16_t t001=(int16_t)(tx10*10); // Convert to 0.01 units
-            uint16_t h001=(uint16_t)(hx10*10);
+    // Try reading with timeout protection
+    for(int a=0; a<DHT22_MAX_RETRIES && !ok && !s_stop; a++){ 
+        int64_t t0 = esp_timer_get_time();
+        TRACE_BEGIN("dht.read");
+        ok=dht22_read_rmt(tx10,hx10); 
+        TRACE_END("dht.read");
+        s_m_read_us.record((uint32_t)(esp_timer_get_time() - t0));
+        if(ok) s_m_reads_ok.inc(); else s_m_reads_fail.inc();
+        if(!ok) vTaskDelay(pdMS_TO_TICKS(100)); // Longer delay between retries
+    }
+    
+    if(ok && !s_stop){
+        s_fail_streak=0; 
+        s_m_fail_streak.set(0);
+        int16_t t001=(int16_t)(tx10*10); // Convert to 0.01 units
+        uint16_t h001=(uint16_t)(hx10*10);
 
 #if DHT22_DISCARD_ZERO_FRAME
-            bool zero_frame = (t001 == 0 && h001 == 0);
-            if(zero_frame) {
-                ESP_LOGW(TAG, "Discarding all-zero DHT22 frame (suspect)");
-                ok = false; // treat as failure for retry/backoff logic
-            }
+        bool zero_frame = (t001 == 0 && h001 == 0);
+        if(zero_frame) {
+            ESP_LOGW(TAG, "Discarding all-zero DHT22 frame (suspect)");
+            ok = false; // treat as failure for retry/backoff logic
+        }
 #endif
 
-            if(ok && s_warmup_discarded < DHT22_WARMUP_READS) {
-                s_warmup_discarded++;
-                ESP_LOGI(TAG, "Warmup discard %d/%d", s_warmup_discarded, DHT22_WARMUP_READS);
-                ok = false; // skip report
+        if(ok && s_warmup_discarded < DHT22_WARMUP_READS) {
+            s_warmup_discarded++;
+            ESP_LOGI(TAG, "Warmup discard %d/%d", s_warmup_discarded, DHT22_WARMUP_READS);
+            ok = false; // skip report
+        }
+        
+        if(ok) {
+            s_have_valid = true;
+            s_last_t_0_01 = t001;
+            s_last_h_0_01 = h001;
+            s_m_last_t.set(t001);
+            s_m_last_h.set(h001);
+            rules_on_sample(t001, h001);
+            struct THVal { int16_t t; uint16_t h; };
+            THVal * vals = chip::Platform::New<THVal>();
+            if(vals){ 
+                vals->t = t001; 
+                vals->h = h001; 
+                work_probe_schedule(WorkSource::SensorReport, +[](intptr_t ctx){
+                    auto *v = reinterpret_cast<THVal*>(ctx);
+                    if(v) {
+                        report(v->t, v->h);
+                        ESP_LOGI(TAG,"report T=%.2fC RH=%.2f%%", v->t/100.0f, v->h/100.0f);
+                        chip::Platform::Delete(v);
+                    }
+                }, reinterpret_cast<intptr_t>(vals));
             }
-            
-            if(ok) {
-                s_have_valid = true;
-                s_last_t_0_01 = t001;
-                s_last_h_0_01 = h001;
+        } else {
+            // On invalid frame, optionally re-report last known good after several failures
+            if(s_have_valid && (s_fail_streak == 5 || s_fail_streak == 15)) {
                 struct THVal { int16_t t; uint16_t h; };
                 THVal * vals = chip::Platform::New<THVal>();
-                if(vals){ 
-                    vals->t = t001; 
-                    vals->h = h001; 
-                    chip::DeviceLayer::PlatformMgr().ScheduleWork(+[](intptr_t ctx){
+                if(vals){
+                    vals->t = s_last_t_0_01; vals->h = s_last_h_0_01;
+                    work_probe_schedule(WorkSource::SensorReport, +[](intptr_t ctx){
                         auto *v = reinterpret_cast<THVal*>(ctx);
-                        if(v) {
-                            report(v->t, v->h);
-                            ESP_LOGI(TAG,"report T=%.2fC RH=%.2f%%", v->t/100.0f, v->h/100.0f);
-                            chip::Platform::Delete(v);
-                        }
-                    }, reinterpret_cast<intptr_t>(vals));
-                }
-            } else {
-                // On invalid frame, optionally re-report last known good after several failures
-                if(s_have_valid && (s_fail_streak == 5 || s_fail_streak == 15)) {
-                    struct THVal { int16_t t; uint16_t h; };
-                    THVal * vals = chip::Platform::New<THVal>();
-                    if(vals){
-                        vals->t = s_last_t_0_01; vals->h = s_last_h_0_01;
-                        chip::DeviceLayer::PlatformMgr().ScheduleWork(+[](intptr_t ctx){
-                            auto *v = reinterpret_cast<THVal*>(ctx);
-                            if(v){ report(v->t, v->h); chip::Platform::Delete(v);} }, reinterpret_cast<intptr_t>(vals));
-                        ESP_LOGI(TAG, "Re-reporting last valid reading after failures");
-                    }
+                        if(v){ report(v->t, v->h); chip::Platform::Delete(v);} }, reinterpret_cast<intptr_t>(vals));
+                    ESP_LOGI(TAG, "Re-reporting last valid reading after failures");
                 }
             }
-        } else if(!s_stop) {
-            s_fail_streak++;
-            if(s_fail_streak==3 || (s_fail_streak%10)==0) {
-                ESP_LOGW(TAG,"read failures streak=%d", s_fail_streak);
-            }
         }
-        
+    } else if(!s_stop) {
+        s_fail_streak++;
+        s_m_fail_streak.set(s_fail_streak);
+        if(s_fail_streak==3 || (s_fail_streak%10)==0) {
+            ESP_LOGW(TAG,"read failures streak=%d", s_fail_streak);
+        }
+    }
+}
+
+static void task(void*){
+    ESP_LOGI(TAG,"start pin=%d period=%dms (RMT-based)", (int)DHT22_GPIO, DHT22_PERIOD_MS);
+    vTaskDelay(pdMS_TO_TICKS(DHT22_STABILIZE_DELAY_MS));
+
+    while(true){
+        // Static task: park on a notification while stopped instead of deleting itself.
+        if(s_stop){ ulTaskNotifyTake(pdTRUE, portMAX_DELAY); continue; }
+        temp_manager_poll_once();
         if(!s_stop) vTaskDelay(pdMS_TO_TICKS(DHT22_PERIOD_MS));
     }
-    s_task = nullptr;
-    vTaskDelete(nullptr);
 }
 
 void temp_manager_start(){ 
-    if(s_task || !DHT22_ENABLE) return; 
+    if(!DHT22_ENABLE) return; 
+    if(s_task){
+        if(s_stop){ s_stop=false; xTaskNotifyGive(s_task); }
+        return;
+    }
     s_stop=false; 
+    rules_init();
     // Prime attributes with NULL so esp-matter sets internal type expectations
     if (g_temp_endpoint_id) {
         esp_matter_attr_val_t v{}; v.type = ESP_MATTER_VAL_TYPE_NULLABLE_INT16; v.val.i16 = 0; // non-null 0
@@ -349,14 +370,11 @@ void temp_manager_start(){
             chip::app::Clusters::RelativeHumidityMeasurement::Attributes::MeasuredValue::Id,
             &v2);
     }
-    xTaskCreate(task,"temp_mgr",4096,nullptr, tskIDLE_PRIORITY+1,&s_task);
+    s_task = rtos_static_task_start(RtosTask::TempMgr, task, nullptr, tskIDLE_PRIORITY+1);
 } 
 
 void temp_manager_stop(){ 
-    s_stop=true; 
-    if(s_task) {
-        vTaskDelay(pdMS_TO_TICKS(100)); // Give task time to exit
-    }
+    s_stop=true; // the task parks after its current read
 }
 
 void temp_manager_force_read(){ 
@@ -367,4 +385,5 @@ void temp_manager_force_read(){
 void temp_manager_start(){ESP_LOGI(TAG, "DHT22 disabled (DHT22_ENABLE=0)");}
 void temp_manager_stop(){}
 void temp_manager_force_read(){}
+void temp_manager_poll_once(){}
 #endif
@@ -9,6 +9,8 @@ extern "C" {
 void temp_manager_start();
 void temp_manager_stop();
 void temp_manager_force_read();
+// Single read + report cycle (normally run by the sensor task; used directly by the host build).
+void temp_manager_poll_once();
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,254 @@
+#!/usr/bin/env python3
+"""Scale tests: how the switch behaves as one channel is bound to more lights.
+
+Two modes:
+
+  host   Build host/ and run host_scale (switch logic + simulated lights, in process) over a
+         range of target counts. Writes a JSON report and can compare it with a baseline.
+
+             scale_test.py host --targets 1,5,10,25,50 -o scale.json
+             scale_test.py host --baseline old.json --max-regress 0.15
+
+  fleet  Start N Linux chip-lighting-app instances on this host, commission them with chip-tool,
+         grant the switch Operate on OnOff and write the switch's Binding list so a real device
+         fans out to all of them. Then run `matter bench toggle` / `matter metrics` on the device.
+         The device's own Binding cluster holds at most MAX_SHADOW_BINDINGS_PER_CH entries per
+         channel, so rebuild with a larger value for N > 10.
+
+             scale_test.py fleet --lighting-app out/chip-lighting-app --chip-tool out/chip-tool \\
+                 --count 20 --switch-node 0x10 --switch-endpoint 1
+
+         Instances stay up until Ctrl-C; state lives in a temp directory removed on exit.
+"""
+import argparse
+import json
+import os
+import platform
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST_DIR = os.path.join(REPO, "host")
+
+
+# ---------------------------------------------------------------------------- host mode
+
+def build_host(build_dir):
+    subprocess.check_call(["cmake", "-S", HOST_DIR, "-B", build_dir, "-DCMAKE_BUILD_TYPE=Release"], stdout=subprocess.DEVNULL)
+    subprocess.check_call(["cmake", "--build", build_dir, "-j", str(os.cpu_count() or 2), "--target", "host_scale"],
+                          stdout=subprocess.DEVNULL)
+    return os.path.join(build_dir, "host_scale")
+
+
+def run_scale(exe, targets, iters, group):
+    cmd = [exe, "--targets", targets, "--iters", str(iters), "--json", "-"]
+    if group:
+        cmd.append("--group")
+    out = subprocess.check_output(cmd, text=True)
+    return json.loads(out[out.index("{"):])
+
+
+def git_rev():
+    try:
+        return subprocess.check_output(["git", "-C", REPO, "rev-parse", "--short", "HEAD"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def compare(report, baseline, max_regress):
+    """Return list of regressions (metric p50 grew by more than max_regress)."""
+    def index(rep):
+        return {(r["mode"], r["targets"]): r for r in rep["results"]}
+    base = index(baseline)
+    bad = []
+    for key, cur in index(report).items():
+        old = base.get(key)
+        if not old:
+            continue
+        for metric in ("toggle", "sync"):
+            a, b = old[metric]["p50_ns"], cur[metric]["p50_ns"]
+            if a > 0 and (b - a) / a > max_regress:
+                bad.append(f"{key[0]} N={key[1]} {metric}.p50 {a:.0f} -> {b:.0f} ns (+{(b - a) / a:.0%})")
+        if cur["heap"]["calls"] > old["heap"]["calls"]:
+            bad.append(f"{key[0]} N={key[1]} heap.calls {old['heap']['calls']} -> {cur['heap']['calls']}")
+    return bad
+
+
+def cmd_host(args):
+    exe = args.exe or build_host(args.build_dir)
+    results = []
+    for mode, group in (("unicast", False), ("unicast+group", True)):
+        rep = run_scale(exe, args.targets, args.iters, group)
+        for r in rep["results"]:
+            r["mode"] = mode
+            results.append(r)
+    report = {
+        "schema": "switch-scale-report/1",
+        "git_rev": git_rev(),
+        "host": platform.node(),
+        "machine": platform.machine(),
+        "created": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "iters": rep["iters"],
+        "max_bindings_per_ch": rep["max_bindings_per_ch"],
+        "static_bytes": rep["static_bytes"],
+        "results": results,
+    }
+    text = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+    print(f"{'mode':<14}{'N':>5}{'toggle p50':>12}{'toggle p99':>12}{'sync p50':>12}{'heap':>6}", file=sys.stderr)
+    for r in results:
+        print(f"{r['mode']:<14}{r['targets']:>5}{r['toggle']['p50_ns']:>10.0f}ns{r['toggle']['p99_ns']:>10.0f}ns"
+              f"{r['sync']['p50_ns']:>10.0f}ns{r['heap']['calls']:>6}", file=sys.stderr)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            bad = compare(report, json.load(f), args.max_regress)
+        for line in bad:
+            print("REGRESSION " + line, file=sys.stderr)
+        return 1 if bad else 0
+    return 0
+
+
+# ---------------------------------------------------------------------------- fleet mode
+
+def chip_tool(args, *cmd):
+    full = [args.chip_tool] + list(cmd) + ["--storage-directory", args.chip_tool_storage]
+    if args.verbose:
+        print("+ " + " ".join(full), file=sys.stderr)
+    res = subprocess.run(full, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True, timeout=args.timeout)
+    if res.returncode != 0:
+        sys.stderr.write(res.stdout[-2000:])
+        raise RuntimeError(f"chip-tool {' '.join(cmd[:2])} failed ({res.returncode})")
+    return res.stdout
+
+
+def rss_kb(pid):
+    try:
+        with open(f"/proc/{pid}/status") as f:
+            for line in f:
+                if line.startswith("VmRSS:"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return 0
+
+
+def cmd_fleet(args):
+    work = tempfile.mkdtemp(prefix="switch-fleet-")
+    procs = []
+
+    def teardown(*_):
+        for p in procs:
+            if p.poll() is None:
+                p.send_signal(signal.SIGTERM)
+        for p in procs:
+            try:
+                p.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                p.kill()
+        shutil.rmtree(work, ignore_errors=True)
+
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    report = {"schema": "switch-fleet-report/1", "count": args.count, "lights": [], "created": time.strftime("%Y-%m-%dT%H:%M:%S")}
+    try:
+        for i in range(args.count):
+            port = args.base_port + i
+            disc = args.base_discriminator + i
+            log = open(os.path.join(work, f"light{i}.log"), "w")
+            p = subprocess.Popen([args.lighting_app, "--secured-device-port", str(port), "--discriminator", str(disc),
+                                  "--passcode", str(args.passcode), "--KVS", os.path.join(work, f"light{i}.kvs")],
+                                 stdout=log, stderr=subprocess.STDOUT)
+            procs.append(p)
+        time.sleep(args.startup_s)
+
+        bindings = []
+        for i, p in enumerate(procs):
+            node = args.base_node + i
+            disc = args.base_discriminator + i
+            t0 = time.monotonic()
+            chip_tool(args, "pairing", "onnetwork-long", str(node), str(args.passcode), str(disc))
+            commission_s = time.monotonic() - t0
+            acl = [
+                {"fabricIndex": 1, "privilege": 5, "authMode": 2, "subjects": [args.controller_node], "targets": None},
+                {"fabricIndex": 1, "privilege": 3, "authMode": 2, "subjects": [args.switch_node],
+                 "targets": [{"cluster": 6, "endpoint": 1, "deviceType": None}]},
+            ]
+            chip_tool(args, "accesscontrol", "write", "acl", json.dumps(acl), str(node), "0")
+            bindings.append({"fabricIndex": 1, "node": node, "endpoint": 1, "cluster": 6})
+            report["lights"].append({"node": node, "pid": p.pid, "commission_s": round(commission_s, 3), "rss_kb": rss_kb(p.pid)})
+            print(f"light {i}: node=0x{node:X} commissioned in {commission_s:.1f}s", file=sys.stderr)
+
+        if args.group is not None:
+            bindings.append({"fabricIndex": 1, "group": args.group})
+        t0 = time.monotonic()
+        chip_tool(args, "binding", "write", "binding", json.dumps(bindings), str(args.switch_node), str(args.switch_endpoint))
+        report["binding_write_s"] = round(time.monotonic() - t0, 3)
+        report["rss_kb_total"] = sum(rss_kb(p.pid) for p in procs)
+
+        text = json.dumps(report, indent=2)
+        if args.output:
+            with open(args.output, "w") as f:
+                f.write(text + "\n")
+        else:
+            print(text)
+        print(f"{args.count} lights bound to switch 0x{args.switch_node:X} ep{args.switch_endpoint}. "
+              f"Run `matter bench toggle <ch> <count> <interval_ms>` on the device; Ctrl-C to stop.", file=sys.stderr)
+        while all(p.poll() is None for p in procs):
+            time.sleep(1)
+        print("a light instance exited; stopping", file=sys.stderr)
+        return 1
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        teardown()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="mode", required=True)
+
+    h = sub.add_parser("host", help="in-process scale sweep (host build)")
+    h.add_argument("--targets", default="1,5,10,25,50")
+    h.add_argument("--iters", type=int, default=200)
+    h.add_argument("--build-dir", default=os.path.join(HOST_DIR, "build-scale"))
+    h.add_argument("--exe", help="use an existing host_scale binary instead of building")
+    h.add_argument("-o", "--output", help="report path (default: stdout)")
+    h.add_argument("--baseline", help="previous report; exit 1 on regression")
+    h.add_argument("--max-regress", type=float, default=0.15, help="allowed p50 growth ratio (default 0.15)")
+    h.set_defaults(func=cmd_host)
+
+    f = sub.add_parser("fleet", help="N chip-lighting-app instances bound to a real switch")
+    f.add_argument("--lighting-app", required=True)
+    f.add_argument("--chip-tool", required=True)
+    f.add_argument("--count", type=int, default=10)
+    f.add_argument("--switch-node", type=lambda s: int(s, 0), required=True)
+    f.add_argument("--switch-endpoint", type=int, default=1)
+    f.add_argument("--group", type=lambda s: int(s, 0), help="also bind this group id")
+    f.add_argument("--controller-node", type=int, default=112233, help="chip-tool's node id (ACL admin)")
+    f.add_argument("--base-node", type=lambda s: int(s, 0), default=0x1000)
+    f.add_argument("--base-port", type=int, default=5600)
+    f.add_argument("--base-discriminator", type=int, default=3000)
+    f.add_argument("--passcode", type=int, default=20202021)
+    f.add_argument("--startup-s", type=float, default=3.0)
+    f.add_argument("--timeout", type=float, default=120.0, help="per chip-tool command")
+    f.add_argument("--chip-tool-storage", default=os.path.expanduser("~/.chip-tool"),
+                   help="chip-tool storage dir (must hold the fabric the switch is on)")
+    f.add_argument("-o", "--output")
+    f.add_argument("-v", "--verbose", action="store_true")
+    f.set_defaults(func=cmd_fleet)
+
+    args = ap.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Convert a `matter trace dump` capture into Chrome Trace Event JSON.
+
+Usage:
+    trace2chrome.py monitor.log [-o trace.json]
+    idf.py monitor | tee monitor.log   # then: matter trace dump
+
+The last "=== TRACE BEGIN ... === / === TRACE END ===" block in the input is used.
+Open the output in chrome://tracing or https://ui.perfetto.dev.
+"""
+import argparse
+import json
+import re
+import sys
+
+ANSI = re.compile(r"\x1b\[[0-9;]*m")
+BEGIN = re.compile(r"=== TRACE BEGIN")
+END = re.compile(r"=== TRACE END ===")
+
+
+def last_block(lines):
+    block, current = None, None
+    for raw in lines:
+        line = ANSI.sub("", raw).strip()
+        if BEGIN.search(line):
+            current = []
+        elif END.search(line):
+            if current is not None:
+                block = current
+            current = None
+        elif current is not None:
+            current.append(line)
+    return block
+
+
+def convert(block, pid=1):
+    events = []
+    threads = {}
+    wrap, last_raw, base = 0, None, None
+    for line in block:
+        parts = line.split(",", 5)
+        if parts[0] == "N" and len(parts) >= 3:
+            threads[int(parts[1])] = ",".join(parts[2:])
+            continue
+        if parts[0] != "E" or len(parts) != 6:
+            continue
+        raw, ph, tid, arg, name = int(parts[1]), parts[2], int(parts[3]), int(parts[4]), parts[5]
+        # Device timestamps are the low 32 bits of esp_timer time.
+        if last_raw is not None and raw < last_raw and last_raw - raw > (1 << 31):
+            wrap += 1 << 32
+        last_raw = raw
+        ts = raw + wrap
+        if base is None:
+            base = ts
+        ev = {"name": name, "ph": ph, "ts": ts - base, "pid": pid, "tid": tid}
+        if ph == "i":
+            ev["s"] = "t"
+            ev["args"] = {"arg": arg}
+        elif ph in ("b", "e"):
+            ev["cat"] = "async"
+            ev["id"] = hex(arg)
+        elif ph == "C":
+            ev["args"] = {name: arg}
+        events.append(ev)
+    for tid, tname in sorted(threads.items()):
+        events.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": tid, "args": {"name": tname}})
+    events.append({"name": "process_name", "ph": "M", "pid": pid, "args": {"name": "firmware"}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("input", nargs="?", help="captured serial log (default: stdin)")
+    ap.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = ap.parse_args()
+
+    with (open(args.input, errors="replace") if args.input else sys.stdin) as f:
+        block = last_block(f)
+    if block is None:
+        sys.exit("no complete TRACE BEGIN/END block found")
+    trace = convert(block)
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    if args.output:
+        out.close()
+        n = sum(1 for e in trace["traceEvents"] if e["ph"] != "M")
+        print(f"wrote {n} events to {args.output}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()